@@ -20,6 +20,15 @@ try {
     log.info('QUIC is not enabled for internal IO');
 }
 
+if (global.config && global.config.internal) {
+    var compact = !!global.config.internal.compact_frame_format;
+    internalIO.setFrameWireConfig(compact);
+    internalIO.setShmConfig(global.config.internal.shm_ring_bytes || 0);
+    if (quicIO) {
+        quicIO.setFrameWireConfig(compact);
+    }
+}
+
 var cf = 'leaf_cert.pem';
 var kf = 'leaf_cert.pkcs8';
 var cipher;
@@ -38,7 +47,7 @@ try {
     log.info('Failed to set secure for internal IO');
 }
 
-// Wrapper object for sctp-connection and tcp/udp-connection
+// Wrapper object for sctp-connection and tcp/udp/shm-connection
 function InConnection(prot, minport, maxport, ticket) {
     var conn = null;
     var protocol = "quic";
@@ -46,6 +55,7 @@ function InConnection(prot, minport, maxport, ticket) {
     switch (prot) {
         case 'tcp':
         case 'udp':
+        case 'shm':
             protocol = prot;
             conn = new InternalIn(prot, minport, maxport, ticket);
             break;
@@ -77,7 +87,7 @@ function InConnection(prot, minport, maxport, ticket) {
     return conn;
 }
 
-// Wrapper object for sctp-connection and tcp/udp-connection
+// Wrapper object for sctp-connection and tcp/udp/shm-connection
 function OutConnection(prot, minport, maxport, ticket) {
     var that = {};
     var conn = null;
@@ -86,6 +96,7 @@ function OutConnection(prot, minport, maxport, ticket) {
     switch (prot) {
         case 'tcp':
         case 'udp':
+        case 'shm':
         case 'quic':
             protocol = prot;
             break;
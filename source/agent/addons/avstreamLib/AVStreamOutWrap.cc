@@ -6,6 +6,7 @@
 #include <MediaFramePipeline.h>
 #include <MediaFileOut.h>
 #include <LiveStreamOut.h>
+#include <TeeStreamOut.h>
 
 using namespace v8;
 
@@ -14,6 +15,63 @@ static std::string getString(v8::Local<v8::Value> value) {
   return std::string(*value_str);
 }
 
+// connection: {
+//   protocol: ('rtmp', 'rtsp', 'hls', 'dash')
+//   url: (string)
+//   parameters: (required for 'hls' and 'dash')
+// }
+static bool getStreamingOptions(Local<Object> connection, owt_base::LiveStreamOut::StreamingOptions& opts, std::string& url)
+{
+    std::string protocol = getString(
+        Nan::Get(connection, Nan::New("protocol").ToLocalChecked()).ToLocalChecked());
+    url = getString(
+        Nan::Get(connection, Nan::New("url").ToLocalChecked()).ToLocalChecked());
+
+    owt_base::LiveStreamOut::StreamingFormat format;
+    if (protocol.compare("rtsp") == 0) {
+        format = owt_base::LiveStreamOut::STREAMING_FORMAT_RTSP;
+    } else if (protocol.compare("rtmp") == 0) {
+        format = owt_base::LiveStreamOut::STREAMING_FORMAT_RTMP;
+    } else if (protocol.compare("hls") == 0) {
+        format = owt_base::LiveStreamOut::STREAMING_FORMAT_HLS;
+    } else if (protocol.compare("dash") == 0) {
+        format = owt_base::LiveStreamOut::STREAMING_FORMAT_DASH;
+    } else {
+        return false;
+    }
+
+    opts.format = format;
+    if (protocol.compare("hls") == 0) {
+        Local<Object> parameters = Nan::To<v8::Object>(
+            Nan::Get(connection, Nan::New("parameters").ToLocalChecked()).ToLocalChecked())
+            .ToLocalChecked();
+        opts.hls_time = Nan::To<int32_t>(
+            Nan::Get(parameters, Nan::New("hlsTime").ToLocalChecked()).ToLocalChecked()).FromJust();
+        opts.hls_list_size = Nan::To<int32_t>(
+            Nan::Get(parameters, Nan::New("hlsListSize").ToLocalChecked()).ToLocalChecked()).FromJust();
+
+        memset(opts.hls_method, 0, sizeof(opts.hls_method));
+        strncat(opts.hls_method,
+                getString(Nan::Get(parameters, Nan::New("method").ToLocalChecked()).ToLocalChecked()).c_str(),
+                sizeof(opts.hls_method) - 1);
+
+    } else if (protocol.compare("dash") == 0) {
+        Local<Object> parameters = Nan::To<v8::Object>(
+            Nan::Get(connection, Nan::New("parameters").ToLocalChecked()).ToLocalChecked())
+            .ToLocalChecked();
+        opts.dash_seg_duration = Nan::To<int32_t>(
+            Nan::Get(parameters, Nan::New("dashSegDuration").ToLocalChecked()).ToLocalChecked()).FromJust();
+        opts.dash_window_size = Nan::To<int32_t>(
+            Nan::Get(parameters, Nan::New("dashWindowSize").ToLocalChecked()).ToLocalChecked()).FromJust();
+
+        memset(opts.dash_method, 0, sizeof(opts.dash_method));
+        strncat(opts.dash_method,
+                getString(Nan::Get(parameters, Nan::New("method").ToLocalChecked()).ToLocalChecked()).c_str(),
+                sizeof(opts.dash_method) - 1);
+    }
+    return true;
+}
+
 Persistent<Function> AVStreamOutWrap::constructor;
 AVStreamOutWrap::AVStreamOutWrap() {}
 AVStreamOutWrap::~AVStreamOutWrap() {}
@@ -61,7 +119,7 @@ void AVStreamOutWrap::New(const v8::FunctionCallbackInfo<v8::Value>& args)
     }
 
     // essential options: {
-    //     type: (required, 'avstream', or 'file')
+    //     type: (required, 'streaming', 'file', or 'tee')
     //     require_audio: (required, true or false)
     //     require_video: (required, true or false)
     //     audio_codec: (optional, string, 'pcm_raw' for rtsp/rtmp, 'pcmu', 'opus_48000_2' for recording, etc.),
@@ -73,6 +131,8 @@ void AVStreamOutWrap::New(const v8::FunctionCallbackInfo<v8::Value>& args)
     //       protocol: ('rtmp', 'rtsp', 'hls', 'dash')
     //       url: (string)
     //     }
+    //     outputs: (required, only for 'tee', array of {type, url, connection},
+    //               all muxed from one input queue)
     // }
     Local<Object> options = Nan::To<v8::Object>(args[0]).ToLocalChecked();
     bool requireAudio = Nan::To<bool>(
@@ -89,60 +149,50 @@ void AVStreamOutWrap::New(const v8::FunctionCallbackInfo<v8::Value>& args)
     if (type.compare("streaming") == 0) {
         Local<Object> connection = Nan::To<v8::Object>(
             Nan::Get(options, Nan::New("connection").ToLocalChecked()).ToLocalChecked()).ToLocalChecked();
-        std::string protocol = getString(
-            Nan::Get(connection, Nan::New("protocol").ToLocalChecked()).ToLocalChecked());
-        std::string url = getString(
-            Nan::Get(connection, Nan::New("url").ToLocalChecked()).ToLocalChecked());
-
-        owt_base::LiveStreamOut::StreamingFormat format;
-        if (protocol.compare("rtsp") == 0) {
-            format = owt_base::LiveStreamOut::STREAMING_FORMAT_RTSP;
-        } else if (protocol.compare("rtmp") == 0) {
-            format = owt_base::LiveStreamOut::STREAMING_FORMAT_RTMP;
-        } else if (protocol.compare("hls") == 0) {
-            format = owt_base::LiveStreamOut::STREAMING_FORMAT_HLS;
-        } else if (protocol.compare("dash") == 0) {
-            format = owt_base::LiveStreamOut::STREAMING_FORMAT_DASH;
-        } else {
+        owt_base::LiveStreamOut::StreamingOptions opts;
+        std::string url;
+        if (!getStreamingOptions(connection, opts, url)) {
             Nan::ThrowError("Unsupported AVStreamOut type");
             return;
         }
 
-        owt_base::LiveStreamOut::StreamingOptions opts;
-
-        opts.format = format;
-        if (protocol.compare("hls") == 0) {
-            Local<Object> parameters = Nan::To<v8::Object>(
-                Nan::Get(connection, Nan::New("parameters").ToLocalChecked()).ToLocalChecked())
-                .ToLocalChecked();
-            opts.hls_time = Nan::To<int32_t>(
-                Nan::Get(parameters, Nan::New("hlsTime").ToLocalChecked()).ToLocalChecked()).FromJust();
-            opts.hls_list_size = Nan::To<int32_t>(
-                Nan::Get(parameters, Nan::New("hlsListSize").ToLocalChecked()).ToLocalChecked()).FromJust();
-
-            memset(opts.hls_method, 0, sizeof(opts.hls_method));
-            strncat(opts.hls_method,
-                    getString(Nan::Get(parameters, Nan::New("method").ToLocalChecked()).ToLocalChecked()).c_str(),
-                    sizeof(opts.hls_method) - 1);
-
-        } else if (protocol.compare("dash") == 0) {
-            Local<Object> parameters = Nan::To<v8::Object>(
-                Nan::Get(connection, Nan::New("parameters").ToLocalChecked()).ToLocalChecked())
-                .ToLocalChecked();
-            opts.dash_seg_duration = Nan::To<int32_t>(
-                Nan::Get(parameters, Nan::New("dashSegDuration").ToLocalChecked()).ToLocalChecked()).FromJust();
-            opts.dash_window_size = Nan::To<int32_t>(
-                Nan::Get(parameters, Nan::New("dashWindowSize").ToLocalChecked()).ToLocalChecked()).FromJust();
-
-            memset(opts.dash_method, 0, sizeof(opts.dash_method));
-            strncat(opts.dash_method,
-                    getString(Nan::Get(parameters, Nan::New("method").ToLocalChecked()).ToLocalChecked()).c_str(),
-                    sizeof(opts.dash_method) - 1);
-        }
-
         obj->me = new owt_base::LiveStreamOut(url, requireAudio, requireVideo, obj, initializeTimeout, opts);
     } else if (type.compare("file") == 0) {
         obj->me = new owt_base::MediaFileOut(url, requireAudio, requireVideo, obj, initializeTimeout);
+    } else if (type.compare("tee") == 0) {
+        Local<Array> outputs = Local<Array>::Cast(
+            Nan::Get(options, Nan::New("outputs").ToLocalChecked()).ToLocalChecked());
+        std::vector<owt_base::TeeStreamOut::Sink> sinks;
+        for (uint32_t i = 0; i < outputs->Length(); i++) {
+            Local<Object> output = Nan::To<v8::Object>(Nan::Get(outputs, i).ToLocalChecked()).ToLocalChecked();
+            std::string outputType = getString(
+                Nan::Get(output, Nan::New("type").ToLocalChecked()).ToLocalChecked());
+
+            owt_base::TeeStreamOut::Sink sink;
+            if (outputType.compare("streaming") == 0) {
+                Local<Object> connection = Nan::To<v8::Object>(
+                    Nan::Get(output, Nan::New("connection").ToLocalChecked()).ToLocalChecked()).ToLocalChecked();
+                sink.isFile = false;
+                if (!getStreamingOptions(connection, sink.options, sink.url)) {
+                    Nan::ThrowError("Unsupported AVStreamOut type");
+                    return;
+                }
+            } else if (outputType.compare("file") == 0) {
+                sink.isFile = true;
+                sink.url = getString(
+                    Nan::Get(output, Nan::New("url").ToLocalChecked()).ToLocalChecked());
+            } else {
+                Nan::ThrowError("Unsupported AVStreamOut type");
+                return;
+            }
+            sinks.push_back(sink);
+        }
+
+        if (sinks.empty()) {
+            Nan::ThrowError("Wrong arguments");
+            return;
+        }
+        obj->me = new owt_base::TeeStreamOut(sinks, requireAudio, requireVideo, obj, initializeTimeout);
     } else {
         Nan::ThrowError("Unsupported AVStreamOut type");
         return;
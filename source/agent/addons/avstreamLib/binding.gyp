@@ -6,10 +6,12 @@
       'AVStreamInWrap.cc',
       'AVStreamOutWrap.cc',
       '../../addons/common/NodeEventRegistry.cc',
+      '../../addons/common/NodeEventDispatcher.cc',
       '../../../core/owt_base/MediaFramePipeline.cpp',
       '../../../core/owt_base/AVStreamOut.cpp',
       '../../../core/owt_base/MediaFileOut.cpp',
       '../../../core/owt_base/LiveStreamOut.cpp',
+      '../../../core/owt_base/TeeStreamOut.cpp',
       '../../../core/owt_base/LiveStreamIn.cpp',
     ],
     'include_dirs': [ "<!(node -e \"require('nan')\")",
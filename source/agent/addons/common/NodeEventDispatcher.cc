@@ -0,0 +1,310 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "NodeEventDispatcher.h"
+#include <chrono>
+#include <string.h>
+
+using namespace v8;
+
+DEFINE_LOGGER(NodeEventDispatcher, "NodeEventDispatcher");
+
+static uint64_t currentTimeMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+NodeEventDispatcher* NodeEventDispatcher::instance()
+{
+    // Never destroyed, its handle lives as long as the loop.
+    static NodeEventDispatcher* dispatcher = new NodeEventDispatcher();
+    return dispatcher;
+}
+
+NodeEventDispatcher::NodeEventDispatcher()
+    : m_signaled(false)
+    , m_nextId(0)
+    , m_dispatchedStatsKeys(0)
+    , m_statsPerSecond(kDefaultStatsPerSecond)
+    , m_hasStatsListener(false)
+{
+    for (Batch* batch : { &m_pending, &m_dispatching }) {
+        batch->records.reserve(kMaxPendingRecords);
+        batch->droppedStats = 0;
+    }
+    m_async.data = this;
+    uv_async_init(uv_default_loop(), &m_async, callback);
+    // The dispatcher is never destroyed, so its handle is never closed. Unreferenced, it does not keep the loop alive
+    // once the objects posting to it are gone, as their own handles used to be closed with them.
+    uv_unref(reinterpret_cast<uv_handle_t*>(&m_async));
+}
+
+NAN_MODULE_INIT(NodeEventDispatcher::Init)
+{
+    Nan::SetMethod(target, "setStatsListener", setStatsListener);
+    Nan::SetMethod(target, "setStatsRateLimit", setStatsRateLimit);
+}
+
+uint32_t NodeEventDispatcher::addListener(Listener* listener)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    uint32_t id = ++m_nextId;
+    m_sources[id] = Source{ listener, 0, 0 };
+    return id;
+}
+
+void NodeEventDispatcher::removeListener(uint32_t id)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_sources.erase(id);
+}
+
+// other thread
+bool NodeEventDispatcher::post(uint32_t id, const std::string& event, const std::string& data, bool emergency)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return append(id, event, data, emergency ? kEmergency : 0);
+}
+
+// other thread
+bool NodeEventDispatcher::postStats(uint32_t id, const std::string& data)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!allowStats(id)) {
+        return false;
+    }
+    return append(id, "", data, kStats);
+}
+
+// other thread
+bool NodeEventDispatcher::acceptStats(uint32_t id)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_hasStatsListener) {
+        return false;
+    }
+    return allowStats(id);
+}
+
+// other thread
+bool NodeEventDispatcher::postStats(uint32_t id, const std::vector<StatsValue>& values)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_hasStatsListener) {
+        return false;
+    }
+    if (m_pending.stats.size() / kStatsRecordSize + values.size() > kMaxPendingRecords) {
+        m_pending.droppedStats++;
+        return false;
+    }
+    for (const StatsValue& value : values) {
+        m_pending.stats.push_back(id);
+        m_pending.stats.push_back(value.group);
+        m_pending.stats.push_back(value.key);
+        m_pending.stats.push_back(value.value);
+    }
+    signal();
+    return true;
+}
+
+bool NodeEventDispatcher::append(uint32_t id, const std::string& event, const std::string& data, uint16_t flags)
+{
+    // Control events are never dropped, they carry state changes listeners can't recover from.
+    if ((flags & kStats) && m_pending.records.size() >= kMaxPendingRecords) {
+        m_pending.droppedStats++;
+        return false;
+    }
+    Record record;
+    record.source = id;
+    record.event = eventIndex(event);
+    record.flags = flags;
+    record.offset = m_pending.payload.size();
+    record.length = data.size();
+    m_pending.payload.insert(m_pending.payload.end(), data.begin(), data.end());
+    m_pending.records.push_back(record);
+    signal();
+    return true;
+}
+
+bool NodeEventDispatcher::allowStats(uint32_t id)
+{
+    auto it = m_sources.find(id);
+    if (it == m_sources.end()) {
+        return false;
+    }
+    Source& source = it->second;
+    uint64_t now = currentTimeMs();
+    if (now - source.statsWindowStart >= 1000) {
+        source.statsWindowStart = now;
+        source.statsInWindow = 0;
+    }
+    if (source.statsInWindow >= m_statsPerSecond) {
+        m_pending.droppedStats++;
+        return false;
+    }
+    source.statsInWindow++;
+    return true;
+}
+
+bool NodeEventDispatcher::hasStatsListener()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_hasStatsListener;
+}
+
+uint32_t NodeEventDispatcher::statsKey(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_statsKeyIndexes.find(name);
+    if (it != m_statsKeyIndexes.end()) {
+        return it->second;
+    }
+    uint32_t index = m_statsKeys.size();
+    m_statsKeys.push_back(name);
+    m_statsKeyIndexes[name] = index;
+    return index;
+}
+
+uint16_t NodeEventDispatcher::eventIndex(const std::string& event)
+{
+    auto it = m_eventIndexes.find(event);
+    if (it != m_eventIndexes.end()) {
+        return it->second;
+    }
+    // Event names are literals, a few dozens per addon.
+    uint16_t index = m_events.size();
+    m_events.push_back(event);
+    m_eventIndexes[event] = index;
+    return index;
+}
+
+void NodeEventDispatcher::signal()
+{
+    // One wakeup per batch.
+    if (!m_signaled) {
+        m_signaled = true;
+        uv_async_send(&m_async);
+    }
+}
+
+void NodeEventDispatcher::callback(uv_async_t* handle)
+{
+    reinterpret_cast<NodeEventDispatcher*>(handle->data)->dispatch();
+}
+
+NodeEventDispatcher::Listener* NodeEventDispatcher::listener(uint32_t id)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_sources.find(id);
+    return it == m_sources.end() ? nullptr : it->second.listener;
+}
+
+void NodeEventDispatcher::dispatch()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::swap(m_pending, m_dispatching);
+        m_signaled = false;
+        // Other threads may add names while dispatching.
+        m_dispatchedEvents.insert(m_dispatchedEvents.end(), m_events.begin() + m_dispatchedEvents.size(), m_events.end());
+    }
+    if (m_dispatching.droppedStats) {
+        ELOG_DEBUG("Dropped %lu stats reports", m_dispatching.droppedStats);
+        m_dispatching.droppedStats = 0;
+    }
+
+    const std::vector<Record>& records = m_dispatching.records;
+    for (auto it = records.rbegin(); it != records.rend(); ++it) {
+        if ((it->flags & kEmergency) == 0) {
+            continue;
+        }
+        // Looked up for each record, a listener may remove another one.
+        if (Listener* target = listener(it->source)) {
+            target->onDispatchedEvent(m_dispatchedEvents[it->event], m_dispatching.payload.data() + it->offset, it->length);
+        }
+    }
+    for (const Record& record : records) {
+        if (record.flags & kEmergency) {
+            continue;
+        }
+        Listener* target = listener(record.source);
+        if (!target) {
+            continue;
+        }
+        const char* data = m_dispatching.payload.data() + record.offset;
+        if (record.flags & kStats) {
+            target->onDispatchedStats(data, record.length);
+        } else {
+            target->onDispatchedEvent(m_dispatchedEvents[record.event], data, record.length);
+        }
+    }
+    m_dispatching.records.clear();
+    m_dispatching.payload.clear();
+
+    if (!m_dispatching.stats.empty()) {
+        dispatchStats();
+        m_dispatching.stats.clear();
+    }
+}
+
+void NodeEventDispatcher::dispatchStats()
+{
+    Nan::HandleScope scope;
+    if (m_statsListener.IsEmpty()) {
+        return;
+    }
+    const std::vector<double>& stats = m_dispatching.stats;
+    Local<Float64Array> records = Float64Array::New(
+        ArrayBuffer::New(Isolate::GetCurrent(), stats.size() * sizeof(double)), 0, stats.size());
+    Nan::TypedArrayContents<double> contents(records);
+    memcpy(*contents, stats.data(), stats.size() * sizeof(double));
+
+    int argc = 1;
+    Local<Value> argv[2] = { records, Nan::Undefined() };
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_statsKeys.size() > m_dispatchedStatsKeys) {
+            // All the names, keys are only added so listeners can replace their table.
+            Local<Array> keys = Nan::New<Array>(m_statsKeys.size());
+            for (size_t i = 0; i < m_statsKeys.size(); i++) {
+                Nan::Set(keys, i, Nan::New(m_statsKeys[i]).ToLocalChecked());
+            }
+            m_dispatchedStatsKeys = m_statsKeys.size();
+            argv[1] = keys;
+            argc = 2;
+        }
+    }
+    Nan::TryCatch tryCatch;
+    Nan::Call(Nan::New(m_statsListener), Nan::GetCurrentContext()->Global(), argc, argv);
+    if (tryCatch.HasCaught()) {
+        Nan::FatalException(tryCatch);
+    }
+}
+
+NAN_METHOD(NodeEventDispatcher::setStatsListener)
+{
+    NodeEventDispatcher* dispatcher = instance();
+    std::lock_guard<std::mutex> lock(dispatcher->m_mutex);
+    if (info.Length() > 0 && info[0]->IsFunction()) {
+        dispatcher->m_statsListener.Reset(info[0].As<Function>());
+        dispatcher->m_hasStatsListener = true;
+        // The next batch carries all key names.
+        dispatcher->m_dispatchedStatsKeys = 0;
+    } else {
+        dispatcher->m_statsListener.Reset();
+        dispatcher->m_hasStatsListener = false;
+    }
+}
+
+NAN_METHOD(NodeEventDispatcher::setStatsRateLimit)
+{
+    if (info.Length() < 1 || !info[0]->IsNumber()) {
+        Nan::ThrowTypeError("Wrong arguments");
+        return;
+    }
+    NodeEventDispatcher* dispatcher = instance();
+    std::lock_guard<std::mutex> lock(dispatcher->m_mutex);
+    dispatcher->m_statsPerSecond = Nan::To<uint32_t>(info[0]).FromJust();
+}
@@ -0,0 +1,130 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef NODEEVENTDISPATCHER_H
+#define NODEEVENTDISPATCHER_H
+
+#include <logger.h>
+#include <mutex>
+#include <nan.h>
+#include <string>
+#include <unordered_map>
+#include <uv.h>
+#include <vector>
+
+// Carries events and stats from native threads to the Node main thread for all objects of an addon.
+//
+// Posts are appended as fixed size records to a pending batch, with event payloads copied into one byte buffer. The
+// main thread is woken once per batch on a single uv_async_t, swaps the batch with the one it has drained and
+// dispatches it, so a steady flow of events allocates nothing and costs one wakeup per batch instead of per event.
+// Stats are numeric records handed to JavaScript as one Float64Array per batch, limited per object.
+class NodeEventDispatcher {
+    DECLARE_LOGGER();
+
+public:
+    class Listener {
+    public:
+        virtual ~Listener() { }
+        // On the main thread.
+        virtual void onDispatchedEvent(const std::string& event, const char* data, size_t length) = 0;
+        virtual void onDispatchedStats(const char* data, size_t length) { }
+    };
+
+    // A numeric stats value, `key` is from statsKey().
+    struct StatsValue {
+        uint32_t group;
+        uint32_t key;
+        double value;
+    };
+
+    static const size_t kMaxPendingRecords = 8192;
+    static const size_t kStatsRecordSize = 4;
+    static const uint32_t kDefaultStatsPerSecond = 1;
+
+    // Created on first use, which must be on the main thread.
+    static NodeEventDispatcher* instance();
+
+    // Exports setStatsListener(callback) and setStatsRateLimit(reportsPerSecond). The callback receives a
+    // Float64Array of [source, group, key, value] records and, when new keys were added, the array of key names.
+    static NAN_MODULE_INIT(Init);
+
+    // On the main thread. Records of a removed listener still pending are discarded.
+    uint32_t addListener(Listener*);
+    void removeListener(uint32_t id);
+
+    // Emergency events are dispatched before the other events of their batch, latest first. Events are never dropped.
+    bool post(uint32_t id, const std::string& event, const std::string& data, bool emergency = false);
+    // Stats reports are dropped beyond the rate limit of `id` or once kMaxPendingRecords are pending. A text report
+    // goes to the listener of `id`, numeric values to the stats listener set from JavaScript and are dropped if there's
+    // none. Numeric values are only posted after acceptStats(id), which applies the rate limit before they are built.
+    bool postStats(uint32_t id, const std::string& data);
+    bool acceptStats(uint32_t id);
+    bool postStats(uint32_t id, const std::vector<StatsValue>& values);
+    bool hasStatsListener();
+    uint32_t statsKey(const std::string& name);
+
+private:
+    NodeEventDispatcher();
+
+    struct Record {
+        uint32_t source;
+        uint16_t event;
+        uint16_t flags;
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    struct Batch {
+        std::vector<Record> records;
+        std::vector<char> payload;
+        // kStatsRecordSize doubles per value.
+        std::vector<double> stats;
+        uint64_t droppedStats;
+    };
+
+    struct Source {
+        Listener* listener;
+        uint64_t statsWindowStart;
+        uint32_t statsInWindow;
+    };
+
+    enum RecordFlags : uint16_t {
+        kEmergency = 1,
+        kStats = 2,
+    };
+
+    // With m_mutex held.
+    bool append(uint32_t id, const std::string& event, const std::string& data, uint16_t flags);
+    bool allowStats(uint32_t id);
+    uint16_t eventIndex(const std::string& event);
+    void signal();
+
+    static void callback(uv_async_t*);
+    void dispatch();
+    void dispatchStats();
+    Listener* listener(uint32_t id);
+
+    static NAN_METHOD(setStatsListener);
+    static NAN_METHOD(setStatsRateLimit);
+
+    uv_async_t m_async;
+    std::mutex m_mutex;
+    bool m_signaled;
+    Batch m_pending;
+    Batch m_dispatching;
+    uint32_t m_nextId;
+    std::unordered_map<uint32_t, Source> m_sources;
+    std::vector<std::string> m_events;
+    std::unordered_map<std::string, uint16_t> m_eventIndexes;
+    // The names of m_events known to the main thread.
+    std::vector<std::string> m_dispatchedEvents;
+    std::vector<std::string> m_statsKeys;
+    std::unordered_map<std::string, uint32_t> m_statsKeyIndexes;
+    size_t m_dispatchedStatsKeys;
+    uint32_t m_statsPerSecond;
+    bool m_hasStatsListener;
+    Nan::Persistent<v8::Function> m_statsListener;
+};
+
+#endif
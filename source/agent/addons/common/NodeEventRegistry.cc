@@ -3,7 +3,6 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "NodeEventRegistry.h"
-#include <list>
 #include <nan.h>
 
 using namespace v8;
@@ -20,37 +19,23 @@ NodeEventRegistry* NodeEventRegistry::New(const Local<Function>& f)
 
 NodeEventRegistry::NodeEventRegistry()
     : m_store{ Isolate::GetCurrent(), Object::New(Isolate::GetCurrent()) }
-    , m_uvHandle{ reinterpret_cast<uv_async_t*>(malloc(sizeof(uv_async_t))) }
+    , m_id{ NodeEventDispatcher::instance()->addListener(this) }
 {
-    if (m_uvHandle) {
-        m_uvHandle->data = this;
-        m_uvHandle->close_cb = closeCallback;
-        uv_async_init(uv_default_loop(), m_uvHandle, callback);
-    }
 }
 
 NodeEventRegistry::NodeEventRegistry(Isolate* isolate, const Local<Function>& f)
     : m_store{ Isolate::GetCurrent(), f }
-    , m_uvHandle{ reinterpret_cast<uv_async_t*>(malloc(sizeof(uv_async_t))) }
+    , m_id{ NodeEventDispatcher::instance()->addListener(this) }
 {
-    if (m_uvHandle) {
-        m_uvHandle->data = this;
-        m_uvHandle->close_cb = closeCallback;
-        uv_async_init(uv_default_loop(), m_uvHandle, callback);
-    }
 }
 
 NodeEventRegistry::~NodeEventRegistry()
 {
-    std::lock_guard<std::mutex> lock(m_lock);
+    NodeEventDispatcher::instance()->removeListener(m_id);
     m_store.Reset();
-    if (m_uvHandle && !uv_is_closing(reinterpret_cast<uv_handle_t*>(m_uvHandle)))
-        uv_close(reinterpret_cast<uv_handle_t*>(m_uvHandle), closeCallback);
-    if (m_uvHandle)
-        m_uvHandle->data = nullptr;
 }
 
-void NodeEventRegistry::process(const Data& data)
+void NodeEventRegistry::onDispatchedEvent(const std::string& event, const char* data, size_t length)
 {
     Isolate* isolate = Isolate::GetCurrent();
     HandleScope scope(isolate);
@@ -60,7 +45,7 @@ void NodeEventRegistry::process(const Data& data)
 
     const unsigned argc = 1;
     Local<Value> argv[argc] = {
-        Nan::New(data.message.c_str()).ToLocalChecked()
+        Nan::New(data, length).ToLocalChecked()
     };
     TryCatch try_catch(isolate);
 
@@ -75,7 +60,7 @@ void NodeEventRegistry::process(const Data& data)
         return;
     }
 
-    Local<Value> val = Nan::Get(store, Nan::New(data.event.c_str()).ToLocalChecked())
+    Local<Value> val = Nan::Get(store, Nan::New(event).ToLocalChecked())
                        .ToLocalChecked();
     if (!val->IsFunction())
         return;
@@ -87,70 +72,16 @@ void NodeEventRegistry::process(const Data& data)
     }
 }
 
-void NodeEventRegistry::process()
-{
-    std::list<Data> datas;
-    {
-        std::lock_guard<std::mutex> lock(m_lock);
-        while (true) {
-            Data data;
-            {
-                if (!m_buffer.empty()) {
-                    data = m_buffer.front();
-                    m_buffer.pop_front();
-                } else {
-                    break;
-                }
-            }
-            datas.push_back(data);
-        }
-    }
-    for (std::list<Data>::iterator it = datas.begin(); it != datas.end(); ++it) {
-        process(*it);
-    }
-}
-
 // other thread
 bool NodeEventRegistry::notifyAsyncEvent(const std::string& event, const std::string& data)
 {
-    if (m_uvHandle && uv_is_active(reinterpret_cast<uv_handle_t*>(m_uvHandle))) {
-        {
-            std::lock_guard<std::mutex> lock(m_lock);
-            m_buffer.push_back(Data{ event, data });
-        }
-        uv_async_send(m_uvHandle);
-        return true;
-    }
-    return false;
+    return NodeEventDispatcher::instance()->post(m_id, event, data);
 }
 
 // other thread
 bool NodeEventRegistry::notifyAsyncEventInEmergency(const std::string& event, const std::string& data)
 {
-    if (m_uvHandle && uv_is_active(reinterpret_cast<uv_handle_t*>(m_uvHandle))) {
-        {
-            std::lock_guard<std::mutex> lock(m_lock);
-            m_buffer.push_front(Data{ event, data });
-        }
-        uv_async_send(m_uvHandle);
-        return true;
-    }
-    return false;
-}
-
-void NodeEventRegistry::closeCallback(uv_handle_t* handle)
-{
-    free(handle);
-    handle = nullptr;
-}
-
-void NodeEventRegistry::callback(uv_async_t* handle)
-{
-    if (handle && uv_is_active(reinterpret_cast<uv_handle_t*>(handle)) && handle->data) {
-        NodeEventRegistry* registry = reinterpret_cast<NodeEventRegistry*>(handle->data);
-        if (registry)
-            registry->process();
-    }
+    return NodeEventDispatcher::instance()->post(m_id, event, data, true);
 }
 
 NodeEventedObjectWrap::NodeEventedObjectWrap()
@@ -5,17 +5,15 @@
 #ifndef NODEEVENTREGISTRY_H
 #define NODEEVENTREGISTRY_H
 
+#include "NodeEventDispatcher.h"
 #include <EventRegistry.h>
 #include <memory>
-#include <mutex>
 #include <node.h>
 #include <node_object_wrap.h>
-#include <queue>
 #include <string>
-#include <uv.h>
 
-// Implement ::EventRegistry interface
-class NodeEventRegistry : public ::EventRegistry {
+// Implement ::EventRegistry interface, events are delivered through the NodeEventDispatcher of the addon.
+class NodeEventRegistry : public ::EventRegistry, public NodeEventDispatcher::Listener {
 public:
     static NodeEventRegistry* New(v8::Isolate*, const v8::Local<v8::Function>&);
     static NodeEventRegistry* New(const v8::Local<v8::Function>&);
@@ -28,19 +26,11 @@ protected:
     explicit NodeEventRegistry();
     explicit NodeEventRegistry(v8::Isolate*, const v8::Local<v8::Function>&);
 
-    struct Data {
-        std::string event, message;
-    };
     v8::Persistent<v8::Object> m_store;
 
 private:
-    uv_async_t* m_uvHandle;
-    std::mutex m_lock;
-    std::deque<Data> m_buffer;
-    void process();
-    void process(const Data& data);
-    static void closeCallback(uv_handle_t*);
-    static void callback(uv_async_t*);
+    uint32_t m_id;
+    void onDispatchedEvent(const std::string& event, const char* data, size_t length) override;
 };
 
 class NodeEventedObjectWrap : public node::ObjectWrap, public NodeEventRegistry {
@@ -8,6 +8,10 @@
 
 #include "InternalConfig.h"
 #include <nan.h>
+#include <FrameWireFormat.h>
+#include <IOService.h>
+#include <SendQueue.h>
+#include <ShmChannel.h>
 #include <TransportBase.h>
 
 using namespace v8;
@@ -18,8 +22,82 @@ void setPassphrase(const Nan::FunctionCallbackInfo<v8::Value>& info) {
   owt_base::TransportSecret::setPassphrase(p);
 }
 
+// Arguments: maxBytes, maxItems, policy ("drop-oldest", "drop-until-keyframe" or "block")
+void setSendQueueConfig(const Nan::FunctionCallbackInfo<v8::Value>& info) {
+  owt_base::SendQueueConfig& config = owt_base::SendQueueConfig::defaultConfig();
+  if (info.Length() > 0 && info[0]->IsNumber()) {
+    config.maxBytes = Nan::To<uint32_t>(info[0]).FromJust();
+  }
+  if (info.Length() > 1 && info[1]->IsNumber()) {
+    config.maxItems = Nan::To<uint32_t>(info[1]).FromJust();
+  }
+  if (info.Length() > 2 && info[2]->IsString()) {
+    Nan::Utf8String param2(Nan::To<v8::String>(info[2]).ToLocalChecked());
+    if (!owt_base::SendQueueConfig::parsePolicy(std::string(*param2), config.policy)) {
+      Nan::ThrowError("Unknown send queue policy");
+    }
+  }
+}
+
+// Arguments: serviceNum (0 for the number of cores), pinThreads. Only takes
+// effect before the first internal connection.
+void setIOServiceConfig(const Nan::FunctionCallbackInfo<v8::Value>& info) {
+  owt_base::IOServiceConfig& config = owt_base::IOServiceConfig::defaultConfig();
+  if (info.Length() > 0 && info[0]->IsNumber()) {
+    config.serviceNum = Nan::To<uint32_t>(info[0]).FromJust();
+  }
+  if (info.Length() > 1 && info[1]->IsBoolean()) {
+    config.pinThreads = Nan::To<bool>(info[1]).FromJust();
+  }
+}
+
+// Arguments: ringBytes, the ring size of the shared memory connections
+// created afterwards, 0 for the default
+void setShmConfig(const Nan::FunctionCallbackInfo<v8::Value>& info) {
+  if (info.Length() > 0 && info[0]->IsNumber()) {
+    owt_base::ShmChannelConfig::defaultConfig().ringBytes = Nan::To<uint32_t>(info[0]).FromJust();
+  }
+}
+
+// Arguments: compact, whether to send frames in the compact wire format
+// instead of the legacy one every agent reads
+void setFrameWireConfig(const Nan::FunctionCallbackInfo<v8::Value>& info) {
+  if (info.Length() > 0 && info[0]->IsBoolean()) {
+    owt_base::FrameWireConfig::defaultConfig().compact = Nan::To<bool>(info[0]).FromJust();
+  }
+}
+
+// Returns [{inProcess, users, busyRatio}] for the pooled IO services
+void getIOServiceStats(const Nan::FunctionCallbackInfo<v8::Value>& info) {
+  std::vector<owt_base::IOServiceStats> stats = owt_base::getIOServiceStats();
+  Local<Array> result = Nan::New<Array>(stats.size());
+  for (size_t i = 0; i < stats.size(); i++) {
+    Local<Object> item = Nan::New<Object>();
+    Nan::Set(item, Nan::New("inProcess").ToLocalChecked(), Nan::New(stats[i].inProcessCount));
+    Nan::Set(item, Nan::New("users").ToLocalChecked(), Nan::New(stats[i].userCount));
+    Nan::Set(item, Nan::New("busyRatio").ToLocalChecked(), Nan::New(stats[i].busyRatio));
+    Nan::Set(result, i, item);
+  }
+  info.GetReturnValue().Set(result);
+}
+
 void InitInternalConfig(v8::Local<v8::Object> exports) {
   Local<FunctionTemplate> tpl = Nan::New<FunctionTemplate>(setPassphrase);
   Nan::Set(exports, Nan::New("setPassphrase").ToLocalChecked(),
            Nan::GetFunction(tpl).ToLocalChecked());
+  Local<FunctionTemplate> queueTpl = Nan::New<FunctionTemplate>(setSendQueueConfig);
+  Nan::Set(exports, Nan::New("setSendQueueConfig").ToLocalChecked(),
+           Nan::GetFunction(queueTpl).ToLocalChecked());
+  Local<FunctionTemplate> ioConfigTpl = Nan::New<FunctionTemplate>(setIOServiceConfig);
+  Nan::Set(exports, Nan::New("setIOServiceConfig").ToLocalChecked(),
+           Nan::GetFunction(ioConfigTpl).ToLocalChecked());
+  Local<FunctionTemplate> shmTpl = Nan::New<FunctionTemplate>(setShmConfig);
+  Nan::Set(exports, Nan::New("setShmConfig").ToLocalChecked(),
+           Nan::GetFunction(shmTpl).ToLocalChecked());
+  Local<FunctionTemplate> wireTpl = Nan::New<FunctionTemplate>(setFrameWireConfig);
+  Nan::Set(exports, Nan::New("setFrameWireConfig").ToLocalChecked(),
+           Nan::GetFunction(wireTpl).ToLocalChecked());
+  Local<FunctionTemplate> ioStatsTpl = Nan::New<FunctionTemplate>(getIOServiceStats);
+  Nan::Set(exports, Nan::New("getIOServiceStats").ToLocalChecked(),
+           Nan::GetFunction(ioStatsTpl).ToLocalChecked());
 }
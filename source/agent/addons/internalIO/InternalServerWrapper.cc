@@ -45,6 +45,7 @@ NAN_MODULE_INIT(InternalServer::Init) {
   Nan::SetPrototypeMethod(tpl, "getListeningPort", getListeningPort);
   Nan::SetPrototypeMethod(tpl, "addSource", addSource);
   Nan::SetPrototypeMethod(tpl, "removeSource", removeSource);
+  Nan::SetPrototypeMethod(tpl, "getSendQueueStats", getSendQueueStats);
 
   constructor.Reset(Nan::GetFunction(tpl).ToLocalChecked());
   Nan::Set(target, Nan::New("InternalServer").ToLocalChecked(),
@@ -128,6 +129,32 @@ NAN_METHOD(InternalServer::removeSource) {
   me->removeSource(streamId);
 }
 
+NAN_METHOD(InternalServer::getSendQueueStats) {
+  InternalServer* obj = ObjectWrap::Unwrap<InternalServer>(info.Holder());
+  owt_base::InternalServer* me = obj->me;
+  if (!me) {
+    return;
+  }
+
+  owt_base::SendQueueStats stats = me->getSendQueueStats();
+  Local<Object> result = Nan::New<Object>();
+  Nan::Set(result, Nan::New("queuedItems").ToLocalChecked(),
+           Nan::New(static_cast<double>(stats.queuedItems)));
+  Nan::Set(result, Nan::New("queuedBytes").ToLocalChecked(),
+           Nan::New(static_cast<double>(stats.queuedBytes)));
+  Nan::Set(result, Nan::New("droppedFrames").ToLocalChecked(),
+           Nan::New(static_cast<double>(stats.droppedFrames)));
+  Nan::Set(result, Nan::New("droppedBytes").ToLocalChecked(),
+           Nan::New(static_cast<double>(stats.droppedBytes)));
+  Nan::Set(result, Nan::New("sentItems").ToLocalChecked(),
+           Nan::New(static_cast<double>(stats.sentItems)));
+  Nan::Set(result, Nan::New("averageQueueTimeUs").ToLocalChecked(),
+           Nan::New(static_cast<double>(stats.averageQueueTimeUs())));
+  Nan::Set(result, Nan::New("maxQueueTimeUs").ToLocalChecked(),
+           Nan::New(static_cast<double>(stats.maxQueueTimeUs)));
+  info.GetReturnValue().Set(result);
+}
+
 NAUV_WORK_CB(InternalServer::statsCallback) {
   Nan::HandleScope scope;
   InternalServer* obj = reinterpret_cast<InternalServer*>(async->data);
@@ -52,6 +52,9 @@ private:
 
     static NAN_METHOD(removeSource);
 
+    // Returns send queue counters summed over all sessions.
+    static NAN_METHOD(getSendQueueStats);
+
     static NAUV_WORK_CB(statsCallback);
 };
 
@@ -12,6 +12,7 @@
       '../../../core/owt_base/internal/TransportBase.cpp',
       '../../../core/owt_base/internal/InternalServer.cpp',
       '../../../core/owt_base/internal/InternalClient.cpp',
+      '../../../core/owt_base/ShmChannel.cpp',
       '../../../core/common/IOService.cpp',
     ],
     'include_dirs': [
@@ -0,0 +1,98 @@
+{
+  'targets': [{
+    'target_name': 'frameWireFormatTest',
+    'type': 'executable',
+    'sources': [
+      '../../../../core/owt_base/FrameWireFormatTest.cpp',
+    ],
+    'include_dirs': [
+        '../../common',
+        '../../../../core/common/',
+        '../../../../core/owt_base/',
+    ],
+    'libraries': [
+      '-lboost_thread',
+      '-lboost_system',
+      '-llog4cxx',
+      '-lboost_unit_test_framework'
+    ],
+    'conditions': [
+      [ 'OS=="mac"', {
+        'xcode_settings': {
+          'GCC_ENABLE_CPP_EXCEPTIONS': 'YES',        # -fno-exceptions
+          'MACOSX_DEPLOYMENT_TARGET':  '10.7',       # from MAC OS 10.7
+          'OTHER_CFLAGS': ['-g -O$(OPTIMIZATION_LEVEL) -stdlib=libc++']
+        },
+      }, { # OS!="mac"
+        'cflags!':    ['-fno-exceptions'],
+        'cflags_cc':  ['-Wall', '-O$(OPTIMIZATION_LEVEL)', '-g', '-std=c++11'],
+        'cflags_cc!': ['-fno-exceptions'],
+        'cflags_cc!' : ['-fno-rtti']
+      }],
+    ]
+  }, {
+    'target_name': 'shmChannelTest',
+    'type': 'executable',
+    'sources': [
+      '../../../../core/owt_base/ShmChannelTest.cpp',
+      '../../../../core/owt_base/ShmChannel.cpp',
+      '../../../../core/common/IOService.cpp',
+    ],
+    'include_dirs': [
+        '../../common',
+        '../../../../core/common/',
+        '../../../../core/owt_base/',
+    ],
+    'libraries': [
+      '-lboost_thread',
+      '-lboost_system',
+      '-llog4cxx',
+      '-lboost_unit_test_framework'
+    ],
+    'conditions': [
+      [ 'OS=="mac"', {
+        'xcode_settings': {
+          'GCC_ENABLE_CPP_EXCEPTIONS': 'YES',        # -fno-exceptions
+          'MACOSX_DEPLOYMENT_TARGET':  '10.7',       # from MAC OS 10.7
+          'OTHER_CFLAGS': ['-g -O$(OPTIMIZATION_LEVEL) -stdlib=libc++']
+        },
+      }, { # OS!="mac"
+        'cflags!':    ['-fno-exceptions'],
+        'cflags_cc':  ['-Wall', '-O$(OPTIMIZATION_LEVEL)', '-g', '-std=c++11'],
+        'cflags_cc!': ['-fno-exceptions'],
+        'cflags_cc!' : ['-fno-rtti']
+      }],
+    ]
+  }, {
+    'target_name': 'sendQueueTest',
+    'type': 'executable',
+    'sources': [
+      '../../../../core/owt_base/SendQueueTest.cpp',
+    ],
+    'include_dirs': [
+        '../../common',
+        '../../../../core/common/',
+        '../../../../core/owt_base/',
+    ],
+    'libraries': [
+      '-lboost_thread',
+      '-lboost_system',
+      '-llog4cxx',
+      '-lboost_unit_test_framework'
+    ],
+    'conditions': [
+      [ 'OS=="mac"', {
+        'xcode_settings': {
+          'GCC_ENABLE_CPP_EXCEPTIONS': 'YES',        # -fno-exceptions
+          'MACOSX_DEPLOYMENT_TARGET':  '10.7',       # from MAC OS 10.7
+          'OTHER_CFLAGS': ['-g -O$(OPTIMIZATION_LEVEL) -stdlib=libc++']
+        },
+      }, { # OS!="mac"
+        'cflags!':    ['-fno-exceptions'],
+        'cflags_cc':  ['-Wall', '-O$(OPTIMIZATION_LEVEL)', '-g', '-std=c++11'],
+        'cflags_cc!': ['-fno-exceptions'],
+        'cflags_cc!' : ['-fno-rtti']
+      }],
+    ]
+  }]
+}
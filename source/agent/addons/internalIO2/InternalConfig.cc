@@ -7,7 +7,9 @@
 #endif
 
 #include "InternalConfig.h"
+#include <FrameWireFormat.h>
 #include <RawTransport.h>
+#include <ShmChannel.h>
 
 using namespace v8;
 
@@ -17,8 +19,27 @@ void setPassphrase(const FunctionCallbackInfo<Value>& args) {
   owt_base::RawTransport<owt_base::Protocol::TCP>::setPassphrase(p);
 }
 
+// Arguments: ringBytes, the ring size of the shared memory connections
+// created afterwards, 0 for the default
+void setShmConfig(const FunctionCallbackInfo<Value>& args) {
+  if (args.Length() > 0 && args[0]->IsNumber()) {
+    owt_base::ShmChannelConfig::defaultConfig().ringBytes = args[0]->Uint32Value();
+  }
+}
+
+// Arguments: compact, whether to send frames in the compact wire format
+void setFrameWireConfig(const FunctionCallbackInfo<Value>& args) {
+  if (args.Length() > 0 && args[0]->IsBoolean()) {
+    owt_base::FrameWireConfig::defaultConfig().compact = args[0]->BooleanValue();
+  }
+}
+
 void InitInternalConfig(v8::Local<v8::Object> exports) {
   Isolate* isolate = Isolate::GetCurrent();
   Local<FunctionTemplate> tpl = FunctionTemplate::New(isolate, setPassphrase);
   exports->Set(String::NewFromUtf8(isolate, "setPassphrase"), tpl->GetFunction());
+  Local<FunctionTemplate> wireTpl = FunctionTemplate::New(isolate, setFrameWireConfig);
+  exports->Set(String::NewFromUtf8(isolate, "setFrameWireConfig"), wireTpl->GetFunction());
+  Local<FunctionTemplate> shmTpl = FunctionTemplate::New(isolate, setShmConfig);
+  exports->Set(String::NewFromUtf8(isolate, "setShmConfig"), shmTpl->GetFunction());
 }
@@ -13,6 +13,8 @@
       '../../../core/owt_base/MediaFramePipeline.cpp',
       '../../../core/owt_base/RawTransport.cpp',
       '../../../core/owt_base/SctpTransport.cpp',
+      '../../../core/owt_base/ShmChannel.cpp',
+      '../../../core/owt_base/ShmTransport.cpp',
       '../../../core/common/IOService.cpp',
     ],
     'include_dirs': [
@@ -6,6 +6,7 @@
 
 #include "QuicTransportConnection.h"
 #include "QuicTransportStream.h"
+#include <algorithm>
 
 using v8::Function;
 using v8::FunctionTemplate;
@@ -21,6 +22,7 @@ DEFINE_LOGGER(QuicTransportConnection, "QuicTransportConnection");
 QuicTransportConnection::QuicTransportConnection()
     : m_session(nullptr)
     , m_visitor(nullptr)
+    , m_sessionClosed(false)
 {
 }
 
@@ -184,8 +186,34 @@ void QuicTransportConnection::onFrame(const owt_base::Frame& frame)
 
 void QuicTransportConnection::onVideoSourceChanged() { }
 
+void QuicTransportConnection::startStreamPerGop(WebTransportSendScheduler* scheduler)
+{
+    std::lock_guard<std::mutex> lock(m_schedulersMutex);
+    if (m_sessionClosed) {
+        return;
+    }
+    m_schedulers.push_back(scheduler);
+    scheduler->setStreamPerGop(m_session);
+}
+
+void QuicTransportConnection::stopStreamPerGop(WebTransportSendScheduler* scheduler)
+{
+    std::lock_guard<std::mutex> lock(m_schedulersMutex);
+    m_schedulers.erase(std::remove(m_schedulers.begin(), m_schedulers.end(), scheduler), m_schedulers.end());
+    scheduler->setStreamPerGop(nullptr);
+}
+
 void QuicTransportConnection::OnConnectionClosed()
 {
+    {
+        // JavaScript's onclose runs later, after the session is gone.
+        std::lock_guard<std::mutex> lock(m_schedulersMutex);
+        m_sessionClosed = true;
+        for (auto scheduler : m_schedulers) {
+            scheduler->onSessionClosed();
+        }
+        m_schedulers.clear();
+    }
     m_asyncOnClose.data = this;
     uv_async_send(&m_asyncOnClose);
 }
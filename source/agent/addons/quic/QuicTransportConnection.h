@@ -16,6 +16,7 @@
 #include <nan.h>
 
 #include "QuicTransportStream.h"
+#include "WebTransportSendScheduler.h"
 #include "owt/quic/web_transport_session_interface.h"
 
 class QuicTransportConnection : public owt_base::FrameDestination, public NanFrameNode, public owt::quic::WebTransportSessionInterface::Visitor, QuicTransportStream::Visitor {
@@ -32,6 +33,10 @@ public:
     ~QuicTransportConnection();
     void setVisitor(Visitor* visitor);
     static v8::Local<v8::Object> newInstance(owt::quic::WebTransportSessionInterface* session);
+    owt::quic::WebTransportSessionInterface* session() const { return m_session; }
+    // Lets `scheduler` open a stream on the session for each GOP, until stopped or the session closes.
+    void startStreamPerGop(WebTransportSendScheduler* scheduler);
+    void stopStreamPerGop(WebTransportSendScheduler* scheduler);
 
     static NAN_MODULE_INIT(init);
     static NAN_METHOD(newInstance);
@@ -73,6 +78,9 @@ private:
     std::mutex m_streamQueueMutex;
     std::queue<owt::quic::WebTransportStreamInterface*> m_streamsToBeNotified;
     uv_async_t m_asyncOnClose;
+    std::mutex m_schedulersMutex;
+    std::vector<WebTransportSendScheduler*> m_schedulers;
+    bool m_sessionClosed;
 };
 
 #endif
\ No newline at end of file
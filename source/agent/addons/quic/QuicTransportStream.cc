@@ -44,6 +44,7 @@ QuicTransportStream::QuicTransportStream(owt::quic::WebTransportStreamInterface*
     , m_currentFrameSize(0)
     , m_receivedFrameOffset(0)
     , m_audioTimeStamp(0)
+    , m_writeVisitor(nullptr)
 {
 }
 
@@ -77,6 +78,17 @@ void QuicTransportStream::OnCanRead()
 void QuicTransportStream::OnCanWrite()
 {
     ELOG_DEBUG("On can write.");
+    std::lock_guard<std::mutex> lock(m_writeVisitorMutex);
+    if (m_writeVisitor) {
+        m_writeVisitor->OnCanWrite();
+    }
+}
+
+void QuicTransportStream::setWriteVisitor(owt::quic::WebTransportStreamInterface::Visitor* visitor)
+{
+    // Returns after a forwarded OnCanWrite in progress, so the previous visitor can be destroyed.
+    std::lock_guard<std::mutex> lock(m_writeVisitorMutex);
+    m_writeVisitor = visitor;
 }
 
 void QuicTransportStream::OnFinRead()
@@ -412,6 +424,7 @@ void QuicTransportStream::SignalOnData()
             // Complete frame.
             if (m_receivedFrameOffset == m_currentFrameSize) {
                 owt_base::Frame frame;
+                memset(&frame, 0, sizeof(frame));
                 if (m_trackKind == "audio") {
                     frame.format = owt_base::FRAME_FORMAT_OPUS;
                     frame.timeStamp = m_audioTimeStamp;
@@ -439,6 +452,7 @@ void QuicTransportStream::SignalOnData()
                 ReallocateBuffer(readableBytes);
             }
             owt_base::Frame frame;
+            memset(&frame, 0, sizeof(frame));
             frame.format = owt_base::FRAME_FORMAT_DATA;
             frame.length = readableBytes;
             frame.payload = m_buffer;
@@ -30,6 +30,10 @@ public:
 
     static v8::Local<v8::Object> newInstance(owt::quic::WebTransportStreamInterface* stream);
 
+    owt::quic::WebTransportStreamInterface* stream() const { return m_stream; }
+    // OnCanWrite is forwarded to `visitor` when a scheduler writes to this stream. Null to stop.
+    void setWriteVisitor(owt::quic::WebTransportStreamInterface::Visitor* visitor);
+
     static NAN_MODULE_INIT(init);
     static NAN_METHOD(newInstance);
     static NAN_METHOD(write);
@@ -111,6 +115,9 @@ private:
     // TODO: Using wall clock timestamps seems not working. Using an increasing sequence instead. Fix it later.
     uint32_t m_audioTimeStamp;
 
+    std::mutex m_writeVisitorMutex;
+    owt::quic::WebTransportStreamInterface::Visitor* m_writeVisitor;
+
     uv_async_t m_asyncOnContentSessionId;
     uv_async_t m_asyncOnTrackId;
     uv_async_t m_asyncOnData;
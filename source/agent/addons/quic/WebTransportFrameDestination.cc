@@ -5,6 +5,8 @@
  */
 
 #include "WebTransportFrameDestination.h"
+#include "QuicTransportConnection.h"
+#include "QuicTransportStream.h"
 
 using v8::Function;
 using v8::FunctionTemplate;
@@ -25,12 +27,29 @@ WebTransportFrameDestination::WebTransportFrameDestination(const std::string& su
     , m_datagramOutput(nullptr)
     , m_rtpFactory(nullptr)
     , m_videoRtpPacketizer(nullptr)
+    , m_gopConnection(nullptr)
 {
 #ifdef OWT_FAKE_RTP
     m_rtpFactory = m_rtpFactory->createFakeFactory();
 #else
     m_rtpFactory = m_rtpFactory->createDefaultFactory();
 #endif
+    if (!m_isDatagram) {
+        m_sendScheduler.reset(new WebTransportSendScheduler(subscriptionId, this));
+    }
+}
+
+WebTransportFrameDestination::~WebTransportFrameDestination()
+{
+    if (m_gopConnection) {
+        m_gopConnection->stopStreamPerGop(m_sendScheduler.get());
+        m_gopConnectionObject.Reset();
+    }
+    std::unique_lock<std::shared_timed_mutex> lock(m_streamOutputMutex);
+    // Stream outputs are QuicTransportStreams.
+    for (auto& output : m_streamOutput) {
+        static_cast<QuicTransportStream*>(output.second)->setWriteVisitor(nullptr);
+    }
 }
 
 NAN_MODULE_INIT(WebTransportFrameDestination::init)
@@ -44,6 +63,7 @@ NAN_MODULE_INIT(WebTransportFrameDestination::init)
     Nan::SetPrototypeMethod(tpl, "removeDatagramOutput", removeDatagramOutput);
     Nan::SetPrototypeMethod(tpl, "addStreamOutput", addStreamOutput);
     Nan::SetPrototypeMethod(tpl, "removeStreamOutput", removeStreamOutput);
+    Nan::SetPrototypeMethod(tpl, "setStreamPerGop", setStreamPerGop);
     Nan::SetPrototypeMethod(tpl, "receiver", receiver);
     Nan::SetAccessor(instanceTpl, Nan::New("rtpConfig").ToLocalChecked(), rtpConfigGetter);
 
@@ -112,10 +132,16 @@ NAN_METHOD(WebTransportFrameDestination::addStreamOutput)
     if (obj->m_streamOutput.find(track) != obj->m_streamOutput.end()) {
         ELOG_WARN("Stream output for track %s exists, will be replaced by the new one.", track);
         obj->m_streamOutput[track]->FrameDestination()->setDataSource(nullptr);
+        static_cast<QuicTransportStream*>(obj->m_streamOutput[track])->setWriteVisitor(nullptr);
     }
     // TODO: Use addDataDestination defined in MediaFramePipeline. We use m_streamOutput here because the output could also be datagrams.
     obj->m_streamOutput[track] = output;
     output->FrameDestination()->setDataSource(obj);
+    if (obj->m_sendScheduler) {
+        QuicTransportStream* stream = static_cast<QuicTransportStream*>(output);
+        obj->m_sendScheduler->setStream(track == audioTrackId, track, stream->stream());
+        stream->setWriteVisitor(obj->m_sendScheduler.get());
+    }
     ELOG_DEBUG("Add stream output.");
 }
 
@@ -133,10 +159,35 @@ NAN_METHOD(WebTransportFrameDestination::removeStreamOutput)
         return;
     }
     obj->m_streamOutput[track]->FrameDestination()->setDataSource(nullptr);
+    if (obj->m_sendScheduler) {
+        static_cast<QuicTransportStream*>(obj->m_streamOutput[track])->setWriteVisitor(nullptr);
+        obj->m_sendScheduler->setStream(track == audioTrackId, track, nullptr);
+    }
     obj->m_streamOutput.erase(track);
     ELOG_DEBUG("Remove stream output.");
 }
 
+NAN_METHOD(WebTransportFrameDestination::setStreamPerGop)
+{
+    WebTransportFrameDestination* obj = Nan::ObjectWrap::Unwrap<WebTransportFrameDestination>(info.Holder());
+    if (!obj->m_sendScheduler) {
+        return Nan::ThrowTypeError("Stream per GOP is only available for stream outputs.");
+    }
+    if (obj->m_gopConnection) {
+        obj->m_gopConnection->stopStreamPerGop(obj->m_sendScheduler.get());
+        obj->m_gopConnection = nullptr;
+        obj->m_gopConnectionObject.Reset();
+    }
+    if (info.Length() < 1 || !info[0]->IsObject()) {
+        return;
+    }
+    Local<Object> connectionObject = Nan::To<v8::Object>(info[0]).ToLocalChecked();
+    QuicTransportConnection* connection = Nan::ObjectWrap::Unwrap<QuicTransportConnection>(connectionObject);
+    obj->m_gopConnection = connection;
+    obj->m_gopConnectionObject.Reset(connectionObject);
+    connection->startStreamPerGop(obj->m_sendScheduler.get());
+}
+
 NAN_METHOD(WebTransportFrameDestination::receiver)
 {
     info.GetReturnValue().Set(info.This());
@@ -188,38 +239,17 @@ void WebTransportFrameDestination::onFeedback(const owt_base::FeedbackMsg& feedb
     m_videoRtpPacketizer->onFeedback(feedback);
 }
 
+void WebTransportFrameDestination::onKeyFrameRequired()
+{
+    deliverFeedbackMsg(owt_base::FeedbackMsg(owt_base::VIDEO_FEEDBACK, owt_base::REQUEST_KEY_FRAME));
+}
+
 void WebTransportFrameDestination::DispatchMediaFrame(const owt_base::Frame& frame)
 {
-    std::shared_lock<std::shared_timed_mutex> lock(m_streamOutputMutex);
-    owt_base::FrameDestination* dest(nullptr);
-    if (owt_base::isAudioFrame(frame)) {
-        if (m_streamOutput.find(audioTrackId) == m_streamOutput.end()) {
-            ELOG_DEBUG("Audio output not found. Dropping an audio frame.");
-            return;
-        }
-        dest = m_streamOutput[audioTrackId]->FrameDestination();
-    } else if (owt_base::isVideoFrame(frame)) {
-        if (m_streamOutput.find(videoTrackId) == m_streamOutput.end()) {
-            ELOG_DEBUG("Video output not found. Dropping a video frame.");
-            return;
-        }
-        dest = m_streamOutput[videoTrackId]->FrameDestination();
-    } else {
+    if (!owt_base::isAudioFrame(frame) && !owt_base::isVideoFrame(frame)) {
         ELOG_ERROR("Unknown frame type.");
         return;
     }
-    // Write header. 4 bytes for the size of the body.
-    uint32_t payloadSize(frame.length);
-    uint8_t* buffer = new uint8_t[4];
-    for (int i = 0; i < 4; i++) {
-        buffer[3 - i] = payloadSize & 0xFF;
-        payloadSize >>= 8;
-    }
-    owt_base::Frame header;
-    header.format = owt_base::FRAME_FORMAT_DATA;
-    header.length = 4;
-    header.payload = buffer;
-    dest->onFrame(header);
-    // Write body.
-    dest->onFrame(frame);
-}
\ No newline at end of file
+    // Frames of a track without output are dropped by the scheduler.
+    m_sendScheduler->onFrame(frame);
+}
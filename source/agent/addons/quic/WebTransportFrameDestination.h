@@ -8,19 +8,22 @@
 #define QUIC_ADDON_WEB_TRANSPORT_FRAME_DESTINATION_H_
 
 #include "RtpFactory.h"
+#include "WebTransportSendScheduler.h"
 #include "owt/quic/web_transport_stream_interface.h"
 #include <shared_mutex>
 #include <unordered_map>
 #include <logger.h>
 #include <nan.h>
 
+class QuicTransportConnection;
+
 // A WebTransportFrameDestination is a hub for a single InternalIO input to multiple WebTransport outputs.
-class WebTransportFrameDestination : public owt_base::FrameSource, public owt_base::FrameDestination, public NanFrameNode {
+class WebTransportFrameDestination : public owt_base::FrameSource, public owt_base::FrameDestination, public NanFrameNode, public WebTransportSendScheduler::Observer {
     DECLARE_LOGGER();
 
 public:
     explicit WebTransportFrameDestination(const std::string& subscriptionId, bool isDatagram);
-    ~WebTransportFrameDestination() override = default;
+    ~WebTransportFrameDestination() override;
 
     static NAN_MODULE_INIT(init);
 
@@ -35,6 +38,9 @@ public:
     owt_base::FrameSource* FrameSource() override { return nullptr; }
     owt_base::FrameDestination* FrameDestination() override { return this; }
 
+    // Overrides WebTransportSendScheduler::Observer.
+    void onKeyFrameRequired() override;
+
 private:
     static Nan::Persistent<v8::Function> s_constructor;
     static NAN_METHOD(newInstance);
@@ -44,12 +50,15 @@ private:
     static NAN_METHOD(addStreamOutput);
     // removeStreamOutput(string:trackId).
     static NAN_METHOD(removeStreamOutput);
+    // setStreamPerGop(QuicTransportConnection:connection). Sends each video GOP on a new stream of `connection`, or
+    // stops when it's undefined.
+    static NAN_METHOD(setStreamPerGop);
     // receiver() is required by connection.js.
     static NAN_METHOD(receiver);
     // Returns an object of RTP configuration. {audio:{ssrc}, video:{ssrc}}. Returns undefined if no RTP receiver is available.
     static NAN_GETTER(rtpConfigGetter);
 
-    // Dispatch a media frame to its corresponding WebTransport stream. It works for WebTransport streams only.
+    // Schedule a media frame on its corresponding WebTransport stream. It works for WebTransport streams only.
     void DispatchMediaFrame(const owt_base::Frame&);
 
     bool m_isDatagram;
@@ -59,6 +68,11 @@ private:
     std::unordered_map<std::string, NanFrameNode*> m_streamOutput; // Key is track ID.
     std::unique_ptr<RtpFactoryBase> m_rtpFactory;
     std::unique_ptr<VideoRtpPacketizerInterface> m_videoRtpPacketizer;
+    // Only for stream outputs.
+    std::unique_ptr<WebTransportSendScheduler> m_sendScheduler;
+    // Connection of setStreamPerGop, kept alive until it's unset.
+    QuicTransportConnection* m_gopConnection;
+    Nan::Persistent<v8::Object> m_gopConnectionObject;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,26 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "WebTransportFrameWriter.h"
+#include <string.h>
+
+size_t WebTransportFrameWriter::frame(const owt_base::Frame& frame, std::vector<uint8_t>& buffer)
+{
+    size_t size = kHeaderSize + frame.length;
+    // Only grows, so the buffer settles at the largest frame seen.
+    if (buffer.size() < size) {
+        buffer.resize(size);
+    }
+    uint32_t payloadSize(frame.length);
+    for (size_t i = 0; i < kHeaderSize; i++) {
+        buffer[kHeaderSize - 1 - i] = payloadSize & 0xFF;
+        payloadSize >>= 8;
+    }
+    if (frame.length > 0) {
+        memcpy(buffer.data() + kHeaderSize, frame.payload, frame.length);
+    }
+    return size;
+}
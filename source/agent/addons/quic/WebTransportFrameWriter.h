@@ -0,0 +1,24 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef QUIC_ADDON_WEB_TRANSPORT_FRAME_WRITER_H_
+#define QUIC_ADDON_WEB_TRANSPORT_FRAME_WRITER_H_
+
+#include "../../core/owt_base/MediaFramePipeline.h"
+#include <vector>
+
+// Frames media frames for a WebTransport stream output, each prefixed by the 4 bytes big-endian size of its body as
+// QuicTransportStream expects on the receiving side. Header and body are gathered into one buffer, so a frame is a
+// single write to the stream.
+class WebTransportFrameWriter {
+public:
+    static const size_t kHeaderSize = 4;
+
+    // Fills `buffer` with the header and body of `frame`, growing it when needed. Returns the framed size.
+    static size_t frame(const owt_base::Frame& frame, std::vector<uint8_t>& buffer);
+};
+
+#endif
@@ -0,0 +1,370 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "WebTransportSendScheduler.h"
+#include "WebTransportFrameWriter.h"
+
+DEFINE_LOGGER(WebTransportSendScheduler, "WebTransportSendScheduler");
+
+const size_t WebTransportSendScheduler::kMaxQueuedAudioFrames;
+const size_t WebTransportSendScheduler::kMaxQueuedVideoFrames;
+const int64_t WebTransportSendScheduler::kKeyFrameRequestIntervalMs;
+const size_t WebTransportSendScheduler::kMaxRetainedItemBytes;
+
+static const size_t uuidSizeInBytes = 16;
+
+// Converts 32 hex digits to 16 bytes, as QuicTransportServer does for the stream headers written in JavaScript.
+static std::vector<uint8_t> uuidStringToBytes(const std::string& uuid)
+{
+    std::vector<uint8_t> bytes;
+    if (uuid.size() != uuidSizeInBytes * 2) {
+        return bytes;
+    }
+    for (size_t i = 0; i < uuidSizeInBytes; i++) {
+        bytes.push_back(std::stoul(uuid.substr(i * 2, 2), nullptr, 16));
+    }
+    return bytes;
+}
+
+WebTransportSendScheduler::Track::Track(bool isAudio, size_t maxQueued)
+    : isAudio(isAudio)
+    , maxQueued(maxQueued)
+    , stream(nullptr)
+    , ownsStream(false)
+    , blocked(false)
+    , waitKeyFrame(!isAudio)
+    , newGop(false)
+    , framesOnStream(0)
+    , current(nullptr)
+    , offset(0)
+    , sentFrames(0)
+    , droppedFrames(0)
+    , streams(0)
+{
+}
+
+WebTransportSendScheduler::WebTransportSendScheduler(const std::string& contentSessionId, Observer* observer)
+    : m_contentSessionId(contentSessionId)
+    , m_observer(observer)
+    , m_audio(true, kMaxQueuedAudioFrames)
+    , m_video(false, kMaxQueuedVideoFrames)
+    , m_session(nullptr)
+    , m_draining(false)
+    , m_flushPending(false)
+{
+}
+
+WebTransportSendScheduler::~WebTransportSendScheduler()
+{
+    setStream(true, "", nullptr);
+    setStream(false, "", nullptr);
+    ELOG_DEBUG("Sent audio %lu, video %lu frames. Dropped audio %lu, video %lu frames. Video streams %u.",
+        m_audio.sentFrames, m_video.sentFrames, m_audio.droppedFrames, m_video.droppedFrames, m_video.streams);
+}
+
+void WebTransportSendScheduler::setStream(bool isAudio, const std::string& trackId, owt::quic::WebTransportStreamInterface* stream)
+{
+    Track& track = isAudio ? m_audio : m_video;
+    owt::quic::WebTransportStreamInterface* owned(nullptr);
+    {
+        // Waits for a write in progress on the stream being replaced.
+        std::unique_lock<std::shared_timed_mutex> streamLock(m_streamMutex);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (track.ownsStream) {
+            owned = track.stream;
+        }
+        if (track.current) {
+            // The rest of a partially written frame is useless on another stream.
+            releaseItem(track, track.current);
+            track.current = nullptr;
+        }
+        track.trackId = trackId;
+        track.stream = stream;
+        track.ownsStream = false;
+        track.blocked = false;
+        track.framesOnStream = 0;
+        track.waitKeyFrame = !isAudio;
+        if (stream) {
+            track.streams++;
+        }
+    }
+    // Not closed with the locks held, the stream may call back into OnCanWrite.
+    if (owned) {
+        owned->SetVisitor(nullptr);
+        owned->Close();
+    }
+}
+
+void WebTransportSendScheduler::setStreamPerGop(owt::quic::WebTransportSessionInterface* session)
+{
+    // Not waiting for a write, startGopStream reads the session once.
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_session = session;
+}
+
+void WebTransportSendScheduler::onSessionClosed()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_session = nullptr;
+    // Streams opened by JavaScript are removed later by their onclose.
+    for (Track* track : { &m_audio, &m_video }) {
+        track->stream = nullptr;
+        track->ownsStream = false;
+    }
+}
+
+void WebTransportSendScheduler::onFrame(const owt_base::Frame& frame)
+{
+    bool isAudio = owt_base::isAudioFrame(frame);
+    bool requestKeyFrame(false);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Track& track = isAudio ? m_audio : m_video;
+        if (!track.stream) {
+            return;
+        }
+        requestKeyFrame = enqueue(track, frame);
+        // Streams created by JavaScript have no SDK visitor to receive OnCanWrite, retry on each frame as well.
+        track.blocked = false;
+    }
+    if (requestKeyFrame) {
+        ELOG_DEBUG("Request key frame, video queue dropped.");
+        m_observer->onKeyFrameRequired();
+    }
+    flush();
+}
+
+bool WebTransportSendScheduler::enqueue(Track& track, const owt_base::Frame& frame)
+{
+    bool isKeyFrame = !track.isAudio && frame.additionalInfo.video.isKeyFrame;
+    if (!track.isAudio) {
+        if (isKeyFrame) {
+            // Frames of the previous GOP not sent yet are only late now.
+            dropQueued(track);
+            track.waitKeyFrame = false;
+            if (m_session) {
+                // The next GOP goes to a new stream even if the current one is blocked.
+                track.newGop = true;
+                track.blocked = false;
+            }
+        } else if (track.waitKeyFrame) {
+            track.droppedFrames++;
+            return shouldRequestKeyFrame(track);
+        } else if (track.queued.size() >= track.maxQueued) {
+            // Later frames depend on the dropped ones, skip to the next key frame.
+            dropQueued(track);
+            track.droppedFrames++;
+            track.waitKeyFrame = true;
+            return shouldRequestKeyFrame(track);
+        }
+    } else if (track.queued.size() >= track.maxQueued) {
+        releaseItem(track, track.queued.front());
+        track.queued.pop_front();
+        track.droppedFrames++;
+    }
+
+    Item* item = takeItem(track);
+    item->length = WebTransportFrameWriter::frame(frame, item->data);
+    item->isKeyFrame = isKeyFrame;
+    track.queued.push_back(item);
+    return false;
+}
+
+void WebTransportSendScheduler::dropQueued(Track& track)
+{
+    track.droppedFrames += track.queued.size();
+    for (Item* item : track.queued) {
+        releaseItem(track, item);
+    }
+    track.queued.clear();
+}
+
+void WebTransportSendScheduler::releaseItem(Track& track, Item* item)
+{
+    if (item->data.capacity() > kMaxRetainedItemBytes) {
+        std::vector<uint8_t>().swap(item->data);
+    }
+    track.freeItems.push_back(item);
+}
+
+WebTransportSendScheduler::Item* WebTransportSendScheduler::takeItem(Track& track)
+{
+    if (!track.freeItems.empty()) {
+        Item* item = track.freeItems.back();
+        track.freeItems.pop_back();
+        return item;
+    }
+    // At most maxQueued + 2 items per track, the one being written and the one being queued.
+    track.items.emplace_back(new Item());
+    return track.items.back().get();
+}
+
+bool WebTransportSendScheduler::shouldRequestKeyFrame(Track& track)
+{
+    auto now = std::chrono::steady_clock::now();
+    if (now - track.lastKeyFrameRequest < std::chrono::milliseconds(kKeyFrameRequestIntervalMs)) {
+        return false;
+    }
+    track.lastKeyFrameRequest = now;
+    return true;
+}
+
+void WebTransportSendScheduler::OnCanWrite()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_audio.blocked = false;
+        m_video.blocked = false;
+    }
+    flush();
+}
+
+void WebTransportSendScheduler::flush()
+{
+    m_flushPending = true;
+    while (m_flushPending) {
+        if (m_draining.exchange(true)) {
+            // The draining thread sees m_flushPending after it's done.
+            return;
+        }
+        m_flushPending = false;
+        drain();
+        m_draining = false;
+    }
+}
+
+void WebTransportSendScheduler::drain()
+{
+    std::shared_lock<std::shared_timed_mutex> streamLock(m_streamMutex);
+    while (true) {
+        Track* track(nullptr);
+        bool startGop(false);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            // Audio first.
+            for (Track* t : { &m_audio, &m_video }) {
+                if (!t->stream || t->blocked) {
+                    continue;
+                }
+                if (t->newGop && !t->queued.empty() && t->queued.front()->isKeyFrame) {
+                    t->newGop = false;
+                    if (m_session) {
+                        startGop = t->framesOnStream > 0 || (t->current && t->offset > 0);
+                        if (t->current) {
+                            // Left of the previous GOP, abandoned with its stream.
+                            releaseItem(*t, t->current);
+                            t->current = nullptr;
+                            t->droppedFrames++;
+                        }
+                    }
+                }
+                if (!t->current && !t->queued.empty()) {
+                    t->current = t->queued.front();
+                    t->queued.pop_front();
+                    t->offset = 0;
+                }
+                if (t->current) {
+                    track = t;
+                    break;
+                }
+            }
+        }
+        if (!track) {
+            return;
+        }
+        if (startGop) {
+            startGopStream(*track);
+        }
+
+        owt::quic::WebTransportStreamInterface* stream(nullptr);
+        Item* item(nullptr);
+        size_t offset(0);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            // Cleared when the session closes.
+            stream = track->stream;
+            item = track->current;
+            offset = track->offset;
+        }
+        if (!stream) {
+            continue;
+        }
+        size_t written = stream->Write(item->data.data() + offset, item->length - offset);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        track->offset += written;
+        if (track->offset < item->length) {
+            // Resumed on OnCanWrite.
+            track->blocked = true;
+            continue;
+        }
+        releaseItem(*track, item);
+        track->current = nullptr;
+        track->sentFrames++;
+        track->framesOnStream++;
+    }
+}
+
+void WebTransportSendScheduler::startGopStream(Track& track)
+{
+    owt::quic::WebTransportSessionInterface* session(nullptr);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        session = m_session;
+    }
+    if (!session) {
+        return;
+    }
+    owt::quic::WebTransportStreamInterface* stream = session->CreateBidirectionalStream();
+    if (!stream) {
+        ELOG_WARN("Failed to create a stream for new GOP, keep using the current one.");
+        return;
+    }
+    stream->SetVisitor(this);
+    std::vector<uint8_t> header = uuidStringToBytes(m_contentSessionId);
+    std::vector<uint8_t> trackId = uuidStringToBytes(track.trackId);
+    header.insert(header.end(), trackId.begin(), trackId.end());
+    if (stream->Write(header.data(), header.size()) != header.size()) {
+        ELOG_WARN("Failed to write stream header for new GOP.");
+    }
+
+    owt::quic::WebTransportStreamInterface* previous(nullptr);
+    bool ownedPrevious(false);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_session) {
+            // Closed meanwhile, the new stream goes with it.
+            return;
+        }
+        previous = track.stream;
+        ownedPrevious = track.ownsStream;
+        track.stream = stream;
+        track.ownsStream = true;
+        track.blocked = false;
+        track.framesOnStream = 0;
+        track.streams++;
+    }
+    // Only the draining thread replaces streams while the shared lock is held, so `previous` is not used by others.
+    if (!previous) {
+        return;
+    }
+    if (ownedPrevious) {
+        previous->SetVisitor(nullptr);
+    }
+    previous->Close();
+}
+
+WebTransportSendScheduler::Stats WebTransportSendScheduler::getStats(bool isAudio)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Track& track = isAudio ? m_audio : m_video;
+    Stats stats;
+    stats.sentFrames = track.sentFrames;
+    stats.droppedFrames = track.droppedFrames;
+    stats.queuedFrames = track.queued.size();
+    stats.streams = track.streams;
+    return stats;
+}
@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef QUIC_ADDON_WEB_TRANSPORT_SEND_SCHEDULER_H_
+#define QUIC_ADDON_WEB_TRANSPORT_SEND_SCHEDULER_H_
+
+#include "../../core/owt_base/MediaFramePipeline.h"
+#include "owt/quic/web_transport_session_interface.h"
+#include "owt/quic/web_transport_stream_interface.h"
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <logger.h>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+// Schedules the media frames of one subscription onto its WebTransport streams, one stream per track.
+//
+// Frames are queued per track and written when the streams can take them, audio before video. A stream that takes a
+// frame partially is resumed on its next OnCanWrite, so frames are never interleaved or cut. When the video queue
+// overflows, queued video is dropped and so are the following frames until a key frame, as they can't be decoded
+// without the dropped ones, and a key frame is requested from upstream. Optionally every GOP is sent on a new stream
+// and the previous one is closed, so the rest of a stale GOP is abandoned instead of being completed.
+class WebTransportSendScheduler : public owt::quic::WebTransportStreamInterface::Visitor {
+    DECLARE_LOGGER();
+
+public:
+    class Observer {
+    public:
+        virtual ~Observer() = default;
+        virtual void onKeyFrameRequired() = 0;
+    };
+
+    struct Stats {
+        uint64_t sentFrames;
+        uint64_t droppedFrames;
+        uint32_t queuedFrames;
+        uint32_t streams;
+    };
+
+    static const size_t kMaxQueuedAudioFrames = 50;
+    static const size_t kMaxQueuedVideoFrames = 30;
+    static const int64_t kKeyFrameRequestIntervalMs = 1000;
+    // Larger frame buffers, typically of key frames, are released once sent or dropped instead of being reused.
+    static const size_t kMaxRetainedItemBytes = 128 * 1024;
+
+    // `contentSessionId` and the track IDs are 32 hex digits, written at the start of streams opened per GOP.
+    WebTransportSendScheduler(const std::string& contentSessionId, Observer* observer);
+    ~WebTransportSendScheduler() override;
+
+    // Streams are owned by their QuicTransportStream, which passes its OnCanWrite to the scheduler. Null to remove.
+    void setStream(bool isAudio, const std::string& trackId, owt::quic::WebTransportStreamInterface* stream);
+    // Opens a new stream on `session` for each video GOP. Null to stop. Set through QuicTransportConnection, which
+    // stops it when the session closes.
+    void setStreamPerGop(owt::quic::WebTransportSessionInterface* session);
+    // The session of the streams is closing, they and the session are released afterwards. Called on the QUIC thread
+    // by QuicTransportConnection, doesn't wait for a write in progress as it would wait for the QUIC thread.
+    void onSessionClosed();
+
+    void onFrame(const owt_base::Frame&);
+
+    Stats getStats(bool isAudio);
+
+    // Overrides owt::quic::WebTransportStreamInterface::Visitor.
+    void OnCanRead() override { }
+    void OnCanWrite() override;
+    void OnFinRead() override { }
+
+private:
+    struct Item {
+        std::vector<uint8_t> data;
+        size_t length;
+        bool isKeyFrame;
+    };
+
+    struct Track {
+        Track(bool isAudio, size_t maxQueued);
+
+        bool isAudio;
+        size_t maxQueued;
+        std::string trackId;
+        owt::quic::WebTransportStreamInterface* stream;
+        // The output stream was opened by the scheduler for the current GOP.
+        bool ownsStream;
+        bool blocked;
+        bool waitKeyFrame;
+        // A key frame is queued to start a new GOP stream.
+        bool newGop;
+        uint64_t framesOnStream;
+        std::chrono::steady_clock::time_point lastKeyFrameRequest;
+        std::deque<Item*> queued;
+        std::vector<std::unique_ptr<Item>> items;
+        std::vector<Item*> freeItems;
+        // Being written and its written size, only touched by the draining thread.
+        Item* current;
+        size_t offset;
+        uint64_t sentFrames;
+        uint64_t droppedFrames;
+        uint32_t streams;
+    };
+
+    // Returns true if a key frame should be requested.
+    bool enqueue(Track&, const owt_base::Frame&);
+    void dropQueued(Track&);
+    Item* takeItem(Track&);
+    void releaseItem(Track&, Item*);
+    bool shouldRequestKeyFrame(Track&);
+
+    // Writes queued frames until all streams are blocked or empty. Only one thread drains at a time, the others leave
+    // a note for it to drain again.
+    void flush();
+    void drain();
+    // Closes the current output of `track` and opens a new one for the GOP starting with `current`.
+    void startGopStream(Track&);
+
+    std::string m_contentSessionId;
+    Observer* m_observer;
+
+    // Guards the queues and stream pointers, never held while writing.
+    std::mutex m_mutex;
+    // Held shared while writing, so streams are not replaced during a write.
+    std::shared_timed_mutex m_streamMutex;
+    Track m_audio;
+    Track m_video;
+    owt::quic::WebTransportSessionInterface* m_session;
+
+    std::atomic<bool> m_draining;
+    std::atomic<bool> m_flushPending;
+};
+
+#endif
@@ -5,12 +5,39 @@
  */
 
 #include "QuicTransportServer.h"
+#include "RtpPacketizerInterface.h"
 #include "WebTransportFrameDestination.h"
 #include "WebTransportFrameSource.h"
 #include <node.h>
 
 using namespace v8;
 
+#ifndef OWT_FAKE_RTP
+// Process wide pool of the WebRTC task queues used by the RTP packetizers.
+NAN_METHOD(setTaskQueuePoolSize)
+{
+    if (info.Length() > 0 && info[0]->IsNumber()) {
+        rtc_adapter::RtcAdapterFactory::SetTaskQueuePoolSize(Nan::To<uint32_t>(info[0]).FromJust());
+    }
+}
+
+NAN_METHOD(getTaskQueueStats)
+{
+    std::vector<rtc_adapter::TaskQueueStats> stats = rtc_adapter::RtcAdapterFactory::GetTaskQueueStats();
+    Local<Array> result = Nan::New<Array>(stats.size());
+    for (size_t i = 0; i < stats.size(); i++) {
+        Local<Object> queue = Nan::New<Object>();
+        Nan::Set(queue, Nan::New("name").ToLocalChecked(), Nan::New(stats[i].name).ToLocalChecked());
+        Nan::Set(queue, Nan::New("index").ToLocalChecked(), Nan::New<Number>(stats[i].index));
+        Nan::Set(queue, Nan::New("users").ToLocalChecked(), Nan::New<Number>(stats[i].users));
+        Nan::Set(queue, Nan::New("tasks").ToLocalChecked(), Nan::New<Number>(stats[i].tasks));
+        Nan::Set(queue, Nan::New("busyUs").ToLocalChecked(), Nan::New<Number>(stats[i].busyUs));
+        Nan::Set(result, i, queue);
+    }
+    info.GetReturnValue().Set(result);
+}
+#endif
+
 NAN_MODULE_INIT(InitAll)
 {
     QuicTransportServer::init(target);
@@ -18,6 +45,10 @@ NAN_MODULE_INIT(InitAll)
     QuicTransportConnection::init(target);
     WebTransportFrameSource::init(target);
     WebTransportFrameDestination::init(target);
+#ifndef OWT_FAKE_RTP
+    Nan::SetMethod(target, "setTaskQueuePoolSize", setTaskQueuePoolSize);
+    Nan::SetMethod(target, "getTaskQueueStats", getTaskQueueStats);
+#endif
 }
 
 NODE_MODULE(addon, InitAll)
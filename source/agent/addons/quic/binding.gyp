@@ -12,6 +12,8 @@
       'QuicTransportStream.cc',
       'WebTransportFrameSource.cc',
       'WebTransportFrameDestination.cc',
+      'WebTransportFrameWriter.cc',
+      'WebTransportSendScheduler.cc',
       'VideoRtpPacketizer.cc',
       'RtpFactory.cc',
       '../../../core/owt_base/MediaFramePipeline.cpp',
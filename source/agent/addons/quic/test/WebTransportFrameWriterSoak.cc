@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// Soak benchmark of the WebTransport send path. Feeds frames of varying size to a WebTransportSendScheduler, which
+// frames them with WebTransportFrameWriter, and writes them to a stream taking a limited number of bytes per
+// OnCanWrite, so frames are queued, written partially and dropped. Reports RSS, stream writes per sent frame and the
+// scheduler stats. The stream bytes are parsed as the receiving side does, a frame cut or interleaved is reported as
+// bad. RSS is expected to stay flat once the item buffers reach the largest frames retained.
+//
+// Build and run from this directory, with the include directory of the QUIC SDK:
+//   g++ -O2 -std=gnu++14 -I../../../../core/common -I../../../../core/owt_base -I<quic sdk>/include \
+//       WebTransportFrameWriterSoak.cc ../WebTransportSendScheduler.cc ../WebTransportFrameWriter.cc \
+//       ../../../../core/owt_base/MediaFramePipeline.cpp -lboost_thread -lboost_system -llog4cxx -pthread -o soak
+//   ./soak [frames]
+
+#include "../WebTransportFrameWriter.h"
+#include "../WebTransportSendScheduler.h"
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+// Takes up to `budget` bytes between OnCanWrite calls and parses them as framed media frames.
+class CountingStream : public owt::quic::WebTransportStreamInterface {
+public:
+    CountingStream()
+        : budget(0)
+        , writes(0)
+        , bytes(0)
+        , frames(0)
+        , badFrames(0)
+        , m_headerBytes(0)
+        , m_size(0)
+        , m_remaining(0)
+    {
+    }
+
+    uint32_t Id() const override { return 0; }
+    void SetVisitor(Visitor*) override { }
+    size_t Write(const uint8_t* data, size_t length) override
+    {
+        size_t written = std::min(length, budget);
+        budget -= written;
+        if (written > 0) {
+            writes++;
+            bytes += written;
+            parse(data, written);
+        }
+        return written;
+    }
+    size_t Read(uint8_t*, size_t) override { return 0; }
+    size_t ReadableBytes() const override { return 0; }
+    void Close() override { }
+
+    size_t budget;
+    uint64_t writes;
+    uint64_t bytes;
+    uint64_t frames;
+    uint64_t badFrames;
+
+private:
+    // Body bytes of a frame are expected to count up from its first byte.
+    void parse(const uint8_t* data, size_t length)
+    {
+        for (size_t i = 0; i < length; i++) {
+            if (m_headerBytes < WebTransportFrameWriter::kHeaderSize) {
+                m_size = (m_size << 8) + data[i];
+                if (++m_headerBytes == WebTransportFrameWriter::kHeaderSize) {
+                    m_remaining = m_size;
+                    m_expected = -1;
+                    endFrameIfDone();
+                }
+                continue;
+            }
+            if (m_expected >= 0 && data[i] != uint8_t(m_expected)) {
+                badFrames++;
+            }
+            m_expected = uint8_t(data[i] + 1);
+            m_remaining--;
+            endFrameIfDone();
+        }
+    }
+
+    void endFrameIfDone()
+    {
+        if (m_remaining == 0) {
+            frames++;
+            m_headerBytes = 0;
+            m_size = 0;
+        }
+    }
+
+    size_t m_headerBytes;
+    uint32_t m_size;
+    uint32_t m_remaining;
+    int m_expected;
+};
+
+class KeyFrameCounter : public WebTransportSendScheduler::Observer {
+public:
+    KeyFrameCounter()
+        : requests(0)
+    {
+    }
+    void onKeyFrameRequired() override { requests++; }
+
+    uint64_t requests;
+};
+
+long rssKb()
+{
+    long pages(0);
+    FILE* statm = fopen("/proc/self/statm", "r");
+    if (statm) {
+        if (fscanf(statm, "%*ld %ld", &pages) != 1) {
+            pages = 0;
+        }
+        fclose(statm);
+    }
+    return pages * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    const uint64_t frames = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+    const uint64_t reportInterval = frames / 10 > 0 ? frames / 10 : 1;
+    // Mostly delta frames with a large key frame every 60 frames.
+    std::vector<uint8_t> payload(200 * 1024 + 256);
+    for (size_t i = 0; i < payload.size(); i++) {
+        payload[i] = i & 0xFF;
+    }
+
+    KeyFrameCounter observer;
+    WebTransportSendScheduler scheduler(std::string(32, '0'), &observer);
+    CountingStream stream;
+    scheduler.setStream(false, std::string(32, '1'), &stream);
+
+    owt_base::Frame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.format = owt_base::FRAME_FORMAT_H264;
+
+    long startRss = rssKb();
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < frames; i++) {
+        bool isKeyFrame = (i % 60 == 0);
+        frame.length = isKeyFrame ? 200 * 1024 : 1000 + (i * 7919) % 20000;
+        frame.additionalInfo.video.isKeyFrame = isKeyFrame;
+        // Starts at a different byte each frame, so bytes of two frames don't count up across a cut.
+        frame.payload = payload.data() + (i & 0xFF);
+        scheduler.onFrame(frame);
+        // A bit less than the average frame size, so the video queue overflows now and then.
+        stream.budget = 8 * 1024 + (i * 104729) % (8 * 1024);
+        scheduler.OnCanWrite();
+        if ((i + 1) % reportInterval == 0) {
+            WebTransportSendScheduler::Stats stats = scheduler.getStats(false);
+            printf("frames %lu, rss %ld KB (+%ld), sent %lu, dropped %lu, queued %u, writes/frame %.2f\n", i + 1,
+                rssKb(), rssKb() - startRss, stats.sentFrames, stats.droppedFrames, stats.queuedFrames,
+                stats.sentFrames ? (double)stream.writes / stats.sentFrames : 0.0);
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    // Completes the frame being written, so every sent frame can be parsed.
+    stream.budget = SIZE_MAX;
+    scheduler.OnCanWrite();
+    WebTransportSendScheduler::Stats stats = scheduler.getStats(false);
+    printf("%lu frames, %lu sent, %lu parsed, %lu bad, %lu dropped, %lu key frame requests, %lu writes, %lu bytes, "
+           "%.1f ns/frame\n",
+        frames, stats.sentFrames, stream.frames, stream.badFrames, stats.droppedFrames, observer.requests,
+        stream.writes, stream.bytes, seconds * 1e9 / frames);
+    scheduler.setStream(false, std::string(32, '1'), nullptr);
+    return stream.badFrames == 0 && stream.frames == stats.sentFrames ? 0 : 1;
+}
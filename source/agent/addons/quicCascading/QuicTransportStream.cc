@@ -7,6 +7,7 @@
 #include <chrono>
 #include <iostream>
 #include "QuicTransportStream.h"
+#include "FrameWireFormat.h"
 
 //using namespace net;
 using namespace owt_base;
@@ -242,13 +243,11 @@ void QuicTransportStream::onFrame(const owt_base::Frame& frame)
     //ELOG_DEBUG("QuicTransportStream::onFrame");
     //dump(this, frame.payload, frame.length);
     TransportData sendData;
-    sendData.buffer.reset(new char[sizeof(Frame) + frame.length + 5]);
-    *(reinterpret_cast<uint32_t*>(sendData.buffer.get())) = htonl(sizeof(Frame) + frame.length + 1);
-    sendData.buffer[4] = TDT_MEDIA_FRAME;
-    memcpy(sendData.buffer.get() + 5, reinterpret_cast<uint8_t*>(const_cast<Frame*>(&frame)),
-           sizeof(Frame));
-    memcpy(sendData.buffer.get() + 5 + sizeof(Frame), frame.payload, frame.length);
-    sendData.length = sizeof(Frame) + frame.length + 5;
+    sendData.buffer.reset(new char[kFrameMessageMaxHeaderSize + frame.length + 4]);
+    size_t headerLength = encodeFrameMessage(frame, reinterpret_cast<uint8_t*>(sendData.buffer.get() + 4));
+    *(reinterpret_cast<uint32_t*>(sendData.buffer.get())) = htonl(headerLength + frame.length);
+    memcpy(sendData.buffer.get() + 4 + headerLength, frame.payload, frame.length);
+    sendData.length = headerLength + frame.length + 4;
 
     m_stream->SendData(sendData.buffer.get(), sendData.length);
 }
@@ -308,18 +307,27 @@ void QuicTransportStream::OnData(owt::quic::QuicTransportStreamInterface* stream
         } else {
             m_receivedBytes -= expectedLen;
             char* dpos = m_receiveData.buffer.get() + 4;
-            Frame* frame = nullptr;
+            Frame frame;
+            bool isFrame = false;
             std::string s_data(dpos + 1, payloadlen - 1);
             owt_base::FeedbackMsg msg {.type = owt_base::VIDEO_FEEDBACK, .cmd = owt_base::REQUEST_KEY_FRAME};
 
             switch (dpos[0]) {
+                case TDT_MEDIA_FRAME_WIRE:
                 case TDT_MEDIA_FRAME:
                     //ELOG_DEBUG("QuicTransportStream deliver frame with trackKind: %s", m_trackKind.c_str());
-                    frame = reinterpret_cast<Frame*>(dpos + 1);
-                    frame->payload = reinterpret_cast<uint8_t*>(dpos + 1 + sizeof(Frame));
+                    if (dpos[0] == TDT_MEDIA_FRAME_WIRE) {
+                        isFrame = decodeFrame(reinterpret_cast<uint8_t*>(dpos + 1), payloadlen - 1, frame);
+                    } else {
+                        // From cascaded clusters sending the previous format
+                        isFrame = decodeLegacyFrame(reinterpret_cast<uint8_t*>(dpos + 1), payloadlen - 1, frame);
+                    }
+                    if (!isFrame) {
+                        break;
+                    }
                     if (m_trackKind == "video") {
                       if (m_needKeyFrame) {
-                        if (frame->additionalInfo.video.isKeyFrame) {
+                        if (frame.additionalInfo.video.isKeyFrame) {
                             m_needKeyFrame = false;
                         } else {
                             ELOG_DEBUG("Request key frame\n");
@@ -328,8 +336,8 @@ void QuicTransportStream::OnData(owt::quic::QuicTransportStreamInterface* stream
                         }
                       }
                     }
-                    //dump(this, frame->payload, frame->length);
-                    deliverFrame(*frame);
+                    //dump(this, frame.payload, frame.length);
+                    deliverFrame(frame);
                     break;
                 case TDT_MEDIA_METADATA: {
                     ELOG_DEBUG("QuicTransportStream::onData with type TDT_MEDIA_METADATA%s", s_data.c_str(), " in stream:%d", id);
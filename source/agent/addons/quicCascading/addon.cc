@@ -8,10 +8,19 @@
 #include "QuicTransportClient.h"
 #include "QuicTransportFrameSource.h"
 #include "QuicTransportFrameDestination.h"
+#include "FrameWireFormat.h"
 #include <node.h>
 
 using namespace v8;
 
+// Arguments: compact, whether to send frames in the compact wire format
+NAN_METHOD(setFrameWireConfig)
+{
+  if (info.Length() > 0 && info[0]->IsBoolean()) {
+    owt_base::FrameWireConfig::defaultConfig().compact = Nan::To<bool>(info[0]).FromJust();
+  }
+}
+
 NAN_MODULE_INIT(InitAll)
 {
   QuicTransportStream::init(target);
@@ -20,6 +29,7 @@ NAN_MODULE_INIT(InitAll)
   QuicTransportClient::init(target);
   QuicTransportFrameSource::init(target);
   QuicTransportFrameDestination::init(target);
+  Nan::SetMethod(target, "setFrameWireConfig", setFrameWireConfig);
 }
 
 NODE_MODULE(addon, InitAll)
@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "QuicTransport.h"
+#include "FrameWireFormat.h"
 #include <thread>
 #include <chrono>
 #include <iostream>
@@ -49,14 +50,21 @@ void QuicIn::onFeedback(const FeedbackMsg& msg) {
     server_->send((char*)sendBuffer, sizeof(FeedbackMsg) + 1);
 }
 
-void QuicIn::dFrame(char* buf) {
-    owt_base::Frame* frame = nullptr;
+void QuicIn::dFrame(char* buf, uint32_t len) {
+    owt_base::Frame frame;
+    if (len <= 1) {
+        return;
+    }
     switch (buf[0]) {
+        case TDT_MEDIA_FRAME_WIRE:
+            if (decodeFrame(reinterpret_cast<uint8_t*>(buf + 1), len - 1, frame)) {
+                deliverFrame(frame);
+            }
+            break;
         case TDT_MEDIA_FRAME:
-            frame = reinterpret_cast<Frame*>(buf + 1);
-            frame->payload = reinterpret_cast<uint8_t*>(buf + 1 + sizeof(Frame));
-            deliverFrame(*frame);
-            // std::cout << "deliverFrame" << std::endl;
+            if (decodeLegacyFrame(reinterpret_cast<uint8_t*>(buf + 1), len - 1, frame)) {
+                deliverFrame(frame);
+            }
             break;
         default:
             break;
@@ -94,7 +102,7 @@ void QuicIn::onData(uint32_t session_id, uint32_t stream_id, char* buf, uint32_t
             // std::cout << "receive: " << expectedLen << std::endl;
             m_receivedBytes -= expectedLen;
             char* dpos = m_receiveData.buffer.get() + 4;
-            dFrame(dpos);
+            dFrame(dpos, payloadlen);
             if (m_receivedBytes > 0) {
                 std::cout << "not zero m_receiveBytes" << std::endl;
                 memcpy(m_receiveData.buffer.get(), m_receiveData.buffer.get() + expectedLen, m_receivedBytes);
@@ -116,14 +124,11 @@ QuicOut::~QuicOut() {
 }
 
 void QuicOut::onFrame(const Frame& frame) {
-    char sendBuffer[sizeof(Frame) + 1];
-    size_t header_len = sizeof(Frame);
-
-    sendBuffer[0] = TDT_MEDIA_FRAME;
-    memcpy(&sendBuffer[1], reinterpret_cast<char*>(const_cast<Frame*>(&frame)), header_len);
+    char sendBuffer[kFrameMessageMaxHeaderSize];
+    size_t header_len = encodeFrameMessage(frame, reinterpret_cast<uint8_t*>(sendBuffer));
 
     char* header = sendBuffer;
-    int headerLength = header_len + 1;
+    int headerLength = header_len;
     char* payload = reinterpret_cast<char*>(const_cast<uint8_t*>(frame.payload));
     int payloadLength = frame.length;
 
@@ -32,7 +32,7 @@ public:
     void onReady() override;
     void onData(uint32_t session_id, uint32_t stream_id, char* data, uint32_t len) override;
 private:
-    void dFrame(char* buf);
+    void dFrame(char* buf, uint32_t len);
 
     typedef struct {
         boost::shared_array<char> buffer;
@@ -3,13 +3,22 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "InternalQuic.h"
+#include "FrameWireFormat.h"
 #include <node.h>
 
 using namespace v8;
 
+// Arguments: compact, whether to send frames in the compact wire format
+void setFrameWireConfig(const FunctionCallbackInfo<Value>& args) {
+  if (args.Length() > 0 && args[0]->IsBoolean()) {
+    owt_base::FrameWireConfig::defaultConfig().compact = args[0]->BooleanValue();
+  }
+}
+
 void InitAll(Handle<Object> exports) {
   InternalQuicIn::Init(exports);
   InternalQuicOut::Init(exports);
+  NODE_SET_METHOD(exports, "setFrameWireConfig", setFrameWireConfig);
 }
 
 NODE_MODULE(addon, InitAll)
@@ -56,6 +56,9 @@ module.exports.load = () => {
 
     config.analytics = config.analytics || {};
     config.analytics.libpath = config.analytics.libpath || 'lib';
+    config.analytics.streamsPerProcess = config.analytics.streamsPerProcess || 1;
+    config.analytics.batchSize = config.analytics.batchSize || 1;
+    config.analytics.inferenceFramerate = config.analytics.inferenceFramerate || 0;
 
     config.capacity = config.capacity || {};
     // add plugin library to ld library path
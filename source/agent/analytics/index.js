@@ -50,11 +50,11 @@ module.exports = function (rpcClient, rpcId, agentId, clusterIp) {
 
   // get algorithms from "plugin.cfg"
   var algorithms = {};
-  var newStreamId;
-  var inputs = {};  //TODO:Each process will only have one input, so this can be modified to input 
+  // connectionId - {engine, streamId, connectionclose}, one engine per input as
+  // several inputs of a room may share this process, see analytics.streamsPerProcess
+  var inputs = {};
   // connectionId - dispatcher
   var outputs = {};
-  var engine = new VideoAnalyzer();
   var controller;
   // For GRPC notifications
   var streamingEmitter = new EventEmitter();
@@ -136,6 +136,28 @@ module.exports = function (rpcClient, rpcId, agentId, clusterIp) {
   };
 
 
+  // Inputs are keyed by subscription, their generated streams by stream ID.
+  const findInput = (id) => {
+    if (inputs[id]) {
+      return {id, input: inputs[id]};
+    }
+    for (const inputId in inputs) {
+      if (inputs[inputId].streamId === id) {
+        return {id: inputId, input: inputs[inputId]};
+      }
+    }
+    return {id, input: null};
+  };
+
+  // The process outlives the input when it's shared with others, so its
+  // engine is closed once both the input and its output are removed.
+  const releaseInput = (id) => {
+    if (inputs[id] && inputs[id].unsubscribed && !outputs[id]) {
+      inputs[id].engine.close();
+      delete inputs[id];
+    }
+  };
+
   that.getInternalAddress = function(callback) {
     const ip = global.config.internal.ip_address;
     const port = router.internalPort;
@@ -149,10 +171,14 @@ module.exports = function (rpcClient, rpcId, agentId, clusterIp) {
       return callback('callback', {type: 'failed', reason: 'invalid connctionType'+connectionType});
     }
 
+    const {id, input} = findInput(connectionId);
+    if (!input) {
+      return callback('callback', 'error', 'Input not found: ' + connectionId);
+    }
     var dispatcher = new MediaFrameMulticaster();
-    if (engine.addOutput(dispatcher)){
-      outputs[connectionId] = {dispatcher: dispatcher};
-      router.addLocalSource(newStreamId, connectionType, dispatcher.source());
+    if (input.engine.addOutput(dispatcher)){
+      outputs[id] = {dispatcher: dispatcher, streamId: input.streamId};
+      router.addLocalSource(input.streamId, connectionType, dispatcher.source());
       callback('callback', 'ok');
     } else {
       callback('callback', 'error', 'Failed in adding output')
@@ -161,15 +187,21 @@ module.exports = function (rpcClient, rpcId, agentId, clusterIp) {
 
   that.unpublish = function (connectionId, callback) {
     log.debug('unpublish, connectionId:', connectionId);
-    if (outputs[connectionId]) {
-      var output = outputs[connectionId];
-      engine.removeOutput(output.dispatcher);
-      engine.clearPipeline();
-      router.removeLocalSource(newStreamId);
+    const {id, input} = findInput(connectionId);
+    if (outputs[id]) {
+      var output = outputs[id];
+      if (input) {
+        input.engine.removeOutput(output.dispatcher);
+        input.engine.clearPipeline();
+      }
+      router.removeLocalSource(output.streamId);
       output.dispatcher.close();
-      delete outputs[connectionId];
+      delete outputs[id];
+    }
+    if (input) {
+      input.connectionclose();
+      releaseInput(id);
     }
-    this.connectionclose();
     callback('callback', 'ok');
   };
 
@@ -190,7 +222,8 @@ module.exports = function (rpcClient, rpcId, agentId, clusterIp) {
       const algo = options.connection.algorithm;
       controller = options.controller;
 
-      newStreamId = algo + options.media.video.from;
+      const newStreamId = algo + options.media.video.from;
+      const engine = new VideoAnalyzer();
 
       const pluginName = algorithms[algo].name;
       let codec = videoFormat.codec;
@@ -201,20 +234,29 @@ module.exports = function (rpcClient, rpcId, agentId, clusterIp) {
       const {resolution, framerate, keyFrameInterval, bitrate}
           = getVideoParameterForAddon(options.connection.video);
 
-      if ( !engine.createPipeline(codec,resolution,framerate,bitrate,keyFrameInterval,algo,pluginName) ) {
-        return Promise.reject('Create pipeline failed');
+      // Inference runs on every inferenceInterval-th frame, and the frames of
+      // up to batchSize inputs of this process are batched by the plugin.
+      const inferenceFramerate = global.config.analytics.inferenceFramerate;
+      const inferenceInterval = inferenceFramerate > 0
+          ? Math.max(1, Math.round(framerate / inferenceFramerate)) : 1;
+      const batchSize = global.config.analytics.batchSize || 1;
+
+      if ( !engine.createPipeline(codec,resolution,framerate,bitrate,keyFrameInterval,algo,pluginName,
+                                  inferenceInterval,batchSize) ) {
+        engine.close();
+        return callback('callback', 'error', 'Create pipeline failed');
       }
 
       const status = {type: 'ready', info: {algorithm: algo}};
       notifyStatus(options.controller, connectionId, 'out', status);
 
-      this.connectionclose = () => {
+      const connectionclose = () => {
         destroyStream(options.controller, newStreamId);
         // Notify stream engine if needed
         const data = {id: newStreamId};
         notifyStatus(options.controller, connectionId, 'onStreamRemoved', data);
       }
-      inputs[connectionId] = true;
+      inputs[connectionId] = {engine, streamId: newStreamId, connectionclose};
 
       engine.addEventListener('fatal', function (error) {
         log.error('GStreamer pipeline error:', error);
@@ -232,7 +274,7 @@ module.exports = function (rpcClient, rpcId, agentId, clusterIp) {
 
         var dispatcher = new MediaFrameMulticaster();
         if (engine.addOutput(dispatcher)){
-          outputs[connectionId] = {dispatcher: dispatcher};
+          outputs[connectionId] = {dispatcher: dispatcher, streamId: newStreamId};
           router.addLocalSource(newStreamId, connectionType, dispatcher.source());
           callback('callback', 'ok');
         } else {
@@ -286,6 +328,8 @@ module.exports = function (rpcClient, rpcId, agentId, clusterIp) {
             callback('callback', 'ok');
         }, rpcError(callback));
       }
+      inputs[connectionId].unsubscribed = true;
+      releaseInput(connectionId);
     }
   };
 
@@ -294,6 +338,7 @@ module.exports = function (rpcClient, rpcId, agentId, clusterIp) {
   that.linkup = function (connectionId, fromInfo, callback) {
     log.debug('linkup, connectionId:', connectionId, 'from:', fromInfo);
     if (inputs[connectionId]) {
+      const engine = inputs[connectionId].engine;
       if (engine) {
         var conn = router.getOrCreateRemoteSource({
           id: fromInfo.video.id,
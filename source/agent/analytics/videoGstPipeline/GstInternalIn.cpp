@@ -29,6 +29,11 @@ static void mem_put_le32(uint8_t *mem, unsigned int val) {
     mem[3] = val >> 24;
 }
 
+static void releasePayload(gpointer data)
+{
+    intrusive_ptr_release(static_cast<owt_base::MediaBuffer*>(data));
+}
+
 DEFINE_LOGGER(GstInternalIn, "GstInternalIn");
 GstInternalIn::GstInternalIn(GstAppSrc *data, int framerate)
 {
@@ -69,7 +74,6 @@ void GstInternalIn::onFrame(const owt_base::Frame& frame)
         return;
     }
     size_t payloadLength       = frame.length;
-    size_t headerLength       = sizeof(frame);
 
     GstBuffer *buffer;
     GstFlowReturn ret;
@@ -88,11 +92,9 @@ void GstInternalIn::onFrame(const owt_base::Frame& frame)
     }
 
 
-    size_t allocLength = payloadLength + headerLength;
-    uint8_t ivf_header[32] = {0};
-    uint8_t ivf_frame_header[12] = {0};
+    // The IVF file header before the first frame, then the frame header.
+    uint8_t ivf_header[32 + 12] = {0};
     size_t ivf_header_length = 0;
-    size_t ivf_frame_header_length = 0;
 
     if (frame.format == owt_base::FRAME_FORMAT_VP8) {
         if (num_frames == 0) {
@@ -115,29 +117,28 @@ void GstInternalIn::onFrame(const owt_base::Frame& frame)
             mem_put_le32(ivf_header+28, 0);
             ivf_header_length = 32;
         }
-        mem_put_le32(ivf_frame_header, payloadLength);
-        mem_put_le32(ivf_frame_header+4, num_frames);
-        ivf_frame_header_length = 12;
+        mem_put_le32(ivf_header+ivf_header_length, payloadLength);
+        mem_put_le32(ivf_header+ivf_header_length+4, num_frames);
+        ivf_header_length += 12;
     }
 
-    /* Create a new empty buffer */
-    buffer = gst_buffer_new_and_alloc (payloadLength + ivf_header_length + ivf_frame_header_length);
-    gst_buffer_map(buffer, &map, GST_MAP_WRITE);
-    if (frame.format == owt_base::FRAME_FORMAT_VP8) {
-        if (num_frames == 0) {
-            memcpy(map.data, ivf_header, ivf_header_length);
-        }
-        memcpy(map.data + ivf_header_length, ivf_frame_header, ivf_frame_header_length);
+    /* The payload is referenced instead of copied when the producer attached a MediaBuffer */
+    owt_base::MediaBuffer* payload = owt_base::retainPayload(frame).detach();
+    buffer = gst_buffer_new();
+    if (ivf_header_length > 0) {
+        gpointer header = g_memdup(ivf_header, ivf_header_length);
+        gst_buffer_append_memory(buffer, gst_memory_new_wrapped(GST_MEMORY_FLAG_READONLY,
+            header, ivf_header_length, 0, ivf_header_length, header, g_free));
     }
-
-    memcpy(map.data + ivf_header_length + ivf_frame_header_length, frame.payload, payloadLength);
+    gst_buffer_append_memory(buffer, gst_memory_new_wrapped(GST_MEMORY_FLAG_READONLY,
+        payload->data(), payload->capacity(), 0, payloadLength, payload, releasePayload));
 
     if(m_dumpIn) {
+        gst_buffer_map(buffer, &map, GST_MAP_READ);
         dump(this, map.data, map.size);
+        gst_buffer_unmap(buffer, &map);
     }
 
-
-    gst_buffer_unmap(buffer, &map);
     g_signal_emit_by_name(appsrc, "push-buffer", buffer, &ret);
 
     gst_buffer_unref(buffer);
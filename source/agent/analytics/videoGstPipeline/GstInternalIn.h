@@ -20,6 +20,8 @@ public:
     virtual ~GstInternalIn();
 
     void onFrame(const owt_base::Frame& frame);
+    // Wrapped in the GstBuffer pushed to the pipeline
+    bool keepsPayload() { return true; }
     void setPushData(bool status);
 
 private:
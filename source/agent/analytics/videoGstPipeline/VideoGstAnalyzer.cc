@@ -14,6 +14,9 @@ namespace mcu {
 DEFINE_LOGGER(VideoGstAnalyzer, "mcu.VideoGstAnalyzer");
 
 GMainLoop* VideoGstAnalyzer::loop = NULL;
+GThread* VideoGstAnalyzer::loopThread = NULL;
+int VideoGstAnalyzer::loopUsers = 0;
+boost::mutex VideoGstAnalyzer::loopMutex;
 
 inline bool isH264KeyFrame(uint8_t *data, size_t len)
 {
@@ -84,6 +87,10 @@ VideoGstAnalyzer::VideoGstAnalyzer(EventRegistry *handle) : m_asyncHandle(handle
 {
     ELOG_INFO("Init");
     sourceid = 0;
+    pipeline = NULL;
+    pipelineHandle = NULL;
+    pipeline_ = NULL;
+    m_loopAcquired = false;
     sink = NULL;
     encoder_pad = NULL;
     addlistener = false;
@@ -138,9 +145,8 @@ gboolean VideoGstAnalyzer::StreamEventCallBack(GstBus *bus, GstMessage *message,
         break;
     }
     case GST_MESSAGE_EOS:
-        /* end-of-stream */
+        /* end-of-stream, the loop is shared with the other pipelines and keeps running */
         ELOG_ERROR("End of stream\n");
-        g_main_loop_quit(pStreamObj->loop);
         break;
     case GST_MESSAGE_TAG:{
         GstTagList *tags = NULL;
@@ -218,8 +224,7 @@ void VideoGstAnalyzer::clearPipeline()
         gst_element_set_state(pipeline, GST_STATE_NULL);
         gst_object_unref(GST_OBJECT(pipeline));
         g_source_remove(m_bus_watch_id);
-        g_main_loop_unref(loop);
-        gst_object_unref(m_bus);
+        pipeline = nullptr;
     }
 
 }
@@ -231,12 +236,13 @@ void VideoGstAnalyzer::destroyPipeline()
     if (pipeline_ != nullptr && pipelineHandle != nullptr) {
          destroyPlugin(pipeline_);
          dlclose(pipelineHandle);
-         stopLoop();
     }
+    stopLoop();
 }
 
 bool VideoGstAnalyzer::createPipeline(std::string codec, int width, int height,
-    int framerate, int bitrate, int kfi, std::string algo, std::string pluginName)
+    int framerate, int bitrate, int kfi, std::string algo, std::string pluginName,
+    int inferenceInterval, int batchSize)
 {
     this->inputcodec = codec;
     this->width = width;
@@ -246,6 +252,8 @@ bool VideoGstAnalyzer::createPipeline(std::string codec, int width, int height,
     this->kfi = kfi;
     this->algo = algo;
     this->libraryName = pluginName;
+    this->inferenceInterval = inferenceInterval;
+    this->batchSize = batchSize;
 
     pipelineHandle = dlopen(libraryName.c_str(), RTLD_LAZY);
     if (pipelineHandle == nullptr) {
@@ -274,7 +282,12 @@ bool VideoGstAnalyzer::createPipeline(std::string codec, int width, int height,
         {"inputheight", std::to_string(height)},
         {"inputframerate", std::to_string(framerate)},
         {"inputcodec", inputcodec},
-        {"pipelinename", algo} };
+        {"pipelinename", algo},
+        // For the inference elements of the plugin. Elements with the same model instance id share one inference
+        // engine, which batches the frames of all the pipelines of the process running the algorithm.
+        {"inferenceinterval", std::to_string(inferenceInterval)},
+        {"batchsize", std::to_string(batchSize)},
+        {"modelinstanceid", algo} };
     pipeline_->PipelineConfig(plugin_config_map);
 
     /* Create the empty VideoGstAnalyzer */
@@ -286,7 +299,8 @@ bool VideoGstAnalyzer::createPipeline(std::string codec, int width, int height,
         return false;
     }
 
-    loop = g_main_loop_new(NULL, FALSE);
+    acquireLoop();
+    m_loopAcquired = true;
 
     m_bus = gst_pipeline_get_bus(GST_PIPELINE(pipeline));
     m_bus_watch_id = gst_bus_add_watch(m_bus, StreamEventCallBack, this);
@@ -364,20 +378,44 @@ void VideoGstAnalyzer::new_sample_from_sink (GstElement * source, gpointer data)
 
 void VideoGstAnalyzer::stopLoop()
 {
-    if(loop){
+    if (m_loopAcquired) {
+        m_loopAcquired = false;
+        releaseLoop();
+    }
+}
+
+void VideoGstAnalyzer::acquireLoop()
+{
+    boost::mutex::scoped_lock lock(loopMutex);
+    if (loopUsers++ == 0) {
+        loop = g_main_loop_new(NULL, FALSE);
+        loopThread = g_thread_new("analytics-loop", (GThreadFunc)main_loop_thread, loop);
+    }
+}
+
+void VideoGstAnalyzer::releaseLoop()
+{
+    boost::mutex::scoped_lock lock(loopMutex);
+    if (--loopUsers == 0) {
         ELOG_DEBUG("main loop quit\n");
         g_main_loop_quit(loop);
+        g_thread_join(loopThread);
+        g_main_loop_unref(loop);
+        loop = NULL;
+        loopThread = NULL;
     }
 }
 
 void VideoGstAnalyzer::main_loop_thread(gpointer data)
 {
-    g_main_loop_run(loop);
-    g_thread_exit(0);
+    g_main_loop_run(static_cast<GMainLoop*>(data));
 }
 
 void VideoGstAnalyzer::setState(GstState newstate)
 {
+    if (!pipeline) {
+        return;
+    }
     ret = gst_element_set_state(pipeline, newstate);
     if (ret == GST_STATE_CHANGE_FAILURE) {
         ELOG_ERROR("Unable to set the pipeline to the PLAYING state.\n");
@@ -390,7 +428,6 @@ void VideoGstAnalyzer::setPlaying()
 {
 
     setState(GST_STATE_PLAYING);
-    m_thread = g_thread_create((GThreadFunc)main_loop_thread,NULL,TRUE,NULL);
 }
 
 bool VideoGstAnalyzer::linkInput(owt_base::FrameSource* videosource) {
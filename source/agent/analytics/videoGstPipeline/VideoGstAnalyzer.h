@@ -26,8 +26,11 @@ class VideoGstAnalyzer : public EventRegistry {
 public:
     VideoGstAnalyzer(EventRegistry* handle);
     ~VideoGstAnalyzer();
+    // `inferenceInterval` runs inference on one of every that many frames, `batchSize` is the batch size of the
+    // inference instance shared by the pipelines of the process running `algo`.
     bool createPipeline(std::string codec, int width, int height,
-    int framerate, int bitrate, int kfi, std::string algo, std::string pluginName);
+    int framerate, int bitrate, int kfi, std::string algo, std::string pluginName,
+    int inferenceInterval = 1, int batchSize = 1);
     void clearPipeline();
     void removeOutput(owt_base::FrameDestination* out);
     bool addOutput(owt_base::FrameDestination* out);
@@ -40,7 +43,13 @@ public:
 
 protected:
     static void main_loop_thread(gpointer);
+    // One main loop and thread serve the bus watches of all the pipelines of the process.
     static GMainLoop *loop;
+    static GThread *loopThread;
+    static int loopUsers;
+    static boost::mutex loopMutex;
+    static void acquireLoop();
+    static void releaseLoop();
     static gboolean StreamEventCallBack(GstBus *bus, GstMessage *message, gpointer data);
     void setState(GstState newstate);
     void setPlaying();
@@ -65,7 +74,7 @@ private:
     
     GstStateChangeReturn ret;
 
-    GThread *m_thread;
+    bool m_loopAcquired;
     guint m_bus_watch_id;
     GstBus *m_bus;
     boost::thread m_playthread;
@@ -81,6 +90,8 @@ private:
     int width,height;
     int framerate,bitrate;
     int kfi; //keyFrameInterval
+    int inferenceInterval;
+    int batchSize;
     bool addlistener;
     bool m_dumpOut;
 };
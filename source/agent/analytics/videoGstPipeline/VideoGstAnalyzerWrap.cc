@@ -80,8 +80,11 @@ void VideoGstAnalyzerWrap::createPipeline(const FunctionCallbackInfo<Value>& arg
   Nan::Utf8String param7(Nan::To<v8::String>(args[6]).ToLocalChecked());
   std::string pluginName = std::string(*param7);
 
+  unsigned int inferenceInterval = args[7]->IsNumber() ? Nan::To<uint32_t>(args[7]).FromJust() : 1;
+  unsigned int batchSize = args[8]->IsNumber() ? Nan::To<uint32_t>(args[8]).FromJust() : 1;
+
   bool result = me->createPipeline(codec,width,height,framerateFPS,bitrateKbps,
-                       keyFrameIntervalSeconds,algorithm,pluginName);
+                       keyFrameIntervalSeconds,algorithm,pluginName,inferenceInterval,batchSize);
 
   args.GetReturnValue().Set(Number::New(isolate, result));
 }
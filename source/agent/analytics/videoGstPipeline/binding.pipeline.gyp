@@ -6,6 +6,7 @@
       './VideoGstAnalyzerWrap.cc',
       './VideoGstAnalyzer.cpp',
       '../../addons/common/NodeEventRegistry.cc',
+      '../../addons/common/NodeEventDispatcher.cc',
       '../../../core/owt_base/MediaFramePipeline.cpp',
       '../../../core/owt_base/RawTransport.cpp',
       '../../../core/common/IOService.cpp',
@@ -18,24 +18,22 @@ AcmEncoder::AcmEncoder(const FrameFormat format)
     : m_format(format)
     , m_rtpSampleRate(0)
     , m_valid(false)
-    , m_running(false)
+    , m_shard(0)
     , m_incomingFrameCount(0)
 {
     AudioCodingModule::Config config;
     m_audioCodingModule.reset(AudioCodingModule::Create(config));
 
     m_frame.reset(new AudioFrame());
-    m_running = true;
-    m_thread = boost::thread(&AcmEncoder::encodeLoop, this);
+    m_encodingFrame.reset(new AudioFrame());
+    m_shard = AudioEncodeExecutor::GetInstance().attach(this);
 }
 
 AcmEncoder::~AcmEncoder()
 {
     int ret;
 
-    m_running = false;
-    m_cond.notify_one();
-    m_thread.join();
+    AudioEncodeExecutor::GetInstance().detach(this, m_shard);
 
     if (!m_valid)
         return;
@@ -111,39 +109,28 @@ bool AcmEncoder::addAudioFrame(const AudioFrame* audioFrame)
         if (m_incomingFrameCount == 3)
             ELOG_WARN_T("Too many pending frames(%d)", m_incomingFrameCount);
 
-        m_incomingFrameCount++;
-        m_cond.notify_one();
+        if (m_incomingFrameCount++ == 0)
+            AudioEncodeExecutor::GetInstance().schedule(this, m_shard);
     }
 
     return true;
 }
 
-void AcmEncoder::encodeLoop()
+void AcmEncoder::encodePending()
 {
-    while (true) {
-        boost::shared_ptr<AudioFrame> frame;
-
-        {
-            boost::mutex::scoped_lock lock(m_mutex);
-
-            while (m_running && m_incomingFrameCount == 0) {
-                m_cond.wait(lock);
-            }
-
-            if (!m_running)
-                break;
-
-            m_incomingFrameCount = 0;
-            frame = m_frame;
-        }
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        if (m_incomingFrameCount == 0)
+            return;
 
-        int ret = m_audioCodingModule->Add10MsData(*frame.get());
-        if (ret < 0) {
-            ELOG_ERROR_T("Fail to insert raw into acm");
-        }
+        m_incomingFrameCount = 0;
+        m_frame.swap(m_encodingFrame);
     }
 
-    ELOG_DEBUG_T("Thread exited!");
+    int ret = m_audioCodingModule->Add10MsData(*m_encodingFrame.get());
+    if (ret < 0) {
+        ELOG_ERROR_T("Fail to insert raw into acm");
+    }
 }
 
 int32_t AcmEncoder::SendData(FrameType frame_type,
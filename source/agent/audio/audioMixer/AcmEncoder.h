@@ -15,13 +15,15 @@
 
 #include "MediaFramePipeline.h"
 #include "AudioEncoder.h"
+#include "AudioEncodeExecutor.h"
 
 namespace mcu {
 using namespace owt_base;
 using namespace webrtc;
 
 class AcmEncoder : public AudioEncoder,
-                       public AudioPacketizationCallback {
+                       public AudioPacketizationCallback,
+                       public AudioEncodeJob {
     DECLARE_LOGGER();
 
 public:
@@ -39,8 +41,8 @@ public:
             size_t payload_len_bytes,
             const RTPFragmentationHeader* fragmentation) override;
 
-protected:
-    void encodeLoop();
+    // Implements AudioEncodeJob
+    void encodePending() override;
 
 private:
     boost::shared_ptr<AudioCodingModule> m_audioCodingModule;
@@ -49,13 +51,12 @@ private:
 
     bool m_valid;
 
-    bool m_running;
-    boost::thread m_thread;
+    uint32_t m_shard;
     boost::mutex m_mutex;
-    boost::condition_variable m_cond;
 
     uint32_t m_incomingFrameCount;
     boost::shared_ptr<AudioFrame> m_frame;
+    boost::shared_ptr<AudioFrame> m_encodingFrame;
 };
 
 } /* namespace mcu */
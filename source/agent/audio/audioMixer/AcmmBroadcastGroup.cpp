@@ -104,6 +104,14 @@ int32_t AcmmBroadcastGroup::NeededFrequency()
     return neededFreq;
 }
 
+void AcmmBroadcastGroup::getOutputs(std::vector<boost::shared_ptr<AcmmOutput>> &outputs)
+{
+    outputs.clear();
+    for (auto& it : m_outputMap) {
+        outputs.push_back(it.second);
+    }
+}
+
 void AcmmBroadcastGroup::NewMixedAudio(const webrtc::AudioFrame *audioFrame)
 {
     ELOG_TRACE("newAudioFrame, frame id(0x%x), sample_rate(%d), channels(%ld), samples_per_channel(%ld), timestamp(%d)",
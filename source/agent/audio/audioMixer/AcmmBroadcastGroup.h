@@ -34,6 +34,8 @@ public:
     int32_t NeededFrequency();
     void NewMixedAudio(const AudioFrame* audioFrame);
 
+    void getOutputs(std::vector<boost::shared_ptr<AcmmOutput>> &outputs);
+
 protected:
     bool getFreeOutputId(uint16_t *id);
 
@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "AcmmFrameMixer.h"
+#include "AudioEncodeExecutor.h"
 
 namespace mcu {
 
@@ -32,6 +33,8 @@ AcmmFrameMixer::AcmmFrameMixer()
     : m_asyncHandle(NULL)
     , m_vadEnabled(false)
     , m_frequency(0)
+    , m_sharedEncodes(0)
+    , m_savedEncodes(0)
 {
     m_mixerModule.reset(AudioConferenceMixer::Create(0));
     m_mixerModule->RegisterMixedStreamCallback(this);
@@ -492,6 +495,8 @@ void AcmmFrameMixer::onTimeout()
 void AcmmFrameMixer::performMix()
 {
     boost::upgrade_lock<boost::shared_mutex> lock(m_mutex);
+    // Hand this tick's encode jobs to the executor together
+    AudioEncodeExecutor::Batch encodeBatch;
     m_mixerModule->Process();
 }
 
@@ -520,16 +525,68 @@ void AcmmFrameMixer::NewMixedAudio(int32_t id,
         }
     }
 
+    // Groups without unique audio all hear the general mix, encode it once per format.
+    std::vector<boost::shared_ptr<AcmmOutput>> sharedOutputs;
+    std::vector<boost::shared_ptr<AcmmOutput>> outputs;
     for (auto& p : m_groups) {
         boost::shared_ptr<AcmmGroup> acmmGroup = p.second;
         if (groupMap.find(acmmGroup->id()) == groupMap.end()) {
             if (acmmGroup->numOfOutputs()) {
-                acmmGroup->NewMixedAudio(&generalAudioFrame);
+                acmmGroup->getOutputs(outputs);
+                sharedOutputs.insert(sharedOutputs.end(), outputs.begin(), outputs.end());
             }
         }
     }
 
-    m_broadcastGroup->NewMixedAudio(&generalAudioFrame);
+    m_broadcastGroup->getOutputs(outputs);
+    sharedOutputs.insert(sharedOutputs.end(), outputs.begin(), outputs.end());
+
+    encodeShared(generalAudioFrame, sharedOutputs);
+}
+
+boost::shared_ptr<AcmmSharedEncoder> AcmmFrameMixer::getSharedEncoder(owt_base::FrameFormat format)
+{
+    auto it = m_sharedEncoders.find(format);
+    if (it != m_sharedEncoders.end())
+        return it->second;
+
+    boost::shared_ptr<AcmmSharedEncoder> encoder(new AcmmSharedEncoder(format));
+    if (!encoder->init()) {
+        ELOG_WARN("Can not create shared encoder(%s)", getFormatStr(format));
+        encoder.reset();
+    }
+
+    // A failed format is remembered as NULL and encoded per output.
+    m_sharedEncoders[format] = encoder;
+    return encoder;
+}
+
+void AcmmFrameMixer::encodeShared(const AudioFrame& audioFrame, const std::vector<boost::shared_ptr<AcmmOutput>>& outputs)
+{
+    for (auto& output : outputs) {
+        if (!output->hasDest()) {
+            output->setSharedEncoder(NULL);
+            continue;
+        }
+
+        boost::shared_ptr<AcmmSharedEncoder> encoder = getSharedEncoder(output->format());
+        if (encoder)
+            output->setSharedEncoder(encoder);
+        else
+            output->newAudioFrame(&audioFrame);
+    }
+
+    for (auto& it : m_sharedEncoders) {
+        if (!it.second)
+            continue;
+
+        uint32_t subscribers = it.second->numOfSubscribers();
+        if (subscribers) {
+            it.second->newAudioFrame(&audioFrame);
+            m_sharedEncodes++;
+            m_savedEncodes += subscribers - 1;
+        }
+    }
 }
 
 boost::shared_ptr<AcmmInput> AcmmFrameMixer::getInputById(int32_t id)
@@ -606,13 +663,24 @@ void AcmmFrameMixer::statistics()
             unknownCount++;
     }
 
+    uint32_t sharedOutputCount = 0;
+    for (auto& it : m_sharedEncoders) {
+        if (it.second)
+            sharedOutputCount += it.second->numOfSubscribers();
+    }
+
     ELOG_DEBUG("All(%ld), Active(%d), Muted(%d), ReceivedOnly(%d), StreamIn(%d), Unknown(%d)"
+            ", SharedEncoders(%ld), SharedOutputs(%d), SharedEncodes(%lu), SavedEncodes(%lu)"
             , m_groups.size()
             , activeCount
             , mutedCount
             , receivedOnlyCount
             , streamInCount
             , unknownCount
+            , m_sharedEncoders.size()
+            , sharedOutputCount
+            , m_sharedEncodes
+            , m_savedEncodes
             );
 }
 
@@ -20,6 +20,7 @@
 #include "AcmmBroadcastGroup.h"
 #include "AcmmGroup.h"
 #include "AcmmInput.h"
+#include "AcmmSharedEncoder.h"
 
 namespace mcu {
 
@@ -85,6 +86,9 @@ protected:
 
     boost::shared_ptr<AcmmInput> getInputById(int32_t id);
 
+    boost::shared_ptr<AcmmSharedEncoder> getSharedEncoder(owt_base::FrameFormat format);
+    void encodeShared(const AudioFrame& audioFrame, const std::vector<boost::shared_ptr<AcmmOutput>>& outputs);
+
     void statistics();
 
 private:
@@ -103,6 +107,11 @@ private:
     bool m_vadEnabled;
     boost::shared_ptr<AcmmInput> m_mostActiveInput;
     int32_t m_frequency;
+
+    // Encoders of the general mix, one per output format
+    std::map<owt_base::FrameFormat, boost::shared_ptr<AcmmSharedEncoder>> m_sharedEncoders;
+    uint64_t m_sharedEncodes;
+    uint64_t m_savedEncodes;
 };
 
 } /* namespace mcu */
@@ -5,6 +5,7 @@
 #include "AudioUtilities.h"
 
 #include "AcmmOutput.h"
+#include "AcmmSharedEncoder.h"
 
 #include "AcmEncoder.h"
 #include "PcmEncoder.h"
@@ -28,13 +29,55 @@ AcmmOutput::~AcmmOutput()
 {
     ELOG_DEBUG_T("~AcmmOutput, dst count(%ld)", m_destinations.size());
 
+    setSharedEncoder(NULL);
+
     for (auto dst : m_destinations)
-        m_encoder->removeAudioDestination(dst);
+        removeAudioDestination(dst);
+
+    if (m_encoder)
+        m_encoder->removeAudioDestination(this);
 
     m_dstFormat = FRAME_FORMAT_UNKNOWN;
     m_encoder.reset();
 }
 
+boost::shared_ptr<AudioEncoder> AcmmOutput::createEncoder(FrameFormat& format)
+{
+    boost::shared_ptr<AudioEncoder> encoder;
+
+    switch(format) {
+        case FRAME_FORMAT_PCM_48000_2:
+            encoder.reset(new PcmEncoder(format));
+            break;
+        case FRAME_FORMAT_AAC:
+            ELOG_WARN("FRAME_FORMAT_AAC is deprecated for audio output, using FRAME_FORMAT_AAC_48000_2!");
+            format = FRAME_FORMAT_AAC_48000_2;
+            encoder.reset(new FfEncoder(FRAME_FORMAT_AAC_48000_2));
+            break;
+        case FRAME_FORMAT_AAC_48000_2:
+            encoder.reset(new FfEncoder(FRAME_FORMAT_AAC_48000_2));
+            break;
+        case FRAME_FORMAT_PCMU:
+        case FRAME_FORMAT_PCMA:
+        case FRAME_FORMAT_OPUS:
+        case FRAME_FORMAT_ISAC16:
+        case FRAME_FORMAT_ISAC32:
+        case FRAME_FORMAT_ILBC:
+        case FRAME_FORMAT_G722_16000_1:
+        case FRAME_FORMAT_G722_16000_2:
+            encoder.reset(new AcmEncoder(format));
+            break;
+        default:
+            ELOG_ERROR("Unsupported format(%s), %d", getFormatStr(format), format);
+            return NULL;
+    }
+
+    if (!encoder->init())
+        return NULL;
+
+    return encoder;
+}
+
 bool AcmmOutput::addDest(FrameFormat format, FrameDestination* destination)
 {
     ELOG_DEBUG_T("addDest, format(%s), dest(%p)", getFormatStr(format), destination);
@@ -47,42 +90,15 @@ bool AcmmOutput::addDest(FrameFormat format, FrameDestination* destination)
     }
 
     if (m_dstFormat == FRAME_FORMAT_UNKNOWN) {
-        switch(format) {
-            case FRAME_FORMAT_PCM_48000_2:
-                m_encoder.reset(new PcmEncoder(format));
-                break;
-            case FRAME_FORMAT_AAC:
-                ELOG_WARN_T("FRAME_FORMAT_AAC is deprecated for audio output, using FRAME_FORMAT_AAC_48000_2!");
-                format = FRAME_FORMAT_AAC_48000_2;
-                m_encoder.reset(new FfEncoder(FRAME_FORMAT_AAC_48000_2));
-                break;
-            case FRAME_FORMAT_AAC_48000_2:
-                m_encoder.reset(new FfEncoder(FRAME_FORMAT_AAC_48000_2));
-                break;
-            case FRAME_FORMAT_PCMU:
-            case FRAME_FORMAT_PCMA:
-            case FRAME_FORMAT_OPUS:
-            case FRAME_FORMAT_ISAC16:
-            case FRAME_FORMAT_ISAC32:
-            case FRAME_FORMAT_ILBC:
-            case FRAME_FORMAT_G722_16000_1:
-            case FRAME_FORMAT_G722_16000_2:
-                m_encoder.reset(new AcmEncoder(format));
-                break;
-            default:
-                ELOG_ERROR_T("Unsupported format(%s), %d", getFormatStr(format), format);
-                return false;
-        }
-
-        if (!m_encoder->init()) {
-            m_encoder.reset();
+        m_encoder = createEncoder(format);
+        if (!m_encoder)
             return false;
-        }
 
+        m_encoder->addAudioDestination(this);
         m_dstFormat = format;
     }
 
-    m_encoder->addAudioDestination(destination);
+    addAudioDestination(destination);
     m_destinations.push_back(destination);
     return true;
 }
@@ -92,7 +108,7 @@ void AcmmOutput::removeDest(FrameDestination* destination)
     ELOG_DEBUG_T("removeDest, dst(%p)", destination);
 
     m_destinations.remove(destination);
-    m_encoder->removeAudioDestination(destination);
+    removeAudioDestination(destination);
 }
 
 int32_t AcmmOutput::NeededFrequency()
@@ -116,6 +132,8 @@ bool AcmmOutput::newAudioFrame(const webrtc::AudioFrame *audioFrame)
             audioFrame->timestamp_
             );
 
+    setSharedEncoder(NULL);
+
     if (m_encoder) {
         m_encoder->addAudioFrame(audioFrame);
     }
@@ -123,4 +141,24 @@ bool AcmmOutput::newAudioFrame(const webrtc::AudioFrame *audioFrame)
     return true;
 }
 
+void AcmmOutput::setSharedEncoder(boost::shared_ptr<AcmmSharedEncoder> encoder)
+{
+    if (m_sharedEncoder == encoder)
+        return;
+
+    if (m_sharedEncoder)
+        m_sharedEncoder->unsubscribe(this);
+
+    m_sharedEncoder = encoder;
+
+    if (m_sharedEncoder)
+        m_sharedEncoder->subscribe(this);
+}
+
+void AcmmOutput::onFrame(const Frame& frame)
+{
+    boost::mutex::scoped_lock lock(m_deliverMutex);
+    deliverFrame(frame);
+}
+
 } /* namespace mcu */
@@ -7,6 +7,7 @@
 
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
 
 #include <webrtc/modules/audio_conference_mixer/include/audio_conference_mixer_defines.h>
 
@@ -21,14 +22,25 @@ namespace mcu {
 using namespace owt_base;
 using namespace webrtc;
 
-class AcmmOutput {
+class AcmmSharedEncoder;
+
+/*
+ * Destinations are attached to the output itself. Encoded frames come
+ * either from its own encoder or, while it gets the general mix, from
+ * the mixer's shared encoder of the same format.
+ */
+class AcmmOutput : public FrameSource, public FrameDestination {
     DECLARE_LOGGER();
 
 public:
     AcmmOutput(int32_t id);
     ~AcmmOutput();
 
+    // Create an encoder for |format|, which may be normalized.
+    static boost::shared_ptr<AudioEncoder> createEncoder(FrameFormat& format);
+
     int32_t id() {return m_id;}
+    FrameFormat format() {return m_dstFormat;}
 
     bool addDest(FrameFormat format, FrameDestination* destination);
     void removeDest(FrameDestination* destination);
@@ -38,6 +50,12 @@ public:
     int32_t NeededFrequency();
     bool newAudioFrame(const webrtc::AudioFrame *audioFrame);
 
+    // Take encoded frames from |encoder| instead of encoding, or stop with NULL.
+    void setSharedEncoder(boost::shared_ptr<AcmmSharedEncoder> encoder);
+
+    // Implements FrameDestination
+    void onFrame(const Frame& frame) override;
+
 private:
     int32_t m_id;
 
@@ -45,6 +63,9 @@ private:
     std::list<FrameDestination *> m_destinations;
 
     boost::shared_ptr<AudioEncoder> m_encoder;
+    boost::shared_ptr<AcmmSharedEncoder> m_sharedEncoder;
+    // Both encoders may deliver around a switch
+    boost::mutex m_deliverMutex;
 };
 
 } /* namespace mcu */
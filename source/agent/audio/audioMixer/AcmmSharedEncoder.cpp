@@ -0,0 +1,70 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "AcmmSharedEncoder.h"
+#include "AcmmOutput.h"
+
+namespace mcu {
+
+using namespace owt_base;
+
+DEFINE_LOGGER(AcmmSharedEncoder, "mcu.media.AcmmSharedEncoder");
+
+AcmmSharedEncoder::AcmmSharedEncoder(FrameFormat format)
+    : m_format(format)
+{
+    ELOG_DEBUG("AcmmSharedEncoder(%s)", getFormatStr(format));
+}
+
+AcmmSharedEncoder::~AcmmSharedEncoder()
+{
+    ELOG_DEBUG("~AcmmSharedEncoder(%s)", getFormatStr(m_format));
+
+    if (m_encoder)
+        m_encoder->removeAudioDestination(this);
+    m_encoder.reset();
+}
+
+bool AcmmSharedEncoder::init()
+{
+    m_encoder = AcmmOutput::createEncoder(m_format);
+    if (!m_encoder)
+        return false;
+
+    m_encoder->addAudioDestination(this);
+    return true;
+}
+
+void AcmmSharedEncoder::subscribe(AcmmOutput* output)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_subscribers.insert(output);
+}
+
+void AcmmSharedEncoder::unsubscribe(AcmmOutput* output)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_subscribers.erase(output);
+}
+
+uint32_t AcmmSharedEncoder::numOfSubscribers()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    return m_subscribers.size();
+}
+
+void AcmmSharedEncoder::newAudioFrame(const webrtc::AudioFrame* audioFrame)
+{
+    m_encoder->addAudioFrame(audioFrame);
+}
+
+void AcmmSharedEncoder::onFrame(const Frame& frame)
+{
+    // Held while delivering, so an output is never used after unsubscribe() returns.
+    boost::mutex::scoped_lock lock(m_mutex);
+    for (auto output : m_subscribers)
+        output->onFrame(frame);
+}
+
+} /* namespace mcu */
@@ -0,0 +1,59 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef AcmmSharedEncoder_h
+#define AcmmSharedEncoder_h
+
+#include <set>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <webrtc/modules/include/module_common_types.h>
+
+#include <logger.h>
+
+#include "MediaFramePipeline.h"
+
+#include "AudioEncoder.h"
+
+namespace mcu {
+
+using namespace owt_base;
+
+class AcmmOutput;
+
+/*
+ * Encodes the general mix once per format and hands the result to all
+ * outputs whose group has no unique mix in the current tick.
+ */
+class AcmmSharedEncoder : public FrameDestination {
+    DECLARE_LOGGER();
+
+public:
+    AcmmSharedEncoder(FrameFormat format);
+    ~AcmmSharedEncoder();
+
+    bool init();
+
+    void subscribe(AcmmOutput* output);
+    void unsubscribe(AcmmOutput* output);
+    uint32_t numOfSubscribers();
+
+    void newAudioFrame(const webrtc::AudioFrame* audioFrame);
+
+    // Implements FrameDestination
+    void onFrame(const Frame& frame) override;
+
+private:
+    FrameFormat m_format;
+    boost::shared_ptr<AudioEncoder> m_encoder;
+
+    boost::mutex m_mutex;
+    std::set<AcmmOutput*> m_subscribers;
+};
+
+} /* namespace mcu */
+
+#endif /* AcmmSharedEncoder_h */
@@ -0,0 +1,170 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "AudioEncodeExecutor.h"
+
+namespace mcu {
+
+DEFINE_LOGGER(AudioEncodeExecutor, "mcu.media.AudioEncodeExecutor");
+
+// Deadline misses are summarized at most this often
+static const int64_t kReportIntervalMs = 5000;
+
+static thread_local AudioEncodeExecutor::Batch* tCurrentBatch = nullptr;
+
+static int64_t steadyMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+AudioEncodeExecutor& AudioEncodeExecutor::GetInstance()
+{
+    // Intentionally leaked, encoders may be released during static destruction.
+    static AudioEncodeExecutor* executor = nullptr;
+    static boost::once_flag once = BOOST_ONCE_INIT;
+
+    boost::call_once(once, []() {
+        uint32_t threadCount = boost::thread::hardware_concurrency();
+        if (threadCount == 0)
+            threadCount = 1;
+
+        executor = new AudioEncodeExecutor(threadCount);
+        ELOG_DEBUG("Audio encode threads %d", threadCount);
+    });
+    return *executor;
+}
+
+AudioEncodeExecutor::AudioEncodeExecutor(uint32_t threadCount)
+    : m_deadlineMisses(0)
+    , m_lastReportMs(steadyMs())
+    , m_reportedMisses(0)
+{
+    for (uint32_t i = 0; i < threadCount; i++) {
+        Shard* shard = new Shard();
+        shard->thread.reset(new boost::thread(&AudioEncodeExecutor::workerLoop, this, shard));
+        m_shards.push_back(shard);
+    }
+}
+
+uint32_t AudioEncodeExecutor::attach(AudioEncodeJob* job)
+{
+    // Place on the least loaded shard
+    uint32_t best = 0;
+    uint32_t bestJobs = UINT32_MAX;
+    for (uint32_t i = 0; i < m_shards.size(); i++) {
+        boost::mutex::scoped_lock lock(m_shards[i]->mutex);
+        if (m_shards[i]->jobs < bestJobs) {
+            best = i;
+            bestJobs = m_shards[i]->jobs;
+        }
+    }
+
+    boost::mutex::scoped_lock lock(m_shards[best]->mutex);
+    m_shards[best]->jobs++;
+    return best;
+}
+
+void AudioEncodeExecutor::detach(AudioEncodeJob* job, uint32_t shardIndex)
+{
+    Shard* shard = m_shards[shardIndex];
+    boost::mutex::scoped_lock lock(shard->mutex);
+
+    for (auto it = shard->tasks.begin(); it != shard->tasks.end();) {
+        if (it->job == job)
+            it = shard->tasks.erase(it);
+        else
+            ++it;
+    }
+
+    while (shard->running == job)
+        shard->idleCond.wait(lock);
+
+    shard->jobs--;
+}
+
+void AudioEncodeExecutor::schedule(AudioEncodeJob* job, uint32_t shard)
+{
+    if (tCurrentBatch) {
+        tCurrentBatch->m_jobs[shard].push_back(job);
+        return;
+    }
+
+    enqueue(shard, std::vector<AudioEncodeJob*>(1, job), std::chrono::steady_clock::now());
+}
+
+void AudioEncodeExecutor::enqueue(uint32_t shardIndex, const std::vector<AudioEncodeJob*>& jobs,
+        std::chrono::steady_clock::time_point scheduleTime)
+{
+    Shard* shard = m_shards[shardIndex];
+    boost::mutex::scoped_lock lock(shard->mutex);
+
+    for (auto job : jobs)
+        shard->tasks.push_back(Task{job, scheduleTime});
+    shard->cond.notify_one();
+}
+
+void AudioEncodeExecutor::workerLoop(Shard* shard)
+{
+    boost::mutex::scoped_lock lock(shard->mutex);
+
+    while (true) {
+        while (shard->tasks.empty())
+            shard->cond.wait(lock);
+
+        Task task = shard->tasks.front();
+        shard->tasks.pop_front();
+        shard->running = task.job;
+        lock.unlock();
+
+        int64_t lateMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - task.scheduleTime).count();
+        if (lateMs > kDeadlineMs)
+            reportDeadlineMiss(lateMs);
+
+        task.job->encodePending();
+
+        lock.lock();
+        shard->running = nullptr;
+        shard->idleCond.notify_all();
+    }
+}
+
+void AudioEncodeExecutor::reportDeadlineMiss(int64_t lateMs)
+{
+    uint64_t misses = ++m_deadlineMisses;
+
+    int64_t now = steadyMs();
+    int64_t last = m_lastReportMs;
+    if (now - last >= kReportIntervalMs && m_lastReportMs.compare_exchange_strong(last, now)) {
+        uint64_t reported = m_reportedMisses.exchange(misses);
+        ELOG_WARN("%llu audio encodes started later than %lldms in the last %lldms, latest %lldms late",
+                (unsigned long long)(misses - reported), (long long)kDeadlineMs,
+                (long long)(now - last), (long long)lateMs);
+    }
+}
+
+AudioEncodeExecutor::Batch::Batch()
+    : m_time(std::chrono::steady_clock::now())
+{
+    if (!tCurrentBatch) {
+        m_jobs.resize(AudioEncodeExecutor::GetInstance().m_shards.size());
+        tCurrentBatch = this;
+    }
+}
+
+AudioEncodeExecutor::Batch::~Batch()
+{
+    if (tCurrentBatch != this)
+        return;
+
+    tCurrentBatch = nullptr;
+    AudioEncodeExecutor& executor = AudioEncodeExecutor::GetInstance();
+    for (uint32_t i = 0; i < m_jobs.size(); i++) {
+        if (!m_jobs[i].empty())
+            executor.enqueue(i, m_jobs[i], m_time);
+    }
+}
+
+} /* namespace mcu */
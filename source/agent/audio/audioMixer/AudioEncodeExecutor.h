@@ -0,0 +1,100 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef AudioEncodeExecutor_h
+#define AudioEncodeExecutor_h
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <vector>
+
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include <logger.h>
+
+namespace mcu {
+
+class AudioEncodeJob {
+public:
+    virtual ~AudioEncodeJob() { }
+
+    // Encode the pending 10ms frame, runs on an executor thread.
+    virtual void encodePending() = 0;
+};
+
+/*
+ * Fixed pool of audio encode threads shared by all mixers in the process.
+ * Jobs are sharded across the threads when attached, and a job always
+ * runs on its own shard so it never encodes concurrently with itself.
+ */
+class AudioEncodeExecutor {
+    DECLARE_LOGGER();
+
+public:
+    static const int64_t kDeadlineMs = 10;
+
+    static AudioEncodeExecutor& GetInstance();
+
+    // Returns the shard |job| is to be scheduled on.
+    uint32_t attach(AudioEncodeJob* job);
+    // Drops pending runs of |job| and waits for a running one to finish.
+    void detach(AudioEncodeJob* job, uint32_t shard);
+
+    void schedule(AudioEncodeJob* job, uint32_t shard);
+
+    uint64_t deadlineMisses() const { return m_deadlineMisses; }
+
+    /*
+     * Jobs scheduled from this thread while a Batch is alive are handed
+     * to the shards when it goes out of scope, waking each shard once per
+     * mix tick instead of once per output.
+     */
+    class Batch {
+    public:
+        Batch();
+        ~Batch();
+
+    private:
+        friend class AudioEncodeExecutor;
+
+        std::vector<std::vector<AudioEncodeJob*>> m_jobs;
+        std::chrono::steady_clock::time_point m_time;
+    };
+
+private:
+    struct Task {
+        AudioEncodeJob* job;
+        std::chrono::steady_clock::time_point scheduleTime;
+    };
+
+    struct Shard {
+        Shard() : running(nullptr), jobs(0) { }
+
+        boost::mutex mutex;
+        boost::condition_variable cond;
+        boost::condition_variable idleCond;
+        std::deque<Task> tasks;
+        AudioEncodeJob* running;
+        uint32_t jobs;
+        boost::scoped_ptr<boost::thread> thread;
+    };
+
+    AudioEncodeExecutor(uint32_t threadCount);
+
+    void enqueue(uint32_t shard, const std::vector<AudioEncodeJob*>& jobs,
+            std::chrono::steady_clock::time_point scheduleTime);
+    void workerLoop(Shard* shard);
+    void reportDeadlineMiss(int64_t lateMs);
+
+    std::vector<Shard*> m_shards;
+    std::atomic<uint64_t> m_deadlineMisses;
+    std::atomic<int64_t> m_lastReportMs;
+    std::atomic<uint64_t> m_reportedMisses;
+};
+
+} /* namespace mcu */
+
+#endif /* AudioEncodeExecutor_h */
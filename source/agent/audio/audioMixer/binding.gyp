@@ -8,6 +8,7 @@
       'AcmDecoder.cpp',
       'FfDecoder.cpp',
       'AcmEncoder.cpp',
+      'AudioEncodeExecutor.cpp',
       'PcmEncoder.cpp',
       'FfEncoder.cpp',
       'AcmmFrameMixer.cpp',
@@ -15,8 +16,10 @@
       'AcmmGroup.cpp',
       'AcmmInput.cpp',
       'AcmmOutput.cpp',
+      'AcmmSharedEncoder.cpp',
       'AudioTime.cpp',
       '../../addons/common/NodeEventRegistry.cc',
+      '../../addons/common/NodeEventDispatcher.cc',
       '../../../core/owt_base/MediaFramePipeline.cpp',
       '../../../core/owt_base/AudioUtilities.cpp',
       '../../../core/common/JobTimer.cpp',
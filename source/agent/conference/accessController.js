@@ -159,6 +159,9 @@ module.exports.create = function(spec, rpcReq, on_session_established, on_sessio
       onFailed(sessionId, status.reason);
     } else if (status.type === 'offer' || status.type === 'answer' || status.type === 'candidate') {
       onSignaling(sessionId, status);
+    } else if (status.type === 'warning') {
+      // Degraded, e.g. one output of a streaming-out failed, still running
+      log.warn('Session', sessionId, 'warning:', status.reason);
     } else {
       log.error('Irrispective status:' + status.type);
       return Promise.reject('Irrispective status');
@@ -115,6 +115,12 @@ var init_manager = () => {
     || myPurpose === 'conference'
     || myPurpose === 'sip');
   var consumeNodeByRoom = !(myPurpose === 'audio' || myPurpose === 'video' || myPurpose === 'analytics');
+  var maxTasksPerNode = undefined;
+  if (myPurpose === 'analytics' && config.analytics && config.analytics.streamsPerProcess > 1) {
+    // Streams of a room share a process, so their inference can be batched.
+    consumeNodeByRoom = true;
+    maxTasksPerNode = config.analytics.streamsPerProcess;
+  }
 
   var spawnOptions = {
     cmd: 'node',
@@ -129,7 +135,8 @@ var init_manager = () => {
       prerunNodeNum: config.agent.prerunProcesses,
       maxNodeNum: config.agent.maxProcesses,
       reuseNode: reuseNode,
-      consumeNodeByRoom: consumeNodeByRoom
+      consumeNodeByRoom: consumeNodeByRoom,
+      maxTasksPerNode: maxTasksPerNode
     },
     spawnOptions,
     (nodeId, tasks) => {
@@ -15,6 +15,22 @@ const internalIO = require('../internalIO/build/Release/internalIO');
 
 const {InternalServer, InternalClient} = internalIO;
 
+// Before any connection, the IO thread pool is created on first use.
+if (config && config.internal) {
+  internalIO.setIOServiceConfig(config.internal.io_threads || 0,
+                                !!config.internal.io_pin_threads);
+  internalIO.setFrameWireConfig(!!config.internal.compact_frame_format);
+  internalIO.setShmConfig(config.internal.shm_ring_bytes || 0);
+  // Missing values keep the defaults
+  try {
+    internalIO.setSendQueueConfig(config.internal.send_queue_max_bytes,
+                                  config.internal.send_queue_max_items,
+                                  config.internal.send_queue_policy);
+  } catch (e) {
+    log.error('Invalid send queue config:', e.message);
+  }
+}
+
 const setSecurePromise = new Promise(function (resolve) {
   try {
     const cipher = require('../cipher');
@@ -145,9 +161,13 @@ class InternalConnectionRouter {
    * @param {string} protocol Protocol for internal connection (tcp/quic)
    * @param {number} minport Internal server listening min port
    * @param {number} maxport Internal server listening max port
+   * @param {string} ip_address Internal IP address of this agent
+   * @param {boolean} shared_memory Use shared memory with the agents of this host
    */
-  constructor({protocol, minport, maxport}) {
+  constructor({protocol, minport, maxport, ip_address, shared_memory}) {
     this.protocol = protocol;
+    this.localIp = ip_address;
+    this.sharedMemory = !!shared_memory;
     this.connections = Connections();
 
     this.internalServer = {
@@ -157,12 +177,51 @@ class InternalConnectionRouter {
     };
     setSecurePromise.then(() => {
       this.internalServer = new InternalServer(
-        protocol, minport, maxport, (a, b) => {
+        this.sharedMemory ? 'shm' : protocol, minport, maxport, (a, b) => {
           log.debug('server stat:', a, b);
       });
       this.internalPort = this.internalServer.getListeningPort();
     });
     this.remoteStreams = new Map(); // id => Set {string}
+
+    this.reportedDrops = 0;
+    const statsInterval = (config && config.internal &&
+      config.internal.stats_interval !== undefined) ?
+      config.internal.stats_interval : 10;
+    if (statsInterval > 0) {
+      this.statsTimer = setInterval(() => this.reportStats(),
+                                    statsInterval * 1000);
+      this.statsTimer.unref();
+    }
+  }
+
+  /*
+   * Statistics of the internal connections of this agent
+   */
+  getStats() {
+    const stats = {};
+    if (this.internalServer.getSendQueueStats) {
+      stats.sendQueue = this.internalServer.getSendQueueStats();
+    }
+    if (internalIO.getIOServiceStats) {
+      // [{inProcess, users, busyRatio}] of the IO threads
+      stats.ioServices = internalIO.getIOServiceStats();
+    }
+    return stats;
+  }
+
+  reportStats() {
+    const stats = this.getStats();
+    if (stats.sendQueue) {
+      // Summed over the current sessions, may go down as they close
+      const dropped = stats.sendQueue.droppedFrames;
+      if (dropped > this.reportedDrops) {
+        log.warn('Internal send queues dropped frames:',
+                 dropped - this.reportedDrops);
+      }
+      this.reportedDrops = dropped;
+    }
+    log.debug('Internal connection stats:', JSON.stringify(stats));
   }
 
   /*
@@ -236,7 +295,10 @@ class InternalConnectionRouter {
       return conn;
     } else if (!this.remoteStreams.has(id) && ip && port) {
       log.debug('RemoteSource created:', id, ip, port);
-      let conn = new InternalClient(id, this.protocol, ip, port, onStat);
+      // Falls back to TCP if the server doesn't offer shared memory
+      const protocol = (this.sharedMemory && ip === this.localIp) ?
+        'shm' : this.protocol;
+      let conn = new InternalClient(id, protocol, ip, port, onStat);
       conn.receiver = () => conn;
       this.connections.addConnection(id, 'internal', '', conn, 'in');
       this.remoteStreams.set(id, new Set());
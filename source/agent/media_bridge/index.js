@@ -19,6 +19,9 @@ var logger = require('../logger').logger;
 var log = logger.getLogger('MediaBridge');
 const cipher = require('../cipher');
 var addon = require('../quicCascading/build/Release/quicCascading.node');
+if (global.config && global.config.internal) {
+  addon.setFrameWireConfig(!!global.config.internal.compact_frame_format);
+}
 const QuicTransportStreamPipeline =
     require('./quicTransportStreamPipeline');
 const path = require('path');
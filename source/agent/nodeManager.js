@@ -18,6 +18,7 @@ var enableGRPC = false;
  * * @param {number}   spec.maxNodeNum           -The max number of running nodes.
  * * @param {bool}     spec.reuseNode            -Whether reuse the current in-use nodes if maxNodeNum has been reached.
  * * @param {bool}     spec.consumeNodeByRoom    -Whether tasks from the same room be scheduled to the same node.
+ * * @param {number}   spec.maxTasksPerNode      -Optional, the max number of tasks of a room consuming the same node.
  * * @param {object}   spawnOptions              -The options to spawn new nodes.
  * * @param {string}   spawnOptions.cmd          -The command name to execute.
  * * @param {object}   spawnOptions.config       -The node initial configuration.
@@ -239,7 +240,8 @@ module.exports = function (spec, spawnOptions, onNodeAbnormallyQuit, onTaskAdded
   let findNodeUsedByRoom = (nodeList, roomId) => {
       for (let i in nodeList) {
         let node_id = nodeList[i];
-        if (tasks[node_id] !== undefined && tasks[node_id][roomId] !== undefined) {
+        if (tasks[node_id] !== undefined && tasks[node_id][roomId] !== undefined
+            && !(spec.maxTasksPerNode > 0 && tasks[node_id][roomId].length >= spec.maxTasksPerNode)) {
           return node_id;
         }
       }
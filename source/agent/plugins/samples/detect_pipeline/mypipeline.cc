@@ -2,6 +2,7 @@
 //
 // SPDX-License-Identifier: Apache-2.0
 
+#include <algorithm>
 #include <iostream>
 #include <string.h>
 #include "toml.hpp"
@@ -11,6 +12,9 @@ MyPipeline::MyPipeline() {
     inputwidth = 640;
     inputheight = 480;
     inputframerate = 24;
+    inferenceinterval = 1;
+    batchsize = 1;
+    modelinstanceid = "dtc";
     pipeline = NULL; 
     source = NULL;
     fakesink = NULL;
@@ -44,6 +48,20 @@ rvaStatus MyPipeline::PipelineConfig(std::unordered_map<std::string, std::string
     else
         pipelinename = name->second;
 
+    std::unordered_map<std::string,std::string>::const_iterator interval = params.find ("inferenceinterval");
+    if ( interval != params.end() )
+        inferenceinterval = std::max(1, std::atoi(interval->second.c_str()));
+
+    std::unordered_map<std::string,std::string>::const_iterator batch = params.find ("batchsize");
+    if ( batch != params.end() )
+        batchsize = std::max(1, std::atoi(batch->second.c_str()));
+
+    // Pipelines of a process with the same id share one inference instance,
+    // which batches their frames
+    std::unordered_map<std::string,std::string>::const_iterator instance = params.find ("modelinstanceid");
+    if ( instance != params.end() && !instance->second.empty() )
+        modelinstanceid = instance->second;
+
     return RVA_ERR_OK;
 }
 
@@ -101,6 +119,8 @@ rvaStatus MyPipeline::LinkElements() {
     std::cout << "inputwidth is:" << inputwidth << std::endl;
     std::cout << "input height is:" << inputheight << std::endl;
     std::cout << "input framerate is:" << inputframerate << std::endl;
+    std::cout << "inference interval is:" << inferenceinterval << std::endl;
+    std::cout << "batch size is:" << batchsize << std::endl;
 
     postprocsinkcaps = gst_caps_from_string("video/x-raw(memory:VASurface),format=NV12");
     postprocsrccaps = gst_caps_from_string("video/x-raw(memory:VASurface),format=NV12");
@@ -122,7 +142,14 @@ rvaStatus MyPipeline::LinkElements() {
             "cpu-streams", 12,
             "nireq", 24,
             "pre-proc", "vaapi",
-            "inference-id", "dtc", NULL);
+            "inference-interval", inferenceinterval,
+            "batch-size", batchsize, NULL);
+
+    // Renamed from inference-id in later DL Streamer releases
+    if (g_object_class_find_property(G_OBJECT_GET_CLASS(detect), "model-instance-id"))
+        g_object_set(G_OBJECT(detect), "model-instance-id", modelinstanceid.c_str(), NULL);
+    else
+        g_object_set(G_OBJECT(detect), "inference-id", modelinstanceid.c_str(), NULL);
 
     
     g_object_set(G_OBJECT(fakesink),"async", false, NULL);
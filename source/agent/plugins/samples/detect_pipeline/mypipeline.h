@@ -32,7 +32,8 @@ public:
 private:
     GstElement *pipeline, *source, *receive,*detect,*decodebin,*postproc,*h264parse,*counter,*fakesink, *videorate;
     int inputwidth, inputheight, inputframerate;
-    std::string pipelinename;
+    int inferenceinterval, batchsize;
+    std::string pipelinename, modelinstanceid;
 };
 
 #endif  //MYPIPELINE_H
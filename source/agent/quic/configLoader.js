@@ -33,6 +33,9 @@ module.exports.load = () => {
     config.capacity.isps = config.capacity.isps || [];
     config.capacity.regions = config.capacity.regions || [];
 
+    config.quic = config.quic || {};
+    config.quic.rtc_task_queues = config.quic.rtc_task_queues || 4;
+
     config.internal.ip_address = config.internal.ip_address || '';
     config.internal.network_interface = config.internal.network_interface || undefined;
     config.internal.minport = config.internal.minport || 0;
@@ -22,6 +22,7 @@ const QuicTransportStreamPipeline =
     require('./webtransport/quicTransportStreamPipeline');
 const log = logger.getLogger('QuicNode');
 const addon = require('./build/Release/quic');
+require('./rtcTaskQueues').setup(addon, global.config.quic.rtc_task_queues);
 const cipher = require('../cipher');
 const path = require('path');
 const {InternalConnectionRouter} = require('./internalConnectionRouter');
@@ -413,7 +414,7 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
             const webTransportConnection =
                 quicTransportServer.getConnection(options.transport.id);
             if (isDatagrame) {
-              webTransportConnection.onclose = () => {
+              conn.transportCloseListener = () => {
                 conn.removeDatagramOutput(webTransportConnection);
               };
               conn.addDatagramOutput(webTransportConnection);
@@ -428,6 +429,19 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
                 };
                 conn.addStreamOutput(trackId, stream);
               }
+              if (global.config.quic.streamPerGop) {
+                // Stopped by the connection when its session closes, this
+                // releases the connection.
+                conn.transportCloseListener = () => {
+                  conn.setStreamPerGop();
+                };
+                conn.setStreamPerGop(webTransportConnection);
+              }
+            }
+            if (conn.transportCloseListener) {
+              conn.webTransportConnection = webTransportConnection;
+              webTransportConnection.closeListeners.add(
+                  conn.transportCloseListener);
             }
           } else {
             // TODO: Remove StreamPipeline, move to WebTransportFrameDestination.
@@ -473,6 +487,10 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
     that.unsubscribe = function (connectionId, callback) {
         log.debug('unsubscribe, connectionId:', connectionId);
         var conn = router.getConnection(connectionId);
+        if (conn && conn.webTransportConnection) {
+          conn.webTransportConnection.closeListeners.delete(
+              conn.transportCloseListener);
+        }
         router.removeConnection(connectionId).then(function(ok) {
             if (conn) {
               if (typeof conn.close === 'function') {
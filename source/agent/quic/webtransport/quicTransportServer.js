@@ -35,6 +35,15 @@ module.exports = class QuicTransportServer extends EventEmitter {
     this._validateTokenCallback = validateTokenCallback;
     this._server.onconnection = (connection) => {
       this._unAuthenticatedConnections.push(connection);
+      // There is a single onclose, the subscriptions on the connection add
+      // their listeners here.
+      connection.closeListeners = new Set();
+      connection.onclose = () => {
+        for (const listener of connection.closeListeners) {
+          listener();
+        }
+        connection.closeListeners.clear();
+      };
       setTimeout(() => {
         // Must be authenticated in `authenticationTimeout` seconds.
         if (!connection.transportId) {
@@ -0,0 +1,50 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+'use strict';
+
+const log = require('../logger').logger.getLogger('RtcTaskQueues');
+
+let configured = false;
+
+/*
+ * Sizes the process wide pool of WebRTC task queues shared by the RtcAdapters
+ * of |addon|, and logs the load of the queues at the interval of the internal
+ * connection stats.
+ * @param {object} addon Addon exporting setTaskQueuePoolSize and getTaskQueueStats
+ * @param {number} poolSize Number of queues per kind
+ */
+exports.setup = function (addon, poolSize) {
+  if (configured || !addon.setTaskQueuePoolSize) {
+    return;
+  }
+  configured = true;
+  if (poolSize > 0) {
+    addon.setTaskQueuePoolSize(poolSize);
+  }
+
+  const internal = global.config && global.config.internal;
+  const statsInterval = (internal && internal.stats_interval !== undefined) ?
+    internal.stats_interval : 10;
+  if (statsInterval > 0) {
+    const reported = new Map(); // name#index => busyUs
+    const timer = setInterval(() => {
+      const queues = addon.getTaskQueueStats().map((queue) => {
+        const key = queue.name + '#' + queue.index;
+        const busyUs = queue.busyUs - (reported.get(key) || 0);
+        reported.set(key, queue.busyUs);
+        return {
+          queue: key,
+          users: queue.users,
+          tasks: queue.tasks,
+          busy: (busyUs / (statsInterval * 1e6)).toFixed(2),
+        };
+      });
+      if (queues.length > 0) {
+        log.debug('Task queue stats:', JSON.stringify(queues));
+      }
+    }, statsInterval * 1000);
+    timer.unref();
+  }
+};
@@ -29,6 +29,9 @@ module.exports.load = () => {
 
     config.capacity = config.capacity || {};
 
+    config.sip = config.sip || {};
+    config.sip.rtc_task_queues = config.sip.rtc_task_queues || 4;
+
     config.internal.ip_address = config.internal.ip_address || '';
     config.internal.network_interface = config.internal.network_interface || undefined;
     config.internal.minport = config.internal.minport || 0;
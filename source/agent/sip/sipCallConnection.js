@@ -16,6 +16,8 @@ var VideoFramePacketizer = frameAddon.VideoFramePacketizer;
 var path = require('path');
 var logger = require('../logger').logger;
 var log = logger.getLogger('SipCallConnection');
+
+require('./rtcTaskQueues').setup(frameAddon, global.config.sip.rtc_task_queues);
 exports.SipCallConnection = function (spec, onMediaUpdate) {
     var that = {},
         input = true,
@@ -6,6 +6,7 @@
       'SipGateway.cc',
       'SipCallConnection.cpp',
       '../../addons/common/NodeEventRegistry.cc',
+      '../../addons/common/NodeEventDispatcher.cc',
       '../../../core/common/JobTimer.cpp',
     ],
     'dependencies': ['sipLib'],
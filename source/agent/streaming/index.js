@@ -84,6 +84,21 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
         return connection;
     };
 
+    var defaultParameters = function (connection) {
+        if (connection.parameters) {
+            return connection;
+        }
+        var parameters;
+        if (connection.protocol === 'hls') {
+            parameters = {method: 'PUT', hlsTime: 2, hlsListSize: 5};
+        } else if (connection.protocol === 'dash') {
+            parameters = {method: 'PUT', dashSegDuration: 2, dashWindowSize: 5};
+        }
+        return Object.assign({parameters}, connection);
+    };
+
+    // options.connection.mirrors: (optional) [{protocol, url, parameters}],
+    // muxed from the same input as options.connection by one tee output
     var createAVStreamOut = function (connectionId, options) {
         var avstream_options = {type: 'streaming',
                                 require_audio: !!options.media.audio,
@@ -91,14 +106,22 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
                                 connection: options.connection,
                                 initializeTimeout: global.config.avstream.initializeTimeout};
 
-        if ((options.connection.protocol === 'dash' || options.connection.protocol === 'hls') && !options.connection.url.startsWith('http')) {
-            var fs = require('fs');
-            if (fs.existsSync(options.connection.url)) {
-                log.error('avstream-out init error: file existed.');
-                notifyStatus(options.controller, connectionId, 'out', {type: 'failed', reason: 'file existed.'});
-                return;
+        var mirrors = (options.connection.mirrors || []).map(defaultParameters);
+        var sinks = [options.connection].concat(mirrors);
+        for (var sink of sinks) {
+            if ((sink.protocol === 'dash' || sink.protocol === 'hls') && !sink.url.startsWith('http')) {
+                var fs = require('fs');
+                if (fs.existsSync(sink.url)) {
+                    log.error('avstream-out init error: file existed.');
+                    notifyStatus(options.controller, connectionId, 'out', {type: 'failed', reason: 'file existed.'});
+                    return;
+                }
             }
         }
+        if (mirrors.length > 0) {
+            avstream_options.type = 'tee';
+            avstream_options.outputs = sinks.map((sink) => ({type: 'streaming', connection: sink}));
+        }
 
         var connection = new AVStreamOut(avstream_options, function (error) {
             if (error) {
@@ -114,6 +137,11 @@ module.exports = function (rpcClient, selfRpcId, parentRpcId, clusterWorkerIP) {
                 notifyStatus(options.controller, connectionId, 'out', {type: 'failed', reason: 'avstream_out fatal error: ' + error});
             }
         });
+        // One url of a tee failed for good, the others go on
+        connection.addEventListener('sinkfailed', function (url) {
+            log.warn('avstream-out sink failed:', url);
+            notifyStatus(options.controller, connectionId, 'out', {type: 'warning', reason: 'output failed: ' + url});
+        });
 
         connection.receiver = function(type) {
             return this;
@@ -46,6 +46,8 @@ module.exports.load = () => {
     config.video.hardwareAccelerated = !!config.video.hardwareAccelerated;
     config.video.enableBetterHEVCQuality = !!config.video.enableBetterHEVCQuality;
     config.video.MFE_timeout = config.video.MFE_timeout || 0;
+    config.video.decode_stats_interval = (config.video.decode_stats_interval !== undefined) ?
+        config.video.decode_stats_interval : 10;
     let videoCap = require('./videoCapability').detected(config.video.hardwareAccelerated);
     config.video.hardwareAccelerated = videoCap.hw;
     config.video.codecs = videoCap.codecs;
@@ -0,0 +1,157 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "CompositeWorkerPool.h"
+
+namespace mcu {
+
+bool CompositeBatch::runOne()
+{
+    size_t index = m_next.fetch_add(1);
+    if (index >= m_tasks.size())
+        return false;
+
+    m_tasks[index]();
+
+    if (m_remaining.fetch_sub(1) == 1) {
+        boost::mutex::scoped_lock lock(m_mutex);
+        m_done.notify_all();
+    }
+    return true;
+}
+
+DEFINE_LOGGER(CompositeWorkerPool, "mcu.media.CompositeWorkerPool");
+
+CompositeWorkerPool& CompositeWorkerPool::GetInstance()
+{
+    // Intentionally leaked, workers are not joined during static destruction.
+    static CompositeWorkerPool* pool = nullptr;
+    static boost::once_flag once = BOOST_ONCE_INIT;
+
+    boost::call_once(once, []() {
+        uint32_t nThreads = boost::thread::hardware_concurrency();
+        uint32_t parallelNum = nThreads / 2;
+        if (parallelNum > 16)
+            parallelNum = 16;
+        if (parallelNum < 2)
+            parallelNum = 0;
+
+        pool = new CompositeWorkerPool(parallelNum);
+        ELOG_DEBUG("hardware concurrency %d, composite workers %d", nThreads, parallelNum);
+    });
+    return *pool;
+}
+
+CompositeWorkerPool::CompositeWorkerPool(uint32_t threadCount)
+    : m_clientId(0)
+    , m_running(true)
+{
+    m_nextClient = m_clients.end();
+    for (uint32_t i = 0; i < threadCount; i++)
+        m_threads.push_back(m_threadGroup.create_thread(boost::bind(&CompositeWorkerPool::workerLoop, this)));
+}
+
+CompositeWorkerPool::~CompositeWorkerPool()
+{
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        m_running = false;
+        m_cond.notify_all();
+    }
+    m_threadGroup.join_all();
+}
+
+CompositeWorkerPool::ClientId CompositeWorkerPool::addClient()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    Client client;
+    client.id = ++m_clientId;
+    m_clients.push_back(client);
+    return client.id;
+}
+
+void CompositeWorkerPool::removeClient(ClientId id)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+
+    for (auto it = m_clients.begin(); it != m_clients.end(); ++it) {
+        if (it->id == id) {
+            if (m_nextClient == it)
+                ++m_nextClient;
+            m_clients.erase(it);
+            return;
+        }
+    }
+}
+
+boost::shared_ptr<CompositeBatch> CompositeWorkerPool::createBatch()
+{
+    return boost::shared_ptr<CompositeBatch>(new CompositeBatch());
+}
+
+void CompositeWorkerPool::forkJoin(ClientId id, const boost::shared_ptr<CompositeBatch>& batch)
+{
+    if (batch->m_tasks.empty())
+        return;
+
+    batch->m_next = 0;
+    batch->m_remaining = batch->m_tasks.size();
+
+    if (batch->m_tasks.size() > 1 && !m_threads.empty()) {
+        boost::mutex::scoped_lock lock(m_mutex);
+        for (auto& client : m_clients) {
+            if (client.id == id) {
+                client.batches.push_back(batch);
+                m_cond.notify_all();
+                break;
+            }
+        }
+    }
+
+    while (batch->runOne()) {
+    }
+
+    boost::mutex::scoped_lock lock(batch->m_mutex);
+    while (batch->m_remaining > 0)
+        batch->m_done.wait(lock);
+}
+
+// Called with m_mutex held, picks the next client with unclaimed tasks.
+boost::shared_ptr<CompositeBatch> CompositeWorkerPool::nextBatch()
+{
+    for (size_t i = 0; i < m_clients.size(); i++) {
+        if (m_nextClient == m_clients.end())
+            m_nextClient = m_clients.begin();
+
+        Client& client = *m_nextClient++;
+        while (!client.batches.empty()) {
+            boost::shared_ptr<CompositeBatch>& batch = client.batches.front();
+            if (batch->m_next < batch->m_tasks.size())
+                return batch;
+            client.batches.pop_front();
+        }
+    }
+    return boost::shared_ptr<CompositeBatch>();
+}
+
+void CompositeWorkerPool::workerLoop()
+{
+    while (true) {
+        boost::shared_ptr<CompositeBatch> batch;
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            while (m_running && !(batch = nextBatch()))
+                m_cond.wait(lock);
+
+            if (!m_running)
+                return;
+        }
+
+        // One task per turn, then serve the next client
+        batch->runOne();
+    }
+}
+
+}
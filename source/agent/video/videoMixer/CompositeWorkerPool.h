@@ -0,0 +1,95 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef CompositeWorkerPool_h
+#define CompositeWorkerPool_h
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <list>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include "logger.h"
+
+namespace mcu {
+
+class CompositeWorkerPool;
+
+/*
+ * A set of tasks forked to the worker pool. The thread calling join()
+ * runs unclaimed tasks itself, so a batch always completes even when
+ * all workers are busy with other rooms.
+ */
+class CompositeBatch {
+public:
+    void add(const std::function<void()>& task) { m_tasks.push_back(task); }
+    size_t size() const { return m_tasks.size(); }
+
+private:
+    friend class CompositeWorkerPool;
+
+    CompositeBatch() : m_next(0), m_remaining(0) {}
+
+    // Claim and run one task, returns false if none is left to claim.
+    bool runOne();
+
+    std::vector<std::function<void()>> m_tasks;
+    std::atomic<size_t> m_next;
+    std::atomic<size_t> m_remaining;
+
+    boost::mutex m_mutex;
+    boost::condition_variable m_done;
+};
+
+/*
+ * Process wide pool of compositing threads shared by all rooms. Each
+ * client (room) has its own queue of batches and workers serve clients
+ * round robin, so a room with many regions can not starve the others.
+ */
+class CompositeWorkerPool {
+    DECLARE_LOGGER();
+
+public:
+    typedef uint32_t ClientId;
+
+    static CompositeWorkerPool& GetInstance();
+
+    size_t threadCount() const { return m_threads.size(); }
+
+    ClientId addClient();
+    void removeClient(ClientId client);
+
+    boost::shared_ptr<CompositeBatch> createBatch();
+    // Run all tasks of |batch| on the pool and the calling thread, returns when they are done.
+    void forkJoin(ClientId client, const boost::shared_ptr<CompositeBatch>& batch);
+
+private:
+    struct Client {
+        ClientId id;
+        std::deque<boost::shared_ptr<CompositeBatch>> batches;
+    };
+
+    CompositeWorkerPool(uint32_t threadCount);
+    ~CompositeWorkerPool();
+
+    void workerLoop();
+    boost::shared_ptr<CompositeBatch> nextBatch();
+
+    boost::mutex m_mutex;
+    boost::condition_variable m_cond;
+    std::list<Client> m_clients;
+    std::list<Client>::iterator m_nextClient;
+    ClientId m_clientId;
+    bool m_running;
+
+    boost::thread_group m_threadGroup;
+    std::vector<boost::thread*> m_threads;
+};
+
+}
+#endif /* CompositeWorkerPool_h */
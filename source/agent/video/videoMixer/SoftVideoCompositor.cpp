@@ -7,6 +7,9 @@
 #include "libyuv/convert.h"
 #include "libyuv/scale.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <iostream>
 #include <fstream>
 
@@ -17,6 +20,17 @@ using namespace owt_base;
 
 namespace mcu {
 
+// Number of recent composite times the percentiles are computed over
+static const size_t kCompositeTimeWindow = 256;
+
+// Generations are unique across all inputs and avatars, so a region can
+// tell that its content changed by comparing a single number.
+static uint64_t nextGeneration()
+{
+    static std::atomic<uint64_t> generation(0);
+    return ++generation;
+}
+
 DEFINE_LOGGER(AvatarManager, "mcu.media.SoftVideoCompositor.AvatarManager");
 
 AvatarManager::AvatarManager(uint8_t size)
@@ -114,6 +128,7 @@ bool AvatarManager::setAvatar(uint8_t index, const std::string &url)
     boost::unique_lock<boost::shared_mutex> lock(m_mutex);
     ELOG_DEBUG("setAvatar(%d) = %s", index, url.c_str());
 
+    m_generations[index] = nextGeneration();
     auto it = m_inputs.find(index);
     if (it == m_inputs.end()) {
         m_inputs[index] = url;
@@ -140,6 +155,7 @@ bool AvatarManager::unsetAvatar(uint8_t index)
     boost::unique_lock<boost::shared_mutex> lock(m_mutex);
     ELOG_DEBUG("unsetAvatar(%d)", index);
 
+    m_generations[index] = nextGeneration();
     auto it = m_inputs.find(index);
     if (it == m_inputs.end()) {
         return true;
@@ -156,10 +172,12 @@ bool AvatarManager::unsetAvatar(uint8_t index)
     return true;
 }
 
-boost::shared_ptr<webrtc::VideoFrame> AvatarManager::getAvatarFrame(uint8_t index)
+boost::shared_ptr<webrtc::VideoFrame> AvatarManager::getAvatarFrame(uint8_t index, uint64_t& generation)
 {
     boost::unique_lock<boost::shared_mutex> lock(m_mutex);
 
+    generation = m_generations[index];
+
     auto it = m_inputs.find(index);
     if (it == m_inputs.end()) {
         ELOG_WARN("Not valid index(%d)", index);
@@ -179,6 +197,7 @@ DEFINE_LOGGER(SoftInput, "mcu.media.SoftVideoCompositor.SoftInput");
 
 SoftInput::SoftInput()
     : m_active(false)
+    , m_generation(0)
 {
     m_bufferManager.reset(new I420BufferManager(3));
     m_converter.reset(new owt_base::FrameConverter());
@@ -192,6 +211,7 @@ void SoftInput::setActive(bool active)
 {
     boost::unique_lock<boost::shared_mutex> lock(m_mutex);
     m_active = active;
+    m_generation = nextGeneration();
     if (!m_active)
         m_busyFrame.reset();
 }
@@ -223,15 +243,19 @@ void SoftInput::pushInput(webrtc::VideoFrame *videoFrame)
 
     {
         boost::unique_lock<boost::shared_mutex> lock(m_mutex);
-        if (m_active)
+        if (m_active) {
             m_busyFrame.reset(new webrtc::VideoFrame(dstBuffer, webrtc::kVideoRotation_0, 0));
+            m_generation = nextGeneration();
+        }
     }
 }
 
-boost::shared_ptr<VideoFrame> SoftInput::popInput()
+boost::shared_ptr<VideoFrame> SoftInput::popInput(uint64_t& generation)
 {
     boost::unique_lock<boost::shared_mutex> lock(m_mutex);
 
+    generation = m_generation;
+
     if(!m_active)
         return NULL;
 
@@ -257,7 +281,9 @@ SoftFrameGenerator::SoftFrameGenerator(
     , m_bgColor(bgColor)
     , m_crop(crop)
     , m_configureChanged(false)
-    , m_parallelNum(0)
+    , m_layoutChanged(true)
+    , m_canvasChanged(true)
+    , m_compositeCount(0)
 {
     ELOG_DEBUG_T("Support fps max(%d), min(%d)", m_maxSupportedFps, m_minSupportedFps);
 
@@ -281,24 +307,9 @@ SoftFrameGenerator::SoftFrameGenerator(
 
     m_outputs.resize(m_maxSupportedFps / m_minSupportedFps);
 
-    m_bufferManager.reset(new I420BufferManager(1));
-
-    // parallet composition
-    uint32_t nThreads = boost::thread::hardware_concurrency();
-    m_parallelNum = nThreads / 2;
-    if (m_parallelNum > 16)
-        m_parallelNum = 16;
-
-    ELOG_DEBUG_T("hardware concurrency %d, parallel composition num %d", nThreads, m_parallelNum);
-
-    if (m_parallelNum > 1) {
-        m_srv       = boost::make_shared<boost::asio::io_service>();
-        m_srvWork   = boost::make_shared<boost::asio::io_service::work>(*m_srv);
-        m_thrGrp    = boost::make_shared<boost::thread_group>();
-
-        for (uint32_t i = 0; i < m_parallelNum; i++)
-            m_thrGrp->create_thread(boost::bind(&boost::asio::io_service::run, m_srv));
-    }
+    // The previous output is kept for unchanged ticks and encoders may
+    // still hold the ones before it.
+    m_bufferManager.reset(new I420BufferManager(4));
 
     m_textDrawer.reset(new owt_base::FFmpegDrawText());
 
@@ -312,19 +323,6 @@ SoftFrameGenerator::~SoftFrameGenerator()
 
     m_jobTimer->stop();
 
-    if (m_srvWork)
-        m_srvWork.reset();
-
-    if (m_srv) {
-        m_srv->stop();
-        m_srv.reset();
-    }
-
-    if (m_thrGrp) {
-        m_thrGrp->join_all();
-        m_thrGrp.reset();
-    }
-
     for (uint32_t i = 0; i <  m_outputs.size(); i++) {
         if (m_outputs[i].size())
             ELOG_WARN_T("Outputs not empty!!!");
@@ -399,7 +397,11 @@ void SoftFrameGenerator::onTimeout()
     }
 
     if (hasValidOutput) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
         rtc::scoped_refptr<webrtc::VideoFrameBuffer> compositeBuffer = generateFrame();
+        recordCompositeTime(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count());
+
         if (compositeBuffer) {
             webrtc::VideoFrame compositeFrame(
                     compositeBuffer,
@@ -439,139 +441,245 @@ void SoftFrameGenerator::onTimeout()
     m_counter = (m_counter + 1) % m_counterMax;
 }
 
+void SoftFrameGenerator::recordCompositeTime(uint32_t us)
+{
+    if (m_compositeTimesUs.size() < kCompositeTimeWindow) {
+        m_compositeTimesUs.push_back(us);
+    } else {
+        m_compositeTimesUs[m_compositeCount % kCompositeTimeWindow] = us;
+    }
+
+    if (++m_compositeCount % kCompositeTimeWindow == 0) {
+        std::vector<uint32_t> times(m_compositeTimesUs);
+        std::sort(times.begin(), times.end());
+        ELOG_DEBUG_T("Composite time p50 %uus p99 %uus max %uus",
+                times[(times.size() - 1) * 50 / 100],
+                times[(times.size() - 1) * 99 / 100],
+                times.back());
+    }
+}
+
 rtc::scoped_refptr<webrtc::VideoFrameBuffer> SoftFrameGenerator::generateFrame()
 {
     reconfigureIfNeeded();
     return layout();
 }
 
-void SoftFrameGenerator::layout_regions(SoftFrameGenerator *t, rtc::scoped_refptr<webrtc::I420Buffer> compositeBuffer, const LayoutSolution &regions)
+SoftFrameGenerator::Box SoftFrameGenerator::regionBox(const Region& region, uint32_t width, uint32_t height)
 {
-    uint32_t composite_width = compositeBuffer->width();
-    uint32_t composite_height = compositeBuffer->height();
+    Box box;
+    box.x       = (uint64_t)width * region.area.rect.left.numerator / region.area.rect.left.denominator;
+    box.y       = (uint64_t)height * region.area.rect.top.numerator / region.area.rect.top.denominator;
+    box.width   = (uint64_t)width * region.area.rect.width.numerator / region.area.rect.width.denominator;
+    box.height  = (uint64_t)height * region.area.rect.height.numerator / region.area.rect.height.denominator;
 
-    for (LayoutSolution::const_iterator it = regions.begin(); it != regions.end(); ++it) {
-        boost::shared_ptr<webrtc::VideoFrame> inputFrame = t->m_owner->getInputFrame(it->input);
-        if (inputFrame == NULL) {
-            continue;
-        }
+    if (box.x + box.width > width)
+        box.width = width - box.x;
 
-        rtc::scoped_refptr<webrtc::VideoFrameBuffer> inputBuffer = inputFrame->video_frame_buffer();
-
-        Region region = it->region;
-        uint32_t dst_x      = (uint64_t)composite_width * region.area.rect.left.numerator / region.area.rect.left.denominator;
-        uint32_t dst_y      = (uint64_t)composite_height * region.area.rect.top.numerator / region.area.rect.top.denominator;
-        uint32_t dst_width  = (uint64_t)composite_width * region.area.rect.width.numerator / region.area.rect.width.denominator;
-        uint32_t dst_height = (uint64_t)composite_height * region.area.rect.height.numerator / region.area.rect.height.denominator;
-
-        if (dst_x + dst_width > composite_width)
-            dst_width = composite_width - dst_x;
-
-        if (dst_y + dst_height > composite_height)
-            dst_height = composite_height - dst_y;
-
-        uint32_t cropped_dst_width;
-        uint32_t cropped_dst_height;
-        uint32_t src_x;
-        uint32_t src_y;
-        uint32_t src_width;
-        uint32_t src_height;
-        if (t->m_crop) {
-            src_width   = std::min((uint32_t)inputBuffer->width(), dst_width * inputBuffer->height() / dst_height);
-            src_height  = std::min((uint32_t)inputBuffer->height(), dst_height * inputBuffer->width() / dst_width);
-            src_x       = (inputBuffer->width() - src_width) / 2;
-            src_y       = (inputBuffer->height() - src_height) / 2;
-
-            cropped_dst_width   = dst_width;
-            cropped_dst_height  = dst_height;
-        } else {
-            src_width   = inputBuffer->width();
-            src_height  = inputBuffer->height();
-            src_x       = 0;
-            src_y       = 0;
+    if (box.y + box.height > height)
+        box.height = height - box.y;
 
-            cropped_dst_width   = std::min(dst_width, inputBuffer->width() * dst_height / inputBuffer->height());
-            cropped_dst_height  = std::min(dst_height, inputBuffer->height() * dst_width / inputBuffer->width());
-        }
+    return box;
+}
+
+void SoftFrameGenerator::fillBackground(const Box& box)
+{
+    // Cover the even aligned area layout_region() may scale into
+    uint32_t x = box.x & ~1;
+    uint32_t y = box.y & ~1;
+    uint32_t width = std::min(box.x + box.width - x, m_canvas->width() - x);
+    uint32_t height = std::min(box.y + box.height - y, m_canvas->height() - y);
+
+    libyuv::I420Rect(
+            m_canvas->MutableDataY(), m_canvas->StrideY(),
+            m_canvas->MutableDataU(), m_canvas->StrideU(),
+            m_canvas->MutableDataV(), m_canvas->StrideV(),
+            x, y, width, height,
+            m_bgColor.y, m_bgColor.cb, m_bgColor.cr);
+}
 
-        dst_x += (dst_width - cropped_dst_width) / 2;
-        dst_y += (dst_height - cropped_dst_height) / 2;
-
-        src_x               &= ~1;
-        src_y               &= ~1;
-        src_width           &= ~1;
-        src_height          &= ~1;
-        dst_x               &= ~1;
-        dst_y               &= ~1;
-        cropped_dst_width   &= ~1;
-        cropped_dst_height  &= ~1;
-
-        int ret = libyuv::I420Scale(
-                inputBuffer->DataY() + src_y * inputBuffer->StrideY() + src_x, inputBuffer->StrideY(),
-                inputBuffer->DataU() + (src_y * inputBuffer->StrideU() + src_x) / 2, inputBuffer->StrideU(),
-                inputBuffer->DataV() + (src_y * inputBuffer->StrideV() + src_x) / 2, inputBuffer->StrideV(),
-                src_width, src_height,
-                compositeBuffer->MutableDataY() + dst_y * compositeBuffer->StrideY() + dst_x, compositeBuffer->StrideY(),
-                compositeBuffer->MutableDataU() + (dst_y * compositeBuffer->StrideU() + dst_x) / 2, compositeBuffer->StrideU(),
-                compositeBuffer->MutableDataV() + (dst_y * compositeBuffer->StrideV() + dst_x) / 2, compositeBuffer->StrideV(),
-                cropped_dst_width, cropped_dst_height,
-                libyuv::kFilterBox);
-        if (ret != 0)
-            ELOG_ERROR("I420Scale failed, ret %d", ret);
+void SoftFrameGenerator::layout_region(SoftFrameGenerator *t, rtc::scoped_refptr<webrtc::I420Buffer> compositeBuffer, const RegionJob &job)
+{
+    boost::shared_ptr<webrtc::VideoFrame> inputFrame = job.frame;
+    if (inputFrame == NULL) {
+        return;
     }
+
+    rtc::scoped_refptr<webrtc::VideoFrameBuffer> inputBuffer = inputFrame->video_frame_buffer();
+
+    Box box = regionBox(job.region, compositeBuffer->width(), compositeBuffer->height());
+    uint32_t dst_x      = box.x;
+    uint32_t dst_y      = box.y;
+    uint32_t dst_width  = box.width;
+    uint32_t dst_height = box.height;
+
+    uint32_t cropped_dst_width;
+    uint32_t cropped_dst_height;
+    uint32_t src_x;
+    uint32_t src_y;
+    uint32_t src_width;
+    uint32_t src_height;
+    if (t->m_crop) {
+        src_width   = std::min((uint32_t)inputBuffer->width(), dst_width * inputBuffer->height() / dst_height);
+        src_height  = std::min((uint32_t)inputBuffer->height(), dst_height * inputBuffer->width() / dst_width);
+        src_x       = (inputBuffer->width() - src_width) / 2;
+        src_y       = (inputBuffer->height() - src_height) / 2;
+
+        cropped_dst_width   = dst_width;
+        cropped_dst_height  = dst_height;
+    } else {
+        src_width   = inputBuffer->width();
+        src_height  = inputBuffer->height();
+        src_x       = 0;
+        src_y       = 0;
+
+        cropped_dst_width   = std::min(dst_width, inputBuffer->width() * dst_height / inputBuffer->height());
+        cropped_dst_height  = std::min(dst_height, inputBuffer->height() * dst_width / inputBuffer->width());
+    }
+
+    dst_x += (dst_width - cropped_dst_width) / 2;
+    dst_y += (dst_height - cropped_dst_height) / 2;
+
+    src_x               &= ~1;
+    src_y               &= ~1;
+    src_width           &= ~1;
+    src_height          &= ~1;
+    dst_x               &= ~1;
+    dst_y               &= ~1;
+    cropped_dst_width   &= ~1;
+    cropped_dst_height  &= ~1;
+
+    int ret = libyuv::I420Scale(
+            inputBuffer->DataY() + src_y * inputBuffer->StrideY() + src_x, inputBuffer->StrideY(),
+            inputBuffer->DataU() + (src_y * inputBuffer->StrideU() + src_x) / 2, inputBuffer->StrideU(),
+            inputBuffer->DataV() + (src_y * inputBuffer->StrideV() + src_x) / 2, inputBuffer->StrideV(),
+            src_width, src_height,
+            compositeBuffer->MutableDataY() + dst_y * compositeBuffer->StrideY() + dst_x, compositeBuffer->StrideY(),
+            compositeBuffer->MutableDataU() + (dst_y * compositeBuffer->StrideU() + dst_x) / 2, compositeBuffer->StrideU(),
+            compositeBuffer->MutableDataV() + (dst_y * compositeBuffer->StrideV() + dst_x) / 2, compositeBuffer->StrideV(),
+            cropped_dst_width, cropped_dst_height,
+            libyuv::kFilterBox);
+    if (ret != 0)
+        ELOG_ERROR("I420Scale failed, ret %d", ret);
 }
 
 rtc::scoped_refptr<webrtc::VideoFrameBuffer> SoftFrameGenerator::layout()
 {
-    rtc::scoped_refptr<webrtc::I420Buffer> compositeBuffer = m_bufferManager->getFreeBuffer(m_size.width, m_size.height);
-    if (!compositeBuffer) {
-        ELOG_ERROR("No valid composite buffer");
-        return NULL;
+    if (!m_canvas) {
+        m_canvas = webrtc::I420Buffer::Create(m_size.width, m_size.height);
+        m_layoutChanged = true;
     }
 
-    // Set the background color
-    libyuv::I420Rect(
-            compositeBuffer->MutableDataY(), compositeBuffer->StrideY(),
-            compositeBuffer->MutableDataU(), compositeBuffer->StrideU(),
-            compositeBuffer->MutableDataV(), compositeBuffer->StrideV(),
-            0, 0, compositeBuffer->width(), compositeBuffer->height(),
-            m_bgColor.y, m_bgColor.cb, m_bgColor.cr);
+    if (m_layoutChanged) {
+        // Set the background color
+        Box canvasBox = {0, 0, (uint32_t)m_canvas->width(), (uint32_t)m_canvas->height()};
+        fillBackground(canvasBox);
 
-    bool isParallelFrameComposition = m_parallelNum > 1 && m_layout.size() > 4;
+        m_regionStates.assign(m_layout.size(), RegionState());
+        m_canvasChanged = true;
+    }
 
-    if (isParallelFrameComposition) {
-        int nParallelRegions = (m_layout.size() + m_parallelNum - 1) / m_parallelNum;
-        int nRegions = m_layout.size();
+    size_t nRegions = m_layout.size();
+    std::vector<RegionJob> regions(nRegions);
+    std::vector<Box> boxes(nRegions);
+    std::vector<uint64_t> generations(nRegions, 0);
+    std::vector<bool> dirty(nRegions, false);
+    bool anyDirty = false;
 
-        LayoutSolution::iterator regions_begin = m_layout.begin();
-        LayoutSolution::iterator regions_end = m_layout.begin();
+    size_t i = 0;
+    for (auto it = m_layout.begin(); it != m_layout.end(); ++it, ++i) {
+        regions[i].region = it->region;
+        regions[i].frame = m_owner->getInputFrame(it->input, generations[i]);
+        boxes[i] = regionBox(it->region, m_canvas->width(), m_canvas->height());
 
-        std::vector<boost::shared_ptr<boost::packaged_task<void>>> tasks;
-        while (nRegions > 0) {
-            if (nRegions < nParallelRegions)
-                nParallelRegions = nRegions;
+        const RegionState& state = m_regionStates[i];
+        if (regions[i].frame) {
+            dirty[i] = !state.drawn || state.generation != generations[i];
+        } else {
+            dirty[i] = state.drawn;
+        }
+        anyDirty |= dirty[i];
+    }
 
-            regions_begin = regions_end;
-            advance(regions_end, nParallelRegions);
+    if (!anyDirty && !m_layoutChanged && !m_canvasChanged && m_lastOutput) {
+        return m_lastOutput;
+    }
 
-            boost::shared_ptr<boost::packaged_task<void>> task = boost::make_shared<boost::packaged_task<void>>(
-                    boost::bind(SoftFrameGenerator::layout_regions,
-                        this,
-                        compositeBuffer,
-                        LayoutSolution(regions_begin, regions_end))
-                    );
-            m_srv->post(boost::bind(&boost::packaged_task<void>::operator(), task));
-            tasks.push_back(task);
+    // Overlapping regions have to be recomposited together, in layout order.
+    std::vector<bool> overlapped(nRegions, false);
+    bool grown = anyDirty;
+    while (grown) {
+        grown = false;
+        for (size_t a = 0; a < nRegions; a++) {
+            for (size_t b = a + 1; b < nRegions; b++) {
+                if ((dirty[a] || dirty[b]) && boxes[a].intersects(boxes[b])) {
+                    grown |= !dirty[a] || !dirty[b];
+                    dirty[a] = dirty[b] = true;
+                    overlapped[a] = overlapped[b] = true;
+                }
+            }
+        }
+    }
 
-            nRegions -= nParallelRegions;
+    std::vector<RegionJob> jobs;
+    for (i = 0; i < nRegions; i++) {
+        if (!dirty[i]) {
+            continue;
         }
 
-        for (auto& task : tasks)
-            task->get_future().wait();
+        RegionState& state = m_regionStates[i];
+        uint32_t width = regions[i].frame ? regions[i].frame->width() : 0;
+        uint32_t height = regions[i].frame ? regions[i].frame->height() : 0;
+
+        // An unchanged input size covers exactly the pixels it did last time.
+        if (!m_layoutChanged
+                && (overlapped[i] || !regions[i].frame || state.width != width || state.height != height)) {
+            fillBackground(boxes[i]);
+        }
+
+        state.drawn = (regions[i].frame != NULL);
+        state.generation = generations[i];
+        state.width = width;
+        state.height = height;
+
+        if (regions[i].frame) {
+            jobs.push_back(regions[i]);
+        }
+    }
+    m_layoutChanged = false;
+
+    CompositeWorkerPool& pool = CompositeWorkerPool::GetInstance();
+    bool isParallelFrameComposition = pool.threadCount() > 1 && jobs.size() > 4;
+
+    if (isParallelFrameComposition) {
+        boost::shared_ptr<CompositeBatch> batch = pool.createBatch();
+        for (auto& job : jobs)
+            batch->add(boost::bind(SoftFrameGenerator::layout_region, this, m_canvas, job));
+
+        pool.forkJoin(m_owner->m_workerClient, batch);
     } else {
-        layout_regions(this, compositeBuffer, m_layout);
+        for (auto& job : jobs)
+            layout_region(this, m_canvas, job);
+    }
+    m_canvasChanged = true;
+
+    rtc::scoped_refptr<webrtc::I420Buffer> compositeBuffer = m_bufferManager->getFreeBuffer(m_size.width, m_size.height);
+    if (!compositeBuffer) {
+        ELOG_ERROR("No valid composite buffer");
+        return NULL;
     }
 
+    libyuv::I420Copy(
+            m_canvas->DataY(), m_canvas->StrideY(),
+            m_canvas->DataU(), m_canvas->StrideU(),
+            m_canvas->DataV(), m_canvas->StrideV(),
+            compositeBuffer->MutableDataY(), compositeBuffer->StrideY(),
+            compositeBuffer->MutableDataU(), compositeBuffer->StrideU(),
+            compositeBuffer->MutableDataV(), compositeBuffer->StrideV(),
+            m_canvas->width(), m_canvas->height());
+    m_canvasChanged = false;
+    m_lastOutput = compositeBuffer;
+
     return compositeBuffer;
 }
 
@@ -585,6 +693,7 @@ void SoftFrameGenerator::reconfigureIfNeeded()
         m_layout = m_newLayout;
         m_configureChanged = false;
     }
+    m_layoutChanged = true;
 
     ELOG_DEBUG_T("reconfigure");
 }
@@ -604,6 +713,7 @@ DEFINE_LOGGER(SoftVideoCompositor, "mcu.media.SoftVideoCompositor");
 
 SoftVideoCompositor::SoftVideoCompositor(uint32_t maxInput, VideoSize rootSize, YUVColor bgColor, bool crop)
     : m_maxInput(maxInput)
+    , m_workerClient(CompositeWorkerPool::GetInstance().addClient())
 {
     m_inputs.resize(m_maxInput);
     for (auto& input : m_inputs) {
@@ -622,6 +732,8 @@ SoftVideoCompositor::~SoftVideoCompositor()
     m_generators.clear();
     m_avatarManager.reset();
     m_inputs.clear();
+
+    CompositeWorkerPool::GetInstance().removeClient(m_workerClient);
 }
 
 void SoftVideoCompositor::updateRootSize(VideoSize& rootSize)
@@ -700,15 +812,19 @@ bool SoftVideoCompositor::removeOutput(owt_base::FrameDestination *dst)
     return false;
 }
 
-boost::shared_ptr<webrtc::VideoFrame> SoftVideoCompositor::getInputFrame(int index)
+boost::shared_ptr<webrtc::VideoFrame> SoftVideoCompositor::getInputFrame(int index, uint64_t& generation)
 {
     boost::shared_ptr<webrtc::VideoFrame> src;
 
     auto& input = m_inputs[index];
     if (input->isActive()) {
-        src = input->popInput();
+        src = input->popInput(generation);
     } else {
-        src = m_avatarManager->getAvatarFrame(index);
+        uint64_t inputGeneration = 0;
+        uint64_t avatarGeneration = 0;
+        input->popInput(inputGeneration);
+        src = m_avatarManager->getAvatarFrame(index, avatarGeneration);
+        generation = std::max(inputGeneration, avatarGeneration);
     }
 
     return src;
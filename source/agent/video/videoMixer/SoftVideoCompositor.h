@@ -17,6 +17,7 @@
 #include <webrtc/api/video/i420_buffer.h>
 
 #include "logger.h"
+#include "CompositeWorkerPool.h"
 #include "JobTimer.h"
 #include "MediaFramePipeline.h"
 #include "FrameConverter.h"
@@ -38,7 +39,8 @@ public:
     bool setAvatar(uint8_t index, const std::string &url);
     bool unsetAvatar(uint8_t index);
 
-    boost::shared_ptr<webrtc::VideoFrame> getAvatarFrame(uint8_t index);
+    // |generation| changes whenever the avatar of |index| is set or unset.
+    boost::shared_ptr<webrtc::VideoFrame> getAvatarFrame(uint8_t index, uint64_t& generation);
 
 protected:
     bool getImageSize(const std::string &url, uint32_t *pWidth, uint32_t *pHeight);
@@ -48,6 +50,7 @@ private:
     uint8_t m_size;
 
     std::map<uint8_t, std::string> m_inputs;
+    std::map<uint8_t, uint64_t> m_generations;
     std::map<std::string, boost::shared_ptr<webrtc::VideoFrame>> m_frames;
 
     boost::shared_mutex m_mutex;
@@ -64,10 +67,12 @@ public:
     bool isActive(void);
 
     void pushInput(webrtc::VideoFrame *videoFrame);
-    boost::shared_ptr<webrtc::VideoFrame> popInput();
+    // |generation| changes whenever a new frame is pushed or the input is (de)activated.
+    boost::shared_ptr<webrtc::VideoFrame> popInput(uint64_t& generation);
 
 private:
     bool m_active;
+    uint64_t m_generation;
     boost::shared_ptr<webrtc::VideoFrame> m_busyFrame;
     boost::shared_mutex m_mutex;
 
@@ -113,11 +118,39 @@ public:
     void onTimeout() override;
 
 protected:
+    struct Box {
+        uint32_t x;
+        uint32_t y;
+        uint32_t width;
+        uint32_t height;
+
+        bool intersects(const Box& other) const {
+            return x < other.x + other.width && other.x < x + width
+                && y < other.y + other.height && other.y < y + height;
+        }
+    };
+
+    // What was last composited into a region of the canvas
+    struct RegionState {
+        bool drawn;
+        uint64_t generation;
+        uint32_t width;
+        uint32_t height;
+    };
+
+    struct RegionJob {
+        Region region;
+        boost::shared_ptr<webrtc::VideoFrame> frame;
+    };
+
     rtc::scoped_refptr<webrtc::VideoFrameBuffer> generateFrame();
     rtc::scoped_refptr<webrtc::VideoFrameBuffer> layout();
-    static void layout_regions(SoftFrameGenerator *t, rtc::scoped_refptr<webrtc::I420Buffer> compositeBuffer, const LayoutSolution &regions);
+    static void layout_region(SoftFrameGenerator *t, rtc::scoped_refptr<webrtc::I420Buffer> compositeBuffer, const RegionJob &job);
+    static Box regionBox(const Region& region, uint32_t width, uint32_t height);
+    void fillBackground(const Box& box);
 
     void reconfigureIfNeeded();
+    void recordCompositeTime(uint32_t us);
 
 private:
     const webrtc::Clock *m_clock;
@@ -143,15 +176,21 @@ private:
     bool                        m_configureChanged;
     boost::shared_mutex         m_configMutex;
 
+    // Only regions whose input or layout changed are recomposited into the
+    // persistent canvas, which is then copied out to a delivered buffer.
+    rtc::scoped_refptr<webrtc::I420Buffer> m_canvas;
+    std::vector<RegionState>    m_regionStates;
+    bool                        m_layoutChanged;
+    bool                        m_canvasChanged;
+    rtc::scoped_refptr<webrtc::I420Buffer> m_lastOutput;
+
     boost::scoped_ptr<owt_base::I420BufferManager> m_bufferManager;
 
     boost::scoped_ptr<JobTimer> m_jobTimer;
 
-    // parallel composition
-    uint32_t m_parallelNum;
-    boost::shared_ptr<boost::asio::io_service> m_srv;
-    boost::shared_ptr<boost::asio::io_service::work> m_srvWork;
-    boost::shared_ptr<boost::thread_group> m_thrGrp;
+    // recent composite times for tail latency reporting
+    std::vector<uint32_t>       m_compositeTimesUs;
+    uint32_t                    m_compositeCount;
 
     boost::shared_ptr<owt_base::FFmpegDrawText> m_textDrawer;
 };
@@ -186,11 +225,15 @@ public:
     void clearText();
 
 protected:
-    boost::shared_ptr<webrtc::VideoFrame> getInputFrame(int index);
+    boost::shared_ptr<webrtc::VideoFrame> getInputFrame(int index, uint64_t& generation);
 
 private:
     uint32_t m_maxInput;
 
+    // Regions of all generators of this compositor are scheduled as one
+    // client of the shared worker pool.
+    CompositeWorkerPool::ClientId m_workerClient;
+
     std::vector<boost::shared_ptr<SoftFrameGenerator>> m_generators;
 
     std::vector<boost::shared_ptr<SoftInput>> m_inputs;
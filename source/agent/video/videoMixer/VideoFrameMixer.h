@@ -8,6 +8,10 @@
 #include "VideoLayout.h"
 #include <MediaFramePipeline.h>
 
+namespace owt_base {
+struct VideoDecodeStats;
+}
+
 namespace mcu {
 
 // VideoFrameCompositor accepts the raw I420VideoFrame from multiple inputs and
@@ -36,6 +40,8 @@ public:
     virtual bool addInput(int input, owt_base::FrameFormat, owt_base::FrameSource*, const std::string& avatar) = 0;
     virtual void removeInput(int input) = 0;
     virtual void setInputActive(int input, bool active) = 0;
+    // False if the input has no decoder keeping stats.
+    virtual bool getDecodeStats(int input, owt_base::VideoDecodeStats& stats) = 0;
 
     virtual bool addOutput(int output,
             owt_base::FrameFormat,
@@ -61,6 +61,7 @@ public:
     bool addInput(int input, owt_base::FrameFormat, owt_base::FrameSource*, const std::string& avatar);
     void removeInput(int input);
     void setInputActive(int input, bool active);
+    bool getDecodeStats(int input, owt_base::VideoDecodeStats& stats);
 
     bool addOutput(int output,
             owt_base::FrameFormat,
@@ -191,6 +192,21 @@ inline void VideoFrameMixerImpl::removeInput(int input)
     }
 }
 
+inline bool VideoFrameMixerImpl::getDecodeStats(int input, owt_base::VideoDecodeStats& stats)
+{
+    boost::shared_lock<boost::shared_mutex> lock(m_inputMutex);
+    auto it = m_inputs.find(input);
+    if (it == m_inputs.end())
+        return false;
+
+    owt_base::VCMFrameDecoder* decoder = dynamic_cast<owt_base::VCMFrameDecoder*>(it->second.decoder.get());
+    if (!decoder)
+        return false;
+
+    stats = decoder->getDecodeStats();
+    return true;
+}
+
 inline void VideoFrameMixerImpl::setInputActive(int input, bool active)
 {
     auto it = m_inputs.find(input);
@@ -115,6 +115,14 @@ void VideoMixer::setInputActive(const int inputIndex, bool active)
     }
 }
 
+bool VideoMixer::getDecodeStats(const int inputIndex, owt_base::VideoDecodeStats& stats)
+{
+    if (m_inputs.find(inputIndex) == m_inputs.end())
+        return false;
+
+    return m_frameMixer->getDecodeStats(inputIndex, stats);
+}
+
 bool VideoMixer::addOutput(
     const std::string& outStreamID
     , const std::string& codec
@@ -14,6 +14,10 @@
 #include "MediaFramePipeline.h"
 #include "VideoLayout.h"
 
+namespace owt_base {
+struct VideoDecodeStats;
+}
+
 namespace mcu {
 
 class VideoFrameMixer;
@@ -41,6 +45,7 @@ public:
     bool addInput(const int inputIndex, const std::string& codec, owt_base::FrameSource* source, const std::string& avatar);
     void removeInput(const int inputIndex);
     void setInputActive(const int inputIndex, bool active);
+    bool getDecodeStats(const int inputIndex, owt_base::VideoDecodeStats& stats);
     bool addOutput(const std::string& outStreamID
             , const std::string& codec
             , const owt_base::VideoCodecProfile profile
@@ -8,6 +8,7 @@
 
 #include "VideoMixerWrapper.h"
 #include "VideoLayout.h"
+#include <VCMFrameDecoder.h>
 
 using namespace v8;
 
@@ -49,6 +50,7 @@ void VideoMixer::Init(Local<Object> exports, Local<Object> module) {
   NODE_SET_PROTOTYPE_METHOD(tpl, "addInput", addInput);
   NODE_SET_PROTOTYPE_METHOD(tpl, "removeInput", removeInput);
   NODE_SET_PROTOTYPE_METHOD(tpl, "setInputActive", setInputActive);
+  NODE_SET_PROTOTYPE_METHOD(tpl, "getDecodeStats", getDecodeStats);
   NODE_SET_PROTOTYPE_METHOD(tpl, "addOutput", addOutput);
   NODE_SET_PROTOTYPE_METHOD(tpl, "removeOutput", removeOutput);
   NODE_SET_PROTOTYPE_METHOD(tpl, "updateLayoutSolution", updateLayoutSolution);
@@ -149,6 +151,32 @@ void VideoMixer::setInputActive(const v8::FunctionCallbackInfo<v8::Value>& args)
   me->setInputActive(inputIndex, active);
 }
 
+void VideoMixer::getDecodeStats(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  Isolate* isolate = Isolate::GetCurrent();
+  HandleScope scope(isolate);
+
+  VideoMixer* obj = ObjectWrap::Unwrap<VideoMixer>(args.Holder());
+  mcu::VideoMixer* me = obj->me;
+
+  int inputIndex = Nan::To<int32_t>(args[0]).FromJust();
+
+  owt_base::VideoDecodeStats stats;
+  if (!me->getDecodeStats(inputIndex, stats)) {
+    return;
+  }
+
+  Local<Object> result = Nan::New<Object>();
+  Nan::Set(result, Nan::New("decodedFrames").ToLocalChecked(),
+           Nan::New(static_cast<double>(stats.decodedFrames)));
+  Nan::Set(result, Nan::New("droppedFrames").ToLocalChecked(),
+           Nan::New(static_cast<double>(stats.droppedFrames)));
+  Nan::Set(result, Nan::New("decodeTimeP50Us").ToLocalChecked(), Nan::New(stats.decodeTimeP50Us));
+  Nan::Set(result, Nan::New("decodeTimeP99Us").ToLocalChecked(), Nan::New(stats.decodeTimeP99Us));
+  Nan::Set(result, Nan::New("queueWaitP50Us").ToLocalChecked(), Nan::New(stats.queueWaitP50Us));
+  Nan::Set(result, Nan::New("queueWaitP99Us").ToLocalChecked(), Nan::New(stats.queueWaitP99Us));
+  args.GetReturnValue().Set(result);
+}
+
 void VideoMixer::addOutput(const v8::FunctionCallbackInfo<v8::Value>& args) {
   Isolate* isolate = Isolate::GetCurrent();
   HandleScope scope(isolate);
@@ -5,11 +5,13 @@
       '../addon.cc',
       '../VideoMixerWrapper.cc',
       '../SoftVideoCompositor.cpp',
+      '../CompositeWorkerPool.cpp',
       '../VideoMixer.cpp',
       '../../../../core/owt_base/I420BufferManager.cpp',
       '../../../../core/owt_base/MediaFramePipeline.cpp',
       '../../../../core/owt_base/FrameConverter.cpp',
       '../../../../core/owt_base/VCMFrameDecoder.cpp',
+      '../../../../core/owt_base/VideoDecodeExecutor.cpp',
       '../../../../core/owt_base/VCMFrameEncoder.cpp',
       '../../../../core/owt_base/FFmpegFrameDecoder.cpp',
       '../../../../core/owt_base/FFmpegDrawText.cpp',
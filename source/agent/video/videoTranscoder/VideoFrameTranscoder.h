@@ -7,6 +7,9 @@
 
 #include "VideoHelper.h"
 #include <MediaFramePipeline.h>
+#ifdef BUILD_FOR_ANALYTICS
+#include <FrameAnalyzer.h>
+#endif
 
 namespace mcu {
 
@@ -34,7 +37,8 @@ public:
             const unsigned int keyFrameIntervalSeconds,
             const std::string& algorithm,
             const std::string& pluginName,
-            owt_base::FrameDestination*) = 0;
+            owt_base::FrameDestination*,
+            owt_base::FrameAnalyzer::MetadataListener*) = 0;
 #endif
     virtual void removeOutput(int output) = 0;
 
@@ -9,6 +9,7 @@
 #include <boost/shared_ptr.hpp>
 #include <boost/thread/shared_mutex.hpp>
 #include <map>
+#include <vector>
 #include <MediaUtilities.h>
 #include <MediaFramePipeline.h>
 #include <VideoFrameTranscoder.h>
@@ -61,7 +62,8 @@ public:
             const unsigned int keyFrameIntervalSeconds,
             const std::string& algorithm,
             const std::string& pluginName,
-            owt_base::FrameDestination*);
+            owt_base::FrameDestination*,
+            owt_base::FrameAnalyzer::MetadataListener*);
 #endif
     void removeOutput(int output);
 
@@ -79,6 +81,31 @@ private:
         boost::shared_ptr<owt_base::VideoFrameDecoder> decoder;
     };
 
+    // One processer per distinct (format, size, frame rate), shared by all
+    // outputs asking for it. Untimed scalers form a tree, each fed from the
+    // smallest larger one or from the decoded input, so each target size is
+    // scaled once per frame. A timed scaler is a leaf fed from the untimed
+    // scaler of its size, which it holds a reference to, so frame rates are
+    // only applied at the leaves on frames scaled already. While text is
+    // drawn, all of them are fed from the decoded input, so frames are not
+    // drawn on twice.
+    struct Scaler {
+        boost::shared_ptr<owt_base::VideoFrameProcesser> processer;
+        owt_base::FrameFormat format;
+        uint32_t width;
+        uint32_t height;
+        uint32_t frameRate;
+        // The untimed scaler of the same size feeding a timed one
+        boost::shared_ptr<Scaler> base;
+        owt_base::FrameSource* parent;
+        int refCount;
+    };
+
+    boost::shared_ptr<Scaler> getScaler(owt_base::FrameFormat format, uint32_t width, uint32_t height, uint32_t frameRate);
+    void releaseScaler(const boost::shared_ptr<owt_base::VideoFrameProcesser>& processer);
+    bool canFeed(const Scaler& from, const Scaler& to);
+    void rebuildScaleTree();
+
     struct Output {
         boost::shared_ptr<owt_base::VideoFrameProcesser> processer;
 #ifdef BUILD_FOR_ANALYTICS
@@ -92,10 +119,13 @@ private:
     boost::shared_mutex m_inputMutex;
 
     std::map<int, Output> m_outputs;
+    std::vector<boost::shared_ptr<Scaler>> m_scalers;
+    bool m_textEnabled;
     boost::shared_mutex m_outputMutex;
 };
 
 VideoFrameTranscoderImpl::VideoFrameTranscoderImpl()
+    : m_textEnabled(false)
 {
 }
 
@@ -103,8 +133,11 @@ VideoFrameTranscoderImpl::~VideoFrameTranscoderImpl()
 {
     {
         boost::unique_lock<boost::shared_mutex> lock(m_outputMutex);
+        for (auto& scaler : m_scalers)
+            scaler->parent->removeVideoDestination(scaler->processer.get());
+        m_scalers.clear();
+
         for (auto it = m_outputs.begin(); it != m_outputs.end(); ++it) {
-            this->removeVideoDestination(it->second.processer.get());
 #ifdef BUILD_FOR_ANALYTICS
             it->second.processer->removeVideoDestination(it->second.analyzer.get());
             it->second.analyzer->removeVideoDestination(it->second.encoder.get());
@@ -194,11 +227,12 @@ inline bool VideoFrameTranscoderImpl::addOutput(int output,
                                            const unsigned int keyFrameIntervalSeconds,
                                            const std::string& algorithm,
                                            const std::string& pluginName,
-                                           owt_base::FrameDestination* dest)
+                                           owt_base::FrameDestination* dest,
+                                           owt_base::FrameAnalyzer::MetadataListener* metadataListener)
 #endif
 {
     boost::shared_ptr<owt_base::VideoFrameEncoder> encoder;
-    boost::shared_ptr<owt_base::VideoFrameProcesser> processer;
+    boost::shared_ptr<Scaler> scaler;
 #ifdef BUILD_FOR_ANALYTICS
     boost::shared_ptr<owt_base::VideoFrameAnalyzer> analyzer;
 #endif
@@ -226,31 +260,31 @@ inline bool VideoFrameTranscoderImpl::addOutput(int output,
     if (streamId < 0)
         return false;
 
-    if (!processer) {
-        processer.reset(new owt_base::FrameProcesser());
-    }
-
-    if (!processer->init(encoder->getInputFormat(), rootSize.width, rootSize.height, framerateFPS))
+    boost::upgrade_to_unique_lock<boost::shared_mutex> uniqueLock(lock);
+    scaler = getScaler(encoder->getInputFormat(), rootSize.width, rootSize.height, framerateFPS);
+    if (!scaler)
         return false;
 
-    this->addVideoDestination(processer.get());
 #ifdef BUILD_FOR_ANALYTICS
     if (!analyzer) {
-        analyzer.reset(new owt_base::FrameAnalyzer());
+        owt_base::FrameAnalyzer* frameAnalyzer = new owt_base::FrameAnalyzer();
+        frameAnalyzer->setMetadataListener(metadataListener);
+        analyzer.reset(frameAnalyzer);
     }
-    if (!analyzer->init(encoder->getInputFormat(), rootSize.width, rootSize.height, framerateFPS, pluginName))
+    if (!analyzer->init(encoder->getInputFormat(), rootSize.width, rootSize.height, framerateFPS, pluginName)) {
+        releaseScaler(scaler->processer);
         return false;
-    processer->addVideoDestination(analyzer.get());
+    }
+    scaler->processer->addVideoDestination(analyzer.get());
     analyzer->addVideoDestination(encoder.get());
 #else
-    processer->addVideoDestination(encoder.get());
+    scaler->processer->addVideoDestination(encoder.get());
 #endif
 
-    boost::upgrade_to_unique_lock<boost::shared_mutex> uniqueLock(lock);
 #ifdef BUILD_FOR_ANALYTICS
-    Output out{.processer = processer, .analyzer = analyzer, .encoder = encoder, .streamId = streamId};
+    Output out{.processer = scaler->processer, .analyzer = analyzer, .encoder = encoder, .streamId = streamId};
 #else
-    Output out{.processer = processer, .encoder = encoder, .streamId = streamId};
+    Output out{.processer = scaler->processer, .encoder = encoder, .streamId = streamId};
 #endif
     m_outputs[output] = out;
     return true;
@@ -262,8 +296,8 @@ inline void VideoFrameTranscoderImpl::removeOutput(int32_t output)
     auto it = m_outputs.find(output);
     if (it != m_outputs.end()) {
         it->second.encoder->degenerateStream(it->second.streamId);
+        boost::upgrade_to_unique_lock<boost::shared_mutex> ulock(lock);
         if (it->second.encoder->isIdle()) {
-            this->removeVideoDestination(it->second.processer.get());
 #ifdef BUILD_FOR_ANALYTICS
             it->second.processer->removeVideoDestination(it->second.analyzer.get());
             it->second.analyzer->removeVideoDestination(it->second.encoder.get());
@@ -271,11 +305,118 @@ inline void VideoFrameTranscoderImpl::removeOutput(int32_t output)
             it->second.processer->removeVideoDestination(it->second.encoder.get());
 #endif
         }
-        boost::upgrade_to_unique_lock<boost::shared_mutex> ulock(lock);
+        releaseScaler(it->second.processer);
         m_outputs.erase(output);
     }
 }
 
+// Called with m_outputMutex unique locked.
+inline boost::shared_ptr<VideoFrameTranscoderImpl::Scaler> VideoFrameTranscoderImpl::getScaler(
+        owt_base::FrameFormat format, uint32_t width, uint32_t height, uint32_t frameRate)
+{
+    for (auto& scaler : m_scalers) {
+        if (scaler->format == format && scaler->width == width
+                && scaler->height == height && scaler->frameRate == frameRate) {
+            scaler->refCount++;
+            return scaler;
+        }
+    }
+
+    boost::shared_ptr<Scaler> base;
+    if (frameRate) {
+        base = getScaler(format, width, height, 0);
+        if (!base)
+            return boost::shared_ptr<Scaler>();
+    }
+
+    boost::shared_ptr<owt_base::VideoFrameProcesser> processer(new owt_base::FrameProcesser());
+    if (!processer->init(format, width, height, frameRate)) {
+        if (base)
+            releaseScaler(base->processer);
+        return boost::shared_ptr<Scaler>();
+    }
+
+    boost::shared_ptr<Scaler> scaler(new Scaler{
+            .processer = processer, .format = format, .width = width, .height = height,
+            .frameRate = frameRate, .base = base, .parent = nullptr, .refCount = 1});
+    m_scalers.push_back(scaler);
+    rebuildScaleTree();
+    return scaler;
+}
+
+// Called with m_outputMutex unique locked.
+inline void VideoFrameTranscoderImpl::releaseScaler(const boost::shared_ptr<owt_base::VideoFrameProcesser>& processer)
+{
+    for (auto it = m_scalers.begin(); it != m_scalers.end(); ++it) {
+        if ((*it)->processer != processer)
+            continue;
+
+        if (--(*it)->refCount > 0)
+            return;
+
+        // Move its children elsewhere before it stops receiving frames.
+        boost::shared_ptr<Scaler> scaler = *it;
+        m_scalers.erase(it);
+        rebuildScaleTree();
+        scaler->parent->removeVideoDestination(scaler->processer.get());
+        if (scaler->base)
+            releaseScaler(scaler->base->processer);
+        return;
+    }
+}
+
+inline bool VideoFrameTranscoderImpl::canFeed(const Scaler& from, const Scaler& to)
+{
+    // Text is drawn by every scaler on its input.
+    if (m_textEnabled)
+        return false;
+
+    // Timed scalers are leaves, fed from their base.
+    if (from.frameRate || to.frameRate)
+        return false;
+
+    // Zero means the input size, which is not known up front.
+    if (!from.width || !from.height || !to.width || !to.height)
+        return false;
+
+    if (from.format != to.format || from.width < to.width || from.height < to.height)
+        return false;
+
+    // Strictly larger, so that the tree has no cycles.
+    return from.width * from.height > to.width * to.height;
+}
+
+// Called with m_outputMutex unique locked.
+inline void VideoFrameTranscoderImpl::rebuildScaleTree()
+{
+    for (auto& scaler : m_scalers) {
+        owt_base::FrameSource* parent = this;
+        if (scaler->base) {
+            if (!m_textEnabled)
+                parent = scaler->base->processer.get();
+        } else {
+            const Scaler* best = nullptr;
+            for (auto& candidate : m_scalers) {
+                if (!canFeed(*candidate, *scaler))
+                    continue;
+
+                if (!best || candidate->width * candidate->height < best->width * best->height)
+                    best = candidate.get();
+            }
+            if (best)
+                parent = best->processer.get();
+        }
+
+        // Removed first, the scaler would get frames from both parents.
+        if (scaler->parent != parent) {
+            if (scaler->parent)
+                scaler->parent->removeVideoDestination(scaler->processer.get());
+            parent->addVideoDestination(scaler->processer.get());
+            scaler->parent = parent;
+        }
+    }
+}
+
 inline void VideoFrameTranscoderImpl::requestKeyFrame(int output)
 {
     boost::shared_lock<boost::shared_mutex> lock(m_outputMutex);
@@ -287,16 +428,21 @@ inline void VideoFrameTranscoderImpl::requestKeyFrame(int output)
 #ifndef BUILD_FOR_ANALYTICS
 inline void VideoFrameTranscoderImpl::drawText(const std::string& textSpec)
 {
-    boost::shared_lock<boost::shared_mutex> lock(m_outputMutex);
-    for (auto it = m_outputs.begin(); it != m_outputs.end(); ++it)
-        it->second.processer->drawText(textSpec);
+    boost::unique_lock<boost::shared_mutex> lock(m_outputMutex);
+    // Unchain first, a child would draw on its parent's text.
+    m_textEnabled = true;
+    rebuildScaleTree();
+    for (auto& scaler : m_scalers)
+        scaler->processer->drawText(textSpec);
 }
 
 inline void VideoFrameTranscoderImpl::clearText()
 {
-    boost::shared_lock<boost::shared_mutex> lock(m_outputMutex);
-    for (auto it = m_outputs.begin(); it != m_outputs.end(); ++it)
-        it->second.processer->clearText();
+    boost::unique_lock<boost::shared_mutex> lock(m_outputMutex);
+    for (auto& scaler : m_scalers)
+        scaler->processer->clearText();
+    m_textEnabled = false;
+    rebuildScaleTree();
 }
 #endif
 
@@ -7,6 +7,7 @@
 
 #include "VideoTranscoder.h"
 #include "VideoFrameTranscoderImpl.h"
+#include <stdio.h>
 
 using namespace webrtc;
 using namespace owt_base;
@@ -19,6 +20,9 @@ VideoTranscoder::VideoTranscoder(const VideoTranscoderConfig& config)
     : m_inputCount(0)
     , m_maxInputCount(1)
     , m_nextOutputIndex(0)
+#ifdef BUILD_FOR_ANALYTICS
+    , m_asyncHandle(nullptr)
+#endif
 {
     if (ELOG_IS_TRACE_ENABLED()) {
         rtc::LogMessage::LogToDebug(rtc::LS_VERBOSE);
@@ -155,9 +159,11 @@ bool VideoTranscoder::addOutput(
     owt_base::FrameFormat format = getFormat(codec);
     VideoSize vSize{0, 0};
     VideoResolutionHelper::getVideoSize(resolution, vSize);
-    if (m_frameTranscoder->addOutput(m_nextOutputIndex, format, profile, vSize, framerateFPS, bitrateKbps, keyFrameIntervalSeconds, algorithm, pluginName, dest)) {
+    boost::shared_ptr<MetadataNotifier> notifier(new MetadataNotifier(this, outStreamID));
+    if (m_frameTranscoder->addOutput(m_nextOutputIndex, format, profile, vSize, framerateFPS, bitrateKbps, keyFrameIntervalSeconds, algorithm, pluginName, dest, notifier.get())) {
         boost::unique_lock<boost::shared_mutex> lock(m_outputsMutex);
         m_outputs[outStreamID] = m_nextOutputIndex++;
+        m_metadataNotifiers[outStreamID] = notifier;
         return true;
     }
     return false;
@@ -178,6 +184,11 @@ void VideoTranscoder::removeOutput(const std::string& outStreamID)
     if (index != -1) {
         m_frameTranscoder->removeOutput(index);
     }
+#ifdef BUILD_FOR_ANALYTICS
+    // The analyzer of the output is gone, so is any caller of its notifier.
+    lock.lock();
+    m_metadataNotifiers.erase(outStreamID);
+#endif
 }
 
 void VideoTranscoder::forceKeyFrame(const std::string& outStreamID)
@@ -204,6 +215,45 @@ void VideoTranscoder::clearText()
 {
     m_frameTranscoder->clearText();
 }
+#else
+void VideoTranscoder::setEventRegistry(EventRegistry* handle)
+{
+    m_asyncHandle = handle;
+}
+
+static std::string jsonString(const std::string& value)
+{
+    std::string escaped = "\"";
+    for (char c : value) {
+        switch (c) {
+        case '"':
+            escaped += "\\\"";
+            break;
+        case '\\':
+            escaped += "\\\\";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char code[8];
+                snprintf(code, sizeof(code), "\\u%04x", c);
+                escaped += code;
+            } else {
+                escaped += c;
+            }
+        }
+    }
+    return escaped + "\"";
+}
+
+void VideoTranscoder::MetadataNotifier::onAnalyticsMetadata(uint32_t timeStamp, const std::string& metadata)
+{
+    EventRegistry* handle = m_owner->m_asyncHandle;
+    if (handle) {
+        handle->notifyAsyncEvent("metadata", "{\"id\":" + jsonString(m_outStreamID)
+            + ",\"timestamp\":" + std::to_string(timeStamp)
+            + ",\"metadata\":" + jsonString(metadata) + "}");
+    }
+}
 #endif
 
 void VideoTranscoder::closeAll()
@@ -12,6 +12,9 @@
 
 #include "MediaFramePipeline.h"
 #include "VideoFrameTranscoder.h"
+#ifdef BUILD_FOR_ANALYTICS
+#include <EventRegistry.h>
+#endif
 
 namespace mcu {
 
@@ -56,6 +59,9 @@ public:
 #ifndef BUILD_FOR_ANALYTICS
     void drawText(const std::string& textSpec);
     void clearText();
+#else
+    // The analytics metadata of the outputs is notified as "metadata" events.
+    void setEventRegistry(EventRegistry* handle);
 #endif
 
 protected:
@@ -63,6 +69,23 @@ protected:
     void closeAll();
 
 private:
+#ifdef BUILD_FOR_ANALYTICS
+    // Notifies the metadata of one output's analyzer, on plugin threads.
+    class MetadataNotifier : public owt_base::FrameAnalyzer::MetadataListener {
+    public:
+        MetadataNotifier(VideoTranscoder* owner, const std::string& outStreamID)
+            : m_owner(owner)
+            , m_outStreamID(outStreamID)
+        {
+        }
+        void onAnalyticsMetadata(uint32_t timeStamp, const std::string& metadata);
+
+    private:
+        VideoTranscoder* m_owner;
+        std::string m_outStreamID;
+    };
+#endif
+
     uint32_t m_inputCount;
     uint32_t m_maxInputCount;
     uint32_t m_nextOutputIndex;
@@ -73,6 +96,11 @@ private:
 
     boost::shared_mutex m_outputsMutex;
     std::map<std::string, int32_t> m_outputs;
+#ifdef BUILD_FOR_ANALYTICS
+    EventRegistry* m_asyncHandle;
+    // Outlive the analyzers of m_frameTranscoder, which call them.
+    std::map<std::string, boost::shared_ptr<MetadataNotifier>> m_metadataNotifiers;
+#endif
 
     boost::shared_ptr<VideoFrameTranscoder> m_frameTranscoder;
 };
@@ -35,6 +35,8 @@ void VideoTranscoder::Init(Local<Object> exports, Local<Object> module) {
 #ifndef BUILD_FOR_ANALYTICS
   NODE_SET_PROTOTYPE_METHOD(tpl, "drawText", drawText);
   NODE_SET_PROTOTYPE_METHOD(tpl, "clearText", clearText);
+#else
+  NODE_SET_PROTOTYPE_METHOD(tpl, "addEventListener", addEventListener);
 #endif
 
   constructor.Reset(isolate, Nan::GetFunction(tpl).ToLocalChecked());
@@ -55,6 +57,9 @@ void VideoTranscoder::New(const v8::FunctionCallbackInfo<v8::Value>& args) {
 
   VideoTranscoder* obj = new VideoTranscoder();
   obj->me = new mcu::VideoTranscoder(config);
+#ifdef BUILD_FOR_ANALYTICS
+  obj->me->setEventRegistry(obj);
+#endif
 
   obj->Wrap(args.This());
   args.GetReturnValue().Set(args.This());
@@ -200,3 +205,17 @@ void VideoTranscoder::clearText(const v8::FunctionCallbackInfo<v8::Value>& args)
 }
 #endif
 
+#ifdef BUILD_FOR_ANALYTICS
+void VideoTranscoder::addEventListener(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  Isolate* isolate = Isolate::GetCurrent();
+  HandleScope scope(isolate);
+  if (args.Length() < 2 || !args[0]->IsString() || !args[1]->IsFunction()) {
+    Nan::ThrowError("Wrong arguments");
+    return;
+  }
+  VideoTranscoder* obj = ObjectWrap::Unwrap<VideoTranscoder>(args.Holder());
+  if (!obj->me)
+    return;
+  Nan::Set(Local<Object>::New(isolate, obj->m_store), args[0], args[1]);
+}
+#endif
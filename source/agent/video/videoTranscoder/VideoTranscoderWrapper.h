@@ -6,6 +6,9 @@
 #define VideoTranscoderWRAPPER_H
 
 #include "../../addons/common/MediaFramePipelineWrapper.h"
+#ifdef BUILD_FOR_ANALYTICS
+#include "../../addons/common/NodeEventRegistry.h"
+#endif
 #include "VideoTranscoder.h"
 #include <node.h>
 #include <node_object_wrap.h>
@@ -15,7 +18,11 @@
 /*
  * Wrapper class of mcu::VideoTranscoder
  */
+#ifdef BUILD_FOR_ANALYTICS
+class VideoTranscoder : public node::ObjectWrap, public NodeEventRegistry {
+#else
 class VideoTranscoder : public node::ObjectWrap {
+#endif
  public:
   static void Init(v8::Local<v8::Object>, v8::Local<v8::Object>);
   mcu::VideoTranscoder* me;
@@ -38,6 +45,9 @@ class VideoTranscoder : public node::ObjectWrap {
   static void drawText(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void clearText(const v8::FunctionCallbackInfo<v8::Value>& args);
 #endif
+#ifdef BUILD_FOR_ANALYTICS
+  static void addEventListener(const v8::FunctionCallbackInfo<v8::Value>& args);
+#endif
 };
 
 #endif
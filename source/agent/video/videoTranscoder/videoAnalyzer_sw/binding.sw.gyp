@@ -5,11 +5,14 @@
       '../addon.cc',
       '../VideoTranscoderWrapper.cc',
       '../VideoTranscoder.cpp',
+      '../../../addons/common/NodeEventRegistry.cc',
+      '../../../addons/common/NodeEventDispatcher.cc',
       '../../../../core/owt_base/MediaFramePipeline.cpp',
       '../../../../core/owt_base/FrameConverter.cpp',
       '../../../../core/owt_base/FrameAnalyzer.cpp',
       '../../../../core/owt_base/I420BufferManager.cpp',
       '../../../../core/owt_base/VCMFrameDecoder.cpp',
+      '../../../../core/owt_base/VideoDecodeExecutor.cpp',
       '../../../../core/owt_base/VCMFrameEncoder.cpp',
       '../../../../core/owt_base/FFmpegFrameDecoder.cpp',
       '../../../../core/owt_base/FrameProcesser.cpp',
@@ -0,0 +1,115 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// Sample version 2 analytics plugin. It annotates every frame with its
+// average luma and sends the pushed frame back as is, so no pixel is copied.
+// A plugin producing pixels would instead fill a frame from AllocateFrame()
+// and send that one.
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "AnalyticsPlugin.h"
+
+using owt::analytics::AnalyticsFrame;
+using owt::analytics::AnalyticsPlane;
+
+class LumaPlugin : public rvaPluginV2 {
+public:
+    LumaPlugin()
+        : m_callback(nullptr)
+        , m_closed(false)
+        , m_worker(&LumaPlugin::run, this)
+    {
+    }
+
+    ~LumaPlugin()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_closed = true;
+            m_cond.notify_one();
+        }
+        m_worker.join();
+        for (auto frame : m_frames) {
+            frame->Release();
+        }
+    }
+
+    rvaStatus PluginInit(std::unordered_map<std::string, std::string> params) override { return RVA_ERR_OK; }
+    rvaStatus PluginClose() override { return RVA_ERR_OK; }
+    rvaStatus GetPluginParams(std::unordered_map<std::string, std::string>& params) override { return RVA_ERR_OK; }
+    rvaStatus SetPluginParams(std::unordered_map<std::string, std::string> params) override { return RVA_ERR_OK; }
+
+    rvaStatus ProcessFrameAsync(AnalyticsFrame* frame) override
+    {
+        if (!frame) {
+            return RVA_ERR_NULL_PTR;
+        }
+        frame->AddRef();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_frames.push_back(frame);
+        m_cond.notify_one();
+        return RVA_ERR_OK;
+    }
+
+    rvaStatus RegisterFrameCallback(rvaFrameCallbackV2* callback) override
+    {
+        // Waits for a frame in process, no callback is made after unregistering
+        std::lock_guard<std::mutex> lock(m_callbackMutex);
+        m_callback = callback;
+        return RVA_ERR_OK;
+    }
+
+private:
+    void run()
+    {
+        while (true) {
+            AnalyticsFrame* frame;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_cond.wait(lock, [this] { return m_closed || !m_frames.empty(); });
+                if (m_closed) {
+                    return;
+                }
+                frame = m_frames.front();
+                m_frames.pop_front();
+            }
+            process(frame);
+            frame->Release();
+        }
+    }
+
+    void process(AnalyticsFrame* frame)
+    {
+        AnalyticsPlane y = frame->Plane(0);
+        uint64_t sum = 0;
+        for (int row = 0; row < y.height; row++) {
+            const uint8_t* line = y.data + row * y.stride;
+            for (int col = 0; col < y.width; col++) {
+                sum += line[col];
+            }
+        }
+        int luma = (y.width && y.height) ? (int)(sum / ((uint64_t)y.width * y.height)) : 0;
+        std::string metadata = "{\"luma\":" + std::to_string(luma) + "}";
+
+        std::lock_guard<std::mutex> lock(m_callbackMutex);
+        if (m_callback) {
+            m_callback->OnPluginFrame(frame, metadata);
+        }
+    }
+
+    std::mutex m_callbackMutex;
+    rvaFrameCallbackV2* m_callback;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::deque<AnalyticsFrame*> m_frames;
+    bool m_closed;
+    std::thread m_worker;
+};
+
+DECLARE_PLUGIN_V2(LumaPlugin)
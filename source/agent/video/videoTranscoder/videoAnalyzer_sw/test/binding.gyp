@@ -0,0 +1,52 @@
+{
+  'target_defaults': {
+    'cflags_cc': [
+        '-Wall',
+        '-O$(OPTIMIZATION_LEVEL)',
+        '-g',
+        '-std=c++11',
+        '-DWEBRTC_POSIX',
+    ],
+    'cflags_cc!': [
+        '-fno-exceptions',
+    ],
+    'include_dirs': [
+        '../../../../../core/common',
+        '../../../../../core/owt_base',
+        '$(CORE_HOME)/../../third_party/webrtc/src',
+        '$(CORE_HOME)/../../third_party/webrtc/src/third_party/libyuv/include',
+        '$(DEFAULT_DEPENDENCY_PATH)/include',
+        '$(CUSTOM_INCLUDE_PATH)',
+    ],
+  },
+  'targets': [{
+    # Run frameAnalyzerTest with the directory of liblumaPlugin.so in LD_LIBRARY_PATH
+    'target_name': 'lumaPlugin',
+    'type': 'shared_library',
+    'sources': [
+      '../samples/LumaPlugin.cc',
+    ],
+    'libraries': [
+      '-pthread',
+    ],
+  }, {
+    'target_name': 'frameAnalyzerTest',
+    'type': 'executable',
+    'sources': [
+      '../../../../../core/owt_base/FrameAnalyzerTest.cpp',
+      '../../../../../core/owt_base/FrameAnalyzer.cpp',
+      '../../../../../core/owt_base/FrameConverter.cpp',
+      '../../../../../core/owt_base/I420BufferManager.cpp',
+      '../../../../../core/owt_base/MediaFramePipeline.cpp',
+      '../../../../../core/common/JobTimer.cpp',
+    ],
+    'libraries': [
+      '-lboost_thread',
+      '-lboost_system',
+      '-llog4cxx',
+      '-lboost_unit_test_framework',
+      '-ldl',
+      '-L$(CORE_HOME)/../../third_party/webrtc', '-lwebrtc',
+    ],
+  }]
+}
@@ -9,6 +9,7 @@
       '../../../../core/owt_base/FrameConverter.cpp',
       '../../../../core/owt_base/I420BufferManager.cpp',
       '../../../../core/owt_base/VCMFrameDecoder.cpp',
+      '../../../../core/owt_base/VideoDecodeExecutor.cpp',
       '../../../../core/owt_base/VCMFrameEncoder.cpp',
       '../../../../core/owt_base/FFmpegFrameDecoder.cpp',
       '../../../../core/owt_base/FrameProcesser.cpp',
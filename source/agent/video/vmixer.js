@@ -198,6 +198,7 @@ function VMixer(rpcClient, clusterIP, VideoMixer, router, streamingEmitter) {
         view,
 
         drawing_text_tmr,
+        decode_stats_tmr,
 
         motion_factor = 0.8,
         default_resolution = {width: 640, height: 480},
@@ -384,6 +385,20 @@ function VMixer(rpcClient, clusterIP, VideoMixer, router, streamingEmitter) {
         });
     };
 
+    var reportDecodeStats = function () {
+        const stats = {};
+        for (let stream_id of inputManager.getStreamList()) {
+            if (!inputManager.isPending(stream_id)) {
+                // Undefined for inputs not decoded by VCMFrameDecoder
+                const decodeStats = engine.getDecodeStats(inputManager.get(stream_id).id);
+                if (decodeStats) {
+                    stats[stream_id] = decodeStats;
+                }
+            }
+        }
+        log.debug('Video decode stats:', JSON.stringify(stats));
+    };
+
     that.initialize = function (videoConfig, belongTo, layoutcontroller, mixView, callback) {
         log.debug('initEngine, videoConfig:', JSON.stringify(videoConfig));
         log.debug('res:', resolution2String(videoConfig.parameters.resolution));
@@ -400,6 +415,11 @@ function VMixer(rpcClient, clusterIP, VideoMixer, router, streamingEmitter) {
 
         inputManager = new InputManager(videoConfig.maxInput);
         engine = new VideoMixer(config);
+        const decodeStatsInterval = global.config.video.decode_stats_interval;
+        if (decodeStatsInterval > 0 && typeof engine.getDecodeStats === 'function') {
+            decode_stats_tmr = setInterval(reportDecodeStats, decodeStatsInterval * 1000);
+            decode_stats_tmr.unref();
+        }
         layoutProcessor = new LayoutProcessor(videoConfig.layout.templates);
         layoutProcessor.on('error', function (e) {
             log.warn('layout error:', e);
@@ -447,6 +467,10 @@ function VMixer(rpcClient, clusterIP, VideoMixer, router, streamingEmitter) {
           clearTimeout(drawing_text_tmr);
           drawing_text_tmr = undefined;
         }
+        if (decode_stats_tmr) {
+          clearInterval(decode_stats_tmr);
+          decode_stats_tmr = undefined;
+        }
 
         for (var stream_id in outputs) {
             removeOutput(stream_id);
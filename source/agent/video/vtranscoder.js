@@ -21,7 +21,7 @@ const gaccPluginEnabled = global.config.video.enableBetterHEVCQuality || false;
 const MFE_timeout = global.config.video.MFE_timeout || 0;
 const supported_codecs = global.config.video.codecs;
 
-function VTranscoder(rpcClient, clusterIP, VideoTranscoder, router) {
+function VTranscoder(rpcClient, clusterIP, VideoTranscoder, router, streamingEmitter) {
     var that = {},
         engine,
         controller,
@@ -168,6 +168,28 @@ function VTranscoder(rpcClient, clusterIP, VideoTranscoder, router) {
         controller = ctrlr;
 
         engine = new VideoTranscoder(config);
+        if (typeof engine.addEventListener === 'function') {
+            // Only the analyzer build of the engine has plugins reporting metadata
+            engine.addEventListener('metadata', function (data) {
+                let result;
+                try {
+                    result = JSON.parse(data);
+                } catch (e) {
+                    log.warn('Invalid analytics metadata:', data);
+                    return;
+                }
+                if (!outputs[result.id]) {
+                    return;
+                }
+                log.debug('analytics metadata, stream_id:', result.id, 'timestamp:', result.timestamp);
+                if (streamingEmitter) {
+                    streamingEmitter.emit('notification', {
+                        name: 'onAnalyticsMetadata',
+                        data: result
+                    });
+                }
+            });
+        }
 
         motion_factor = (motionFactor || 1.0);
         log.debug('Video transcoding engine init OK, supported_codecs:', supported_codecs);
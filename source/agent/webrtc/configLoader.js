@@ -57,6 +57,8 @@ module.exports.load = () => {
     config.webrtc.num_workers = config.webrtc.num_workers || 24;
     config.webrtc.use_nicer = config.webrtc.use_nicer || false;
     config.webrtc.io_workers = config.webrtc.io_workers || 8;
+    config.webrtc.rtc_task_queues = config.webrtc.rtc_task_queues || 4;
+    config.webrtc.stream_stats_interval = config.webrtc.stream_stats_interval || 0;
     config.webrtc.network_interfaces = config.webrtc.network_interfaces || [];
 
     config.webrtc.network_interfaces.forEach(item => {
@@ -49,6 +49,7 @@ const CONN_FAILED         = 500;
 const WARN_BAD_CONNECTION = 502;
 
 const mediaConfig = require('./mediaConfig');
+const streamStats = require('./streamStats').get(addon);
 
 class Connection extends EventEmitter {
   constructor (id, threadPool, ioThreadPool, options = {}) {
@@ -115,9 +116,19 @@ class Connection extends EventEmitter {
     mediaStream.onMediaStreamEvent((type, message) => {
       this._onMediaStreamEvent(type, message, mediaStream.id);
     });
+    if (streamStats) {
+      mediaStream.statsSource = streamStats.add(mediaStream);
+    }
     return mediaStream;
   }
 
+  _closeMediaStream(mediaStream) {
+    if (streamStats) {
+      streamStats.remove(mediaStream.statsSource);
+    }
+    mediaStream.close();
+  }
+
   _onMediaStreamEvent(type, message, mediaStreamId) {
     let streamEvent = {
       type: type,
@@ -223,7 +234,7 @@ class Connection extends EventEmitter {
   removeMediaStream(id) {
     if (this.mediaStreams.get(id) !== undefined) {
       this.wrtc.removeMediaStream(id);
-      this.mediaStreams.get(id).close();
+      this._closeMediaStream(this.mediaStreams.get(id));
       this.mediaStreams.delete(id);
       log.debug(`removed mediaStreamId ${id}, remaining size ${this.getNumMediaStreams()}`);
       // this._maybeSendAnswer(CONN_SDP, id, true);
@@ -279,7 +290,7 @@ class Connection extends EventEmitter {
     this.mediaStreams.forEach((mediaStream, id) => {
       log.debug(`message: Closing mediaStream, connectionId : ${this.id}, `+
         `mediaStreamId: ${id}`);
-      mediaStream.close();
+      this._closeMediaStream(mediaStream);
     });
     this.wrtc.close();
     delete this.mediaStreams;
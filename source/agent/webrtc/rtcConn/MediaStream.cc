@@ -77,17 +77,31 @@ void StatCallWorker::HandleOKCallback() {
   callback->Call(1, argv, async_resource);
 }
 
-void destroyAsyncHandle(uv_handle_t *handle) {
-  delete handle;
+// Flattens the numeric members of an erizo stats report, grouped by SSRC. Members of other groups are keyed by path.
+static void flattenStats(const json& report, uint32_t group, const std::string& prefix,
+                         std::vector<NodeEventDispatcher::StatsValue>& values) {
+  for (json::const_iterator item = report.begin(); item != report.end(); ++item) {
+    std::string key = prefix.empty() ? item.key() : prefix + "." + item.key();
+    if (item.value().is_object()) {
+      if (prefix.empty() && !item.key().empty() &&
+          item.key().find_first_not_of("0123456789") == std::string::npos) {
+        flattenStats(item.value(), std::stoul(item.key()), "", values);
+      } else {
+        flattenStats(item.value(), group, key, values);
+      }
+    } else if (item.value().is_number() || item.value().is_boolean()) {
+      double value = item.value().is_boolean() ? item.value().get<bool>() : item.value().get<double>();
+      values.push_back({group, NodeEventDispatcher::instance()->statsKey(key), value});
+    }
+  }
 }
 
 Nan::Persistent<Function> MediaStream::constructor;
 
-MediaStream::MediaStream() : closed_{false}, id_{"undefined"} {
-  async_stats_ = new uv_async_t;
-  async_event_ = new uv_async_t;
-  uv_async_init(uv_default_loop(), async_stats_, &MediaStream::statsCallback);
-  uv_async_init(uv_default_loop(), async_event_, &MediaStream::eventCallback);
+MediaStream::MediaStream()
+    : dispatcher_id_{NodeEventDispatcher::instance()->addListener(this)},
+      has_event_callback_{false}, has_stats_callback_{false}, has_binary_stats_{false},
+      closed_{false}, id_{"undefined"} {
 }
 
 MediaStream::~MediaStream() {
@@ -109,17 +123,10 @@ void MediaStream::close() {
     me.reset();
   }
   has_stats_callback_ = false;
+  has_binary_stats_ = false;
   has_event_callback_ = false;
-  if (!uv_is_closing(reinterpret_cast<uv_handle_t*>(async_stats_))) {
-    ELOG_DEBUG("%s, message: Closing Stats handle", toLog());
-    uv_close(reinterpret_cast<uv_handle_t*>(async_stats_), destroyAsyncHandle);
-  }
-  async_stats_ = nullptr;
-  if (!uv_is_closing(reinterpret_cast<uv_handle_t*>(async_event_))) {
-    ELOG_DEBUG("%s, message: Closing MediaStreamEvent handle", toLog());
-    uv_close(reinterpret_cast<uv_handle_t*>(async_event_), destroyAsyncHandle);
-  }
-  async_event_ = nullptr;
+  // Pending events and stats are dropped.
+  NodeEventDispatcher::instance()->removeListener(dispatcher_id_);
   closed_ = true;
   ELOG_DEBUG("%s, message: Closed", toLog());
 }
@@ -401,12 +408,17 @@ NAN_METHOD(MediaStream::getStats) {
 
 NAN_METHOD(MediaStream::getPeriodicStats) {
   MediaStream* obj = Nan::ObjectWrap::Unwrap<MediaStream>(info.Holder());
-  if (obj->me == nullptr || info.Length() != 1) {
+  if (obj->me == nullptr || info.Length() > 1) {
     return;
   }
+  if (info.Length() == 1) {
+    obj->has_stats_callback_ = true;
+    obj->stats_callback_ = new Nan::Callback(info[0].As<Function>());
+  } else {
+    obj->has_binary_stats_ = true;
+  }
   obj->me->setMediaStreamStatsListener(obj);
-  obj->has_stats_callback_ = true;
-  obj->stats_callback_ = new Nan::Callback(info[0].As<Function>());
+  info.GetReturnValue().Set(Nan::New(obj->dispatcher_id_));
 }
 
 NAN_METHOD(MediaStream::setFeedbackReports) {
@@ -433,62 +445,43 @@ NAN_METHOD(MediaStream::onMediaStreamEvent) {
 }
 
 void MediaStream::notifyStats(const std::string& message) {
-  if (!this->has_stats_callback_) {
-    return;
-  }
-  if (!async_stats_) {
-    return;
+  if (has_binary_stats_) {
+    // Parsing and flattening cost more than the report, skip rate limited ones
+    if (!NodeEventDispatcher::instance()->acceptStats(dispatcher_id_)) {
+      return;
+    }
+    std::vector<NodeEventDispatcher::StatsValue> values;
+    json report = json::parse(message, nullptr, false);
+    if (report.is_object()) {
+      flattenStats(report, 0, "", values);
+    }
+    NodeEventDispatcher::instance()->postStats(dispatcher_id_, values);
+  } else if (has_stats_callback_) {
+    NodeEventDispatcher::instance()->postStats(dispatcher_id_, message);
   }
-  boost::mutex::scoped_lock lock(mutex);
-  this->stats_messages.push(message);
-  async_stats_->data = this;
-  uv_async_send(async_stats_);
 }
 
 void MediaStream::notifyMediaStreamEvent(const std::string& type, const std::string& message) {
   if (!this->has_event_callback_) {
     return;
   }
-  if (!async_event_) {
-    return;
-  }
-  boost::mutex::scoped_lock lock(mutex);
-  this->event_messages.push(std::make_pair(type, message));
-  async_event_->data = this;
-  uv_async_send(async_event_);
+  NodeEventDispatcher::instance()->post(dispatcher_id_, type, message);
 }
 
-NAUV_WORK_CB(MediaStream::statsCallback) {
+void MediaStream::onDispatchedStats(const char* data, size_t length) {
   Nan::HandleScope scope;
-  MediaStream* obj = reinterpret_cast<MediaStream*>(async->data);
-  if (!obj || !obj->me) {
+  if (!me || !has_stats_callback_) {
     return;
   }
-  boost::mutex::scoped_lock lock(obj->mutex);
-  if (obj->has_stats_callback_) {
-    while (!obj->stats_messages.empty()) {
-      Local<Value> args[] = {Nan::New(obj->stats_messages.front().c_str()).ToLocalChecked()};
-      obj->asyncResource_->runInAsyncScope(Nan::GetCurrentContext()->Global(), obj->stats_callback_->GetFunction(), 1, args);
-      obj->stats_messages.pop();
-    }
-  }
+  Local<Value> args[] = {Nan::New(data, length).ToLocalChecked()};
+  asyncResource_->runInAsyncScope(Nan::GetCurrentContext()->Global(), stats_callback_->GetFunction(), 1, args);
 }
 
-NAUV_WORK_CB(MediaStream::eventCallback) {
+void MediaStream::onDispatchedEvent(const std::string& event, const char* data, size_t length) {
   Nan::HandleScope scope;
-  MediaStream* obj = reinterpret_cast<MediaStream*>(async->data);
-  if (!obj || !obj->me) {
+  if (!me || !has_event_callback_) {
     return;
   }
-  boost::mutex::scoped_lock lock(obj->mutex);
-  ELOG_DEBUG("%s, message: eventsCallback", obj->toLog());
-  if (obj->has_event_callback_) {
-      while (!obj->event_messages.empty()) {
-          Local<Value> args[] = {Nan::New(obj->event_messages.front().first.c_str()).ToLocalChecked(),
-              Nan::New(obj->event_messages.front().second.c_str()).ToLocalChecked()};
-          obj->asyncResource_->runInAsyncScope(Nan::GetCurrentContext()->Global(), obj->event_callback_->GetFunction(), 2, args);
-          obj->event_messages.pop();
-      }
-  }
-  ELOG_DEBUG("%s, message: eventsCallback finished", obj->toLog());
+  Local<Value> args[] = {Nan::New(event).ToLocalChecked(), Nan::New(data, length).ToLocalChecked()};
+  asyncResource_->runInAsyncScope(Nan::GetCurrentContext()->Global(), event_callback_->GetFunction(), 2, args);
 }
@@ -32,11 +32,11 @@
 #include <nan.h>
 #include <MediaStream.h>
 #include <logger.h>
-#include <queue>
 #include <string>
 #include <future>  // NOLINT
 
 #include "MediaWrapper.h"
+#include "../../addons/common/NodeEventDispatcher.h"
 
 class StatCallWorker : public Nan::AsyncWorker {
  public:
@@ -57,16 +57,13 @@ class StatCallWorker : public Nan::AsyncWorker {
  * A WebRTC Connection. This class represents a MediaStream that can be established with other peers via a SDP negotiation
  * it comprises all the necessary ICE and SRTP components.
  */
-class MediaStream : public MediaFilter, public erizo::MediaStreamStatsListener, public erizo::MediaStreamEventListener {
+class MediaStream : public MediaFilter, public erizo::MediaStreamStatsListener, public erizo::MediaStreamEventListener,
+                    public NodeEventDispatcher::Listener {
  public:
     DECLARE_LOGGER();
     static NAN_MODULE_INIT(Init);
 
     std::shared_ptr<erizo::MediaStream> me;
-    std::queue<std::string> stats_messages;
-    std::queue<std::pair<std::string, std::string>> event_messages;
-
-    boost::mutex mutex;
 
  private:
     MediaStream();
@@ -75,13 +72,15 @@ class MediaStream : public MediaFilter, public erizo::MediaStreamStatsListener,
     void close();
     std::string toLog();
 
+    // Events and stats are delivered to the main thread by the dispatcher shared by all streams.
+    uint32_t dispatcher_id_;
+
     Nan::Callback *event_callback_;
-    uv_async_t *async_event_;
     bool has_event_callback_;
 
     Nan::Callback *stats_callback_;
-    uv_async_t *async_stats_;
     bool has_stats_callback_;
+    bool has_binary_stats_;
     bool closed_;
     std::string id_;
     std::string label_;
@@ -155,11 +154,10 @@ class MediaStream : public MediaFilter, public erizo::MediaStreamStatsListener,
     static NAN_METHOD(getStats);
 
     /*
-     * Gets Stats from this MediaStream
-     * Param: None
-     * Returns: The Current stats
+     * Gets periodic Stats from this MediaStream
      * Param: Callback that will get periodic stats reports
-     * Returns: True if the callback was set successfully
+     * Without a callback, numeric stats go to the listener set by setStatsListener()
+     * Returns: The id of this stream in the stats records
      */
     static NAN_METHOD(getPeriodicStats);
 
@@ -186,12 +184,13 @@ class MediaStream : public MediaFilter, public erizo::MediaStreamStatsListener,
 
     static Nan::Persistent<v8::Function> constructor;
 
-    static NAUV_WORK_CB(statsCallback);
     virtual void notifyStats(const std::string& message);
-
-    static NAUV_WORK_CB(eventCallback);
     virtual void notifyMediaStreamEvent(const std::string& type = "",
         const std::string& message = "");
+
+    // Overrides NodeEventDispatcher::Listener.
+    void onDispatchedEvent(const std::string& event, const char* data, size_t length) override;
+    void onDispatchedStats(const char* data, size_t length) override;
 };
 
 #endif  // MEDIASTREAMWRAPPER_H_
@@ -6,6 +6,7 @@
 #include "ThreadPool.h"
 #include "IOThreadPool.h"
 #include "MediaStream.h"
+#include "../../addons/common/NodeEventDispatcher.h"
 
 #include <dtls/DtlsSocket.h>
 
@@ -19,6 +20,7 @@ void InitAll(Local<Object> exports) {
   MediaStream::Init(exports);
   ThreadPool::Init(exports);
   IOThreadPool::Init(exports);
+  NodeEventDispatcher::Init(exports);
 }
 
 NODE_MODULE(addon, InitAll)
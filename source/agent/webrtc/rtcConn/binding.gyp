@@ -11,6 +11,7 @@
       'ThreadPool.cc',
       'IOThreadPool.cc',
       "MediaStream.cc",
+      '../../addons/common/NodeEventDispatcher.cc',
       'conn_handler/WoogeenHandler.cpp',
       'erizo/src/erizo/DtlsTransport.cpp',
       'erizo/src/erizo/IceConnection.cpp',
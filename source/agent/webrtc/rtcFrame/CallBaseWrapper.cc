@@ -27,6 +27,8 @@ NAN_MODULE_INIT(CallBase::Init) {
   constructor.Reset(Nan::GetFunction(tpl).ToLocalChecked());
   Nan::Set(target, Nan::New("CallBase").ToLocalChecked(),
            Nan::GetFunction(tpl).ToLocalChecked());
+  Nan::SetMethod(target, "setTaskQueuePoolSize", setTaskQueuePoolSize);
+  Nan::SetMethod(target, "getTaskQueueStats", getTaskQueueStats);
 }
 
 NAN_METHOD(CallBase::New) {
@@ -45,3 +47,31 @@ NAN_METHOD(CallBase::close) {
   CallBase* obj = Nan::ObjectWrap::Unwrap<CallBase>(info.Holder());
   obj->rtcAdapter.reset();
 }
+
+NAN_METHOD(CallBase::setTaskQueuePoolSize) {
+  if (info.Length() > 0 && info[0]->IsNumber()) {
+    rtc_adapter::RtcAdapterFactory::SetTaskQueuePoolSize(
+        Nan::To<uint32_t>(info[0]).FromJust());
+  }
+}
+
+NAN_METHOD(CallBase::getTaskQueueStats) {
+  std::vector<rtc_adapter::TaskQueueStats> stats =
+      rtc_adapter::RtcAdapterFactory::GetTaskQueueStats();
+  v8::Local<v8::Array> result = Nan::New<v8::Array>(stats.size());
+  for (size_t i = 0; i < stats.size(); i++) {
+    v8::Local<v8::Object> queue = Nan::New<v8::Object>();
+    Nan::Set(queue, Nan::New("name").ToLocalChecked(),
+             Nan::New(stats[i].name).ToLocalChecked());
+    Nan::Set(queue, Nan::New("index").ToLocalChecked(),
+             Nan::New<v8::Number>(stats[i].index));
+    Nan::Set(queue, Nan::New("users").ToLocalChecked(),
+             Nan::New<v8::Number>(stats[i].users));
+    Nan::Set(queue, Nan::New("tasks").ToLocalChecked(),
+             Nan::New<v8::Number>(stats[i].tasks));
+    Nan::Set(queue, Nan::New("busyUs").ToLocalChecked(),
+             Nan::New<v8::Number>(stats[i].busyUs));
+    Nan::Set(result, i, queue);
+  }
+  info.GetReturnValue().Set(result);
+}
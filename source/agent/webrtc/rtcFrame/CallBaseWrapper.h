@@ -23,6 +23,10 @@ class CallBase : public Nan::ObjectWrap {
   static NAN_METHOD(New);
   static NAN_METHOD(close);
 
+  // Process wide pool of the WebRTC task queues used by all RtcAdapters
+  static NAN_METHOD(setTaskQueuePoolSize);
+  static NAN_METHOD(getTaskQueueStats);
+
   static Nan::Persistent<v8::Function> constructor;
 };
 
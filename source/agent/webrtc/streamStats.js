@@ -0,0 +1,65 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+'use strict';
+
+const logger = require('../logger').logger;
+const log = logger.getLogger('StreamStats');
+
+// Collects the numeric periodic stats of media streams, delivered in batches
+// by the stats listener of the rtcConn addon, and logs them.
+class StreamStats {
+  constructor(addon, interval) {
+    // Map { source id => { id, stats: { group => { key => value } } } }
+    this.streams = new Map();
+    this.keys = [];
+    addon.setStatsListener((records, keys) => this.onStats(records, keys));
+    this.timer = setInterval(() => this.report(), interval * 1000);
+    this.timer.unref();
+  }
+
+  add(mediaStream) {
+    const source = mediaStream.getPeriodicStats();
+    this.streams.set(source, {id: mediaStream.id, stats: {}});
+    return source;
+  }
+
+  remove(source) {
+    this.streams.delete(source);
+  }
+
+  // |records| is a Float64Array of [source, group, key, value] records,
+  // |keys| the names of all keys when new ones were added.
+  onStats(records, keys) {
+    if (keys) {
+      this.keys = keys;
+    }
+    for (let i = 0; i + 3 < records.length; i += 4) {
+      const stream = this.streams.get(records[i]);
+      if (!stream) {
+        continue;
+      }
+      const group = records[i + 1];
+      stream.stats[group] = stream.stats[group] || {};
+      stream.stats[group][this.keys[records[i + 2]]] = records[i + 3];
+    }
+  }
+
+  report() {
+    this.streams.forEach((stream) => {
+      log.debug('Media stream stats:', stream.id, JSON.stringify(stream.stats));
+    });
+  }
+}
+
+let streamStats = null;
+
+// Stats are only collected with a positive webrtc.stream_stats_interval.
+exports.get = function (addon) {
+  const interval = global.config.webrtc.stream_stats_interval;
+  if (!streamStats && interval > 0) {
+    streamStats = new StreamStats(addon, interval);
+  }
+  return streamStats;
+};
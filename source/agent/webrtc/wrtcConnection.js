@@ -6,13 +6,14 @@
 
 const { EventEmitter } = require('events');
 
+const rtcFrame = require('../rtcFrame/build/Release/rtcFrame.node');
 const {
   AudioFrameConstructor,
   AudioFramePacketizer,
   VideoFrameConstructor,
   VideoFramePacketizer,
   CallBase,
-} = require('../rtcFrame/build/Release/rtcFrame.node');
+} = rtcFrame;
 
 const logger = require('../logger').logger;
 const cipher = require('../cipher');
@@ -23,6 +24,8 @@ const { Connection } = require('./connection');
 
 const { SdpInfo } = require('./sdpInfo.js');
 
+require('./rtcTaskQueues').setup(rtcFrame, global.config.webrtc.rtc_task_queues);
+
 /*
  * This class represents a filtered stream
  * with specified SVC layers.
@@ -4,19 +4,51 @@
 
 #include "IOService.h"
 
+#include <algorithm>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
 
 namespace owt_base {
 
-static constexpr uint32_t kServiceNum = 4;
+const uint32_t IOServiceConfig::kMaxDefaultServiceNum;
+
 static boost::mutex g_serviceMutex;
 static std::vector<std::shared_ptr<IOService>> g_services;
 
-IOService::IOService()
+static int64_t clockNs(clockid_t clock)
+{
+    struct timespec ts;
+    if (clock_gettime(clock, &ts) != 0) {
+        return 0;
+    }
+    return int64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+// CPU time of the service thread, readable from other threads
+static int64_t threadCpuNs(boost::thread& thread)
+{
+    clockid_t clock;
+    if (pthread_getcpuclockid(thread.native_handle(), &clock) != 0) {
+        return 0;
+    }
+    return clockNs(clock);
+}
+
+IOService::IOService(int cpu)
     : m_count(0)
     , m_service()
     , m_work(m_service)
     , m_thread(boost::bind(&boost::asio::io_service::run, &m_service))
+    , m_lastSampleWallNs(clockNs(CLOCK_MONOTONIC))
+    , m_lastSampleCpuNs(0)
 {
+    if (cpu >= 0) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(cpu, &cpus);
+        pthread_setaffinity_np(m_thread.native_handle(), sizeof(cpus), &cpus);
+    }
 }
 
 IOService::~IOService()
@@ -35,16 +67,86 @@ void IOService::post(std::function<void()> task)
     });
 }
 
+double IOService::sampleBusyRatio()
+{
+    boost::mutex::scoped_lock lock(m_sampleMutex);
+    int64_t wallNs = clockNs(CLOCK_MONOTONIC);
+    int64_t cpuNs = threadCpuNs(m_thread);
+    double ratio = 0;
+    if (wallNs > m_lastSampleWallNs) {
+        ratio = double(cpuNs - m_lastSampleCpuNs) / (wallNs - m_lastSampleWallNs);
+    }
+    m_lastSampleWallNs = wallNs;
+    m_lastSampleCpuNs = cpuNs;
+    return std::min(std::max(ratio, 0.0), 1.0);
+}
+
+// The cores the process may run on, fewer than the host has under taskset, cpusets or containers
+static std::vector<int> allowedCpus()
+{
+    std::vector<int> cpus;
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &allowed)) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+    return cpus;
+}
+
+static void initServices()
+{
+    const IOServiceConfig& config = IOServiceConfig::defaultConfig();
+    std::vector<int> cpus = allowedCpus();
+    uint32_t cores = cpus.empty() ? std::max(boost::thread::hardware_concurrency(), 1u) : cpus.size();
+    uint32_t serviceNum = config.serviceNum;
+    if (serviceNum == 0) {
+        serviceNum = std::min(cores, IOServiceConfig::kMaxDefaultServiceNum);
+    }
+    for (uint32_t i = 0; i < serviceNum; i++) {
+        int cpu = (config.pinThreads && !cpus.empty()) ? cpus[i % cpus.size()] : -1;
+        g_services.push_back(std::make_shared<IOService>(cpu));
+    }
+}
+
 std::shared_ptr<IOService> getIOService()
 {
     boost::mutex::scoped_lock lock(g_serviceMutex);
     if (g_services.empty()) {
-        for (size_t i = 0; i < kServiceNum; i++) {
-            g_services.push_back(std::make_shared<IOService>());
+        initServices();
+    }
+    // Queued work first, long lived users of an idle service next.
+    // Ties go to the first, so idle services fill up in order.
+    size_t best = 0;
+    int bestCount = g_services[0]->getInProcessCount();
+    long bestUsers = g_services[0].use_count();
+    for (size_t i = 1; i < g_services.size(); i++) {
+        int count = g_services[i]->getInProcessCount();
+        long users = g_services[i].use_count();
+        if (count < bestCount || (count == bestCount && users < bestUsers)) {
+            best = i;
+            bestCount = count;
+            bestUsers = users;
         }
     }
-    int i = std::rand()/((RAND_MAX + 1u)/kServiceNum);
-    return g_services[i];
+    return g_services[best];
+}
+
+std::vector<IOServiceStats> getIOServiceStats()
+{
+    boost::mutex::scoped_lock lock(g_serviceMutex);
+    std::vector<IOServiceStats> stats;
+    for (auto& service : g_services) {
+        IOServiceStats s;
+        s.inProcessCount = service->getInProcessCount();
+        s.userCount = int(service.use_count() - 1);
+        s.busyRatio = service->sampleBusyRatio();
+        stats.push_back(s);
+    }
+    return stats;
 }
 
 }
@@ -10,13 +10,45 @@
 #include <boost/thread/mutex.hpp>
 #include <logger.h>
 #include <memory>
+#include <vector>
 
 namespace owt_base {
 
+struct IOServiceConfig {
+    IOServiceConfig()
+        : serviceNum(0)
+        , pinThreads(false)
+    {}
+
+    // Size of the pool, 0 for the number of CPU cores the process may run on, up to kMaxDefaultServiceNum
+    uint32_t serviceNum;
+    // Pin the thread of each pooled service to one of the cores the process may run on, round robin
+    bool pinThreads;
+
+    static const uint32_t kMaxDefaultServiceNum = 16;
+
+    // Process wide config, used when the pool is created on first use
+    static IOServiceConfig& defaultConfig()
+    {
+        static IOServiceConfig config;
+        return config;
+    }
+};
+
+struct IOServiceStats {
+    // Counted tasks posted and not yet run
+    int inProcessCount;
+    // Objects sharing the service, besides the pool
+    int userCount;
+    // CPU time of the service thread over wall time since the previous sample
+    double busyRatio;
+};
+
 // Wrapped io_service for transport usage
 class IOService {
 public:
-    IOService();
+    // Runs on a thread pinned to `cpu` if it's not negative
+    IOService(int cpu = -1);
     virtual ~IOService();
 
     // Get in-process counted tasks number
@@ -25,17 +57,29 @@ public:
     void post(std::function<void()> task);
     // Get raw io_service
     boost::asio::io_service& service() { return m_service; }
+    // Whether the caller runs on the thread of the service
+    bool isServiceThread() const { return m_thread.get_id() == boost::this_thread::get_id(); }
+
+    // Busy ratio since the previous call
+    double sampleBusyRatio();
 
 private:
     std::atomic<int> m_count;
     boost::asio::io_service m_service;
     boost::asio::io_service::work m_work;
     boost::thread m_thread;
+
+    boost::mutex m_sampleMutex;
+    int64_t m_lastSampleWallNs;
+    int64_t m_lastSampleCpuNs;
 };
 
-// Get a IOService from service pool
+// Get the least loaded IOService from service pool, by counted tasks then users
 std::shared_ptr<IOService> getIOService();
 
+// Sample the services of the pool, in pool order
+std::vector<IOServiceStats> getIOServiceStats();
+
 } /* namespace owt_base */
 
 #endif /* IOService_h */
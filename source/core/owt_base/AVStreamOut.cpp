@@ -30,6 +30,165 @@ inline AVCodecID frameFormat2AVCodecID(int frameFormat)
     }
 }
 
+MediaFrameQueue::Track::Track(uint32_t capacity)
+    : queued(capacity + 1)
+    , recycled(capacity + 1)
+    , last(nullptr)
+    , waitKeyFrame(false)
+    , drops(0)
+{
+    // One more frame than queued slots, for the held back one
+    for (uint32_t i = 0; i < capacity + 1; i++) {
+        frames.emplace_back(new MediaFrame());
+        recycled.push(frames.back().get());
+    }
+}
+
+MediaFrameQueue::MediaFrameQueue()
+    : m_audio(kAudioCapacity)
+    , m_video(kVideoCapacity)
+    , m_valid(true)
+    , m_startTimeOffset(currentTimeMs())
+    , m_waiting(false)
+{
+}
+
+MediaFrameQueue::~MediaFrameQueue()
+{
+}
+
+bool MediaFrameQueue::pushFrame(const owt_base::Frame& frame)
+{
+    if (!m_valid)
+        return true;
+
+    bool ret = pushTrack(isAudioFrame(frame) ? m_audio : m_video, frame);
+
+    // Pairs with the fence in popFrame(), either the waiting flag is seen
+    // here or the pushed frame is seen there.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_waiting.load(std::memory_order_relaxed)) {
+        boost::mutex::scoped_lock lock(m_mutex);
+        m_cond.notify_one();
+    }
+    return ret;
+}
+
+bool MediaFrameQueue::pushTrack(Track& track, const owt_base::Frame& frame)
+{
+    boost::mutex::scoped_lock lock(track.producerMutex);
+    bool isVideo = isVideoFrame(frame);
+    if (isVideo && track.waitKeyFrame && !frame.additionalInfo.video.isKeyFrame) {
+        track.drops++;
+        return true;
+    }
+
+    if (isVideo && !frame.additionalInfo.video.isKeyFrame
+            && m_audio.queued.size() + m_video.queued.size() >= kSheddingDepth) {
+        track.drops++;
+        track.waitKeyFrame = true;
+        return false;
+    }
+
+    MediaFrame *mediaFrame;
+    if (!track.recycled.pop(mediaFrame)) {
+        track.drops++;
+        if (isVideo) {
+            // Later delta frames are useless without this one
+            track.waitKeyFrame = true;
+            return false;
+        }
+        return true;
+    }
+    track.waitKeyFrame = false;
+
+    mediaFrame->assign(frame, currentTimeMs() - m_startTimeOffset);
+    if (!track.last) {
+        track.last = mediaFrame;
+        return true;
+    }
+
+    track.last->m_duration = mediaFrame->m_timeStamp - track.last->m_timeStamp;
+    if (track.last->m_duration <= 0) {
+        track.last->m_duration = 1;
+        mediaFrame->m_timeStamp = track.last->m_timeStamp + 1;
+    }
+
+    // Can not fail, there are no more frames than queued slots
+    track.queued.push(track.last);
+    track.last = mediaFrame;
+    return true;
+}
+
+MediaFrame *MediaFrameQueue::nextFrame()
+{
+    MediaFrame *audioFrame = nullptr;
+    MediaFrame *videoFrame = nullptr;
+    MediaFrame *mediaFrame = nullptr;
+
+    m_audio.queued.front(audioFrame);
+    m_video.queued.front(videoFrame);
+
+    if (audioFrame && (!videoFrame || audioFrame->m_timeStamp <= videoFrame->m_timeStamp))
+        m_audio.queued.pop(mediaFrame);
+    else if (videoFrame)
+        m_video.queued.pop(mediaFrame);
+
+    return mediaFrame;
+}
+
+MediaFrame *MediaFrameQueue::popFrame(int timeout)
+{
+    if (!m_valid)
+        return NULL;
+
+    MediaFrame *mediaFrame = nextFrame();
+    if (mediaFrame || timeout <= 0)
+        return mediaFrame;
+
+    boost::system_time deadline = boost::get_system_time() + boost::posix_time::milliseconds(timeout);
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_waiting = true;
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    while (m_valid && !(mediaFrame = nextFrame())) {
+        if (!m_cond.timed_wait(lock, deadline))
+            break;
+    }
+    m_waiting = false;
+
+    return m_valid ? mediaFrame : NULL;
+}
+
+void MediaFrameQueue::releaseFrame(MediaFrame *mediaFrame)
+{
+    if (!mediaFrame)
+        return;
+
+    bool isAudio = isAudioFrame(mediaFrame->m_frame);
+    mediaFrame->release();
+    if (isAudio)
+        m_audio.recycled.push(mediaFrame);
+    else
+        m_video.recycled.push(mediaFrame);
+}
+
+void MediaFrameQueue::cancel()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_valid = false;
+    m_cond.notify_all();
+}
+
+MediaFrameQueue::Stats MediaFrameQueue::getStats()
+{
+    Stats stats;
+    stats.audioDepth = m_audio.queued.size();
+    stats.videoDepth = m_video.queued.size();
+    stats.audioDrops = m_audio.drops;
+    stats.videoDrops = m_video.drops;
+    return stats;
+}
+
 DEFINE_LOGGER(AVStreamOut, "owt.AVStreamOut");
 
 AVStreamOut::AVStreamOut(const std::string& url, bool hasAudio, bool hasVideo, EventRegistry *handle, int timeout)
@@ -197,7 +356,10 @@ void AVStreamOut::onFrame(const owt_base::Frame& frame)
             return;
 #endif
 
-        m_frameQueue.pushFrame(frame);
+        if (!m_frameQueue.pushFrame(frame)) {
+            ELOG_DEBUG("Request video key frame after queue overflow");
+            deliverFeedbackMsg(FeedbackMsg{.type = VIDEO_FEEDBACK, .cmd = REQUEST_KEY_FRAME});
+        }
     } else {
         ELOG_WARN("Unsupported frame format: %s(%d)", getFormatStr(frame.format), frame.format);
         notifyAsyncEvent("fatal", "Unsupported frame format");
@@ -208,6 +370,11 @@ void AVStreamOut::sendLoop()
 {
     uint32_t connectRetry;
 
+    // Queue metrics are reported at most this often
+    const int64_t kStatsIntervalMs = 10000;
+    MediaFrameQueue::Stats lastStats = m_frameQueue.getStats();
+    int64_t lastStatsTime = currentTimeMs();
+
     const uint32_t waitMs = 20;
     uint32_t timeOut = 0;
     while ((m_hasAudio && m_audioFormat == FRAME_FORMAT_UNKNOWN) || (m_hasVideo && m_videoFormat == FRAME_FORMAT_UNKNOWN)) {
@@ -257,7 +424,7 @@ reconnect:
 
     ELOG_DEBUG("Start");
     while (m_status == AVStreamOut::Context_READY) {
-        boost::shared_ptr<owt_base::MediaFrame> mediaFrame = m_frameQueue.popFrame(2000);
+        MediaFrame *mediaFrame = m_frameQueue.popFrame(2000);
         if (!mediaFrame) {
             if (m_status == AVStreamOut::Context_READY) {
                 ELOG_WARN("No input frames available");
@@ -267,6 +434,21 @@ reconnect:
         }
 
         bool ret = writeFrame(isVideoFrame(mediaFrame->m_frame) ? m_videoStream : m_audioStream, mediaFrame);
+        m_frameQueue.releaseFrame(mediaFrame);
+
+        if (currentTimeMs() - lastStatsTime >= kStatsIntervalMs) {
+            MediaFrameQueue::Stats stats = m_frameQueue.getStats();
+            if (stats.audioDrops != lastStats.audioDrops || stats.videoDrops != lastStats.videoDrops) {
+                ELOG_WARN("Frame queue overflow, dropped audio(%lu), video(%lu), depth audio(%u), video(%u)"
+                        , stats.audioDrops - lastStats.audioDrops, stats.videoDrops - lastStats.videoDrops
+                        , stats.audioDepth, stats.videoDepth);
+            } else {
+                ELOG_DEBUG("Frame queue depth audio(%u), video(%u)", stats.audioDepth, stats.videoDepth);
+            }
+            lastStats = stats;
+            lastStatsTime = currentTimeMs();
+        }
+
         if (!ret) {
             if (connectRetry-- > 0) {
                 ELOG_WARN("Try to reconnect");
@@ -295,6 +477,8 @@ bool AVStreamOut::connect()
         ELOG_ERROR("Cannot allocate output context, format(%s), url(%s)", formatName ? formatName : "", m_url.c_str());
         return false;
     }
+    // Lets the log callback of a subclass find the stream of a context
+    m_context->opaque = this;
 
     if (!(m_context->oformat->flags & AVFMT_NOFILE)) {
         int ret = avio_open(&m_context->pb, m_context->url, AVIO_FLAG_WRITE);
@@ -450,7 +634,7 @@ bool AVStreamOut::writeHeader()
     return true;
 }
 
-bool AVStreamOut::writeFrame(AVStream *stream, boost::shared_ptr<MediaFrame> mediaFrame)
+bool AVStreamOut::writeFrame(AVStream *stream, MediaFrame *mediaFrame)
 {
     int ret;
     AVPacket pkt;
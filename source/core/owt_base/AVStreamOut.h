@@ -5,7 +5,9 @@
 #ifndef AVStreamOut_h
 #define AVStreamOut_h
 
-#include <queue>
+#include <atomic>
+#include <memory>
+#include <vector>
 #include <boost/shared_ptr.hpp>
 #include <boost/thread.hpp>
 #include <boost/thread/mutex.hpp>
@@ -15,6 +17,7 @@
 #include <rtputils.h>
 
 #include "MediaFramePipeline.h"
+#include "SpscRing.h"
 
 extern "C" {
 #include <libavformat/avformat.h>
@@ -31,138 +34,130 @@ static inline int64_t currentTimeMs()
 
 class MediaFrame {
 public:
-    MediaFrame(const owt_base::Frame& frame, int64_t timeStamp = 0)
-        : m_timeStamp(timeStamp)
+    MediaFrame()
+        : m_timeStamp(0)
         , m_duration(0)
     {
+        memset(&m_frame, 0, sizeof(m_frame));
+    }
+
+    MediaFrame(const owt_base::Frame& frame, int64_t timeStamp = 0)
+        : MediaFrame()
+    {
+        assign(frame, timeStamp);
+    }
+
+    // Reference the payload of |frame|, copied into a pooled buffer when it
+    // carries none or its RTP header is stripped
+    void assign(const owt_base::Frame& frame, int64_t timeStamp)
+    {
+        m_timeStamp = timeStamp;
+        m_duration = 0;
         m_frame = frame;
-        if (frame.length > 0) {
-            uint8_t *payload = frame.payload;
-            uint32_t length = frame.length;
+        m_frame.payload = NULL;
+        m_frame.buffer = nullptr;
 
+        if (frame.length > 0) {
             if (isAudioFrame(frame) && frame.additionalInfo.audio.isRtpPacket) {
-                RTPHeader* rtp = reinterpret_cast<RTPHeader*>(payload);
+                RTPHeader* rtp = reinterpret_cast<RTPHeader*>(frame.payload);
                 uint32_t headerLength = rtp->getHeaderLength();
-                assert(length >= headerLength);
-                payload += headerLength;
-                length -= headerLength;
+                assert(frame.length >= headerLength);
+                m_buffer = MediaBufferPool::GetInstance().copyFrom(frame.payload + headerLength, frame.length - headerLength);
                 m_frame.additionalInfo.audio.isRtpPacket = false;
-                m_frame.length = length;
+                m_frame.length = frame.length - headerLength;
+            } else {
+                m_buffer = retainPayload(frame);
             }
-
-            m_frame.payload = (uint8_t *)malloc(length);
-            memcpy(m_frame.payload, payload, length);
+            m_frame.payload = m_buffer->data();
+            m_frame.buffer = m_buffer.get();
         } else {
-            m_frame.payload = NULL;
+            m_buffer.reset();
+            m_frame.length = 0;
         }
     }
 
-    ~MediaFrame()
+    // Drop the payload, its buffer goes back to the pool
+    void release()
     {
-        if (m_frame.payload) {
-            free(m_frame.payload);
-            m_frame.payload = NULL;
-        }
+        m_buffer.reset();
+        m_frame.payload = NULL;
+        m_frame.buffer = nullptr;
     }
 
     int64_t m_timeStamp;
     int64_t m_duration;
     owt_base::Frame m_frame;
+
+private:
+    MediaBufferPtr m_buffer;
 };
 
+/*
+ * Frames from the audio and the video source to the sendLoop thread. Each
+ * media kind has a bounded ring of queued frames plus a ring returning
+ * consumed frames to the producer side, so frames are recycled without
+ * allocating. Payloads are referenced, or copied into pooled buffers, and
+ * released once written.
+ */
 class MediaFrameQueue {
 public:
-    MediaFrameQueue()
-        : m_valid(true)
-        , m_startTimeOffset(currentTimeMs())
-    {
-    }
-
-    virtual ~MediaFrameQueue()
-    {
-    }
-
-    void pushFrame(const owt_base::Frame& frame)
-    {
-        boost::mutex::scoped_lock lock(m_mutex);
-        if (!m_valid)
-            return;
-
-        boost::shared_ptr<MediaFrame> lastFrame;
-
-        boost::shared_ptr<MediaFrame> mediaFrame(new MediaFrame(frame, currentTimeMs() - m_startTimeOffset));
-        if (isAudioFrame(frame)) {
-            if (!m_lastAudioFrame) {
-                m_lastAudioFrame = mediaFrame;
-                return;
-            }
-
-            m_lastAudioFrame->m_duration = mediaFrame->m_timeStamp - m_lastAudioFrame->m_timeStamp;
-            if (m_lastAudioFrame->m_duration <= 0) {
-                m_lastAudioFrame->m_duration = 1;
-                mediaFrame->m_timeStamp = m_lastAudioFrame->m_timeStamp + 1;
-            }
-
-            lastFrame = m_lastAudioFrame;
-            m_lastAudioFrame = mediaFrame;
-        } else {
-            if (!m_lastVideoFrame) {
-                m_lastVideoFrame = mediaFrame;
-                return;
-            }
+    struct Stats {
+        uint32_t audioDepth;
+        uint32_t videoDepth;
+        uint64_t audioDrops;
+        uint64_t videoDrops;
+    };
 
-            m_lastVideoFrame->m_duration = mediaFrame->m_timeStamp - m_lastVideoFrame->m_timeStamp;
-            if (m_lastVideoFrame->m_duration <= 0) {
-                m_lastVideoFrame->m_duration = 1;
-                mediaFrame->m_timeStamp = m_lastVideoFrame->m_timeStamp + 1;
-            }
+    static const uint32_t kAudioCapacity = 256;
+    static const uint32_t kVideoCapacity = 128;
+    // Frames queued of both kinds above which video delta frames are
+    // dropped, so a slow sink sheds video before audio overflows
+    static const uint32_t kSheddingDepth = 192;
 
-            lastFrame = m_lastVideoFrame;
-            m_lastVideoFrame = mediaFrame;
-        }
+    MediaFrameQueue();
+    virtual ~MediaFrameQueue();
 
-        m_queue.push(lastFrame);
-        if (m_queue.size() == 1)
-            m_cond.notify_one();
-    }
+    // Past kSheddingDepth, or when video is full, video frames are dropped
+    // until the next key frame. Audio is dropped only when full. Returns
+    // false if a video key frame should be requested.
+    bool pushFrame(const owt_base::Frame& frame);
 
-    boost::shared_ptr<MediaFrame> popFrame(int timeout = 0)
-    {
-        boost::mutex::scoped_lock lock(m_mutex);
-        boost::shared_ptr<MediaFrame> mediaFrame;
+    // The earliest queued frame, hand it back with releaseFrame()
+    MediaFrame *popFrame(int timeout = 0);
+    void releaseFrame(MediaFrame *mediaFrame);
 
-        if (!m_valid)
-            return NULL;
+    void cancel();
+    Stats getStats();
 
-        if (m_queue.size() == 0 && timeout > 0) {
-            m_cond.timed_wait(lock, boost::get_system_time() + boost::posix_time::milliseconds(timeout));
-        }
+private:
+    struct Track {
+        Track(uint32_t capacity);
+
+        SpscRing<MediaFrame *> queued;
+        SpscRing<MediaFrame *> recycled;
+        std::vector<std::unique_ptr<MediaFrame>> frames;
+
+        // The rings take one producer, a new source may start delivering
+        // before the previous one stopped. Uncontended otherwise.
+        boost::mutex producerMutex;
+        // Held back until the next frame gives its duration, producer only
+        MediaFrame *last;
+        bool waitKeyFrame;
+        std::atomic<uint64_t> drops;
+    };
 
-        if (m_queue.size() > 0) {
-            mediaFrame = m_queue.front();
-            m_queue.pop();
-        }
+    bool pushTrack(Track& track, const owt_base::Frame& frame);
+    MediaFrame *nextFrame();
 
-        return mediaFrame;
-    }
+    Track m_audio;
+    Track m_video;
 
-    void cancel()
-    {
-        boost::mutex::scoped_lock lock(m_mutex);
-        m_valid = false;
-        m_cond.notify_all();
-    }
+    std::atomic<bool> m_valid;
+    int64_t m_startTimeOffset;
 
-private:
-    std::queue<boost::shared_ptr<MediaFrame>> m_queue;
+    std::atomic<bool> m_waiting;
     boost::mutex m_mutex;
     boost::condition_variable m_cond;
-
-    boost::shared_ptr<MediaFrame> m_lastAudioFrame;
-    boost::shared_ptr<MediaFrame> m_lastVideoFrame;
-
-    bool m_valid;
-    int64_t m_startTimeOffset;
 };
 
 class AVStreamOut : public owt_base::FrameDestination, public EventRegistry {
@@ -181,6 +176,8 @@ public:
 
     // FrameDestination
     virtual void onFrame(const Frame&);
+    // Queued until written
+    virtual bool keepsPayload() { return true; }
     virtual void onVideoSourceChanged(void) {deliverFeedbackMsg(FeedbackMsg{.type = VIDEO_FEEDBACK, .cmd = REQUEST_KEY_FRAME });}
 
 protected:
@@ -218,7 +215,7 @@ protected:
     bool addAudioStream(FrameFormat format, uint32_t sampleRate, uint32_t channels);
     bool addVideoStream(FrameFormat format, uint32_t width, uint32_t height);
 
-    bool writeFrame(AVStream *stream, boost::shared_ptr<MediaFrame> mediaFrame);
+    bool writeFrame(AVStream *stream, MediaFrame *mediaFrame);
 
     void sendLoop(void);
 
@@ -64,6 +64,35 @@ struct AnalyticsBuffer {
  }
 };
 
+/// One plane of an AnalyticsFrame, rows are `stride` bytes apart.
+struct AnalyticsPlane {
+ const uint8_t* data;
+ int stride;
+ int width;
+ int height;
+};
+
+/// A reference counted I420 frame shared between MCU and a version 2 plugin
+/// without copying. Planes stay valid until the last reference is released.
+class AnalyticsFrame {
+ public:
+  virtual void AddRef() const = 0;
+  virtual void Release() const = 0;
+
+  virtual int Width() const = 0;
+  virtual int Height() const = 0;
+  /// RTP timestamp of the frame, 90kHz.
+  virtual rvaU64 Timestamp() const = 0;
+  /// Y, U and V planes for index 0, 1 and 2.
+  virtual AnalyticsPlane Plane(int index) const = 0;
+  /// Writable plane data, or nullptr for frames pushed by MCU, which may be
+  /// shared with other consumers. Frames from AllocateFrame are writable.
+  virtual uint8_t* MutablePlaneData(int index) = 0;
+
+ protected:
+  virtual ~AnalyticsFrame() {}
+};
+
 }
 }
 
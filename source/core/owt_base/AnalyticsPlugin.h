@@ -91,6 +91,55 @@ class rvaPlugin {
 typedef rvaPlugin* rva_create_t();
 typedef void rva_destroy_t(rvaPlugin*);
 
+class rvaFrameCallbackV2 {
+ public:
+  virtual ~rvaFrameCallbackV2() {}
+  /**
+   @brief Allocates a writable frame from the MCU buffer pool, for plugins that
+          produce pixels. The caller owns one reference.
+   @param timestamp RTP timestamp of the pushed frame the output is made from,
+          its Timestamp(), so the output keeps the timing of the source.
+   @return the frame, or nullptr if no buffer is available.
+  */
+  virtual owt::analytics::AnalyticsFrame* AllocateFrame(int width, int height, rvaU64 timestamp) = 0;
+  /**
+   @brief Sends a frame back to MCU, either a pushed frame or one from AllocateFrame.
+          MCU takes its own reference, the caller keeps its reference.
+   @param metadata analytics result of the frame, may be empty.
+  */
+  virtual void OnPluginFrame(owt::analytics::AnalyticsFrame* frame, const std::string& metadata) = 0;
+};
+
+/// Version 2 of the plugin interface. Frames are pushed as references to the
+/// MCU buffers instead of copies, and a plugin that only annotates frames
+/// sends the pushed frame back with its metadata.
+class rvaPluginV2 {
+ public:
+  virtual ~rvaPluginV2() {}
+  /// Same as rvaPlugin.
+  virtual rvaStatus PluginInit(std::unordered_map<std::string, std::string> params) = 0;
+  virtual rvaStatus PluginClose() = 0;
+  virtual rvaStatus GetPluginParams(std::unordered_map<std::string, std::string> &params) = 0;
+  virtual rvaStatus SetPluginParams(std::unordered_map<std::string, std::string> params) = 0;
+  /**
+   @brief MCU pushes a video frame to the plugin for processing. Note this processing
+          must be asynchronous on other thread and should return immediately to caller.
+   @param frame the video frame, read only. The plugin calls AddRef to keep it
+          after returning and Release once done.
+   @return RVA_ERR_OK if no issue. Other return code if any failure.
+  */
+  virtual rvaStatus ProcessFrameAsync(owt::analytics::AnalyticsFrame* frame) = 0;
+  /**
+   @brief Register a callback on the plugin for receiving frames from the plugin,
+          nullptr to unregister.
+   @return RVA_ERR_OK if no issue. Other return code if any failure.
+  */
+  virtual rvaStatus RegisterFrameCallback(rvaFrameCallbackV2* pCallback) = 0;
+};
+
+typedef rvaPluginV2* rva_create_v2_t();
+typedef void rva_destroy_v2_t(rvaPluginV2*);
+
 
 /// Your plugin implemenation is required to invoke
 /// below DECLARE_PLUGIN macro to delcare interfaces
@@ -105,4 +154,16 @@ extern "C" {\
   }\
 }
 
+/// The DECLARE_PLUGIN counterpart for rvaPluginV2 implementations. MCU uses
+/// the version 2 interface of plugins exporting it.
+#define DECLARE_PLUGIN_V2(className)\
+extern "C" {\
+  rvaPluginV2* CreatePluginV2() {\
+    return new className;\
+  }\
+  void DestroyPluginV2(rvaPluginV2* p) {\
+    delete p;\
+  }\
+}
+
 #endif
@@ -3,17 +3,89 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "FrameAnalyzer.h"
+#include <atomic>
 #include <dlfcn.h>
 #include <unistd.h>
 #include <string.h>
 #include <unordered_map>
 
+#include <libyuv/planar_functions.h>
+
 using namespace webrtc;
 
 namespace owt_base {
 
 DEFINE_LOGGER(FrameAnalyzer, "owt.FrameAnalyzer");
 
+// Wraps a webrtc buffer for version 2 plugins, writable if `mutableBuffer` is the same buffer.
+class I420AnalyticsFrame : public owt::analytics::AnalyticsFrame {
+public:
+    I420AnalyticsFrame(rtc::scoped_refptr<webrtc::VideoFrameBuffer> buffer,
+                       rtc::scoped_refptr<webrtc::I420Buffer> mutableBuffer, uint32_t timeStamp)
+        : m_buffer(buffer)
+        , m_mutableBuffer(mutableBuffer)
+        , m_timeStamp(timeStamp)
+        , m_refs(1)
+    {
+    }
+
+    void AddRef() const override { m_refs.fetch_add(1, std::memory_order_relaxed); }
+    void Release() const override
+    {
+        if (m_refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete this;
+        }
+    }
+
+    int Width() const override { return m_buffer->width(); }
+    int Height() const override { return m_buffer->height(); }
+    rvaU64 Timestamp() const override { return m_timeStamp; }
+
+    owt::analytics::AnalyticsPlane Plane(int index) const override
+    {
+        int chromaWidth = (m_buffer->width() + 1) / 2;
+        int chromaHeight = (m_buffer->height() + 1) / 2;
+        switch (index) {
+        case 0:
+            return { m_buffer->DataY(), m_buffer->StrideY(), m_buffer->width(), m_buffer->height() };
+        case 1:
+            return { m_buffer->DataU(), m_buffer->StrideU(), chromaWidth, chromaHeight };
+        case 2:
+            return { m_buffer->DataV(), m_buffer->StrideV(), chromaWidth, chromaHeight };
+        default:
+            return { nullptr, 0, 0, 0 };
+        }
+    }
+
+    uint8_t* MutablePlaneData(int index) override
+    {
+        if (!m_mutableBuffer) {
+            return nullptr;
+        }
+        switch (index) {
+        case 0:
+            return m_mutableBuffer->MutableDataY();
+        case 1:
+            return m_mutableBuffer->MutableDataU();
+        case 2:
+            return m_mutableBuffer->MutableDataV();
+        default:
+            return nullptr;
+        }
+    }
+
+    rtc::scoped_refptr<webrtc::VideoFrameBuffer> buffer() const { return m_buffer; }
+    uint32_t timeStamp() const { return m_timeStamp; }
+
+private:
+    ~I420AnalyticsFrame() { }
+
+    rtc::scoped_refptr<webrtc::VideoFrameBuffer> m_buffer;
+    rtc::scoped_refptr<webrtc::I420Buffer> m_mutableBuffer;
+    uint32_t m_timeStamp;
+    mutable std::atomic<int> m_refs;
+};
+
 FrameAnalyzer::FrameAnalyzer()
     : m_lastWidth(0)
     , m_lastHeight(0)
@@ -22,6 +94,10 @@ FrameAnalyzer::FrameAnalyzer()
     , m_outHeight(-1)
     , m_outFrameRate(-1)
     , m_clock(NULL)
+    , plugin_handle_(nullptr)
+    , plugin_(nullptr)
+    , plugin_v2_(nullptr)
+    , m_metadataListener(nullptr)
 {
 }
 
@@ -30,10 +106,21 @@ FrameAnalyzer::~FrameAnalyzer()
     if (m_outFrameRate > 0) {
         m_jobTimer->stop();
     }
-    if (plugin_ != nullptr && plugin_handle_ != nullptr) {
-         destroy_plugin(plugin_);
-         dlclose(plugin_handle_);
+    if (plugin_v2_ != nullptr) {
+        plugin_v2_->RegisterFrameCallback(nullptr);
+        destroy_plugin_v2(plugin_v2_);
     }
+    if (plugin_ != nullptr) {
+        destroy_plugin(plugin_);
+    }
+    if (plugin_handle_ != nullptr) {
+        dlclose(plugin_handle_);
+    }
+}
+
+void FrameAnalyzer::setMetadataListener(MetadataListener* listener)
+{
+    m_metadataListener = listener;
 }
 
 bool FrameAnalyzer::init(FrameFormat format, const uint32_t width, const uint32_t height, const uint32_t frameRate, const std::string& pluginName)
@@ -59,31 +146,54 @@ bool FrameAnalyzer::init(FrameFormat format, const uint32_t width, const uint32_
         return false;
     }
 
-    create_plugin = (rva_create_t*)dlsym(plugin_handle_, "CreatePlugin");
-    destroy_plugin = (rva_destroy_t*)dlsym(plugin_handle_, "DestroyPlugin");
+    rva_create_v2_t* create_plugin_v2 = (rva_create_v2_t*)dlsym(plugin_handle_, "CreatePluginV2");
+    destroy_plugin_v2 = (rva_destroy_v2_t*)dlsym(plugin_handle_, "DestroyPluginV2");
+    if (create_plugin_v2 != nullptr && destroy_plugin_v2 != nullptr) {
+        plugin_v2_ = create_plugin_v2();
+        if (plugin_v2_ == nullptr) {
+            ELOG_ERROR_T("Failed to create the plugin.");
+            dlclose(plugin_handle_);
+            plugin_handle_ = nullptr;
+            return false;
+        }
 
-    if (create_plugin == nullptr || destroy_plugin == nullptr) {
-        ELOG_ERROR_T("Failed to get plugin interface.");
-        dlclose(plugin_handle_);
-        return false;
-    }
+        plugin_v2_->RegisterFrameCallback(this);
 
-    plugin_ = create_plugin();
-    if (plugin_ == nullptr) {
-        ELOG_ERROR_T("Failed to create the plugin.");
-        dlclose(plugin_handle_);
-        return false;
-    }
+        std::unordered_map<std::string, std::string> plugin_config_map(
+          {{"AnalyticsVersion", "2"}});
+        plugin_v2_->PluginInit(plugin_config_map);
+    } else {
+        create_plugin = (rva_create_t*)dlsym(plugin_handle_, "CreatePlugin");
+        destroy_plugin = (rva_destroy_t*)dlsym(plugin_handle_, "DestroyPlugin");
+
+        if (create_plugin == nullptr || destroy_plugin == nullptr) {
+            ELOG_ERROR_T("Failed to get plugin interface.");
+            dlclose(plugin_handle_);
+            plugin_handle_ = nullptr;
+            return false;
+        }
 
-    // Register frame callback
-    plugin_->RegisterFrameCallback(this);
+        plugin_ = create_plugin();
+        if (plugin_ == nullptr) {
+            ELOG_ERROR_T("Failed to create the plugin.");
+            dlclose(plugin_handle_);
+            plugin_handle_ = nullptr;
+            return false;
+        }
 
-    std::unordered_map<std::string, std::string> plugin_config_map(
-      {{"AnalyticsVersion", "1"}});
-    plugin_->PluginInit(plugin_config_map);
+        // Register frame callback
+        plugin_->RegisterFrameCallback(this);
 
-    if (m_format == FRAME_FORMAT_I420)
-        m_bufferManager.reset(new I420BufferManager(3));
+        std::unordered_map<std::string, std::string> plugin_config_map(
+          {{"AnalyticsVersion", "1"}});
+        plugin_->PluginInit(plugin_config_map);
+    }
+
+    if (m_format == FRAME_FORMAT_I420) {
+        // Scaled inputs queued in the plugin and the frames it allocates
+        m_bufferManager.reset(new I420BufferManager(6));
+        m_converter.reset(new FrameConverter(false));
+    }
 
     if (m_outFrameRate != 0) {
         m_clock = Clock::GetRealTimeClock();
@@ -140,15 +250,44 @@ void FrameAnalyzer::onFrame(const Frame& frame)
     if (m_format == FRAME_FORMAT_I420) {
         if (frame.format == FRAME_FORMAT_I420) {
             VideoFrame *srcFrame = (reinterpret_cast<VideoFrame *>(frame.payload));
+            rtc::scoped_refptr<webrtc::VideoFrameBuffer> i420Buffer = srcFrame->video_frame_buffer();
+            if (i420Buffer->width() != (int)width || i420Buffer->height() != (int)height) {
+                rtc::scoped_refptr<webrtc::I420Buffer> scaledBuffer;
+                {
+                    boost::mutex::scoped_lock lock(m_bufferMutex);
+                    scaledBuffer = m_bufferManager->getFreeBuffer(width, height);
+                }
+                if (!scaledBuffer) {
+                    ELOG_ERROR_T("No valid i420Buffer");
+                    return;
+                }
+                if (!m_converter->convert(i420Buffer.get(), scaledBuffer.get())) {
+                    ELOG_ERROR_T("Failed to scale frame, %dx%d -> %dx%d",
+                            i420Buffer->width(), i420Buffer->height(), width, height);
+                    return;
+                }
+                i420Buffer = scaledBuffer;
+            }
+            if (plugin_v2_) {
+                // The plugin reads the buffer itself, the decoded one if no scaling is needed.
+                I420AnalyticsFrame* analyticsFrame = new I420AnalyticsFrame(i420Buffer, nullptr, frame.timeStamp);
+                plugin_v2_->ProcessFrameAsync(analyticsFrame);
+                analyticsFrame->Release();
+                return;
+            }
             std::unique_ptr<owt::analytics::AnalyticsBuffer> newFrame(new owt::analytics::AnalyticsBuffer());
             newFrame->buffer = new uint8_t[width * height * 3 / 2 + 1];
             memset(newFrame->buffer, 0, width * height * 3 / 2 + 1);
             newFrame->width = width;
             newFrame->height = height;
-            rtc::scoped_refptr<webrtc::VideoFrameBuffer> i420Buffer = srcFrame->video_frame_buffer();
-            memcpy(newFrame->buffer, i420Buffer->DataY(), height * width);
-            memcpy(newFrame->buffer + height * width , i420Buffer->DataU(), height * width / 4);
-            memcpy(newFrame->buffer + height * width * 5 / 4, i420Buffer->DataV(), height * width / 4);
+            libyuv::I420Copy(
+                    i420Buffer->DataY(), i420Buffer->StrideY(),
+                    i420Buffer->DataU(), i420Buffer->StrideU(),
+                    i420Buffer->DataV(), i420Buffer->StrideV(),
+                    newFrame->buffer, width,
+                    newFrame->buffer + width * height, width / 2,
+                    newFrame->buffer + width * height * 5 / 4, width / 2,
+                    width, height);
             if (plugin_) {
                 plugin_->ProcessFrameAsync(std::move(newFrame));
                 return;
@@ -168,7 +307,11 @@ void FrameAnalyzer::onFrame(const Frame& frame)
 void FrameAnalyzer::OnPluginFrame(std::unique_ptr<owt::analytics::AnalyticsBuffer> pluginFrame) {
     int width = pluginFrame->width;
     int height = pluginFrame->height; 
-    rtc::scoped_refptr<webrtc::I420Buffer> i420Buffer = m_bufferManager->getFreeBuffer(width, height);
+    rtc::scoped_refptr<webrtc::I420Buffer> i420Buffer;
+    {
+        boost::mutex::scoped_lock lock(m_bufferMutex);
+        i420Buffer = m_bufferManager->getFreeBuffer(width, height);
+    }
     if (!i420Buffer) {
         ELOG_ERROR_T("No valid i420Buffer");
         return;
@@ -181,12 +324,41 @@ void FrameAnalyzer::OnPluginFrame(std::unique_ptr<owt::analytics::AnalyticsBuffe
     return;
 }
 
-void FrameAnalyzer::SendFrame(rtc::scoped_refptr<webrtc::I420Buffer> i420Buffer, uint32_t timeStamp)
+owt::analytics::AnalyticsFrame* FrameAnalyzer::AllocateFrame(int width, int height, rvaU64 timeStamp)
+{
+    rtc::scoped_refptr<webrtc::I420Buffer> i420Buffer;
+    {
+        boost::mutex::scoped_lock lock(m_bufferMutex);
+        if (m_bufferManager) {
+            i420Buffer = m_bufferManager->getFreeBuffer(width, height);
+        }
+    }
+    if (!i420Buffer) {
+        ELOG_ERROR_T("No valid i420Buffer");
+        return nullptr;
+    }
+    return new I420AnalyticsFrame(i420Buffer, i420Buffer, timeStamp);
+}
+
+void FrameAnalyzer::OnPluginFrame(owt::analytics::AnalyticsFrame* pluginFrame, const std::string& metadata)
+{
+    if (!pluginFrame) {
+        return;
+    }
+    // Plugins only send back frames they got from this analyzer.
+    I420AnalyticsFrame* frame = static_cast<I420AnalyticsFrame*>(pluginFrame);
+    if (!metadata.empty() && m_metadataListener) {
+        m_metadataListener->onAnalyticsMetadata(frame->timeStamp(), metadata);
+    }
+    SendFrame(frame->buffer(), frame->timeStamp());
+}
+
+void FrameAnalyzer::SendFrame(rtc::scoped_refptr<webrtc::VideoFrameBuffer> buffer, uint32_t timeStamp)
 {
     owt_base::Frame outFrame;
     memset(&outFrame, 0, sizeof(outFrame));
 
-    webrtc::VideoFrame i420Frame(i420Buffer, timeStamp, 0, webrtc::kVideoRotation_0);
+    webrtc::VideoFrame i420Frame(buffer, timeStamp, 0, webrtc::kVideoRotation_0);
 
     outFrame.format = FRAME_FORMAT_I420;
     outFrame.payload = reinterpret_cast<uint8_t*>(&i420Frame);
@@ -8,6 +8,7 @@
 #include <vector>
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
 #include <logger.h>
 
 #include <webrtc/api/video/video_frame.h>
@@ -18,21 +19,32 @@
 
 // TODO: enable MSDK for analyzer
 
+#include "FrameConverter.h"
 #include "I420BufferManager.h"
 
 #include "AnalyticsPlugin.h"
 
 namespace owt_base {
 
-class FrameAnalyzer : public VideoFrameAnalyzer, public JobTimerListener, public rvaFrameCallback {
+class FrameAnalyzer : public VideoFrameAnalyzer, public JobTimerListener, public rvaFrameCallback, public rvaFrameCallbackV2 {
     DECLARE_LOGGER();
 
     const uint32_t kMsToRtpTimestamp = 90;
 
 public:
+    // Receives the metadata version 2 plugins send with their frames, on plugin threads.
+    class MetadataListener {
+    public:
+        virtual ~MetadataListener() { }
+        virtual void onAnalyticsMetadata(uint32_t timeStamp, const std::string& metadata) = 0;
+    };
+
     FrameAnalyzer();
     ~FrameAnalyzer();
 
+    // Set before init().
+    void setMetadataListener(MetadataListener* listener);
+
     void onFrame(const Frame&);
     bool init(FrameFormat format, const uint32_t width, const uint32_t height, const uint32_t frameRate, const std::string& pluginName);
 
@@ -40,9 +52,12 @@ public:
 
     void OnPluginFrame(std::unique_ptr<owt::analytics::AnalyticsBuffer> buffer);
 
+    owt::analytics::AnalyticsFrame* AllocateFrame(int width, int height, rvaU64 timeStamp);
+    void OnPluginFrame(owt::analytics::AnalyticsFrame* frame, const std::string& metadata);
+
 protected:
     bool filterFrame(const Frame& frame);
-    void SendFrame(rtc::scoped_refptr<webrtc::I420Buffer> i420Buffer, uint32_t timeStamp);
+    void SendFrame(rtc::scoped_refptr<webrtc::VideoFrameBuffer> buffer, uint32_t timeStamp);
 
 private:
     uint32_t m_lastWidth;
@@ -54,6 +69,10 @@ private:
     uint32_t m_outFrameRate;
 
     boost::scoped_ptr<I420BufferManager> m_bufferManager;
+    // Scales input frames to the output size before the plugin gets them.
+    boost::scoped_ptr<FrameConverter> m_converter;
+    // Plugin threads allocate frames.
+    boost::mutex m_bufferMutex;
     rtc::scoped_refptr<webrtc::I420Buffer> m_activeI420Buffer;
 
     boost::shared_mutex m_mutex;
@@ -66,6 +85,10 @@ private:
     rvaPlugin* plugin_;
     rva_create_t* create_plugin;
     rva_destroy_t* destroy_plugin;
+    // Used instead of plugin_ if the plugin exports it.
+    rvaPluginV2* plugin_v2_;
+    rva_destroy_v2_t* destroy_plugin_v2;
+    MetadataListener* m_metadataListener;
     boost::scoped_ptr<JobTimer> m_jobTimer;
 };
 
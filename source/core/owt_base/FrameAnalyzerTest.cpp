@@ -0,0 +1,127 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE FrameAnalyzer
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string.h>
+#include <vector>
+
+#include "FrameAnalyzer.h"
+
+using namespace owt_base;
+
+// The sample version 2 plugin, found through LD_LIBRARY_PATH
+static const char* kPluginName = "liblumaPlugin.so";
+
+class TestSink : public FrameDestination, public FrameAnalyzer::MetadataListener {
+public:
+    struct Output {
+        const webrtc::VideoFrameBuffer* buffer;
+        int width;
+        int height;
+        uint8_t y;
+        uint32_t timeStamp;
+    };
+
+    void onFrame(const Frame& frame) override
+    {
+        webrtc::VideoFrame* videoFrame = reinterpret_cast<webrtc::VideoFrame*>(frame.payload);
+        rtc::scoped_refptr<webrtc::VideoFrameBuffer> buffer = videoFrame->video_frame_buffer();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        outputs.push_back({buffer.get(), buffer->width(), buffer->height(), buffer->DataY()[0], frame.timeStamp});
+        m_cond.notify_all();
+    }
+
+    void onAnalyticsMetadata(uint32_t timeStamp, const std::string& data) override
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        metadata.push_back(std::make_pair(timeStamp, data));
+        m_cond.notify_all();
+    }
+
+    bool waitFor(size_t count)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        return m_cond.wait_for(lock, std::chrono::seconds(5), [&] {
+            return outputs.size() >= count && metadata.size() >= count;
+        });
+    }
+
+    std::vector<Output> outputs;
+    std::vector<std::pair<uint32_t, std::string>> metadata;
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+};
+
+static rtc::scoped_refptr<webrtc::I420Buffer> grayBuffer(int width, int height, uint8_t y)
+{
+    rtc::scoped_refptr<webrtc::I420Buffer> buffer = webrtc::I420Buffer::Create(width, height);
+    memset(buffer->MutableDataY(), y, buffer->StrideY() * height);
+    memset(buffer->MutableDataU(), 128, buffer->StrideU() * ((height + 1) / 2));
+    memset(buffer->MutableDataV(), 128, buffer->StrideV() * ((height + 1) / 2));
+    return buffer;
+}
+
+static void pushFrame(FrameAnalyzer& analyzer, rtc::scoped_refptr<webrtc::I420Buffer> buffer, uint32_t timeStamp)
+{
+    webrtc::VideoFrame videoFrame(buffer, timeStamp, 0, webrtc::kVideoRotation_0);
+    Frame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.format = FRAME_FORMAT_I420;
+    frame.payload = reinterpret_cast<uint8_t*>(&videoFrame);
+    frame.timeStamp = timeStamp;
+    frame.additionalInfo.video.width = buffer->width();
+    frame.additionalInfo.video.height = buffer->height();
+    analyzer.onFrame(frame);
+}
+
+BOOST_AUTO_TEST_CASE(sameSizeIsNotCopied)
+{
+    TestSink sink;
+    rtc::scoped_refptr<webrtc::I420Buffer> input = grayBuffer(320, 240, 100);
+    {
+        FrameAnalyzer analyzer;
+        analyzer.setMetadataListener(&sink);
+        BOOST_REQUIRE(analyzer.init(FRAME_FORMAT_I420, 320, 240, 30, kPluginName));
+        analyzer.addVideoDestination(&sink);
+        pushFrame(analyzer, input, 9000);
+        BOOST_REQUIRE(sink.waitFor(1));
+        analyzer.removeVideoDestination(&sink);
+    }
+    // The annotated frame is the decoded one, with its timing
+    BOOST_CHECK(sink.outputs[0].buffer == input.get());
+    BOOST_CHECK_EQUAL(sink.outputs[0].timeStamp, 9000u);
+    BOOST_CHECK_EQUAL(sink.metadata[0].first, 9000u);
+    BOOST_CHECK_EQUAL(sink.metadata[0].second, "{\"luma\":100}");
+}
+
+BOOST_AUTO_TEST_CASE(scaledToOutputSize)
+{
+    TestSink sink;
+    {
+        FrameAnalyzer analyzer;
+        analyzer.setMetadataListener(&sink);
+        BOOST_REQUIRE(analyzer.init(FRAME_FORMAT_I420, 160, 120, 30, kPluginName));
+        analyzer.addVideoDestination(&sink);
+        pushFrame(analyzer, grayBuffer(640, 480, 50), 3000);
+        pushFrame(analyzer, grayBuffer(320, 240, 150), 6000);
+        BOOST_REQUIRE(sink.waitFor(2));
+        analyzer.removeVideoDestination(&sink);
+    }
+    // The plugin gets and sends back frames of the output size, whatever the
+    // source resolution
+    for (size_t i = 0; i < 2; i++) {
+        BOOST_CHECK_EQUAL(sink.outputs[i].width, 160);
+        BOOST_CHECK_EQUAL(sink.outputs[i].height, 120);
+    }
+    BOOST_CHECK_EQUAL(sink.outputs[0].y, 50);
+    BOOST_CHECK_EQUAL(sink.outputs[0].timeStamp, 3000u);
+    BOOST_CHECK_EQUAL(sink.metadata[0].second, "{\"luma\":50}");
+    BOOST_CHECK_EQUAL(sink.outputs[1].y, 150);
+    BOOST_CHECK_EQUAL(sink.outputs[1].timeStamp, 6000u);
+    BOOST_CHECK_EQUAL(sink.metadata[1].second, "{\"luma\":150}");
+}
@@ -0,0 +1,448 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef FrameWireFormat_h
+#define FrameWireFormat_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "MediaFramePipeline.h"
+
+namespace owt_base {
+
+// Tags of the messages in this format
+const char TDT_MEDIA_FRAME_WIRE = 0x8E;
+const char TDT_MEDIA_METADATA_WIRE = 0x3B;
+// Tags of the legacy format below, TDT_MEDIA_FRAME and TDT_MEDIA_METADATA
+// of RawTransport.h, which the quic addons don't include
+const char TDT_MEDIA_FRAME_LEGACY = 0x8F;
+const char TDT_MEDIA_METADATA_LEGACY = 0x3A;
+
+/*
+ * Wire format of frames between agents, independent of the in-memory
+ * layout of Frame. Integers are little endian, varints are LEB128.
+ *
+ * | version (1) | format (varint) | timeStamp (4) | flags (varint) |
+ * | length (varint) | media info | extensions | payload (length) |
+ *
+ * Video info: | width (varint) | height (varint) |
+ * Audio info: | nbSamples (varint) | sampleRate (varint) | channels (1) | audioLevel (1) |
+ * Extensions, if flagged: | type (varint) | size (varint) | size bytes |
+ * repeated and ended by type 0. Decoders skip unknown types, so fields can
+ * be added without a new version. The version only changes for layouts
+ * older agents can't read.
+ *
+ * Metadata: | version (1) | type (varint) | length (varint) | payload (length) |
+ */
+const uint8_t kFrameWireVersion = 1;
+// Header size without extensions
+const size_t kFrameWireMaxHeaderSize = 1 + 5 + 4 + 5 + 5 + 5 + 5 + 2;
+const size_t kMetaDataWireMaxHeaderSize = 1 + 5 + 5;
+
+enum FrameWireFlags {
+    FRAME_WIRE_KEY_FRAME = 1 << 0,
+    FRAME_WIRE_VIDEO_INFO = 1 << 1,
+    FRAME_WIRE_AUDIO_INFO = 1 << 2,
+    FRAME_WIRE_RTP_PACKET = 1 << 3,
+    FRAME_WIRE_VOICE = 1 << 4,
+    FRAME_WIRE_EXTENSIONS = 1 << 5,
+};
+
+struct FrameWireExtension {
+    // Not 0, which ends the list
+    uint32_t type;
+    const uint8_t* data;
+    uint32_t length;
+};
+
+// The extensions of a frame checked by decodeFrame(), read in order
+struct FrameWireExtensions {
+    FrameWireExtensions() : pos(nullptr), end(nullptr) {}
+
+    inline bool next(FrameWireExtension& extension);
+
+    const uint8_t* pos;
+    const uint8_t* end;
+};
+
+inline uint8_t* writeVarint(uint8_t* out, uint32_t value)
+{
+    while (value >= 0x80) {
+        *out++ = static_cast<uint8_t>(value) | 0x80;
+        value >>= 7;
+    }
+    *out++ = static_cast<uint8_t>(value);
+    return out;
+}
+
+// Null if the varint is truncated or doesn't fit 32 bits
+inline const uint8_t* readVarint(const uint8_t* pos, const uint8_t* end, uint32_t& value)
+{
+    uint64_t result = 0;
+    for (int shift = 0; shift < 35 && pos < end; shift += 7) {
+        uint8_t byte = *pos++;
+        result |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            if (result > UINT32_MAX) {
+                return nullptr;
+            }
+            value = static_cast<uint32_t>(result);
+            return pos;
+        }
+    }
+    return nullptr;
+}
+
+inline size_t frameWireExtensionsSize(const FrameWireExtension* extensions, size_t count)
+{
+    size_t size = count ? 1 : 0;
+    for (size_t i = 0; i < count; i++) {
+        size += 5 + 5 + extensions[i].length;
+    }
+    return size;
+}
+
+// Writes the header of |frame| to |out|, of at least kFrameWireMaxHeaderSize
+// plus frameWireExtensionsSize() bytes, and returns its size. The payload is
+// sent right after it, as is.
+inline size_t encodeFrameHeader(const Frame& frame, uint8_t* out,
+                                const FrameWireExtension* extensions = nullptr, size_t extensionCount = 0)
+{
+    bool video = isVideoFrame(frame);
+    bool audio = isAudioFrame(frame);
+    uint32_t flags = 0;
+    if (video) {
+        flags |= FRAME_WIRE_VIDEO_INFO;
+        if (frame.additionalInfo.video.isKeyFrame) {
+            flags |= FRAME_WIRE_KEY_FRAME;
+        }
+    } else if (audio) {
+        flags |= FRAME_WIRE_AUDIO_INFO;
+        if (frame.additionalInfo.audio.isRtpPacket) {
+            flags |= FRAME_WIRE_RTP_PACKET;
+        }
+        if (frame.additionalInfo.audio.voice) {
+            flags |= FRAME_WIRE_VOICE;
+        }
+    }
+    if (extensionCount) {
+        flags |= FRAME_WIRE_EXTENSIONS;
+    }
+
+    uint8_t* pos = out;
+    *pos++ = kFrameWireVersion;
+    pos = writeVarint(pos, static_cast<uint32_t>(frame.format));
+    for (int i = 0; i < 4; i++) {
+        *pos++ = static_cast<uint8_t>(frame.timeStamp >> (8 * i));
+    }
+    pos = writeVarint(pos, flags);
+    pos = writeVarint(pos, frame.length);
+    if (video) {
+        pos = writeVarint(pos, frame.additionalInfo.video.width);
+        pos = writeVarint(pos, frame.additionalInfo.video.height);
+    } else if (audio) {
+        pos = writeVarint(pos, frame.additionalInfo.audio.nbSamples);
+        pos = writeVarint(pos, frame.additionalInfo.audio.sampleRate);
+        *pos++ = frame.additionalInfo.audio.channels;
+        *pos++ = frame.additionalInfo.audio.audioLevel;
+    }
+    if (extensionCount) {
+        for (size_t i = 0; i < extensionCount; i++) {
+            pos = writeVarint(pos, extensions[i].type);
+            pos = writeVarint(pos, extensions[i].length);
+            if (extensions[i].length) {
+                memcpy(pos, extensions[i].data, extensions[i].length);
+                pos += extensions[i].length;
+            }
+        }
+        *pos++ = 0;
+    }
+    return pos - out;
+}
+
+// Reads a frame written by encodeFrameHeader() and its payload, |length|
+// bytes in total. |frame.payload| points into |data|, nothing is copied.
+// False if the frame is malformed or of another version.
+inline bool decodeFrame(const uint8_t* data, size_t length, Frame& frame,
+                        FrameWireExtensions* extensions = nullptr)
+{
+    const uint8_t* pos = data;
+    const uint8_t* end = data + length;
+    uint32_t format, flags, payloadLength;
+    if (length < 1 || *pos++ != kFrameWireVersion) {
+        return false;
+    }
+    if (!(pos = readVarint(pos, end, format)) || end - pos < 4) {
+        return false;
+    }
+    frame.timeStamp = static_cast<uint32_t>(pos[0]) | static_cast<uint32_t>(pos[1]) << 8
+        | static_cast<uint32_t>(pos[2]) << 16 | static_cast<uint32_t>(pos[3]) << 24;
+    pos += 4;
+    if (!(pos = readVarint(pos, end, flags)) || !(pos = readVarint(pos, end, payloadLength))) {
+        return false;
+    }
+    frame.format = static_cast<FrameFormat>(format);
+    frame.length = payloadLength;
+    memset(&frame.additionalInfo, 0, sizeof(frame.additionalInfo));
+
+    uint32_t first, second;
+    if (flags & FRAME_WIRE_VIDEO_INFO) {
+        if (!(pos = readVarint(pos, end, first)) || !(pos = readVarint(pos, end, second))
+            || first > UINT16_MAX || second > UINT16_MAX) {
+            return false;
+        }
+        frame.additionalInfo.video.width = first;
+        frame.additionalInfo.video.height = second;
+        frame.additionalInfo.video.isKeyFrame = flags & FRAME_WIRE_KEY_FRAME;
+    } else if (flags & FRAME_WIRE_AUDIO_INFO) {
+        if (!(pos = readVarint(pos, end, first)) || !(pos = readVarint(pos, end, second)) || end - pos < 2) {
+            return false;
+        }
+        frame.additionalInfo.audio.nbSamples = first;
+        frame.additionalInfo.audio.sampleRate = second;
+        frame.additionalInfo.audio.channels = *pos++;
+        frame.additionalInfo.audio.audioLevel = *pos++;
+        frame.additionalInfo.audio.isRtpPacket = (flags & FRAME_WIRE_RTP_PACKET) ? 1 : 0;
+        frame.additionalInfo.audio.voice = (flags & FRAME_WIRE_VOICE) ? 1 : 0;
+    }
+
+    const uint8_t* extensionsBegin = pos;
+    if (flags & FRAME_WIRE_EXTENSIONS) {
+        uint32_t type, size;
+        do {
+            if (!(pos = readVarint(pos, end, type))) {
+                return false;
+            }
+            if (type) {
+                if (!(pos = readVarint(pos, end, size)) || static_cast<size_t>(end - pos) < size) {
+                    return false;
+                }
+                pos += size;
+            }
+        } while (type);
+    }
+    if (extensions) {
+        extensions->pos = extensionsBegin;
+        extensions->end = pos;
+    }
+
+    if (static_cast<size_t>(end - pos) != payloadLength) {
+        return false;
+    }
+    frame.payload = const_cast<uint8_t*>(pos);
+    frame.buffer = nullptr;
+    return true;
+}
+
+inline bool FrameWireExtensions::next(FrameWireExtension& extension)
+{
+    uint32_t type, size;
+    // Checked by decodeFrame()
+    if (pos >= end || !(pos = readVarint(pos, end, type)) || !type
+        || !(pos = readVarint(pos, end, size))) {
+        pos = end;
+        return false;
+    }
+    extension.type = type;
+    extension.data = pos;
+    extension.length = size;
+    pos += size;
+    return true;
+}
+
+inline size_t encodeMetaDataHeader(const MetaData& metadata, uint8_t* out)
+{
+    uint8_t* pos = out;
+    *pos++ = kFrameWireVersion;
+    pos = writeVarint(pos, static_cast<uint32_t>(metadata.type));
+    pos = writeVarint(pos, metadata.length);
+    return pos - out;
+}
+
+inline bool decodeMetaData(const uint8_t* data, size_t length, MetaData& metadata)
+{
+    const uint8_t* pos = data;
+    const uint8_t* end = data + length;
+    uint32_t type, payloadLength;
+    if (length < 1 || *pos++ != kFrameWireVersion
+        || !(pos = readVarint(pos, end, type)) || !(pos = readVarint(pos, end, payloadLength))
+        || static_cast<size_t>(end - pos) != payloadLength) {
+        return false;
+    }
+    metadata.type = static_cast<MetaDataType>(type);
+    metadata.payload = const_cast<uint8_t*>(pos);
+    metadata.length = payloadLength;
+    return true;
+}
+
+/*
+ * The previous format, the Frame and MetaData structs as laid out in memory
+ * by builds before this format (40 and 24 bytes on x86_64), followed by the
+ * payload. Frozen copies of those structs, so it stays readable and
+ * writable for agents not upgraded yet whatever Frame becomes.
+ */
+struct LegacyVideoInfo {
+    uint16_t width;
+    uint16_t height;
+    bool isKeyFrame;
+};
+
+struct LegacyAudioInfo {
+    uint8_t isRtpPacket;
+    uint32_t nbSamples;
+    uint32_t sampleRate;
+    uint8_t channels;
+    uint8_t voice;
+    uint8_t audioLevel;
+};
+
+struct LegacyFrameLayout {
+    int32_t format;
+    uint8_t* payload;
+    uint32_t length;
+    uint32_t timeStamp;
+    union {
+        LegacyVideoInfo video;
+        LegacyAudioInfo audio;
+    } additionalInfo;
+};
+
+struct LegacyMetaDataLayout {
+    int32_t type;
+    uint8_t* payload;
+    uint32_t length;
+};
+
+static_assert(sizeof(void*) != 8 || sizeof(LegacyFrameLayout) == 40, "Legacy frame layout changed");
+static_assert(sizeof(void*) != 8 || sizeof(LegacyMetaDataLayout) == 24, "Legacy metadata layout changed");
+
+inline size_t encodeLegacyFrameHeader(const Frame& frame, uint8_t* out)
+{
+    LegacyFrameLayout layout;
+    memset(&layout, 0, sizeof(layout));
+    layout.format = frame.format;
+    layout.length = frame.length;
+    layout.timeStamp = frame.timeStamp;
+    if (isVideoFrame(frame)) {
+        layout.additionalInfo.video.width = frame.additionalInfo.video.width;
+        layout.additionalInfo.video.height = frame.additionalInfo.video.height;
+        layout.additionalInfo.video.isKeyFrame = frame.additionalInfo.video.isKeyFrame;
+    } else if (isAudioFrame(frame)) {
+        layout.additionalInfo.audio.isRtpPacket = frame.additionalInfo.audio.isRtpPacket;
+        layout.additionalInfo.audio.nbSamples = frame.additionalInfo.audio.nbSamples;
+        layout.additionalInfo.audio.sampleRate = frame.additionalInfo.audio.sampleRate;
+        layout.additionalInfo.audio.channels = frame.additionalInfo.audio.channels;
+        layout.additionalInfo.audio.voice = frame.additionalInfo.audio.voice;
+        layout.additionalInfo.audio.audioLevel = frame.additionalInfo.audio.audioLevel;
+    }
+    memcpy(out, &layout, sizeof(layout));
+    return sizeof(layout);
+}
+
+inline bool decodeLegacyFrame(const uint8_t* data, size_t length, Frame& frame)
+{
+    LegacyFrameLayout layout;
+    if (length < sizeof(layout)) {
+        return false;
+    }
+    memcpy(&layout, data, sizeof(layout));
+    if (layout.length != length - sizeof(layout)) {
+        return false;
+    }
+    frame.format = static_cast<FrameFormat>(layout.format);
+    frame.length = layout.length;
+    frame.timeStamp = layout.timeStamp;
+    memset(&frame.additionalInfo, 0, sizeof(frame.additionalInfo));
+    if (isVideoFrame(frame)) {
+        frame.additionalInfo.video.width = layout.additionalInfo.video.width;
+        frame.additionalInfo.video.height = layout.additionalInfo.video.height;
+        frame.additionalInfo.video.isKeyFrame = layout.additionalInfo.video.isKeyFrame;
+    } else if (isAudioFrame(frame)) {
+        frame.additionalInfo.audio.isRtpPacket = layout.additionalInfo.audio.isRtpPacket;
+        frame.additionalInfo.audio.nbSamples = layout.additionalInfo.audio.nbSamples;
+        frame.additionalInfo.audio.sampleRate = layout.additionalInfo.audio.sampleRate;
+        frame.additionalInfo.audio.channels = layout.additionalInfo.audio.channels;
+        frame.additionalInfo.audio.voice = layout.additionalInfo.audio.voice;
+        frame.additionalInfo.audio.audioLevel = layout.additionalInfo.audio.audioLevel;
+    }
+    frame.payload = const_cast<uint8_t*>(data + sizeof(layout));
+    frame.buffer = nullptr;
+    return true;
+}
+
+inline size_t encodeLegacyMetaDataHeader(const MetaData& metadata, uint8_t* out)
+{
+    LegacyMetaDataLayout layout;
+    memset(&layout, 0, sizeof(layout));
+    layout.type = metadata.type;
+    layout.length = metadata.length;
+    memcpy(out, &layout, sizeof(layout));
+    return sizeof(layout);
+}
+
+inline bool decodeLegacyMetaData(const uint8_t* data, size_t length, MetaData& metadata)
+{
+    LegacyMetaDataLayout layout;
+    if (length < sizeof(layout)) {
+        return false;
+    }
+    memcpy(&layout, data, sizeof(layout));
+    if (layout.length != length - sizeof(layout)) {
+        return false;
+    }
+    metadata.type = static_cast<MetaDataType>(layout.type);
+    metadata.payload = const_cast<uint8_t*>(data + sizeof(layout));
+    metadata.length = layout.length;
+    return true;
+}
+
+struct FrameWireConfig {
+    FrameWireConfig() : compact(false) {}
+
+    // Send the format of this file instead of the legacy one. Receivers
+    // read both, so only enable it once every agent of the cluster, and
+    // of the clusters cascaded to, reads it.
+    bool compact;
+
+    // Process wide, read by each frame sent
+    static FrameWireConfig& defaultConfig()
+    {
+        static FrameWireConfig config;
+        return config;
+    }
+};
+
+// Tag and header of a message in either format
+const size_t kFrameMessageMaxHeaderSize = 1
+    + (kFrameWireMaxHeaderSize > sizeof(LegacyFrameLayout) ? kFrameWireMaxHeaderSize : sizeof(LegacyFrameLayout));
+const size_t kMetaDataMessageMaxHeaderSize = 1
+    + (kMetaDataWireMaxHeaderSize > sizeof(LegacyMetaDataLayout) ? kMetaDataWireMaxHeaderSize : sizeof(LegacyMetaDataLayout));
+
+// Writes the tag and header of |frame| in the configured format to |out|, of
+// kFrameMessageMaxHeaderSize bytes, and returns their size
+inline size_t encodeFrameMessage(const Frame& frame, uint8_t* out)
+{
+    if (FrameWireConfig::defaultConfig().compact) {
+        out[0] = TDT_MEDIA_FRAME_WIRE;
+        return 1 + encodeFrameHeader(frame, out + 1);
+    }
+    out[0] = TDT_MEDIA_FRAME_LEGACY;
+    return 1 + encodeLegacyFrameHeader(frame, out + 1);
+}
+
+inline size_t encodeMetaDataMessage(const MetaData& metadata, uint8_t* out)
+{
+    if (FrameWireConfig::defaultConfig().compact) {
+        out[0] = TDT_MEDIA_METADATA_WIRE;
+        return 1 + encodeMetaDataHeader(metadata, out + 1);
+    }
+    out[0] = TDT_MEDIA_METADATA_LEGACY;
+    return 1 + encodeLegacyMetaDataHeader(metadata, out + 1);
+}
+
+} /* namespace owt_base */
+
+#endif /* FrameWireFormat_h */
@@ -0,0 +1,376 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE FrameWireFormat
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "FrameWireFormat.h"
+
+using namespace owt_base;
+
+static std::vector<uint8_t> encode(const Frame& frame,
+                                   const FrameWireExtension* extensions = nullptr, size_t count = 0)
+{
+    std::vector<uint8_t> message(kFrameWireMaxHeaderSize + frameWireExtensionsSize(extensions, count) + frame.length);
+    size_t headerLength = encodeFrameHeader(frame, message.data(), extensions, count);
+    memcpy(message.data() + headerLength, frame.payload, frame.length);
+    message.resize(headerLength + frame.length);
+    return message;
+}
+
+static Frame videoFrame(uint8_t* payload, uint32_t length)
+{
+    Frame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.format = FRAME_FORMAT_H264;
+    frame.payload = payload;
+    frame.length = length;
+    frame.timeStamp = 0xF1234567;
+    frame.additionalInfo.video.width = 1920;
+    frame.additionalInfo.video.height = 1080;
+    frame.additionalInfo.video.isKeyFrame = true;
+    return frame;
+}
+
+BOOST_AUTO_TEST_CASE(videoRoundTrip)
+{
+    std::vector<uint8_t> payload(5000, 0xAB);
+    Frame frame = videoFrame(payload.data(), payload.size());
+    std::vector<uint8_t> message = encode(frame);
+    // Versus 40 bytes for the legacy layout on x86_64
+    BOOST_CHECK_LE(message.size() - payload.size(), 14u);
+
+    Frame decoded;
+    BOOST_REQUIRE(decodeFrame(message.data(), message.size(), decoded));
+    BOOST_CHECK_EQUAL(decoded.format, FRAME_FORMAT_H264);
+    BOOST_CHECK_EQUAL(decoded.timeStamp, 0xF1234567);
+    BOOST_CHECK_EQUAL(decoded.length, payload.size());
+    BOOST_CHECK_EQUAL(decoded.additionalInfo.video.width, 1920);
+    BOOST_CHECK_EQUAL(decoded.additionalInfo.video.height, 1080);
+    BOOST_CHECK(decoded.additionalInfo.video.isKeyFrame);
+    BOOST_CHECK(decoded.buffer == nullptr);
+    // Zero copy, the payload is read in place
+    BOOST_CHECK(decoded.payload == message.data() + message.size() - payload.size());
+}
+
+BOOST_AUTO_TEST_CASE(audioRoundTrip)
+{
+    uint8_t payload[120] = { 1, 2, 3 };
+    Frame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.format = FRAME_FORMAT_OPUS;
+    frame.payload = payload;
+    frame.length = sizeof(payload);
+    frame.timeStamp = 960;
+    frame.additionalInfo.audio.isRtpPacket = 1;
+    frame.additionalInfo.audio.nbSamples = 960;
+    frame.additionalInfo.audio.sampleRate = 48000;
+    frame.additionalInfo.audio.channels = 2;
+    frame.additionalInfo.audio.voice = 1;
+    frame.additionalInfo.audio.audioLevel = 127;
+    std::vector<uint8_t> message = encode(frame);
+
+    Frame decoded;
+    BOOST_REQUIRE(decodeFrame(message.data(), message.size(), decoded));
+    BOOST_CHECK_EQUAL(decoded.format, FRAME_FORMAT_OPUS);
+    BOOST_CHECK_EQUAL(decoded.timeStamp, 960u);
+    BOOST_CHECK_EQUAL(decoded.additionalInfo.audio.isRtpPacket, 1);
+    BOOST_CHECK_EQUAL(decoded.additionalInfo.audio.nbSamples, 960u);
+    BOOST_CHECK_EQUAL(decoded.additionalInfo.audio.sampleRate, 48000u);
+    BOOST_CHECK_EQUAL(decoded.additionalInfo.audio.channels, 2);
+    BOOST_CHECK_EQUAL(decoded.additionalInfo.audio.voice, 1);
+    BOOST_CHECK_EQUAL(decoded.additionalInfo.audio.audioLevel, 127);
+    BOOST_CHECK_EQUAL(memcmp(decoded.payload, payload, sizeof(payload)), 0);
+}
+
+BOOST_AUTO_TEST_CASE(extensionsAreSkippable)
+{
+    uint8_t payload[16] = { 0 };
+    uint8_t first[3] = { 7, 8, 9 };
+    FrameWireExtension extensions[2] = { { 1, first, sizeof(first) }, { 300, nullptr, 0 } };
+    Frame frame = videoFrame(payload, sizeof(payload));
+    std::vector<uint8_t> message = encode(frame, extensions, 2);
+
+    Frame decoded;
+    FrameWireExtensions read;
+    BOOST_REQUIRE(decodeFrame(message.data(), message.size(), decoded, &read));
+    FrameWireExtension extension;
+    BOOST_REQUIRE(read.next(extension));
+    BOOST_CHECK_EQUAL(extension.type, 1u);
+    BOOST_CHECK_EQUAL(extension.length, 3u);
+    BOOST_CHECK_EQUAL(memcmp(extension.data, first, 3), 0);
+    BOOST_REQUIRE(read.next(extension));
+    BOOST_CHECK_EQUAL(extension.type, 300u);
+    BOOST_CHECK_EQUAL(extension.length, 0u);
+    BOOST_CHECK(!read.next(extension));
+    // Decoders not asking for them still get the frame
+    BOOST_CHECK(decodeFrame(message.data(), message.size(), decoded));
+    BOOST_CHECK_EQUAL(decoded.length, sizeof(payload));
+}
+
+BOOST_AUTO_TEST_CASE(rejectsOtherVersionsAndBadLengths)
+{
+    uint8_t payload[16] = { 0 };
+    Frame frame = videoFrame(payload, sizeof(payload));
+    std::vector<uint8_t> message = encode(frame);
+    Frame decoded;
+
+    message[0] = kFrameWireVersion + 1;
+    BOOST_CHECK(!decodeFrame(message.data(), message.size(), decoded));
+    message[0] = kFrameWireVersion;
+    BOOST_CHECK(!decodeFrame(message.data(), message.size() - 1, decoded));
+    message.push_back(0);
+    BOOST_CHECK(!decodeFrame(message.data(), message.size(), decoded));
+    BOOST_CHECK(!decodeFrame(message.data(), 0, decoded));
+}
+
+BOOST_AUTO_TEST_CASE(metaDataRoundTrip)
+{
+    uint8_t payload[] = "owner";
+    MetaData metadata{ META_DATA_OWNER_ID, payload, sizeof(payload) };
+    uint8_t message[kMetaDataWireMaxHeaderSize + sizeof(payload)];
+    size_t headerLength = encodeMetaDataHeader(metadata, message);
+    memcpy(message + headerLength, payload, sizeof(payload));
+
+    MetaData decoded;
+    BOOST_REQUIRE(decodeMetaData(message, headerLength + sizeof(payload), decoded));
+    BOOST_CHECK_EQUAL(decoded.type, META_DATA_OWNER_ID);
+    BOOST_CHECK_EQUAL(decoded.length, sizeof(payload));
+    BOOST_CHECK_EQUAL(memcmp(decoded.payload, payload, sizeof(payload)), 0);
+    BOOST_CHECK(!decodeMetaData(message, headerLength + sizeof(payload) - 1, decoded));
+}
+
+#if defined(__x86_64__)
+// Messages as sent by builds before the wire format, bytes not belonging
+// to a field are garbage there
+BOOST_AUTO_TEST_CASE(baselineLegacyMessages)
+{
+    const uint8_t video[40 + 4] = {
+        0xCA, 0x00, 0x00, 0x00, 0xEE, 0xEE, 0xEE, 0xEE, // format H264, padding
+        0x10, 0x32, 0x54, 0x76, 0x98, 0xBA, 0xDC, 0xFE, // payload pointer of the sender
+        0x04, 0x00, 0x00, 0x00, 0x04, 0x03, 0x02, 0x01, // length, timeStamp
+        0x00, 0x05, 0xD0, 0x02, 0x01, 0xEE, 0xEE, 0xEE, // width 1280, height 720, key frame
+        0xEE, 0xEE, 0xEE, 0xEE, 0xEE, 0xEE, 0xEE, 0xEE,
+        0xA1, 0xA2, 0xA3, 0xA4,
+    };
+    Frame frame;
+    BOOST_REQUIRE(decodeLegacyFrame(video, sizeof(video), frame));
+    BOOST_CHECK_EQUAL(frame.format, FRAME_FORMAT_H264);
+    BOOST_CHECK_EQUAL(frame.length, 4u);
+    BOOST_CHECK_EQUAL(frame.timeStamp, 0x01020304u);
+    BOOST_CHECK_EQUAL(frame.additionalInfo.video.width, 1280);
+    BOOST_CHECK_EQUAL(frame.additionalInfo.video.height, 720);
+    BOOST_CHECK(frame.additionalInfo.video.isKeyFrame);
+    BOOST_CHECK(frame.payload == video + 40);
+    BOOST_CHECK(frame.buffer == nullptr);
+    BOOST_CHECK(!decodeLegacyFrame(video, sizeof(video) - 1, frame));
+    BOOST_CHECK(!decodeLegacyFrame(video, 39, frame));
+
+    const uint8_t audio[40 + 2] = {
+        0x86, 0x03, 0x00, 0x00, 0xEE, 0xEE, 0xEE, 0xEE, // format OPUS
+        0x10, 0x32, 0x54, 0x76, 0x98, 0xBA, 0xDC, 0xFE,
+        0x02, 0x00, 0x00, 0x00, 0xC0, 0x03, 0x00, 0x00, // length, timeStamp 960
+        0x01, 0xEE, 0xEE, 0xEE, 0xC0, 0x03, 0x00, 0x00, // rtp packet, 960 samples
+        0x80, 0xBB, 0x00, 0x00, 0x02, 0x01, 0x7F, 0xEE, // 48000Hz, 2 channels, voice, level
+        0xB1, 0xB2,
+    };
+    BOOST_REQUIRE(decodeLegacyFrame(audio, sizeof(audio), frame));
+    BOOST_CHECK_EQUAL(frame.format, FRAME_FORMAT_OPUS);
+    BOOST_CHECK_EQUAL(frame.additionalInfo.audio.isRtpPacket, 1);
+    BOOST_CHECK_EQUAL(frame.additionalInfo.audio.nbSamples, 960u);
+    BOOST_CHECK_EQUAL(frame.additionalInfo.audio.sampleRate, 48000u);
+    BOOST_CHECK_EQUAL(frame.additionalInfo.audio.channels, 2);
+    BOOST_CHECK_EQUAL(frame.additionalInfo.audio.voice, 1);
+    BOOST_CHECK_EQUAL(frame.additionalInfo.audio.audioLevel, 127);
+    BOOST_CHECK(frame.payload == audio + 40);
+
+    const uint8_t metadata[24 + 3] = {
+        0x00, 0x00, 0x00, 0x00, 0xEE, 0xEE, 0xEE, 0xEE, // owner id
+        0x10, 0x32, 0x54, 0x76, 0x98, 0xBA, 0xDC, 0xFE,
+        0x03, 0x00, 0x00, 0x00, 0xEE, 0xEE, 0xEE, 0xEE,
+        'a', 'b', 'c',
+    };
+    MetaData decoded;
+    BOOST_REQUIRE(decodeLegacyMetaData(metadata, sizeof(metadata), decoded));
+    BOOST_CHECK_EQUAL(decoded.type, META_DATA_OWNER_ID);
+    BOOST_CHECK_EQUAL(decoded.length, 3u);
+    BOOST_CHECK(decoded.payload == metadata + 24);
+}
+
+// Legacy messages of this build must be what baseline builds read
+BOOST_AUTO_TEST_CASE(legacyEncodeMatchesBaseline)
+{
+    uint8_t payload[4] = { 0xA1, 0xA2, 0xA3, 0xA4 };
+    Frame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.format = FRAME_FORMAT_H264;
+    frame.payload = payload;
+    frame.length = sizeof(payload);
+    frame.timeStamp = 0x01020304;
+    frame.additionalInfo.video.width = 1280;
+    frame.additionalInfo.video.height = 720;
+    frame.additionalInfo.video.isKeyFrame = true;
+
+    uint8_t header[kFrameMessageMaxHeaderSize];
+    BOOST_REQUIRE_EQUAL(encodeLegacyFrameHeader(frame, header), 40u);
+    const uint8_t fields[] = { 0xCA, 0x00, 0x00, 0x00 };
+    BOOST_CHECK_EQUAL(memcmp(header, fields, 4), 0);
+    const uint8_t lengthAndInfo[] = { 0x04, 0x00, 0x00, 0x00, 0x04, 0x03, 0x02, 0x01, 0x00, 0x05, 0xD0, 0x02, 0x01 };
+    BOOST_CHECK_EQUAL(memcmp(header + 16, lengthAndInfo, sizeof(lengthAndInfo)), 0);
+}
+#endif
+
+BOOST_AUTO_TEST_CASE(messagesFollowConfig)
+{
+    uint8_t payload[8] = { 0 };
+    Frame frame = videoFrame(payload, sizeof(payload));
+    uint8_t header[kFrameMessageMaxHeaderSize];
+    Frame decoded;
+
+    // Legacy unless enabled, so agents not upgraded keep reading it
+    BOOST_REQUIRE(!FrameWireConfig::defaultConfig().compact);
+    size_t length = encodeFrameMessage(frame, header);
+    BOOST_CHECK_EQUAL(header[0], static_cast<uint8_t>(TDT_MEDIA_FRAME_LEGACY));
+    std::vector<uint8_t> message(header + 1, header + length);
+    message.insert(message.end(), payload, payload + sizeof(payload));
+    BOOST_REQUIRE(decodeLegacyFrame(message.data(), message.size(), decoded));
+    BOOST_CHECK_EQUAL(decoded.additionalInfo.video.width, 1920);
+    BOOST_CHECK_EQUAL(decoded.timeStamp, frame.timeStamp);
+
+    FrameWireConfig::defaultConfig().compact = true;
+    length = encodeFrameMessage(frame, header);
+    FrameWireConfig::defaultConfig().compact = false;
+    BOOST_CHECK_EQUAL(header[0], static_cast<uint8_t>(TDT_MEDIA_FRAME_WIRE));
+    message.assign(header + 1, header + length);
+    message.insert(message.end(), payload, payload + sizeof(payload));
+    BOOST_REQUIRE(decodeFrame(message.data(), message.size(), decoded));
+    BOOST_CHECK(decoded.additionalInfo.video.isKeyFrame);
+
+    uint8_t owner[] = "owner";
+    MetaData metadata{ META_DATA_OWNER_ID, owner, sizeof(owner) };
+    uint8_t metaHeader[kMetaDataMessageMaxHeaderSize];
+    length = encodeMetaDataMessage(metadata, metaHeader);
+    BOOST_CHECK_EQUAL(metaHeader[0], static_cast<uint8_t>(TDT_MEDIA_METADATA_LEGACY));
+    message.assign(metaHeader + 1, metaHeader + length);
+    message.insert(message.end(), owner, owner + sizeof(owner));
+    MetaData decodedMeta;
+    BOOST_REQUIRE(decodeLegacyMetaData(message.data(), message.size(), decodedMeta));
+    BOOST_CHECK_EQUAL(decodedMeta.length, sizeof(owner));
+}
+
+// Decoding random and corrupted messages must only read within them,
+// run under ASan to catch overreads
+BOOST_AUTO_TEST_CASE(fuzz)
+{
+    std::mt19937 random(20211018);
+    std::vector<uint8_t> payload(300);
+    for (auto& byte : payload) {
+        byte = random();
+    }
+    const FrameFormat formats[] = { FRAME_FORMAT_VP8, FRAME_FORMAT_OPUS, FRAME_FORMAT_DATA, FRAME_FORMAT_H265 };
+    uint8_t extensionData[8] = { 0 };
+
+    int decoded = 0;
+    for (int i = 0; i < 200000; i++) {
+        std::vector<uint8_t> message;
+        if (i % 4 == 0) {
+            message.resize(random() % 64);
+            for (auto& byte : message) {
+                byte = random();
+            }
+        } else {
+            Frame frame = videoFrame(payload.data(), random() % payload.size());
+            frame.format = formats[random() % 4];
+            frame.timeStamp = random();
+            FrameWireExtension extension{ static_cast<uint32_t>(random() % 1000 + 1), extensionData,
+                static_cast<uint32_t>(random() % sizeof(extensionData)) };
+            message = encode(frame, &extension, random() % 2);
+            // Flip, truncate or extend
+            int mutations = random() % 4;
+            for (int m = 0; m < mutations && !message.empty(); m++) {
+                switch (random() % 3) {
+                case 0:
+                    message[random() % message.size()] ^= 1 << (random() % 8);
+                    break;
+                case 1:
+                    message.resize(random() % message.size());
+                    break;
+                default:
+                    message.push_back(random());
+                    break;
+                }
+            }
+        }
+        // Copied to an exact size buffer so overreads go past it
+        std::unique_ptr<uint8_t[]> exact(new uint8_t[message.size() + 1]);
+        if (!message.empty()) {
+            memcpy(exact.get(), message.data(), message.size());
+        }
+        Frame frame;
+        FrameWireExtensions extensions;
+        if (decodeFrame(exact.get(), message.size(), frame, &extensions)) {
+            decoded++;
+            BOOST_REQUIRE(frame.payload >= exact.get());
+            BOOST_REQUIRE(frame.payload + frame.length == exact.get() + message.size());
+            FrameWireExtension extension;
+            while (extensions.next(extension)) {
+                BOOST_REQUIRE(extension.data + extension.length <= frame.payload);
+            }
+        }
+    }
+    BOOST_TEST_MESSAGE("Decoded " << decoded << " of 200000 fuzzed messages");
+    BOOST_CHECK_GT(decoded, 0);
+}
+
+BOOST_AUTO_TEST_CASE(benchmark)
+{
+    const int iterations = 1000000;
+    std::vector<uint8_t> payload(1200, 1);
+    Frame frame = videoFrame(payload.data(), payload.size());
+    uint8_t legacyHeader[sizeof(LegacyFrameLayout)];
+    uint8_t header[kFrameWireMaxHeaderSize];
+    size_t headerLength = encodeFrameHeader(frame, header);
+    std::vector<uint8_t> message = encode(frame);
+    std::vector<uint8_t> legacyMessage(sizeof(LegacyFrameLayout) + payload.size());
+    size_t legacyHeaderLength = encodeLegacyFrameHeader(frame, legacyMessage.data());
+    uint64_t sink = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        frame.timeStamp = i;
+        sink += encodeLegacyFrameHeader(frame, legacyHeader) + legacyHeader[i % sizeof(legacyHeader)];
+    }
+    auto legacyEncode = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        frame.timeStamp = i;
+        sink += encodeFrameHeader(frame, header);
+    }
+    auto wireEncode = std::chrono::steady_clock::now() - start;
+
+    Frame decoded;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        legacyMessage[20] = i;
+        sink += decodeLegacyFrame(legacyMessage.data(), legacyMessage.size(), decoded) + decoded.length;
+    }
+    auto legacyDecode = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        message[3] = i;
+        sink += decodeFrame(message.data(), message.size(), decoded) + decoded.length;
+    }
+    auto wireDecode = std::chrono::steady_clock::now() - start;
+
+    auto ns = [](std::chrono::steady_clock::duration d) {
+        return std::chrono::duration<double, std::nano>(d).count() / iterations;
+    };
+    BOOST_TEST_MESSAGE("Header bytes: legacy " << legacyHeaderLength << ", wire " << headerLength);
+    BOOST_TEST_MESSAGE("Encode ns: legacy " << ns(legacyEncode) << ", wire " << ns(wireEncode));
+    BOOST_TEST_MESSAGE("Decode ns: legacy " << ns(legacyDecode) << ", wire " << ns(wireDecode));
+    BOOST_CHECK(sink > 0);
+}
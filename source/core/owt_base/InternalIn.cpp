@@ -3,6 +3,8 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "InternalIn.h"
+#include "FrameWireFormat.h"
+#include "ShmTransport.h"
 
 namespace owt_base {
 
@@ -10,6 +12,8 @@ InternalIn::InternalIn(const std::string& protocol, unsigned int minPort, unsign
 {
     if (protocol == "tcp")
         m_transport.reset(new owt_base::RawTransport<TCP>(this));
+    else if (protocol == "shm")
+        m_transport.reset(new owt_base::ShmTransport(this));
     else
         m_transport.reset(new owt_base::RawTransport<UDP>(this, 64 * 1024));
 
@@ -28,6 +32,8 @@ InternalIn::InternalIn(
 {
     if (protocol == "tcp")
         m_transport.reset(new owt_base::RawTransport<TCP>(this));
+    else if (protocol == "shm")
+        m_transport.reset(new owt_base::ShmTransport(this));
     else
         m_transport.reset(new owt_base::RawTransport<UDP>(this, 64 * 1024));
 
@@ -59,18 +65,33 @@ void InternalIn::onFeedback(const FeedbackMsg& msg)
 
 void InternalIn::onTransportData(char* buf, int len)
 {
-    Frame* frame = nullptr;
-    MetaData* metadata = nullptr;
+    Frame frame;
+    MetaData metadata;
+    if (len <= 1) {
+        return;
+    }
+    const uint8_t* data = reinterpret_cast<uint8_t*>(buf + 1);
     switch (buf[0]) {
+        case TDT_MEDIA_FRAME_WIRE:
+            if (decodeFrame(data, len - 1, frame)) {
+                deliverFrame(frame);
+            }
+            break;
+        case TDT_MEDIA_METADATA_WIRE:
+            if (decodeMetaData(data, len - 1, metadata)) {
+                deliverMetaData(metadata);
+            }
+            break;
+        // From agents sending the previous format
         case TDT_MEDIA_FRAME:
-            frame = reinterpret_cast<Frame*>(buf + 1);
-            frame->payload = reinterpret_cast<uint8_t*>(buf + 1 + sizeof(Frame));
-            deliverFrame(*frame);
+            if (decodeLegacyFrame(data, len - 1, frame)) {
+                deliverFrame(frame);
+            }
             break;
         case TDT_MEDIA_METADATA:
-            metadata = reinterpret_cast<MetaData*>(buf + 1);
-            metadata->payload = reinterpret_cast<uint8_t*>(buf + 1 + sizeof(MetaData));
-            deliverMetaData(*metadata);
+            if (decodeLegacyMetaData(data, len - 1, metadata)) {
+                deliverMetaData(metadata);
+            }
             break;
         default:
             break;
@@ -3,6 +3,8 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "InternalOut.h"
+#include "FrameWireFormat.h"
+#include "ShmTransport.h"
 
 namespace owt_base {
 
@@ -10,6 +12,8 @@ InternalOut::InternalOut(const std::string& protocol, const std::string& dest_ip
 {
     if (protocol == "tcp")
         m_transport.reset(new owt_base::RawTransport<TCP>(this));
+    else if (protocol == "shm")
+        m_transport.reset(new owt_base::ShmTransport(this));
     else
         m_transport.reset(new owt_base::RawTransport<UDP>(this));
 
@@ -24,6 +28,8 @@ InternalOut::InternalOut(
 {
     if (protocol == "tcp")
         m_transport.reset(new owt_base::RawTransport<TCP>(this));
+    else if (protocol == "shm")
+        m_transport.reset(new owt_base::ShmTransport(this));
     else
         m_transport.reset(new owt_base::RawTransport<UDP>(this));
 
@@ -38,22 +44,22 @@ InternalOut::~InternalOut()
 
 void InternalOut::onFrame(const Frame& frame)
 {
-    char sendBuffer[sizeof(Frame) + 1];
-    size_t header_len = sizeof(Frame);
+    char sendBuffer[kFrameMessageMaxHeaderSize];
+    size_t header_len = encodeFrameMessage(frame, reinterpret_cast<uint8_t*>(sendBuffer));
 
-    sendBuffer[0] = TDT_MEDIA_FRAME;
-    memcpy(&sendBuffer[1], reinterpret_cast<char*>(const_cast<Frame*>(&frame)), header_len);
-    m_transport->sendData(sendBuffer, header_len + 1, reinterpret_cast<char*>(const_cast<uint8_t*>(frame.payload)), frame.length);
+    if (frame.buffer) {
+        m_transport->sendData(sendBuffer, header_len, retainPayload(frame), frame.length, sendItemKind(frame));
+    } else {
+        m_transport->sendData(sendBuffer, header_len, reinterpret_cast<char*>(const_cast<uint8_t*>(frame.payload)), frame.length, sendItemKind(frame));
+    }
 }
 
 void InternalOut::onMetaData(const MetaData& metadata)
 {
-    char sendBuffer[sizeof(MetaData) + 1];
-    size_t header_len = sizeof(MetaData);
+    char sendBuffer[kMetaDataMessageMaxHeaderSize];
+    size_t header_len = encodeMetaDataMessage(metadata, reinterpret_cast<uint8_t*>(sendBuffer));
 
-    sendBuffer[0] = TDT_MEDIA_METADATA;
-    memcpy(&sendBuffer[1], reinterpret_cast<char*>(const_cast<MetaData*>(&metadata)), header_len);
-    m_transport->sendData(sendBuffer, header_len + 1, reinterpret_cast<char*>(const_cast<uint8_t*>(metadata.payload)), metadata.length);
+    m_transport->sendData(sendBuffer, header_len, reinterpret_cast<char*>(const_cast<uint8_t*>(metadata.payload)), metadata.length);
 }
 
 void InternalOut::onTransportData(char* buf, int len)
@@ -66,5 +72,10 @@ void InternalOut::onTransportData(char* buf, int len)
     }
 }
 
+void InternalOut::onTransportKeyFrameNeeded()
+{
+    deliverFeedbackMsg(FeedbackMsg{.type = VIDEO_FEEDBACK, .cmd = REQUEST_KEY_FRAME});
+}
+
 } /* namespace owt_base */
 
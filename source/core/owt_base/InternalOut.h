@@ -19,11 +19,14 @@ public:
 
     void onFrame(const Frame&);
     void onMetaData(const MetaData&);
+    // Queued by the transport until sent
+    bool keepsPayload() { return true; }
 
 
     void onTransportData(char*, int len);
     void onTransportError() { }
     void onTransportConnected() { }
+    void onTransportKeyFrameNeeded();
 
 private:
     boost::shared_ptr<owt_base::RawTransportInterface> m_transport;
@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "InternalSctp.h"
+#include "FrameWireFormat.h"
 
 namespace owt_base {
 
@@ -24,12 +25,10 @@ void InternalSctp::connect(const std::string &ip, unsigned int udpPort, unsigned
 
 void InternalSctp::onFrame(const Frame& frame)
 {
-    char sendBuffer[sizeof(Frame) + 1];
-    size_t header_len = sizeof(Frame);
+    char sendBuffer[kFrameMessageMaxHeaderSize];
+    size_t header_len = encodeFrameMessage(frame, reinterpret_cast<uint8_t*>(sendBuffer));
 
-    sendBuffer[0] = TDT_MEDIA_FRAME;
-    memcpy(&sendBuffer[1], reinterpret_cast<char*>(const_cast<Frame*>(&frame)), header_len);
-    m_transport->sendData(sendBuffer, header_len + 1, reinterpret_cast<char*>(const_cast<uint8_t*>(frame.payload)), frame.length);
+    m_transport->sendData(sendBuffer, header_len, reinterpret_cast<char*>(const_cast<uint8_t*>(frame.payload)), frame.length);
 }
 
 void InternalSctp::onFeedback(const FeedbackMsg& msg)
@@ -42,12 +41,20 @@ void InternalSctp::onFeedback(const FeedbackMsg& msg)
 
 void InternalSctp::onTransportData(char* buf, int len)
 {
-    Frame* frame = nullptr;
+    Frame frame;
+    if (len <= 1) {
+        return;
+    }
     switch (buf[0]) {
+        case TDT_MEDIA_FRAME_WIRE:
+            if (decodeFrame(reinterpret_cast<uint8_t*>(buf + 1), len - 1, frame)) {
+                deliverFrame(frame);
+            }
+            break;
         case TDT_MEDIA_FRAME:
-            frame = reinterpret_cast<Frame*>(buf + 1);
-            frame->payload = reinterpret_cast<uint8_t*>(buf + 1 + sizeof(Frame));
-            deliverFrame(*frame);
+            if (decodeLegacyFrame(reinterpret_cast<uint8_t*>(buf + 1), len - 1, frame)) {
+                deliverFrame(frame);
+            }
             break;
         case TDT_FEEDBACK_MSG:
             deliverFeedbackMsg(*(reinterpret_cast<FeedbackMsg*>(buf + 1)));
@@ -155,6 +155,78 @@ void FramePacketBuffer::clear()
     return;
 }
 
+/*
+ * Threads pacing the jitter buffers of all streams in the process. Each
+ * io_service is run by exactly one thread, so the timer handlers of one
+ * jitter buffer never run concurrently and are executed in post order.
+ */
+class PacingThreadPool {
+public:
+    static PacingThreadPool& GetInstance()
+    {
+        // Intentionally leaked, the threads are never joined.
+        static PacingThreadPool* pool = nullptr;
+        static boost::once_flag once = BOOST_ONCE_INIT;
+
+        boost::call_once(once, []() {
+            uint32_t threadCount = boost::thread::hardware_concurrency() / 4;
+            if (threadCount < 2)
+                threadCount = 2;
+            if (threadCount > 8)
+                threadCount = 8;
+            pool = new PacingThreadPool(threadCount);
+        });
+        return *pool;
+    }
+
+    // Returns the service with the fewest jitter buffers
+    boost::asio::io_service& acquire()
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        Worker* best = m_workers[0];
+        for (auto worker : m_workers) {
+            if (worker->users < best->users)
+                best = worker;
+        }
+        best->users++;
+        return best->service;
+    }
+
+    void release(boost::asio::io_service& service)
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        for (auto worker : m_workers) {
+            if (&worker->service == &service) {
+                worker->users--;
+                break;
+            }
+        }
+    }
+
+private:
+    struct Worker {
+        Worker() : work(service), users(0) {}
+
+        boost::asio::io_service service;
+        boost::asio::io_service::work work;
+        boost::scoped_ptr<boost::thread> thread;
+        uint32_t users;
+    };
+
+    PacingThreadPool(uint32_t threadCount)
+    {
+        for (uint32_t i = 0; i < threadCount; i++) {
+            Worker* worker = new Worker();
+            worker->thread.reset(new boost::thread(
+                boost::bind(&boost::asio::io_service::run, &worker->service)));
+            m_workers.push_back(worker);
+        }
+    }
+
+    boost::mutex m_mutex;
+    std::vector<Worker*> m_workers;
+};
+
 DEFINE_LOGGER(JitterBuffer, "owt.LiveStreamIn.JitterBuffer");
 
 JitterBuffer::JitterBuffer(std::string name, SyncMode syncMode, JitterBufferListener *listener, int64_t maxBufferingMs)
@@ -165,6 +237,7 @@ JitterBuffer::JitterBuffer(std::string name, SyncMode syncMode, JitterBufferList
     , m_lastInterval(5)
     , m_isFirstFramePacket(true)
     , m_listener(listener)
+    , m_ioService(nullptr)
     , m_syncTimestamp(AV_NOPTS_VALUE)
     , m_firstTimestamp(AV_NOPTS_VALUE)
     , m_maxBufferingMs(maxBufferingMs)
@@ -181,10 +254,10 @@ void JitterBuffer::start(uint32_t delay)
     if (!m_isRunning) {
         ELOG_DEBUG_T("(%s)start", m_name.c_str());
 
-        m_timer.reset(new boost::asio::deadline_timer(m_ioService));
+        m_ioService = &PacingThreadPool::GetInstance().acquire();
+        m_timer.reset(new boost::asio::deadline_timer(*m_ioService));
         m_timer->expires_from_now(boost::posix_time::milliseconds(delay));
         m_timer->async_wait(boost::bind(&JitterBuffer::onTimeout, this, boost::asio::placeholders::error));
-        m_timingThread.reset(new boost::thread(boost::bind(&boost::asio::io_service::run, &m_ioService)));
         m_isRunning = true;
     }
 }
@@ -194,12 +267,32 @@ void JitterBuffer::stop()
     if (m_isRunning) {
         ELOG_DEBUG_T("(%s)stop", m_name.c_str());
 
-        m_timer->cancel();
-
         m_isClosing = true;
-        m_timingThread->join();
+
+        // Cancel on the pacing thread, which then runs the aborted handler
+        // before the barrier posted behind it.
+        boost::mutex doneMutex;
+        boost::condition_variable doneCond;
+        bool done = false;
+        m_ioService->post([this, &doneMutex, &doneCond, &done]() {
+            m_timer->cancel();
+            m_ioService->post([&doneMutex, &doneCond, &done]() {
+                boost::mutex::scoped_lock lock(doneMutex);
+                done = true;
+                doneCond.notify_one();
+            });
+        });
+        {
+            boost::mutex::scoped_lock lock(doneMutex);
+            while (!done)
+                doneCond.wait(lock);
+        }
+
+        m_timer.reset();
+        PacingThreadPool::GetInstance().release(*m_ioService);
+        m_ioService = nullptr;
+
         m_buffer.clear();
-        m_ioService.reset();
         m_isRunning = false;
         m_isClosing = false;
 
@@ -137,8 +137,8 @@ private:
 
     FramePacketBuffer m_buffer;
 
-    boost::scoped_ptr<boost::thread> m_timingThread;
-    boost::asio::io_service m_ioService;
+    // Shared pacing service, set while running
+    boost::asio::io_service *m_ioService;
     boost::scoped_ptr<boost::asio::deadline_timer> m_timer;
 
     boost::scoped_ptr<boost::posix_time::ptime> m_syncLocalTime;
@@ -0,0 +1,242 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// Benchmark of the jitter buffer pacing of LiveStreamIn. Each ingest has an
+// audio pacer firing every 20ms and a video pacer firing every 33ms, as the
+// two JitterBuffers of a stream do. Every pacer re-arms a deadline_timer from
+// its handler and does a bit of work standing in for the frame delivery.
+//
+// In "own" mode every pacer runs its own io_service and thread, as
+// JitterBuffer did before. In "shared" mode the pacers are spread over the
+// fewest used of a few single threaded io_services, sized like the
+// PacingThreadPool in LiveStreamIn.cpp, and stopped with the same barrier.
+// Reports the thread count and how late the handlers ran. The FFmpeg free
+// copy of the timer structure keeps the benchmark buildable without FFmpeg.
+//
+// Build and run from this directory:
+//   g++ -O2 -std=c++11 LiveStreamInPacingBench.cc -lboost_thread -lboost_system -pthread -o LiveStreamInPacingBench
+//   ./LiveStreamInPacingBench <ingests> own|shared [seconds]
+
+#include <algorithm>
+#include <atomic>
+#include <boost/asio.hpp>
+#include <boost/bind.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread.hpp>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+class PacingPool {
+public:
+    explicit PacingPool(uint32_t threadCount)
+    {
+        for (uint32_t i = 0; i < threadCount; i++) {
+            Worker* worker = new Worker();
+            worker->thread.reset(new boost::thread(
+                boost::bind(&boost::asio::io_service::run, &worker->service)));
+            m_workers.push_back(worker);
+        }
+    }
+
+    boost::asio::io_service& acquire()
+    {
+        Worker* best = m_workers[0];
+        for (auto worker : m_workers) {
+            if (worker->users < best->users)
+                best = worker;
+        }
+        best->users++;
+        return best->service;
+    }
+
+private:
+    struct Worker {
+        Worker() : work(service), users(0) {}
+
+        boost::asio::io_service service;
+        boost::asio::io_service::work work;
+        boost::scoped_ptr<boost::thread> thread;
+        uint32_t users;
+    };
+
+    std::vector<Worker*> m_workers;
+};
+
+class Pacer {
+public:
+    Pacer(int periodMs, std::vector<int64_t>* lateUs, std::mutex* lateMutex)
+        : m_service(nullptr)
+        , m_periodMs(periodMs)
+        , m_lateUs(lateUs)
+        , m_lateMutex(lateMutex)
+        , m_closing(false)
+        , m_stopped(false)
+        , m_ticksAfterStop(0)
+    {
+    }
+
+    void start(boost::asio::io_service& service)
+    {
+        m_service = &service;
+        m_timer.reset(new boost::asio::deadline_timer(service));
+        arm();
+    }
+
+    void startOwn()
+    {
+        m_ownService.reset(new boost::asio::io_service());
+        start(*m_ownService);
+        m_ownThread.reset(new boost::thread(boost::bind(&boost::asio::io_service::run, m_ownService.get())));
+    }
+
+    // Same as JitterBuffer::stop(), the timer is canceled on the pacing
+    // thread and a barrier behind the aborted handler is waited for.
+    void stop()
+    {
+        m_closing = true;
+        if (m_ownThread) {
+            m_timer->cancel();
+            m_ownThread->join();
+            return;
+        }
+        boost::mutex doneMutex;
+        boost::condition_variable doneCond;
+        bool done = false;
+        m_service->post([this, &doneMutex, &doneCond, &done]() {
+            m_timer->cancel();
+            m_service->post([&doneMutex, &doneCond, &done]() {
+                boost::mutex::scoped_lock lock(doneMutex);
+                done = true;
+                doneCond.notify_one();
+            });
+        });
+        boost::mutex::scoped_lock lock(doneMutex);
+        while (!done)
+            doneCond.wait(lock);
+        m_stopped = true;
+    }
+
+    uint32_t ticksAfterStop() const { return m_ticksAfterStop; }
+
+private:
+    void arm()
+    {
+        m_due = Clock::now() + std::chrono::milliseconds(m_periodMs);
+        m_timer->expires_from_now(boost::posix_time::milliseconds(m_periodMs));
+        m_timer->async_wait(boost::bind(&Pacer::onTimeout, this, boost::asio::placeholders::error));
+    }
+
+    void onTimeout(const boost::system::error_code& ec)
+    {
+        if (m_stopped)
+            m_ticksAfterStop++;
+        if (ec || m_closing)
+            return;
+
+        int64_t late = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - m_due).count();
+        // Stands in for popping and delivering a frame
+        volatile long sum = 0;
+        for (long i = 0; i < 20000; i++)
+            sum += i;
+        {
+            std::lock_guard<std::mutex> lock(*m_lateMutex);
+            m_lateUs->push_back(late);
+        }
+        arm();
+    }
+
+    boost::asio::io_service* m_service;
+    boost::scoped_ptr<boost::asio::io_service> m_ownService;
+    boost::scoped_ptr<boost::thread> m_ownThread;
+    boost::scoped_ptr<boost::asio::deadline_timer> m_timer;
+    int m_periodMs;
+    Clock::time_point m_due;
+    std::vector<int64_t>* m_lateUs;
+    std::mutex* m_lateMutex;
+    std::atomic<bool> m_closing;
+    std::atomic<bool> m_stopped;
+    std::atomic<uint32_t> m_ticksAfterStop;
+};
+
+int threadCount()
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 8, "Threads:") == 0)
+            return atoi(line.c_str() + 8);
+    }
+    return 0;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3) {
+        printf("Usage: %s <ingests> own|shared [seconds]\n", argv[0]);
+        return 2;
+    }
+    const int ingests = atoi(argv[1]);
+    const bool shared = std::string(argv[2]) == "shared";
+    const int seconds = argc > 3 ? atoi(argv[3]) : 3;
+
+    std::vector<int64_t> lateUs;
+    std::mutex lateMutex;
+    boost::scoped_ptr<PacingPool> pool;
+    if (shared) {
+        pool.reset(new PacingPool(std::min(8u, std::max(2u, boost::thread::hardware_concurrency() / 4))));
+    }
+
+    std::vector<Pacer*> pacers;
+    for (int i = 0; i < ingests * 2; i++) {
+        Pacer* pacer = new Pacer((i % 2) ? 20 : 33, &lateUs, &lateMutex);
+        if (shared)
+            pacer->start(pool->acquire());
+        else
+            pacer->startOwn();
+        pacers.push_back(pacer);
+    }
+
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    int threads = threadCount();
+    for (auto pacer : pacers)
+        pacer->stop();
+
+    std::vector<int64_t> late;
+    {
+        std::lock_guard<std::mutex> lock(lateMutex);
+        late = lateUs;
+    }
+    if (late.empty()) {
+        printf("no ticks\n");
+        return 1;
+    }
+    std::sort(late.begin(), late.end());
+    printf("%-6s ingests %4d, threads %4d, ticks %zu, late p50 %ldus p99 %ldus max %ldus\n", argv[2], ingests,
+        threads, late.size(), (long)late[late.size() / 2], (long)late[late.size() * 99 / 100], (long)late.back());
+
+    // Give a handler wrongly left behind by stop() the chance to run
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    uint32_t ticksAfterStop = 0;
+    for (auto pacer : pacers)
+        ticksAfterStop += pacer->ticksAfterStop();
+    if (ticksAfterStop) {
+        printf("%u handlers ran after stop\n", ticksAfterStop);
+        return 1;
+    }
+    // The pool threads are never joined, as in LiveStreamIn.
+    fflush(stdout);
+    _exit(0);
+}
@@ -56,6 +56,29 @@ LiveStreamOut::~LiveStreamOut()
 }
 
 bool LiveStreamOut::isAudioFormatSupported(FrameFormat format)
+{
+    return supportsAudioFormat(format);
+}
+
+bool LiveStreamOut::isVideoFormatSupported(FrameFormat format)
+{
+    return supportsVideoFormat(format);
+}
+
+const char *LiveStreamOut::getFormatName(std::string& url)
+{
+    const char *name = formatName(m_options);
+    if (!name)
+        ELOG_ERROR("Invalid format for url(%s)", url.c_str());
+    return name;
+}
+
+bool LiveStreamOut::getHeaderOpt(std::string& url, AVDictionary **options)
+{
+    return getMuxerOptions(m_options, url, options);
+}
+
+bool LiveStreamOut::supportsAudioFormat(FrameFormat format)
 {
     switch (format) {
         case owt_base::FRAME_FORMAT_AAC:
@@ -66,7 +89,7 @@ bool LiveStreamOut::isAudioFormatSupported(FrameFormat format)
     }
 }
 
-bool LiveStreamOut::isVideoFormatSupported(FrameFormat format)
+bool LiveStreamOut::supportsVideoFormat(FrameFormat format)
 {
     switch (format) {
         case owt_base::FRAME_FORMAT_H264:
@@ -76,9 +99,9 @@ bool LiveStreamOut::isVideoFormatSupported(FrameFormat format)
     }
 }
 
-const char *LiveStreamOut::getFormatName(std::string& url)
+const char *LiveStreamOut::formatName(const StreamingOptions& options)
 {
-    switch(m_options.format) {
+    switch(options.format) {
         case STREAMING_FORMAT_RTSP:
             return "rtsp";
         case STREAMING_FORMAT_RTMP:
@@ -88,14 +111,13 @@ const char *LiveStreamOut::getFormatName(std::string& url)
         case STREAMING_FORMAT_DASH:
             return "dash";
         default:
-            ELOG_ERROR("Invalid format for url(%s)", url.c_str());
             return NULL;
     }
 }
 
-bool LiveStreamOut::getHeaderOpt(std::string& url, AVDictionary **options)
+bool LiveStreamOut::getMuxerOptions(const StreamingOptions& opts, const std::string& url, AVDictionary **options)
 {
-    if (m_options.format == STREAMING_FORMAT_HLS) {
+    if (opts.format == STREAMING_FORMAT_HLS) {
         std::string::size_type pos1 = url.rfind('/');
         if (pos1 == std::string::npos) {
             ELOG_ERROR("Cant not find base url %s", url.c_str());
@@ -124,14 +146,14 @@ bool LiveStreamOut::getHeaderOpt(std::string& url, AVDictionary **options)
 
         av_dict_set(options, "hls_flags", "delete_segments", 0);
 
-        av_dict_set_int(options, "hls_time", m_options.hls_time, 0);
-        av_dict_set_int(options, "hls_list_size", m_options.hls_list_size, 0);
+        av_dict_set_int(options, "hls_time", opts.hls_time, 0);
+        av_dict_set_int(options, "hls_list_size", opts.hls_list_size, 0);
 
         if (url.find("http://") == 0
                 || url.find("https://") == 0) {
-            av_dict_set(options, "method", m_options.hls_method, 0);
+            av_dict_set(options, "method", opts.hls_method, 0);
         }
-    } else if (m_options.format == STREAMING_FORMAT_DASH) {
+    } else if (opts.format == STREAMING_FORMAT_DASH) {
         std::string::size_type last_slash = url.rfind('/');
         if(last_slash == std::string::npos) {
             ELOG_ERROR("Unexpected format of %s", url.c_str());
@@ -161,13 +183,13 @@ bool LiveStreamOut::getHeaderOpt(std::string& url, AVDictionary **options)
         av_dict_set(options, "dash_segment_type", "mp4", 0);
         av_dict_set(options, "remove_at_exit", "1", 0);
 
-        av_dict_set_int(options, "seg_duration", m_options.dash_seg_duration, 0);
-        av_dict_set_int(options, "window_size", m_options.dash_window_size, 0);
-        av_dict_set_int(options, "extra_window_size", m_options.dash_window_size, 0);
+        av_dict_set_int(options, "seg_duration", opts.dash_seg_duration, 0);
+        av_dict_set_int(options, "window_size", opts.dash_window_size, 0);
+        av_dict_set_int(options, "extra_window_size", opts.dash_window_size, 0);
 
         if (url.find("http://") == 0
                 || url.find("https://") == 0) {
-            av_dict_set(options, "method", m_options.dash_method, 0);
+            av_dict_set(options, "method", opts.dash_method, 0);
         }
     }
 
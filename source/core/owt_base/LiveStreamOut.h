@@ -46,6 +46,12 @@ public:
     LiveStreamOut(const std::string& url, bool hasAudio, bool hasVideo, EventRegistry* handle, int streamingTimeout, StreamingOptions& options);
     ~LiveStreamOut();
 
+    // Shared with the sinks of TeeStreamOut
+    static bool supportsAudioFormat(FrameFormat format);
+    static bool supportsVideoFormat(FrameFormat format);
+    static const char *formatName(const StreamingOptions& options);
+    static bool getMuxerOptions(const StreamingOptions& opts, const std::string& url, AVDictionary **options);
+
 protected:
     bool isAudioFormatSupported(FrameFormat format) override;
     bool isVideoFormatSupported(FrameFormat format) override;
@@ -0,0 +1,168 @@
+// Copyright (C) <2019> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef MediaBuffer_h
+#define MediaBuffer_h
+
+#include <atomic>
+#include <boost/intrusive_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+namespace owt_base {
+
+class MediaBufferPool;
+
+// Reference counted payload storage. A Frame may carry one so that
+// consumers which keep the payload beyond onFrame() can hold a reference
+// instead of copying the bytes.
+class MediaBuffer {
+public:
+    uint8_t* data() { return m_data; }
+    const uint8_t* data() const { return m_data; }
+    uint32_t capacity() const { return m_capacity; }
+
+    friend void intrusive_ptr_add_ref(MediaBuffer* buffer)
+    {
+        buffer->m_refCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    friend inline void intrusive_ptr_release(MediaBuffer* buffer);
+
+private:
+    friend class MediaBufferPool;
+
+    MediaBuffer(uint32_t capacity, int sizeClass)
+        : m_data(new uint8_t[capacity])
+        , m_capacity(capacity)
+        , m_sizeClass(sizeClass)
+        , m_refCount(0)
+    {
+    }
+    ~MediaBuffer() { delete[] m_data; }
+
+    uint8_t* m_data;
+    uint32_t m_capacity;
+    int m_sizeClass;
+    std::atomic<int> m_refCount;
+};
+
+typedef boost::intrusive_ptr<MediaBuffer> MediaBufferPtr;
+
+// Size classed free lists of MediaBuffers. Buffers go back to the pool
+// when their last reference is dropped. The lists are sharded by thread, a
+// thread takes from its own shard first and steals from the others, and
+// the pool keeps at most kMaxCachedBytes of free buffers in total.
+class MediaBufferPool {
+public:
+    static MediaBufferPool& GetInstance()
+    {
+        // Intentionally leaked, buffers may be released during static destruction.
+        static MediaBufferPool* pool = new MediaBufferPool();
+        return *pool;
+    }
+
+    MediaBufferPtr acquire(uint32_t size)
+    {
+        int sizeClass = classOf(size);
+        if (sizeClass < 0) {
+            return MediaBufferPtr(new MediaBuffer(size, -1));
+        }
+
+        uint32_t first = shardIndex();
+        for (uint32_t i = 0; i < kNumShards; i++) {
+            Shard& shard = m_shards[(first + i) % kNumShards];
+            boost::mutex::scoped_lock lock(shard.mutex, boost::defer_lock);
+            // Other shards are only stolen from when they're not busy
+            if (i == 0) {
+                lock.lock();
+            } else if (!lock.try_lock()) {
+                continue;
+            }
+            std::vector<MediaBuffer*>& freeList = shard.freeLists[sizeClass];
+            if (!freeList.empty()) {
+                MediaBuffer* buffer = freeList.back();
+                freeList.pop_back();
+                m_cachedBytes.fetch_sub(buffer->m_capacity, std::memory_order_relaxed);
+                return MediaBufferPtr(buffer);
+            }
+        }
+        return MediaBufferPtr(new MediaBuffer(kMinClassSize << sizeClass, sizeClass));
+    }
+
+    MediaBufferPtr copyFrom(const uint8_t* data, uint32_t length)
+    {
+        MediaBufferPtr buffer = acquire(length);
+        if (length) {
+            memcpy(buffer->data(), data, length);
+        }
+        return buffer;
+    }
+
+private:
+    friend void intrusive_ptr_release(MediaBuffer* buffer);
+
+    static const uint32_t kMinClassSize = 1024;
+    static const int kNumClasses = 13; // 1KB ... 4MB
+    static const uint32_t kNumShards = 8;
+    static const size_t kMaxCachedBytes = 32 * 1024 * 1024;
+
+    struct Shard {
+        boost::mutex mutex;
+        std::vector<MediaBuffer*> freeLists[kNumClasses];
+    };
+
+    MediaBufferPool() : m_cachedBytes(0) { }
+
+    static int classOf(uint32_t size)
+    {
+        int sizeClass = 0;
+        uint32_t classSize = kMinClassSize;
+        while (classSize < size) {
+            classSize <<= 1;
+            if (++sizeClass >= kNumClasses) {
+                return -1;
+            }
+        }
+        return sizeClass;
+    }
+
+    // Threads are spread over the shards round robin
+    static uint32_t shardIndex()
+    {
+        static std::atomic<uint32_t> nextIndex(0);
+        thread_local uint32_t index = nextIndex.fetch_add(1, std::memory_order_relaxed) % kNumShards;
+        return index;
+    }
+
+    void recycle(MediaBuffer* buffer)
+    {
+        if (buffer->m_sizeClass >= 0) {
+            size_t cached = m_cachedBytes.fetch_add(buffer->m_capacity, std::memory_order_relaxed);
+            if (cached + buffer->m_capacity <= kMaxCachedBytes) {
+                Shard& shard = m_shards[shardIndex()];
+                boost::mutex::scoped_lock lock(shard.mutex);
+                shard.freeLists[buffer->m_sizeClass].push_back(buffer);
+                return;
+            }
+            m_cachedBytes.fetch_sub(buffer->m_capacity, std::memory_order_relaxed);
+        }
+        delete buffer;
+    }
+
+    Shard m_shards[kNumShards];
+    std::atomic<size_t> m_cachedBytes;
+};
+
+inline void intrusive_ptr_release(MediaBuffer* buffer)
+{
+    if (buffer->m_refCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        MediaBufferPool::GetInstance().recycle(buffer);
+    }
+}
+
+} /* namespace owt_base */
+
+#endif /* MediaBuffer_h */
@@ -19,6 +19,24 @@ MediaFileOut::~MediaFileOut()
 }
 
 bool MediaFileOut::isAudioFormatSupported(FrameFormat format)
+{
+    return supportsAudioFormat(format);
+}
+
+bool MediaFileOut::isVideoFormatSupported(FrameFormat format)
+{
+    return supportsVideoFormat(format);
+}
+
+const char *MediaFileOut::getFormatName(std::string& url)
+{
+    const char *name = formatName(url);
+    if (!name)
+        ELOG_ERROR("Invalid format for url(%s)", url.c_str());
+    return name;
+}
+
+bool MediaFileOut::supportsAudioFormat(FrameFormat format)
 {
     switch (format) {
         case FRAME_FORMAT_PCMU:
@@ -32,7 +50,7 @@ bool MediaFileOut::isAudioFormatSupported(FrameFormat format)
     }
 }
 
-bool MediaFileOut::isVideoFormatSupported(FrameFormat format)
+bool MediaFileOut::supportsVideoFormat(FrameFormat format)
 {
     switch (format) {
         case FRAME_FORMAT_VP8:
@@ -45,7 +63,7 @@ bool MediaFileOut::isVideoFormatSupported(FrameFormat format)
     }
 }
 
-const char *MediaFileOut::getFormatName(std::string& url)
+const char *MediaFileOut::formatName(const std::string& url)
 {
     size_t pos;
 
@@ -57,7 +75,6 @@ const char *MediaFileOut::getFormatName(std::string& url)
             return "mp4";
     }
 
-    ELOG_ERROR("Invalid format for url(%s)", url.c_str());
     return NULL;
 }
 
@@ -20,6 +20,11 @@ public:
 
     void onVideoSourceChanged() override;
 
+    // Shared with the sinks of TeeStreamOut
+    static bool supportsAudioFormat(FrameFormat format);
+    static bool supportsVideoFormat(FrameFormat format);
+    static const char *formatName(const std::string& url);
+
 protected:
     bool isAudioFormatSupported(FrameFormat format) override;
     bool isVideoFormatSupported(FrameFormat format) override;
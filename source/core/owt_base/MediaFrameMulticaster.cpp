@@ -33,7 +33,20 @@ void MediaFrameMulticaster::onFeedback(const FeedbackMsg& msg)
 
 void MediaFrameMulticaster::onFrame(const Frame& frame)
 {
-    deliverFrame(frame);
+    // A single keeper copies the payload itself if it needs to
+    if (frame.buffer || !hasBytePayload(frame) || !frame.length
+            || payloadKeeperCount(frame) < 2) {
+        deliverFrame(frame);
+        return;
+    }
+
+    // Copy the payload once here so that the destinations which keep it
+    // can share the buffer instead of copying it each.
+    MediaBufferPtr buffer = retainPayload(frame);
+    Frame shared = frame;
+    shared.payload = buffer->data();
+    shared.buffer = buffer.get();
+    deliverFrame(shared);
 }
 
 void MediaFrameMulticaster::onMetaData(const MetaData& metadata)
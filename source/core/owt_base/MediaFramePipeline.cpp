@@ -4,115 +4,166 @@
 
 #include "MediaFramePipeline.h"
 
+#include <boost/thread/thread.hpp>
+
 namespace owt_base {
 
-FrameSource::~FrameSource()
+FrameSource::DestinationList::DestinationList()
+    : m_snapshot(new Snapshot())
+    , m_epoch(0)
 {
-    {
-        boost::upgrade_lock<boost::shared_mutex> lock(m_audio_dests_mutex);
-        for (auto it = m_audio_dests.begin(); it != m_audio_dests.end(); ++it) {
-            (*it)->unsetAudioSource();
+    m_readers[0] = 0;
+    m_readers[1] = 0;
+}
+
+FrameSource::DestinationList::~DestinationList()
+{
+    delete m_snapshot.load();
+}
+
+FrameSource::DestinationList::ReadGuard::ReadGuard(DestinationList& list)
+    : m_list(list)
+{
+    // Register on the current epoch; retry if a writer flipped it meanwhile,
+    // since that writer may not wait for the slot we registered on.
+    for (;;) {
+        m_slot = m_list.m_epoch.load() & 1;
+        m_list.m_readers[m_slot].fetch_add(1);
+        if ((m_list.m_epoch.load() & 1) == m_slot) {
+            break;
         }
+        m_list.m_readers[m_slot].fetch_sub(1);
+    }
+    m_snapshot = m_list.m_snapshot.load();
+}
+
+FrameSource::DestinationList::ReadGuard::~ReadGuard()
+{
+    m_list.m_readers[m_slot].fetch_sub(1);
+}
 
-        boost::upgrade_to_unique_lock<boost::shared_mutex> ulock(lock);
-        m_audio_dests.clear();
+void FrameSource::DestinationList::publish(Snapshot* next)
+{
+    Snapshot* previous = m_snapshot.exchange(next);
+    uint32_t slot = m_epoch.fetch_add(1) & 1;
+    while (m_readers[slot].load() != 0) {
+        boost::this_thread::yield();
     }
+    delete previous;
+}
+
+void FrameSource::DestinationList::add(FrameDestination* dest)
+{
+    boost::unique_lock<boost::mutex> lock(m_writeMutex);
+    Snapshot* next = new Snapshot(*m_snapshot.load());
+    next->push_back(dest);
+    publish(next);
+}
 
-    {
-        boost::upgrade_lock<boost::shared_mutex> lock(m_video_dests_mutex);
-        for (auto it = m_video_dests.begin(); it != m_video_dests.end(); ++it) {
-            (*it)->unsetVideoSource();
+void FrameSource::DestinationList::remove(FrameDestination* dest)
+{
+    boost::unique_lock<boost::mutex> lock(m_writeMutex);
+    Snapshot* next = new Snapshot();
+    const Snapshot* current = m_snapshot.load();
+    next->reserve(current->size());
+    for (auto it = current->begin(); it != current->end(); ++it) {
+        if (*it != dest) {
+            next->push_back(*it);
         }
+    }
+    publish(next);
+}
+
+std::vector<FrameDestination*> FrameSource::DestinationList::clear()
+{
+    boost::unique_lock<boost::mutex> lock(m_writeMutex);
+    std::vector<FrameDestination*> removed(*m_snapshot.load());
+    publish(new Snapshot());
+    return removed;
+}
 
-        boost::upgrade_to_unique_lock<boost::shared_mutex> ulock(lock);
-        m_video_dests.clear();
+//=========================================================================================
+
+FrameSource::~FrameSource()
+{
+    std::vector<FrameDestination*> dests = m_audio_dests.clear();
+    for (auto it = dests.begin(); it != dests.end(); ++it) {
+        (*it)->unsetAudioSource();
+    }
+
+    dests = m_video_dests.clear();
+    for (auto it = dests.begin(); it != dests.end(); ++it) {
+        (*it)->unsetVideoSource();
     }
 }
 
 void FrameSource::addAudioDestination(FrameDestination* dest)
 {
-    boost::unique_lock<boost::shared_mutex> lock(m_audio_dests_mutex);
-    m_audio_dests.push_back(dest);
-    lock.unlock();
+    m_audio_dests.add(dest);
     dest->setAudioSource(this);
 }
 
 void FrameSource::addVideoDestination(FrameDestination* dest)
 {
-    boost::unique_lock<boost::shared_mutex> lock(m_video_dests_mutex);
-    m_video_dests.push_back(dest);
-    lock.unlock();
+    m_video_dests.add(dest);
     dest->setVideoSource(this);
 }
 
 void FrameSource::addDataDestination(FrameDestination* dest)
 {
-    boost::unique_lock<boost::shared_mutex> lock(m_data_dests_mutex);
-    m_data_dests.push_back(dest);
-    lock.unlock();
+    m_data_dests.add(dest);
     dest->setDataSource(this);
 }
 
 void FrameSource::removeAudioDestination(FrameDestination* dest)
 {
-    boost::unique_lock<boost::shared_mutex> lock(m_audio_dests_mutex);
     m_audio_dests.remove(dest);
-    lock.unlock();
     dest->unsetAudioSource();
 }
 
 void FrameSource::removeVideoDestination(FrameDestination* dest)
 {
-    boost::unique_lock<boost::shared_mutex> lock(m_video_dests_mutex);
     m_video_dests.remove(dest);
-    lock.unlock();
     dest->unsetVideoSource();
 }
 
 void FrameSource::removeDataDestination(FrameDestination* dest)
 {
-    boost::unique_lock<boost::shared_mutex> lock(m_data_dests_mutex);
     m_data_dests.remove(dest);
-    lock.unlock();
     dest->unsetDataSource();
 }
 
 void FrameSource::deliverFrame(const Frame& frame)
 {
     if (isAudioFrame(frame)) {
-        boost::shared_lock<boost::shared_mutex> lock(m_audio_dests_mutex);
-        for (auto it = m_audio_dests.begin(); it != m_audio_dests.end(); ++it) {
-            (*it)->onFrame(frame);
-        }
+        m_audio_dests.forEach([&frame](FrameDestination* dest) { dest->onFrame(frame); });
     } else if (isVideoFrame(frame)) {
-        boost::shared_lock<boost::shared_mutex> lock(m_video_dests_mutex);
-        for (auto it = m_video_dests.begin(); it != m_video_dests.end(); ++it) {
-            (*it)->onFrame(frame);
-        }
+        m_video_dests.forEach([&frame](FrameDestination* dest) { dest->onFrame(frame); });
     } else if (isDataFrame(frame)){
-        boost::shared_lock<boost::shared_mutex> lock(m_data_dests_mutex);
-        for (auto it = m_data_dests.begin(); it != m_data_dests.end(); ++it) {
-            (*it)->onFrame(frame);
-        }
+        m_data_dests.forEach([&frame](FrameDestination* dest) { dest->onFrame(frame); });
     } else {
         //TODO: log error here.
     }
 }
 
-void FrameSource::deliverMetaData(const MetaData& metadata)
+int FrameSource::payloadKeeperCount(const Frame& frame)
 {
-    {
-        boost::shared_lock<boost::shared_mutex> lock(m_audio_dests_mutex);
-        for (auto it = m_audio_dests.begin(); it != m_audio_dests.end(); ++it) {
-            (*it)->onMetaData(metadata);
-        }
-    }
-    {
-        boost::shared_lock<boost::shared_mutex> lock(m_video_dests_mutex);
-        for (auto it = m_video_dests.begin(); it != m_video_dests.end(); ++it) {
-            (*it)->onMetaData(metadata);
-        }
+    int count = 0;
+    auto countKeeper = [&count](FrameDestination* dest) { count += dest->keepsPayload() ? 1 : 0; };
+    if (isAudioFrame(frame)) {
+        m_audio_dests.forEach(countKeeper);
+    } else if (isVideoFrame(frame)) {
+        m_video_dests.forEach(countKeeper);
+    } else if (isDataFrame(frame)) {
+        m_data_dests.forEach(countKeeper);
     }
+    return count;
+}
+
+void FrameSource::deliverMetaData(const MetaData& metadata)
+{
+    m_audio_dests.forEach([&metadata](FrameDestination* dest) { dest->onMetaData(metadata); });
+    m_video_dests.forEach([&metadata](FrameDestination* dest) { dest->onMetaData(metadata); });
 }
 
 //=========================================================================================
@@ -5,11 +5,16 @@
 #ifndef MediaFramePipeline_h
 #define MediaFramePipeline_h
 
+#include <atomic>
+#include <boost/thread/mutex.hpp>
 #include <boost/thread/shared_mutex.hpp>
 #include <list>
 #include <map>
 #include <stdint.h>
 #include <string>
+#include <vector>
+
+#include "MediaBuffer.h"
 
 namespace owt_base {
 
@@ -86,6 +91,9 @@ struct Frame {
     uint32_t        length;
     uint32_t        timeStamp;
     MediaSpecInfo   additionalInfo;
+    // Optional storage owning |payload|, with payload == buffer->data().
+    // It is borrowed for the duration of onFrame(), use retainPayload() to keep it.
+    MediaBuffer*    buffer;
 };
 
 enum MetaDataType {
@@ -220,6 +228,20 @@ inline bool isDataFrame(const Frame& frame) {
     return frame.format == FRAME_FORMAT_DATA || frame.format == FRAME_FORMAT_RTP;
 }
 
+// Whether |payload| holds plain bytes rather than a decoded frame object.
+inline bool hasBytePayload(const Frame& frame) {
+    return frame.format != FRAME_FORMAT_I420 && frame.format != FRAME_FORMAT_MSDK;
+}
+
+// Take a reference to the payload of a byte-payload frame, copying it into a
+// pooled buffer only when the producer did not attach one.
+inline MediaBufferPtr retainPayload(const Frame& frame) {
+    if (frame.buffer) {
+        return MediaBufferPtr(frame.buffer);
+    }
+    return MediaBufferPool::GetInstance().copyFrom(frame.payload, frame.length);
+}
+
 enum FeedbackType {
     VIDEO_FEEDBACK,
     AUDIO_FEEDBACK,
@@ -273,14 +295,58 @@ public:
 protected:
     void deliverFrame(const Frame&);
     void deliverMetaData(const MetaData&);
+    // Destinations of the frame's kind which keep its payload
+    int payloadKeeperCount(const Frame&);
 
 private:
-    std::list<FrameDestination*> m_audio_dests;
-    boost::shared_mutex m_audio_dests_mutex;
-    std::list<FrameDestination*> m_video_dests;
-    boost::shared_mutex m_video_dests_mutex;
-    std::list<FrameDestination*> m_data_dests;
-    boost::shared_mutex m_data_dests_mutex;
+    // Copy-on-write destination list. Writers are serialized and publish an
+    // immutable snapshot, readers walk the current snapshot without locking.
+    // A writer returns only after the readers of the replaced snapshot have
+    // left, so a removed destination never receives another frame.
+    class DestinationList {
+    public:
+        DestinationList();
+        ~DestinationList();
+
+        void add(FrameDestination*);
+        void remove(FrameDestination*);
+        std::vector<FrameDestination*> clear();
+
+        template <typename Visitor>
+        void forEach(Visitor visit)
+        {
+            ReadGuard guard(*this);
+            for (auto it = guard.snapshot()->begin(); it != guard.snapshot()->end(); ++it) {
+                visit(*it);
+            }
+        }
+
+    private:
+        typedef std::vector<FrameDestination*> Snapshot;
+
+        class ReadGuard {
+        public:
+            explicit ReadGuard(DestinationList&);
+            ~ReadGuard();
+            const Snapshot* snapshot() const { return m_snapshot; }
+
+        private:
+            DestinationList& m_list;
+            uint32_t m_slot;
+            const Snapshot* m_snapshot;
+        };
+
+        void publish(Snapshot* next);
+
+        boost::mutex m_writeMutex;
+        std::atomic<Snapshot*> m_snapshot;
+        std::atomic<uint32_t> m_epoch;
+        std::atomic<uint32_t> m_readers[2];
+    };
+
+    DestinationList m_audio_dests;
+    DestinationList m_video_dests;
+    DestinationList m_data_dests;
 };
 
 
@@ -292,6 +358,9 @@ public:
     virtual void onFrame(const Frame&) = 0;
     virtual void onMetaData(const MetaData&) {}
     virtual void onVideoSourceChanged() {}
+    // Whether onFrame() keeps byte payloads beyond the call through
+    // retainPayload(), so sources fanning a frame out share one copy
+    virtual bool keepsPayload() { return false; }
 
     void setAudioSource(FrameSource*);
     void unsetAudioSource();
@@ -0,0 +1,86 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// Microbenchmark of FrameSource::deliverFrame(). Threads deliver frames
+// through one shared source to 1, 4 and 16 destinations, and the time per
+// deliverFrame() call is reported. Every destination must get every frame.
+//
+// Build and run from this directory:
+//   g++ -O2 -std=c++11 -I. -I../common MediaFramePipelineBench.cc MediaFramePipeline.cpp \
+//       -lboost_thread -lboost_system -llog4cxx -pthread -o MediaFramePipelineBench
+//   ./MediaFramePipelineBench [frames per thread]
+
+#include "MediaFramePipeline.h"
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+using namespace owt_base;
+
+namespace {
+
+class CountingDestination : public FrameDestination {
+public:
+    CountingDestination() : frames(0) { }
+    void onFrame(const Frame&) override { frames.fetch_add(1, std::memory_order_relaxed); }
+
+    std::atomic<uint64_t> frames;
+};
+
+class TestSource : public FrameSource {
+public:
+    void push(const Frame& frame) { deliverFrame(frame); }
+};
+
+}
+
+int main(int argc, char* argv[])
+{
+    const uint64_t iterations = argc > 1 ? strtoull(argv[1], nullptr, 10) : 200000;
+    int failures = 0;
+
+    for (int fanout : {1, 4, 16}) {
+        for (int threads : {1, 8, 32}) {
+            TestSource source;
+            std::vector<CountingDestination> destinations(fanout);
+            for (auto& destination : destinations) {
+                source.addVideoDestination(&destination);
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            std::vector<std::thread> workers;
+            for (int t = 0; t < threads; t++) {
+                workers.emplace_back([&source, iterations] {
+                    Frame frame;
+                    memset(&frame, 0, sizeof(frame));
+                    frame.format = FRAME_FORMAT_VP8;
+                    for (uint64_t i = 0; i < iterations; i++) {
+                        source.push(frame);
+                    }
+                });
+            }
+            for (auto& worker : workers) {
+                worker.join();
+            }
+            double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+            for (auto& destination : destinations) {
+                if (destination.frames != iterations * threads) {
+                    failures++;
+                }
+                source.removeVideoDestination(&destination);
+            }
+            printf("fanout %2d, threads %2d: %.1f ns/deliver\n", fanout, threads, ns / (iterations * threads));
+        }
+    }
+
+    if (failures) {
+        printf("%d destinations missed frames\n", failures);
+    }
+    return failures ? 1 : 0;
+}
@@ -31,8 +31,14 @@ class StreamEncoder : public FrameSource, public JobTimerListener
 
     enum EncoderMode{ENCODER_MODE_NORMAL = 0, ENCODER_MODE_AUTO};
 
+    // The encoder writes into a pooled buffer, which is handed to the
+    // destinations as is and replaced by another one
+    struct PooledBitstream : public mfxBitstream {
+        MediaBufferPtr storage;
+    };
+
     typedef struct {
-        boost::shared_ptr<mfxBitstream> bsBuffer;
+        boost::shared_ptr<PooledBitstream> bsBuffer;
         mfxSyncPoint syncp;
     } bsBufferSync_t;
 
@@ -297,7 +303,7 @@ public:
         mfxSyncPoint syncp;
         boost::scoped_ptr<mfxEncodeCtrl> ctrl;
 
-        boost::shared_ptr<mfxBitstream> bsBuffer = getBitstreamBuffer();
+        boost::shared_ptr<PooledBitstream> bsBuffer = getBitstreamBuffer();
         if (!bsBuffer) {
             ELOG_INFO_T("Drop frame, no bitstream buffer available");
             return;
@@ -369,11 +375,9 @@ retry:
                     , newSize
                     );
 
-            uint8_t* tmpBuf = (mfxU8 *)realloc(bsBuffer->Data, newSize);
-            if(tmpBuf) {
-                bsBuffer->Data = (mfxU8 *)tmpBuf;
-                bsBuffer->MaxLength    = newSize;
-            }
+            MediaBufferPtr storage = bsBuffer->storage;
+            attachStorage(*bsBuffer, newSize);
+            memcpy(bsBuffer->Data, storage->data(), bsBuffer->DataOffset + bsBuffer->DataLength);
 
             goto retry;
         }
@@ -651,28 +655,32 @@ protected:
     {
         m_bitstreamBuffers.resize(NumOfAsyncEnc);
         for (auto& bsBuffer : m_bitstreamBuffers) {
-            bsBuffer.reset(new mfxBitstream);
-            memset((void *)bsBuffer.get(), 0, sizeof(mfxBitstream));
-
-            bsBuffer->Data         = (mfxU8 *)malloc(bufferSize);
-            bsBuffer->MaxLength    = bufferSize;
-            bsBuffer->DataOffset   = 0;
-            bsBuffer->DataLength   = 0;
+            bsBuffer.reset(new PooledBitstream);
+            memset(static_cast<mfxBitstream*>(bsBuffer.get()), 0, sizeof(mfxBitstream));
+            attachStorage(*bsBuffer, bufferSize);
         }
     }
 
+    // Keeps DataOffset and DataLength, the caller copies the data over
+    static void attachStorage(PooledBitstream& bsBuffer, uint32_t size)
+    {
+        bsBuffer.storage = MediaBufferPool::GetInstance().acquire(size);
+        bsBuffer.Data = bsBuffer.storage->data();
+        bsBuffer.MaxLength = bsBuffer.storage->capacity();
+    }
+
     void deinitBitstreamBuffers()
     {
         for (auto& bsBuffer : m_bitstreamBuffers) {
-            if (bsBuffer && bsBuffer->Data) {
-                free(bsBuffer->Data);
+            if (bsBuffer) {
+                bsBuffer->storage.reset();
                 bsBuffer->Data = NULL;
             }
         }
         m_bitstreamBuffers.clear();
     }
 
-    boost::shared_ptr<mfxBitstream> getBitstreamBuffer()
+    boost::shared_ptr<PooledBitstream> getBitstreamBuffer()
     {
         for (auto& bsBuffer : m_bitstreamBuffers) {
             if (bsBuffer && bsBuffer.use_count() == 1) {
@@ -691,7 +699,7 @@ protected:
     {
         mfxStatus sts = MFX_ERR_NONE;
         mfxSyncPoint syncp = bsBufferSync->syncp;
-        boost::shared_ptr<mfxBitstream> bsBuffer = bsBufferSync->bsBuffer;
+        boost::shared_ptr<PooledBitstream> bsBuffer = bsBufferSync->bsBuffer;
 
         sts = m_encSession->SyncOperation(syncp, MFX_INFINITE);
         if(sts != MFX_ERR_NONE) {
@@ -710,11 +718,23 @@ protected:
                 bsBuffer->DataLength
                 );
 
+        // Destinations expect the payload at the start of the buffer. A small
+        // frame is copied instead, queues downstream count its length, not
+        // the capacity of a buffer sized for raw frames.
+        MediaBufferPtr buffer;
+        if (bsBuffer->DataOffset == 0 && bsBuffer->DataLength >= bsBuffer->MaxLength / 4) {
+            buffer = bsBuffer->storage;
+            attachStorage(*bsBuffer, bsBuffer->MaxLength);
+        } else {
+            buffer = MediaBufferPool::GetInstance().copyFrom(bsBuffer->Data + bsBuffer->DataOffset, bsBuffer->DataLength);
+        }
+
         Frame outFrame;
         memset(&outFrame, 0, sizeof(outFrame));
         outFrame.format = m_format;
-        outFrame.payload = bsBuffer->Data + bsBuffer->DataOffset;
+        outFrame.payload = buffer->data();
         outFrame.length = bsBuffer->DataLength;
+        outFrame.buffer = buffer.get();
         outFrame.additionalInfo.video.width = m_width;
         outFrame.additionalInfo.video.height = m_height;
         outFrame.additionalInfo.video.isKeyFrame = isKeyFrame(bsBuffer->FrameType);
@@ -772,7 +792,7 @@ private:
     boost::scoped_ptr<mfxExtMultiFrameControl> m_encExtMultiFrameControl;
 #endif
 
-    std::vector<boost::shared_ptr<mfxBitstream>> m_bitstreamBuffers;
+    std::vector<boost::shared_ptr<PooledBitstream>> m_bitstreamBuffers;
     mfxPluginUID m_pluginID;
 
     //scaler
@@ -4,6 +4,7 @@
 
 #include <fstream>
 #include <netinet/in.h>
+#include <boost/array.hpp>
 #include "RawTransport.h"
 
 namespace owt_base {
@@ -113,10 +114,7 @@ void RawTransport<prot>::sendTicket()
             memcpy(data.buffer.get(), m_connectTicket.c_str(), len);
             data.length = len;
         }
-        boost::lock_guard<boost::mutex> lock(m_sendQueueMutex);
-        m_sendQueue.push(data);
-        assert(m_sendQueue.size() == 1);
-        doSend();
+        enqueue(data, SEND_ITEM_CONTROL);
         m_verified = true;
     }
 }
@@ -631,21 +629,32 @@ void RawTransport<prot>::doSend()
     if (m_isClosing)
         return;
 
-    TransportData& data = m_sendQueue.front();
+    std::vector<TransportData> taken;
+    if (m_sendQueue.take(taken) == 0)
+        return;
+    m_sending = taken.front();
+    TransportData& data = m_sending;
+    boost::array<boost::asio::const_buffer, 2> buffers = {{
+        boost::asio::buffer(data.buffer.get(), data.length),
+        boost::asio::const_buffer()
+    }};
+    if (data.payload) {
+        buffers[1] = boost::asio::buffer(data.payload->data(), data.payloadLength);
+    }
 
     switch (prot) {
     case TCP:
         if (m_ssl) {
             assert(m_socket.ssl.socket);
-            ELOG_DEBUG("Port#%d to send(%d)", m_socket.ssl.socket->lowest_layer().local_endpoint().port(), data.length);
-            boost::asio::async_write(*(m_socket.ssl.socket), boost::asio::buffer(data.buffer.get(), data.length),
+            ELOG_DEBUG("Port#%d to send(%zu)", m_socket.ssl.socket->lowest_layer().local_endpoint().port(), boost::asio::buffer_size(buffers));
+            boost::asio::async_write(*(m_socket.ssl.socket), buffers,
                 boost::bind(&RawTransport::writeHandler, this,
                     boost::asio::placeholders::error,
                     boost::asio::placeholders::bytes_transferred));
         } else {
             assert(m_socket.tcp.socket);
-            ELOG_DEBUG("Port#%d to send(%d)", m_socket.tcp.socket->local_endpoint().port(), data.length);
-            boost::asio::async_write(*(m_socket.tcp.socket), boost::asio::buffer(data.buffer.get(), data.length),
+            ELOG_DEBUG("Port#%d to send(%zu)", m_socket.tcp.socket->local_endpoint().port(), boost::asio::buffer_size(buffers));
+            boost::asio::async_write(*(m_socket.tcp.socket), buffers,
                 boost::bind(&RawTransport::writeHandler, this,
                     boost::asio::placeholders::error,
                     boost::asio::placeholders::bytes_transferred));
@@ -655,13 +664,13 @@ void RawTransport<prot>::doSend()
         assert(m_socket.udp.socket);
         if (!m_socket.udp.connected) {
             boost::system::error_code ignored_error;
-            m_socket.udp.socket->async_send(boost::asio::buffer(data.buffer.get(), data.length),
+            m_socket.udp.socket->async_send(buffers,
                 boost::bind(&RawTransport::writeHandler, this,
                     boost::asio::placeholders::error,
                     boost::asio::placeholders::bytes_transferred));
         } else {
             boost::system::error_code ignored_error;
-            m_socket.udp.socket->async_send_to(boost::asio::buffer(data.buffer.get(), data.length),
+            m_socket.udp.socket->async_send_to(buffers,
                 m_socket.udp.remoteEndpoint,
                 boost::bind(&RawTransport::writeHandler, this,
                     boost::asio::placeholders::error,
@@ -686,10 +695,34 @@ void RawTransport<prot>::writeHandler(const boost::system::error_code& ec, std::
     ELOG_DEBUG("writeHandler(%zu)", bytes);
 
     boost::lock_guard<boost::mutex> lock(m_sendQueueMutex);
-    assert(m_sendQueue.size() > 0);
-    m_sendQueue.pop();
+    assert(m_sendQueue.inFlight() > 0);
+    m_sendQueue.complete(1);
+    m_sending = TransportData();
+
+    if (m_sendQueue.hasPending())
+        doSend();
+}
+
+template<Protocol prot>
+void RawTransport<prot>::enqueue(const TransportData& data, SendItemKind kind)
+{
+    // The queue may block or drop according to its policy, so it is
+    // accessed before taking m_sendQueueMutex which writeHandler needs.
+    // It never blocks the IO thread, which runs writeHandler.
+    bool queued = m_sendQueue.push(data, data.length + (data.payload ? data.payloadLength : 0), kind,
+                                   !m_service->isServiceThread());
+    if (m_sendQueue.takeKeyFrameRequest()) {
+        // Notified on the IO thread, as received feedback is
+        m_service->post([this]() {
+            if (!m_isClosing)
+                m_listener->onTransportKeyFrameNeeded();
+        });
+    }
+    if (!queued)
+        return;
 
-    if (m_sendQueue.size() > 0)
+    boost::lock_guard<boost::mutex> lock(m_sendQueueMutex);
+    if (m_sendQueue.inFlight() == 0)
         doSend();
 }
 
@@ -745,14 +778,11 @@ void RawTransport<prot>::sendData(const char* buf, int len)
         data.length = len;
     }
 
-    boost::lock_guard<boost::mutex> lock(m_sendQueueMutex);
-    m_sendQueue.push(data);
-    if (m_sendQueue.size() == 1)
-        doSend();
+    enqueue(data, SEND_ITEM_CONTROL);
 }
 
 template<Protocol prot>
-void RawTransport<prot>::sendData(const char* header, int headerLength, const char* payload, int payloadLength)
+void RawTransport<prot>::sendData(const char* header, int headerLength, const char* payload, int payloadLength, SendItemKind kind)
 {
     if (!m_verified) {
         return;
@@ -772,10 +802,31 @@ void RawTransport<prot>::sendData(const char* header, int headerLength, const ch
         data.length = headerLength + payloadLength;
     }
 
-    boost::lock_guard<boost::mutex> lock(m_sendQueueMutex);
-    m_sendQueue.push(data);
-    if (m_sendQueue.size() == 1)
-        doSend();
+    enqueue(data, kind);
+}
+
+template<Protocol prot>
+void RawTransport<prot>::sendData(const char* header, int headerLength, MediaBufferPtr payload, int payloadLength, SendItemKind kind)
+{
+    if (!m_verified) {
+        return;
+    }
+
+    TransportData data;
+    if (m_tag) {
+        data.buffer.reset(new char[headerLength + 4]);
+        *(reinterpret_cast<uint32_t*>(data.buffer.get())) = htonl(headerLength + payloadLength);
+        memcpy(data.buffer.get() + 4, header, headerLength);
+        data.length = headerLength + 4;
+    } else {
+        data.buffer.reset(new char[headerLength]);
+        memcpy(data.buffer.get(), header, headerLength);
+        data.length = headerLength;
+    }
+    data.payload = payload;
+    data.payloadLength = payloadLength;
+
+    enqueue(data, kind);
 }
 
 template<Protocol prot>
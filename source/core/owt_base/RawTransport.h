@@ -14,10 +14,13 @@
 #include <logger.h>
 #include <queue>
 #include "IOService.h"
+#include "MediaBuffer.h"
+#include "SendQueue.h"
 
 namespace owt_base {
 
 const char TDT_FEEDBACK_MSG = 0x5A;
+// Frame and MetaData in the legacy layout of FrameWireFormat.h
 const char TDT_MEDIA_FRAME = 0x8F;
 const char TDT_MEDIA_METADATA = 0x3A;
 
@@ -32,6 +35,8 @@ public:
     virtual void onTransportData(char*, int len) = 0;
     virtual void onTransportError() = 0;
     virtual void onTransportConnected() = 0;
+    // Video was dropped by the send queue, until a key frame
+    virtual void onTransportKeyFrameNeeded() { }
 };
 
 class RawTransportInterface {
@@ -41,11 +46,18 @@ public:
     virtual void listenTo(uint32_t port) = 0;
     virtual void listenTo(uint32_t minPort, uint32_t maxPort) = 0;
     virtual void sendData(const char*, int len) = 0;
-    virtual void sendData(const char* header, int headerLength, const char* payload, int payloadLength) = 0;
+    virtual void sendData(const char* header, int headerLength, const char* payload, int payloadLength,
+                          SendItemKind kind = SEND_ITEM_CONTROL) = 0;
+    // Queues a reference to |payload| instead of copying it.
+    virtual void sendData(const char* header, int headerLength, MediaBufferPtr payload, int payloadLength,
+                          SendItemKind kind = SEND_ITEM_CONTROL) = 0;
     virtual void close() = 0;
     virtual bool initTicket(const std::string& ticket) = 0;
 
     virtual unsigned short getListeningPort() = 0;
+
+    virtual void setSendQueueConfig(const SendQueueConfig&) = 0;
+    virtual SendQueueStats getSendQueueStats() = 0;
 };
 
 template<Protocol prot>
@@ -59,10 +71,15 @@ public:
     void listenTo(uint32_t port);
     void listenTo(uint32_t minPort, uint32_t maxPort);
     void sendData(const char*, int len);
-    void sendData(const char* header, int headerLength, const char* payload, int payloadLength);
+    void sendData(const char* header, int headerLength, const char* payload, int payloadLength,
+                  SendItemKind kind = SEND_ITEM_CONTROL);
+    void sendData(const char* header, int headerLength, MediaBufferPtr payload, int payloadLength,
+                  SendItemKind kind = SEND_ITEM_CONTROL);
     void close();
     bool initTicket(const std::string& ticket);
 
+    void setSendQueueConfig(const SendQueueConfig& config) { m_sendQueue.setConfig(config); }
+    SendQueueStats getSendQueueStats() { return m_sendQueue.stats(); }
 
     unsigned short getListeningPort();
 
@@ -72,8 +89,12 @@ private:
     typedef struct {
         boost::shared_array<char> buffer;
         int length;
+        // Referenced payload sent right after |buffer|, if any.
+        MediaBufferPtr payload;
+        int payloadLength;
     } TransportData;
 
+    void enqueue(const TransportData&, SendItemKind);
     void doSend();
     void receiveData();
     void readHandler(const boost::system::error_code&, std::size_t);
@@ -91,8 +112,10 @@ private:
     char m_readHeader[4];
     size_t m_bufferSize;
     TransportData m_receiveData;
-    std::queue<TransportData> m_sendQueue;
+    SendQueue<TransportData> m_sendQueue;
+    // Serializes starting writes, m_sending is the one in flight
     boost::mutex m_sendQueueMutex;
+    TransportData m_sending;
 
     // We need to ensure the order of the object destructions. In this case the
     // io_service object must be destructed after the socket objects, because in
@@ -588,11 +588,14 @@ void SVTHEVCEncoder::fillPacketDone(EB_BUFFERHEADERTYPE* pBufferHeader)
 
     dump(pBufferHeader->pBuffer, pBufferHeader->nFilledLen);
 
+    MediaBufferPtr buffer = MediaBufferPool::GetInstance().copyFrom(pBufferHeader->pBuffer, pBufferHeader->nFilledLen);
+
     Frame outFrame;
     memset(&outFrame, 0, sizeof(outFrame));
     outFrame.format     = FRAME_FORMAT_H265;
-    outFrame.payload    = pBufferHeader->pBuffer;
+    outFrame.payload    = buffer->data();
     outFrame.length     = pBufferHeader->nFilledLen;
+    outFrame.buffer     = buffer.get();
     outFrame.timeStamp = (m_frameEncodedCount++) * 1000 / m_encParameters.frameRate * 90;
     outFrame.additionalInfo.video.width         = m_encParameters.sourceWidth;
     outFrame.additionalInfo.video.height        = m_encParameters.sourceHeight;
@@ -0,0 +1,370 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef SendQueue_h
+#define SendQueue_h
+
+#include <algorithm>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <chrono>
+#include <deque>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "MediaFramePipeline.h"
+
+namespace owt_base {
+
+// What a queued message carries, decides whether a policy may drop it.
+enum SendItemKind {
+    SEND_ITEM_CONTROL = 0,  // Feedback, metadata, tickets, never dropped
+    SEND_ITEM_KEY_FRAME,    // Video key frame, never dropped
+    SEND_ITEM_DELTA_FRAME,  // Video frame depending on previous ones
+    SEND_ITEM_AUDIO_FRAME,  // Independently decodable media
+};
+
+inline SendItemKind sendItemKind(const Frame& frame)
+{
+    if (isVideoFrame(frame)) {
+        return frame.additionalInfo.video.isKeyFrame ? SEND_ITEM_KEY_FRAME : SEND_ITEM_DELTA_FRAME;
+    } else if (isAudioFrame(frame)) {
+        return SEND_ITEM_AUDIO_FRAME;
+    }
+    return SEND_ITEM_CONTROL;
+}
+
+// Once a delta frame is dropped, the following ones are dropped as well
+// until a key frame, which the queue owner is asked to request.
+enum SendQueuePolicy {
+    // Drop the oldest queued delta or audio frames to make room
+    SEND_QUEUE_DROP_OLDEST_NON_KEY = 0,
+    // Drop queued delta frames and skip following ones until a key frame
+    SEND_QUEUE_DROP_UNTIL_KEY_FRAME,
+    // Make the sender wait for room, up to blockTimeoutMs. Senders that
+    // must not wait, such as IO threads shared by other transports, get
+    // SEND_QUEUE_DROP_OLDEST_NON_KEY instead.
+    SEND_QUEUE_BLOCK,
+};
+
+struct SendQueueConfig {
+    SendQueueConfig()
+        : maxBytes(16 * 1024 * 1024)
+        , maxItems(4096)
+        , policy(SEND_QUEUE_DROP_OLDEST_NON_KEY)
+        , blockTimeoutMs(100)
+    {}
+
+    size_t maxBytes;
+    size_t maxItems;
+    SendQueuePolicy policy;
+    uint32_t blockTimeoutMs;
+
+    static bool parsePolicy(const std::string& name, SendQueuePolicy& policy)
+    {
+        if (name == "drop-oldest") {
+            policy = SEND_QUEUE_DROP_OLDEST_NON_KEY;
+        } else if (name == "drop-until-keyframe") {
+            policy = SEND_QUEUE_DROP_UNTIL_KEY_FRAME;
+        } else if (name == "block") {
+            policy = SEND_QUEUE_BLOCK;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    // Process wide default for queues created afterwards
+    static SendQueueConfig& defaultConfig()
+    {
+        static SendQueueConfig config;
+        return config;
+    }
+};
+
+struct SendQueueStats {
+    SendQueueStats()
+        : queuedItems(0), queuedBytes(0), droppedFrames(0), droppedBytes(0)
+        , sentItems(0), totalQueueTimeUs(0), maxQueueTimeUs(0)
+    {}
+
+    void merge(const SendQueueStats& other)
+    {
+        queuedItems += other.queuedItems;
+        queuedBytes += other.queuedBytes;
+        droppedFrames += other.droppedFrames;
+        droppedBytes += other.droppedBytes;
+        sentItems += other.sentItems;
+        totalQueueTimeUs += other.totalQueueTimeUs;
+        maxQueueTimeUs = std::max(maxQueueTimeUs, other.maxQueueTimeUs);
+    }
+
+    uint64_t averageQueueTimeUs() const { return sentItems ? totalQueueTimeUs / sentItems : 0; }
+
+    size_t queuedItems;
+    size_t queuedBytes;
+    uint64_t droppedFrames;
+    uint64_t droppedBytes;
+    uint64_t sentItems;
+    uint64_t totalQueueTimeUs;
+    uint64_t maxQueueTimeUs;
+};
+
+/*
+ * Bounded FIFO of outgoing messages shared by the internal transports.
+ * Items handed out by take() are in flight and stay queued, but can no
+ * longer be dropped, until complete() is called for them.
+ */
+template <typename T>
+class SendQueue {
+public:
+    explicit SendQueue(const SendQueueConfig& config = SendQueueConfig::defaultConfig())
+        : m_config(config)
+        , m_inFlight(0)
+        , m_waitingKeyFrame(false)
+        , m_keyFrameRequested(false)
+    {}
+
+    void setConfig(const SendQueueConfig& config)
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        m_config = config;
+        m_spaceCond.notify_all();
+    }
+
+    // Enqueue according to the policy, returns false if |item| was dropped.
+    // |mayBlock| is false when the caller can not wait for room.
+    bool push(const T& item, uint32_t bytes, SendItemKind kind, bool mayBlock = true)
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+
+        if (kind == SEND_ITEM_DELTA_FRAME && m_waitingKeyFrame) {
+            countDrop(bytes);
+            return false;
+        }
+
+        if (isFull(bytes) && kind != SEND_ITEM_CONTROL) {
+            SendQueuePolicy policy = m_config.policy;
+            if (policy == SEND_QUEUE_BLOCK && !mayBlock) {
+                policy = SEND_QUEUE_DROP_OLDEST_NON_KEY;
+            }
+            switch (policy) {
+            case SEND_QUEUE_DROP_OLDEST_NON_KEY:
+                dropOldest(bytes);
+                break;
+            case SEND_QUEUE_DROP_UNTIL_KEY_FRAME:
+                if (kind == SEND_ITEM_AUDIO_FRAME) {
+                    dropOldest(bytes);
+                } else {
+                    // Resumes at the next key frame
+                    dropDeltaFrames();
+                }
+                break;
+            case SEND_QUEUE_BLOCK:
+                m_spaceCond.timed_wait(lock,
+                    boost::posix_time::milliseconds(m_config.blockTimeoutMs),
+                    [this, bytes]() { return !isFull(bytes); });
+                break;
+            }
+            if (kind == SEND_ITEM_DELTA_FRAME && (m_waitingKeyFrame || isFull(bytes))) {
+                // Also when the frames it references were just dropped
+                waitKeyFrame();
+                countDrop(bytes);
+                return false;
+            }
+            if (isFull(bytes) && kind == SEND_ITEM_AUDIO_FRAME) {
+                countDrop(bytes);
+                return false;
+            }
+        }
+
+        if (kind == SEND_ITEM_KEY_FRAME) {
+            // Delta frames can follow again
+            m_waitingKeyFrame = false;
+            m_keyFrameRequested = false;
+        }
+
+        Entry entry;
+        entry.item = item;
+        entry.bytes = bytes;
+        entry.kind = kind;
+        entry.enqueueTime = std::chrono::steady_clock::now();
+        m_entries.push_back(entry);
+        m_stats.queuedItems++;
+        m_stats.queuedBytes += bytes;
+        return true;
+    }
+
+    // Move up to |maxItems| / |maxBytes| (at least one item) queued items in flight.
+    size_t take(std::vector<T>& out, size_t maxItems = 1, size_t maxBytes = SIZE_MAX)
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        size_t bytes = 0;
+        size_t count = 0;
+        for (size_t i = m_inFlight; i < m_entries.size() && count < maxItems; i++) {
+            if (count && bytes + m_entries[i].bytes > maxBytes) {
+                break;
+            }
+            out.push_back(m_entries[i].item);
+            bytes += m_entries[i].bytes;
+            count++;
+        }
+        m_inFlight += count;
+        return count;
+    }
+
+    // Remove |count| in-flight items once they have been written.
+    void complete(size_t count)
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        count = std::min(count, m_inFlight);
+        for (size_t i = 0; i < count; i++) {
+            const Entry& entry = m_entries.front();
+            uint64_t queueTimeUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                now - entry.enqueueTime).count();
+            m_stats.totalQueueTimeUs += queueTimeUs;
+            m_stats.maxQueueTimeUs = std::max(m_stats.maxQueueTimeUs, queueTimeUs);
+            m_stats.sentItems++;
+            m_stats.queuedItems--;
+            m_stats.queuedBytes -= entry.bytes;
+            m_entries.pop_front();
+        }
+        m_inFlight -= count;
+        m_spaceCond.notify_all();
+    }
+
+    // True once after the queue started dropping delta frames until the
+    // next key frame, the owner should then request one from the source.
+    bool takeKeyFrameRequest()
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        bool requested = m_keyFrameRequested;
+        m_keyFrameRequested = false;
+        return requested;
+    }
+
+    bool hasPending()
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        return m_entries.size() > m_inFlight;
+    }
+
+    size_t inFlight()
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        return m_inFlight;
+    }
+
+    void clear()
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        m_entries.clear();
+        m_inFlight = 0;
+        m_stats.queuedItems = 0;
+        m_stats.queuedBytes = 0;
+        m_spaceCond.notify_all();
+    }
+
+    SendQueueStats stats()
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        return m_stats;
+    }
+
+private:
+    struct Entry {
+        T item;
+        uint32_t bytes;
+        SendItemKind kind;
+        std::chrono::steady_clock::time_point enqueueTime;
+    };
+
+    bool isFull(uint32_t incoming) const
+    {
+        return m_stats.queuedItems + 1 > m_config.maxItems ||
+               m_stats.queuedBytes + incoming > m_config.maxBytes;
+    }
+
+    void countDrop(uint32_t bytes)
+    {
+        m_stats.droppedFrames++;
+        m_stats.droppedBytes += bytes;
+    }
+
+    void erase(size_t index)
+    {
+        countDrop(m_entries[index].bytes);
+        m_stats.queuedItems--;
+        m_stats.queuedBytes -= m_entries[index].bytes;
+        m_entries.erase(m_entries.begin() + index);
+    }
+
+    void waitKeyFrame()
+    {
+        if (!m_waitingKeyFrame) {
+            m_waitingKeyFrame = true;
+            m_keyFrameRequested = true;
+        }
+    }
+
+    void dropOldest(uint32_t incoming)
+    {
+        for (size_t i = m_inFlight; i < m_entries.size() && isFull(incoming);) {
+            if (m_entries[i].kind == SEND_ITEM_AUDIO_FRAME) {
+                erase(i);
+            } else if (m_entries[i].kind == SEND_ITEM_DELTA_FRAME) {
+                // Later delta frames reference it, they go as well
+                i = dropGopFrom(i);
+            } else {
+                i++;
+            }
+        }
+    }
+
+    // Drops the queued delta frames from |index| up to the next key frame,
+    // returns the index following them.
+    size_t dropGopFrom(size_t index)
+    {
+        size_t i = index;
+        while (i < m_entries.size() && m_entries[i].kind != SEND_ITEM_KEY_FRAME) {
+            if (m_entries[i].kind == SEND_ITEM_DELTA_FRAME) {
+                erase(i);
+            } else {
+                i++;
+            }
+        }
+        if (i == m_entries.size()) {
+            // No queued key frame to resume at
+            waitKeyFrame();
+        }
+        return i;
+    }
+
+    void dropDeltaFrames()
+    {
+        for (size_t i = m_inFlight; i < m_entries.size();) {
+            if (m_entries[i].kind == SEND_ITEM_DELTA_FRAME) {
+                erase(i);
+            } else {
+                i++;
+            }
+        }
+        waitKeyFrame();
+    }
+
+    boost::mutex m_mutex;
+    boost::condition_variable m_spaceCond;
+    SendQueueConfig m_config;
+    std::deque<Entry> m_entries;
+    size_t m_inFlight;
+    bool m_waitingKeyFrame;
+    bool m_keyFrameRequested;
+    SendQueueStats m_stats;
+};
+
+} /* namespace owt_base */
+
+#endif /* SendQueue_h */
@@ -0,0 +1,149 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE SendQueue
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "SendQueue.h"
+
+using namespace owt_base;
+
+static const uint32_t kBytes = 100;
+
+static SendQueueConfig queueConfig(SendQueuePolicy policy, size_t maxItems)
+{
+    SendQueueConfig config;
+    config.maxItems = maxItems;
+    config.policy = policy;
+    config.blockTimeoutMs = 50;
+    return config;
+}
+
+// The items still queued, in order
+static std::vector<int> queued(SendQueue<int>& queue)
+{
+    std::vector<int> items;
+    size_t count = queue.take(items, SIZE_MAX);
+    queue.complete(count);
+    return items;
+}
+
+BOOST_AUTO_TEST_CASE(dropOldestNonKey)
+{
+    SendQueue<int> queue(queueConfig(SEND_QUEUE_DROP_OLDEST_NON_KEY, 4));
+    BOOST_CHECK(queue.push(1, kBytes, SEND_ITEM_KEY_FRAME));
+    BOOST_CHECK(queue.push(2, kBytes, SEND_ITEM_AUDIO_FRAME));
+    BOOST_CHECK(queue.push(3, kBytes, SEND_ITEM_DELTA_FRAME));
+    BOOST_CHECK(queue.push(4, kBytes, SEND_ITEM_DELTA_FRAME));
+
+    // The oldest audio frame makes room, key frames stay
+    BOOST_CHECK(queue.push(5, kBytes, SEND_ITEM_AUDIO_FRAME));
+    // Then the oldest delta frames, with the ones referencing them
+    BOOST_CHECK(queue.push(6, kBytes, SEND_ITEM_AUDIO_FRAME));
+    BOOST_CHECK(queue.takeKeyFrameRequest());
+
+    // Until a key frame, delta frames would reference dropped ones
+    BOOST_CHECK(!queue.push(7, kBytes, SEND_ITEM_DELTA_FRAME));
+    BOOST_CHECK(queue.push(8, kBytes, SEND_ITEM_KEY_FRAME));
+    BOOST_CHECK(!queue.takeKeyFrameRequest());
+
+    BOOST_CHECK(queued(queue) == std::vector<int>({1, 5, 6, 8}));
+    SendQueueStats stats = queue.stats();
+    BOOST_CHECK_EQUAL(stats.droppedFrames, 4u);
+    BOOST_CHECK_EQUAL(stats.droppedBytes, 4 * kBytes);
+    BOOST_CHECK_EQUAL(stats.queuedItems, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(dropUntilKeyFrame)
+{
+    SendQueue<int> queue(queueConfig(SEND_QUEUE_DROP_UNTIL_KEY_FRAME, 4));
+    BOOST_CHECK(queue.push(1, kBytes, SEND_ITEM_KEY_FRAME));
+    BOOST_CHECK(queue.push(2, kBytes, SEND_ITEM_DELTA_FRAME));
+    BOOST_CHECK(queue.push(3, kBytes, SEND_ITEM_AUDIO_FRAME));
+    BOOST_CHECK(queue.push(4, kBytes, SEND_ITEM_DELTA_FRAME));
+
+    // All queued delta frames go, the incoming one as well
+    BOOST_CHECK(!queue.push(5, kBytes, SEND_ITEM_DELTA_FRAME));
+    BOOST_CHECK(queue.takeKeyFrameRequest());
+    BOOST_CHECK(queue.push(6, kBytes, SEND_ITEM_AUDIO_FRAME));
+    BOOST_CHECK(!queue.push(7, kBytes, SEND_ITEM_DELTA_FRAME));
+
+    BOOST_CHECK(queue.push(8, kBytes, SEND_ITEM_KEY_FRAME));
+    BOOST_CHECK(!queue.takeKeyFrameRequest());
+    // Control messages are never dropped
+    BOOST_CHECK(queue.push(9, kBytes, SEND_ITEM_CONTROL));
+
+    BOOST_CHECK(queued(queue) == std::vector<int>({1, 3, 6, 8, 9}));
+    BOOST_CHECK_EQUAL(queue.stats().droppedFrames, 4u);
+}
+
+BOOST_AUTO_TEST_CASE(inFlightIsNotDropped)
+{
+    SendQueue<int> queue(queueConfig(SEND_QUEUE_DROP_OLDEST_NON_KEY, 2));
+    BOOST_CHECK(queue.push(1, kBytes, SEND_ITEM_AUDIO_FRAME));
+    BOOST_CHECK(queue.push(2, kBytes, SEND_ITEM_AUDIO_FRAME));
+
+    std::vector<int> items;
+    BOOST_CHECK_EQUAL(queue.take(items, 1), 1u);
+    BOOST_CHECK(queue.push(3, kBytes, SEND_ITEM_AUDIO_FRAME));
+    queue.complete(1);
+
+    BOOST_CHECK(queued(queue) == std::vector<int>({3}));
+}
+
+BOOST_AUTO_TEST_CASE(blockUntilRoom)
+{
+    SendQueueConfig config = queueConfig(SEND_QUEUE_BLOCK, 2);
+    config.blockTimeoutMs = 5000;
+    SendQueue<int> queue(config);
+    BOOST_CHECK(queue.push(1, kBytes, SEND_ITEM_AUDIO_FRAME));
+    BOOST_CHECK(queue.push(2, kBytes, SEND_ITEM_DELTA_FRAME));
+
+    std::thread writer([&queue] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        std::vector<int> items;
+        queue.complete(queue.take(items, 1));
+    });
+    // Waits for the write making room, nothing is dropped
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    BOOST_CHECK(queue.push(3, kBytes, SEND_ITEM_DELTA_FRAME));
+    BOOST_CHECK(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(40));
+    writer.join();
+
+    BOOST_CHECK(queued(queue) == std::vector<int>({2, 3}));
+    BOOST_CHECK_EQUAL(queue.stats().droppedFrames, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(blockTimeout)
+{
+    SendQueue<int> queue(queueConfig(SEND_QUEUE_BLOCK, 2));
+    BOOST_CHECK(queue.push(1, kBytes, SEND_ITEM_KEY_FRAME));
+    BOOST_CHECK(queue.push(2, kBytes, SEND_ITEM_DELTA_FRAME));
+
+    // No room after blockTimeoutMs, delta frames are skipped to a key frame
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    BOOST_CHECK(!queue.push(3, kBytes, SEND_ITEM_DELTA_FRAME));
+    BOOST_CHECK(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(40));
+    BOOST_CHECK(queue.takeKeyFrameRequest());
+    BOOST_CHECK(!queue.push(4, kBytes, SEND_ITEM_AUDIO_FRAME));
+
+    BOOST_CHECK(queued(queue) == std::vector<int>({1, 2}));
+    BOOST_CHECK_EQUAL(queue.stats().droppedFrames, 2u);
+}
+
+BOOST_AUTO_TEST_CASE(blockNotAllowed)
+{
+    SendQueue<int> queue(queueConfig(SEND_QUEUE_BLOCK, 2));
+    BOOST_CHECK(queue.push(1, kBytes, SEND_ITEM_AUDIO_FRAME));
+    BOOST_CHECK(queue.push(2, kBytes, SEND_ITEM_AUDIO_FRAME));
+
+    // As from an IO thread, drops the oldest instead of waiting
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    BOOST_CHECK(queue.push(3, kBytes, SEND_ITEM_AUDIO_FRAME, false));
+    BOOST_CHECK(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(40));
+
+    BOOST_CHECK(queued(queue) == std::vector<int>({2, 3}));
+    BOOST_CHECK_EQUAL(queue.stats().droppedFrames, 1u);
+}
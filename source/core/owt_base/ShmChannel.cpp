@@ -0,0 +1,681 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ShmChannel.h"
+
+#include <boost/bind.hpp>
+#include <errno.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+
+namespace owt_base {
+
+DEFINE_LOGGER(ShmChannel, "owt.ShmChannel");
+DEFINE_LOGGER(ShmAcceptor, "owt.ShmAcceptor");
+
+const size_t ShmChannelConfig::kDefaultRingBytes;
+
+static const uint32_t kShmMagic = 0x5354574F; // "OWTS"
+static const uint32_t kShmVersion = 1;
+static const uint32_t kWrapMarker = 0xFFFFFFFF;
+static const uint32_t kRecordHeaderSize = 8;
+static const size_t kMinCapacity = 64 * 1024;
+// Records delivered per handler before yielding to the other users of the service
+static const int kMaxDrainRecords = 64;
+static const uint32_t kMinAutoPort = 10000;
+static const uint32_t kMaxAutoPort = 60999;
+
+// Lives in the shared memory, the positions only grow and are taken modulo
+// capacity. std::atomic<uint64_t> is lock free on the supported platforms,
+// so it works across processes.
+struct ShmRingHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t capacity;
+    // Written by the producer only
+    alignas(64) std::atomic<uint64_t> tail;
+    // Written by the consumer only
+    alignas(64) std::atomic<uint64_t> head;
+    // Set by the consumer before it waits on the eventfd
+    std::atomic<uint32_t> consumerWaiting;
+};
+
+// Sent by the producer with the memfd and the eventfd
+struct ShmHello {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t capacity;
+};
+
+static const size_t kRecordsOffset = (sizeof(ShmRingHeader) + 63) & ~size_t(63);
+
+static inline uint64_t recordSize(uint32_t length)
+{
+    return (kRecordHeaderSize + length + 7) & ~uint64_t(7);
+}
+
+ShmChannel::ShmChannel(uint32_t id,
+                       std::shared_ptr<IOService> service,
+                       Socket socket,
+                       Listener* listener)
+    : m_id(id)
+    , m_service(service)
+    , m_socket(std::move(socket))
+    , m_event(m_service->service())
+    , m_listener(listener)
+    , m_isClosed(false)
+    , m_isProducer(false)
+    , m_ring(nullptr)
+    , m_records(nullptr)
+    , m_capacity(0)
+    , m_mappedSize(0)
+    , m_tail(0)
+    , m_waitKeyFrame(false)
+    , m_controlLength(0)
+{
+}
+
+ShmChannel::~ShmChannel()
+{
+    // Handlers hold a reference, none is running
+    if (m_ring) {
+        munmap(m_ring, m_mappedSize);
+    }
+    ELOG_DEBUG("Channel %u destroyed, sent:%lu, dropped:%lu", m_id, m_stats.sentItems, m_stats.droppedFrames);
+}
+
+std::string ShmChannel::endpointName(const std::string& prefix, uint32_t port)
+{
+    // Abstract namespace, no file to clean up
+    std::string name(1, '\0');
+    name += "owt-shm-" + prefix + "-" + std::to_string(port);
+    return name;
+}
+
+std::shared_ptr<ShmChannel> ShmChannel::connect(uint32_t id,
+                                                std::shared_ptr<IOService> service,
+                                                const std::string& prefix,
+                                                uint32_t port,
+                                                Listener* listener)
+{
+    boost::system::error_code ec;
+    Socket socket(service->service());
+    socket.connect(boost::asio::local::stream_protocol::endpoint(endpointName(prefix, port)), ec);
+    if (ec) {
+        ELOG_DEBUG("Connect to %s:%u failed: %s", prefix.c_str(), port, ec.message().c_str());
+        return nullptr;
+    }
+    return std::make_shared<ShmChannel>(id, service, std::move(socket), listener);
+}
+
+bool ShmChannel::mapRing(int memFd, size_t capacity, bool create)
+{
+    size_t size = kRecordsOffset + capacity;
+    if (create && ftruncate(memFd, size) != 0) {
+        ELOG_WARN("Failed to size ring: %s", strerror(errno));
+        return false;
+    }
+    void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, memFd, 0);
+    if (addr == MAP_FAILED) {
+        ELOG_WARN("Failed to map ring: %s", strerror(errno));
+        return false;
+    }
+    m_ring = reinterpret_cast<ShmRingHeader*>(addr);
+    m_records = reinterpret_cast<uint8_t*>(addr) + kRecordsOffset;
+    m_mappedSize = size;
+    m_capacity = capacity;
+    if (create) {
+        m_ring = new (addr) ShmRingHeader();
+        m_ring->magic = kShmMagic;
+        m_ring->version = kShmVersion;
+        m_ring->capacity = capacity;
+        m_ring->tail.store(0);
+        m_ring->head.store(0);
+        // Signal the first record, the consumer may not be mapped yet
+        m_ring->consumerWaiting.store(1);
+    } else if (m_ring->magic != kShmMagic || m_ring->capacity != capacity) {
+        ELOG_WARN("Invalid ring header");
+        return false;
+    }
+    return true;
+}
+
+bool ShmChannel::startProducer(size_t capacity)
+{
+    m_isProducer = true;
+    capacity = std::max(kMinCapacity, (capacity + 4095) & ~size_t(4095));
+
+    int memFd = syscall(SYS_memfd_create, "owt-shm", MFD_CLOEXEC);
+    if (memFd < 0) {
+        ELOG_WARN("Failed to create memfd: %s", strerror(errno));
+        return false;
+    }
+    int eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (eventFd < 0 || !mapRing(memFd, capacity, true)) {
+        ELOG_WARN("Failed to create ring");
+        ::close(memFd);
+        if (eventFd >= 0) {
+            ::close(eventFd);
+        }
+        return false;
+    }
+    m_event.assign(eventFd);
+
+    ShmHello hello{kShmMagic, kShmVersion, capacity};
+    struct iovec iov = {&hello, sizeof(hello)};
+    int fds[2] = {memFd, eventFd};
+    char control[CMSG_SPACE(sizeof(fds))];
+    memset(control, 0, sizeof(control));
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+    ssize_t ret = sendmsg(m_socket.native_handle(), &msg, MSG_NOSIGNAL);
+    // The mapping and the peer keep the memory
+    ::close(memFd);
+    if (ret != sizeof(hello)) {
+        ELOG_WARN("Failed to send ring: %s", strerror(errno));
+        return false;
+    }
+    ELOG_DEBUG("Channel %u producing on %zu bytes", m_id, capacity);
+    // The socket is only used on the service thread from now on
+    m_service->service().post(boost::bind(&ShmChannel::receiveControl, shared_from_this()));
+    return true;
+}
+
+void ShmChannel::startConsumer()
+{
+    m_isProducer = false;
+    m_service->service().post(boost::bind(&ShmChannel::receiveRing, shared_from_this()));
+}
+
+void ShmChannel::receiveRing()
+{
+    m_socket.async_read_some(boost::asio::null_buffers(),
+        boost::bind(&ShmChannel::ringReceivedHandler, shared_from_this(),
+            boost::asio::placeholders::error));
+}
+
+void ShmChannel::ringReceivedHandler(const boost::system::error_code& ec)
+{
+    if (m_isClosed) {
+        return;
+    }
+    if (ec) {
+        onPeerClosed();
+        return;
+    }
+    ShmHello hello;
+    struct iovec iov = {&hello, sizeof(hello)};
+    int fds[2] = {-1, -1};
+    char control[CMSG_SPACE(sizeof(fds))];
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    ssize_t ret = recvmsg(m_socket.native_handle(), &msg, MSG_DONTWAIT | MSG_CMSG_CLOEXEC);
+    if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        receiveRing();
+        return;
+    }
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    if (cmsg && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS
+        && cmsg->cmsg_len == CMSG_LEN(sizeof(fds))) {
+        memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+    }
+    bool valid = ret == sizeof(hello) && fds[0] >= 0 && fds[1] >= 0
+        && hello.magic == kShmMagic && hello.version == kShmVersion
+        && mapRing(fds[0], hello.capacity, false);
+    if (fds[0] >= 0) {
+        ::close(fds[0]);
+    }
+    if (!valid) {
+        ELOG_WARN("Channel %u got no valid ring", m_id);
+        if (fds[1] >= 0) {
+            ::close(fds[1]);
+        }
+        onPeerClosed();
+        return;
+    }
+    m_event.assign(fds[1]);
+    ELOG_DEBUG("Channel %u consuming on %zu bytes", m_id, m_capacity);
+
+    Listener* listener = m_listener;
+    if (listener && !m_isClosed) {
+        listener->onShmConnected(m_id);
+    }
+    // The producer only writes to the socket to hand over the ring,
+    // reading it from now on tells when it's gone
+    receiveControl();
+    drain();
+}
+
+void ShmChannel::waitData()
+{
+    m_event.async_read_some(boost::asio::null_buffers(),
+        boost::bind(&ShmChannel::dataHandler, shared_from_this(),
+            boost::asio::placeholders::error));
+}
+
+void ShmChannel::dataHandler(const boost::system::error_code& ec)
+{
+    if (ec || m_isClosed) {
+        return;
+    }
+    uint64_t count;
+    if (read(m_event.native_handle(), &count, sizeof(count)) < 0 && errno != EAGAIN) {
+        ELOG_WARN("Failed to read eventfd: %s", strerror(errno));
+    }
+    drain();
+}
+
+void ShmChannel::drain()
+{
+    if (m_isClosed) {
+        return;
+    }
+    m_ring->consumerWaiting.store(0, std::memory_order_relaxed);
+    uint64_t head = m_ring->head.load(std::memory_order_relaxed);
+    for (int i = 0; i < kMaxDrainRecords; i++) {
+        uint64_t tail = m_ring->tail.load(std::memory_order_acquire);
+        if (head == tail) {
+            // The producer checks the flag after publishing its tail, one of
+            // both sees the other's store
+            m_ring->consumerWaiting.store(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (m_ring->tail.load(std::memory_order_acquire) == head) {
+                waitData();
+                return;
+            }
+            m_ring->consumerWaiting.store(0, std::memory_order_relaxed);
+            continue;
+        }
+
+        size_t offset = head % m_capacity;
+        uint32_t length = *reinterpret_cast<uint32_t*>(m_records + offset);
+        if (length == kWrapMarker) {
+            head += m_capacity - offset;
+            m_ring->head.store(head, std::memory_order_release);
+            continue;
+        }
+        if (recordSize(length) > m_capacity - offset) {
+            ELOG_ERROR("Channel %u corrupted record of %u bytes", m_id, length);
+            onPeerClosed();
+            return;
+        }
+        Listener* listener = m_listener;
+        if (listener && !m_isClosed) {
+            listener->onShmData(m_id, m_records + offset + kRecordHeaderSize, length);
+        }
+        // Released after delivery, the record is read in place
+        head += recordSize(length);
+        m_ring->head.store(head, std::memory_order_release);
+    }
+    m_service->service().post(boost::bind(&ShmChannel::drain, shared_from_this()));
+}
+
+bool ShmChannel::sendData(const uint8_t* header, uint32_t headerLength,
+                          const uint8_t* payload, uint32_t payloadLength,
+                          SendItemKind kind)
+{
+    if (m_isClosed) {
+        return false;
+    }
+    if (m_isProducer) {
+        boost::mutex::scoped_lock lock(m_sendMutex);
+        return writeRecord(header, headerLength, payload, payloadLength, kind);
+    }
+
+    // A synchronous write would race with the read pending on the socket
+    uint32_t length = headerLength + payloadLength;
+    std::vector<uint8_t> message(sizeof(length) + length);
+    memcpy(message.data(), &length, sizeof(length));
+    memcpy(message.data() + sizeof(length), header, headerLength);
+    if (payloadLength > 0) {
+        memcpy(message.data() + sizeof(length) + headerLength, payload, payloadLength);
+    }
+    bool idle;
+    {
+        boost::mutex::scoped_lock lock(m_controlMutex);
+        idle = m_controlQueue.empty();
+        m_controlQueue.push_back(std::move(message));
+    }
+    if (idle) {
+        m_service->service().post(boost::bind(&ShmChannel::writeControl, shared_from_this()));
+    }
+    return true;
+}
+
+void ShmChannel::writeControl()
+{
+    if (m_isClosed) {
+        return;
+    }
+    boost::mutex::scoped_lock lock(m_controlMutex);
+    if (m_controlQueue.empty()) {
+        return;
+    }
+    // Elements of a deque stay in place while others are pushed
+    boost::asio::async_write(m_socket,
+        boost::asio::buffer(m_controlQueue.front()),
+        boost::bind(&ShmChannel::controlWrittenHandler, shared_from_this(),
+            boost::asio::placeholders::error,
+            boost::asio::placeholders::bytes_transferred));
+}
+
+void ShmChannel::controlWrittenHandler(const boost::system::error_code& ec, std::size_t bytes)
+{
+    if (m_isClosed) {
+        return;
+    }
+    if (ec) {
+        ELOG_DEBUG("Channel %u write error: %s", m_id, ec.message().c_str());
+        onPeerClosed();
+        return;
+    }
+    bool more;
+    {
+        boost::mutex::scoped_lock lock(m_controlMutex);
+        m_controlQueue.pop_front();
+        more = !m_controlQueue.empty();
+    }
+    if (more) {
+        writeControl();
+    }
+}
+
+bool ShmChannel::writeRecord(const uint8_t* header, uint32_t headerLength,
+                             const uint8_t* payload, uint32_t payloadLength,
+                             SendItemKind kind)
+{
+    if (!m_ring) {
+        return false;
+    }
+    uint32_t length = headerLength + payloadLength;
+    uint64_t size = recordSize(length);
+    if (kind == SEND_ITEM_DELTA_FRAME && m_waitKeyFrame) {
+        m_stats.droppedFrames++;
+        m_stats.droppedBytes += length;
+        return false;
+    }
+
+    uint64_t head = m_ring->head.load(std::memory_order_acquire);
+    size_t offset = m_tail % m_capacity;
+    size_t contiguous = m_capacity - offset;
+    uint64_t needed = size + (contiguous < size ? contiguous : 0);
+    if (m_tail + needed - head > m_capacity) {
+        // Nothing is queued besides the ring, later delta frames can't be
+        // decoded without this one
+        m_stats.droppedFrames++;
+        m_stats.droppedBytes += length;
+        if (kind == SEND_ITEM_DELTA_FRAME || kind == SEND_ITEM_KEY_FRAME) {
+            // Once per drop, and again if the requested key frame doesn't fit
+            if (!m_waitKeyFrame || kind == SEND_ITEM_KEY_FRAME) {
+                m_service->service().post(boost::bind(&ShmChannel::keyFrameNeeded, shared_from_this()));
+            }
+            m_waitKeyFrame = true;
+        }
+        return false;
+    }
+    if (contiguous < size) {
+        *reinterpret_cast<uint32_t*>(m_records + offset) = kWrapMarker;
+        m_tail += contiguous;
+        offset = 0;
+    }
+
+    uint8_t* record = m_records + offset;
+    reinterpret_cast<uint32_t*>(record)[0] = length;
+    reinterpret_cast<uint32_t*>(record)[1] = 0;
+    memcpy(record + kRecordHeaderSize, header, headerLength);
+    if (payloadLength > 0) {
+        memcpy(record + kRecordHeaderSize + headerLength, payload, payloadLength);
+    }
+    m_tail += size;
+    m_ring->tail.store(m_tail, std::memory_order_release);
+    if (kind == SEND_ITEM_KEY_FRAME) {
+        m_waitKeyFrame = false;
+    }
+    m_stats.sentItems++;
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_ring->consumerWaiting.load(std::memory_order_relaxed)) {
+        uint64_t one = 1;
+        if (write(m_event.native_handle(), &one, sizeof(one)) < 0 && errno != EAGAIN) {
+            ELOG_WARN("Failed to signal eventfd: %s", strerror(errno));
+        }
+    }
+    return true;
+}
+
+void ShmChannel::keyFrameNeeded()
+{
+    Listener* listener = m_listener;
+    if (listener && !m_isClosed) {
+        listener->onShmKeyFrameNeeded(m_id);
+    }
+}
+
+void ShmChannel::receiveControl()
+{
+    boost::asio::async_read(m_socket,
+        boost::asio::buffer(&m_controlLength, sizeof(m_controlLength)),
+        boost::bind(&ShmChannel::controlHeaderHandler, shared_from_this(),
+            boost::asio::placeholders::error,
+            boost::asio::placeholders::bytes_transferred));
+}
+
+void ShmChannel::controlHeaderHandler(const boost::system::error_code& ec, std::size_t bytes)
+{
+    if (m_isClosed) {
+        return;
+    }
+    if (ec) {
+        onPeerClosed();
+        return;
+    }
+    m_controlBuffer.resize(m_controlLength);
+    boost::asio::async_read(m_socket,
+        boost::asio::buffer(m_controlBuffer),
+        boost::bind(&ShmChannel::controlDataHandler, shared_from_this(),
+            boost::asio::placeholders::error,
+            boost::asio::placeholders::bytes_transferred));
+}
+
+void ShmChannel::controlDataHandler(const boost::system::error_code& ec, std::size_t bytes)
+{
+    if (m_isClosed) {
+        return;
+    }
+    if (ec) {
+        onPeerClosed();
+        return;
+    }
+    Listener* listener = m_listener;
+    if (listener) {
+        listener->onShmData(m_id, m_controlBuffer.data(), m_controlBuffer.size());
+    }
+    receiveControl();
+}
+
+void ShmChannel::onPeerClosed()
+{
+    Listener* listener = m_listener;
+    if (!m_isClosed.exchange(true)) {
+        ELOG_DEBUG("Channel %u peer closed", m_id);
+        closeDescriptors();
+        if (listener) {
+            listener->onShmClosed(m_id);
+        }
+    }
+}
+
+void ShmChannel::closeDescriptors()
+{
+    boost::system::error_code ec;
+    m_socket.shutdown(Socket::shutdown_both, ec);
+    m_socket.close(ec);
+    m_event.close(ec);
+}
+
+void ShmChannel::close()
+{
+    if (!m_isClosed.exchange(true)) {
+        m_listener = nullptr;
+        // On the service thread, which may be in a handler of the channel
+        m_service->service().post(boost::bind(&ShmChannel::closeDescriptors, shared_from_this()));
+    }
+}
+
+SendQueueStats ShmChannel::getStats()
+{
+    boost::mutex::scoped_lock lock(m_sendMutex);
+    SendQueueStats stats = m_stats;
+    if (m_ring && m_isProducer) {
+        stats.queuedBytes = m_tail - m_ring->head.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+ShmAcceptor::ShmAcceptor(std::shared_ptr<IOService> service,
+                         const std::string& prefix,
+                         AcceptCallback onAccept)
+    : m_service(service)
+    , m_prefix(prefix)
+    , m_onAccept(onAccept)
+    , m_acceptor(m_service->service())
+    , m_socket(m_service->service())
+    , m_port(0)
+    , m_isClosed(false)
+{
+}
+
+ShmAcceptor::~ShmAcceptor()
+{
+    close();
+}
+
+bool ShmAcceptor::bind(uint32_t port, boost::system::error_code& ec)
+{
+    boost::asio::local::stream_protocol::endpoint endpoint(ShmChannel::endpointName(m_prefix, port));
+    if (m_acceptor.is_open()) {
+        m_acceptor.close();
+    }
+    m_acceptor.open(endpoint.protocol());
+    m_acceptor.bind(endpoint, ec);
+    if (!ec) {
+        m_acceptor.listen(boost::asio::socket_base::max_connections, ec);
+    }
+    if (ec) {
+        m_acceptor.close();
+        return false;
+    }
+    m_port = port;
+    return true;
+}
+
+bool ShmAcceptor::listenTo(uint32_t port)
+{
+    boost::system::error_code ec;
+    if (!bind(port, ec)) {
+        ELOG_WARN("Listen on %s:%u failed: %s", m_prefix.c_str(), port, ec.message().c_str());
+        return false;
+    }
+    doAccept();
+    return true;
+}
+
+bool ShmAcceptor::listenTo(uint32_t minPort, uint32_t maxPort)
+{
+    if (maxPort == 0 || minPort > maxPort) {
+        minPort = kMinAutoPort;
+        maxPort = kMaxAutoPort;
+    }
+    boost::system::error_code ec;
+    uint32_t portRange = maxPort - minPort + 1;
+    uint32_t port = rand() % portRange + minPort;
+    for (uint32_t i = 0; i < portRange; i++) {
+        if (bind(port, ec) || ec != boost::system::errc::address_in_use) {
+            break;
+        }
+        port++;
+        if (port > maxPort) {
+            port -= portRange;
+        }
+    }
+    if (ec) {
+        ELOG_WARN("Listen on %s:%u~%u failed: %s", m_prefix.c_str(), minPort, maxPort, ec.message().c_str());
+        return false;
+    }
+    ELOG_DEBUG("Listening on %s:%u", m_prefix.c_str(), m_port);
+    doAccept();
+    return true;
+}
+
+void ShmAcceptor::doAccept()
+{
+    if (!m_acceptor.is_open()) {
+        return;
+    }
+    m_acceptor.async_accept(m_socket,
+        boost::bind(&ShmAcceptor::acceptHandler, this,
+            boost::asio::placeholders::error));
+}
+
+void ShmAcceptor::acceptHandler(const boost::system::error_code& ec)
+{
+    if (m_isClosed) {
+        return;
+    }
+    if (!ec) {
+        struct ucred cred;
+        socklen_t len = sizeof(cred);
+        if (getsockopt(m_socket.native_handle(), SOL_SOCKET, SO_PEERCRED, &cred, &len) == 0
+            && cred.uid == geteuid()) {
+            // Moved out by the callback to take the connection
+            m_onAccept(m_socket);
+        } else {
+            ELOG_WARN("Reject peer of another user on %s:%u", m_prefix.c_str(), m_port);
+        }
+        if (m_socket.is_open()) {
+            boost::system::error_code ignored;
+            m_socket.close(ignored);
+        }
+        doAccept();
+    } else if (ec.value() != boost::system::errc::operation_canceled) {
+        ELOG_WARN("Accept error: %s", ec.message().c_str());
+        doAccept();
+    }
+}
+
+void ShmAcceptor::close()
+{
+    if (!m_isClosed.exchange(true)) {
+        boost::system::error_code ec;
+        if (m_acceptor.is_open()) {
+            m_acceptor.cancel(ec);
+            m_acceptor.close(ec);
+        }
+    }
+}
+
+} /* namespace owt_base */
@@ -0,0 +1,197 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef ShmChannel_h
+#define ShmChannel_h
+
+#include <atomic>
+#include <boost/asio.hpp>
+#include <boost/thread/mutex.hpp>
+#include <deque>
+#include <functional>
+#include <logger.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "IOService.h"
+#include "SendQueue.h"
+
+namespace owt_base {
+
+struct ShmRingHeader;
+
+struct ShmChannelConfig {
+    ShmChannelConfig()
+        : ringBytes(0)
+    {}
+
+    // Size of the ring of each channel, 0 for kDefaultRingBytes. The
+    // producer cycles through all of the ring, so each channel keeps this
+    // much shared memory resident for its whole life, unlike a send queue
+    // which only grows under backpressure.
+    size_t ringBytes;
+
+    static const size_t kDefaultRingBytes = 4 * 1024 * 1024;
+
+    size_t ringCapacity() const
+    {
+        return ringBytes ? ringBytes : kDefaultRingBytes;
+    }
+
+    // Process wide config, used by the channels created afterwards
+    static ShmChannelConfig& defaultConfig()
+    {
+        static ShmChannelConfig config;
+        return config;
+    }
+};
+
+/*
+ * ShmChannel
+ * A connection between two processes of the same host. Messages of the
+ * producer side are written once into a ring in shared memory (memfd) and
+ * read in place by the consumer, which is woken by an eventfd only when it
+ * waits for data. The unix socket that set the channel up carries the ring
+ * descriptors, the messages of the consumer side, like feedback, and tells
+ * both sides when the other one is gone.
+ *
+ * Ring layout: ShmRingHeader, then |capacity| bytes of records of
+ * | 4 bytes (length) | 4 bytes (reserved) | length bytes |, 8 bytes aligned.
+ * A record never wraps, the producer leaves a wrap marker instead.
+ */
+class ShmChannel : public std::enable_shared_from_this<ShmChannel> {
+    DECLARE_LOGGER();
+public:
+    class Listener {
+    public:
+        virtual ~Listener() { }
+        // On the consumer side, once the ring of the peer is mapped
+        virtual void onShmConnected(uint32_t id) { }
+        // On the IO service thread, |data| is only valid during the call
+        virtual void onShmData(uint32_t id, uint8_t* data, uint32_t len) = 0;
+        virtual void onShmClosed(uint32_t id) = 0;
+        // On the producer side, video was dropped as the ring is full,
+        // until a key frame
+        virtual void onShmKeyFrameNeeded(uint32_t id) { }
+    };
+    typedef boost::asio::local::stream_protocol::socket Socket;
+
+    ShmChannel(uint32_t id,
+               std::shared_ptr<IOService> service,
+               Socket socket,
+               Listener* listener);
+    ~ShmChannel();
+
+    // Creates a ring of |capacity| bytes and hands it to the peer
+    bool startProducer(size_t capacity);
+    // Waits for the ring of the peer
+    void startConsumer();
+
+    // Producer: copies the message into the ring, dropped if it's full.
+    // Consumer: queues a copy of the message, written to the socket on the
+    // service thread.
+    bool sendData(const uint8_t* header, uint32_t headerLength,
+                  const uint8_t* payload = nullptr, uint32_t payloadLength = 0,
+                  SendItemKind kind = SEND_ITEM_CONTROL);
+    void close();
+
+    // Ring usage and drops of the producer side
+    SendQueueStats getStats();
+
+    // Name of the abstract unix socket of |port|, the same port of
+    // different prefixes don't collide
+    static std::string endpointName(const std::string& prefix, uint32_t port);
+    // Connects to the ShmAcceptor listening on |port|, null on failure
+    static std::shared_ptr<ShmChannel> connect(uint32_t id,
+                                               std::shared_ptr<IOService> service,
+                                               const std::string& prefix,
+                                               uint32_t port,
+                                               Listener* listener);
+
+private:
+    bool mapRing(int memFd, size_t capacity, bool create);
+    void receiveRing();
+    void ringReceivedHandler(const boost::system::error_code&);
+    void waitData();
+    void dataHandler(const boost::system::error_code&);
+    void drain();
+    void receiveControl();
+    void controlHeaderHandler(const boost::system::error_code&, std::size_t);
+    void controlDataHandler(const boost::system::error_code&, std::size_t);
+    void writeControl();
+    void controlWrittenHandler(const boost::system::error_code&, std::size_t);
+    void keyFrameNeeded();
+    void onPeerClosed();
+    void closeDescriptors();
+    bool writeRecord(const uint8_t* header, uint32_t headerLength,
+                     const uint8_t* payload, uint32_t payloadLength,
+                     SendItemKind kind);
+
+    uint32_t m_id;
+    std::shared_ptr<IOService> m_service;
+    Socket m_socket;
+    boost::asio::posix::stream_descriptor m_event;
+    // Cleared by close() on any thread
+    std::atomic<Listener*> m_listener;
+    std::atomic<bool> m_isClosed;
+    bool m_isProducer;
+
+    ShmRingHeader* m_ring;
+    uint8_t* m_records;
+    size_t m_capacity;
+    size_t m_mappedSize;
+
+    // Producer state, m_sendMutex serializes the threads sending frames
+    boost::mutex m_sendMutex;
+    uint64_t m_tail;
+    bool m_waitKeyFrame;
+    SendQueueStats m_stats;
+
+    // Consumer side messages waiting for the socket, the front one is
+    // being written
+    boost::mutex m_controlMutex;
+    std::deque<std::vector<uint8_t>> m_controlQueue;
+    // Peer messages being read
+    uint32_t m_controlLength;
+    std::vector<uint8_t> m_controlBuffer;
+};
+
+/*
+ * ShmAcceptor
+ * Listens on the abstract unix socket of a port for ShmChannel peers, which
+ * must run as the same user.
+ */
+class ShmAcceptor {
+    DECLARE_LOGGER();
+public:
+    typedef std::function<void(ShmChannel::Socket&)> AcceptCallback;
+
+    ShmAcceptor(std::shared_ptr<IOService> service,
+                const std::string& prefix,
+                AcceptCallback onAccept);
+    ~ShmAcceptor();
+
+    bool listenTo(uint32_t port);
+    // A free port in the range, any port if |maxPort| is 0
+    bool listenTo(uint32_t minPort, uint32_t maxPort);
+    unsigned short getListeningPort() { return m_port; }
+    void close();
+
+private:
+    bool bind(uint32_t port, boost::system::error_code& ec);
+    void doAccept();
+    void acceptHandler(const boost::system::error_code&);
+
+    std::shared_ptr<IOService> m_service;
+    std::string m_prefix;
+    AcceptCallback m_onAccept;
+    boost::asio::local::stream_protocol::acceptor m_acceptor;
+    ShmChannel::Socket m_socket;
+    unsigned short m_port;
+    std::atomic<bool> m_isClosed;
+};
+
+} /* namespace owt_base */
+#endif /* ShmChannel_h */
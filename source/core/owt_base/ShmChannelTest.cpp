@@ -0,0 +1,257 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE ShmChannel
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include "ShmChannel.h"
+
+using namespace owt_base;
+
+// Smallest ring the producer creates
+static const size_t kRingBytes = 64 * 1024;
+
+class TestListener : public ShmChannel::Listener {
+public:
+    TestListener()
+        : connected(false)
+        , closed(false)
+        , keyFramesNeeded(0)
+        , m_gated(false)
+        , m_inGate(false)
+    {}
+
+    void onShmConnected(uint32_t id) override
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        connected = true;
+        m_cond.notify_all();
+    }
+
+    void onShmData(uint32_t id, uint8_t* data, uint32_t len) override
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        messages.emplace_back(data, data + len);
+        m_inGate = m_gated;
+        m_cond.notify_all();
+        // Holds the record in the ring, as a slow consumer does
+        m_cond.wait(lock, [this] { return !m_gated; });
+    }
+
+    void onShmClosed(uint32_t id) override
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        closed = true;
+        m_cond.notify_all();
+    }
+
+    void onShmKeyFrameNeeded(uint32_t id) override
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        keyFramesNeeded++;
+        m_cond.notify_all();
+    }
+
+    // Blocks the next onShmData until release()
+    void hold()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_gated = true;
+    }
+
+    void release()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_gated = false;
+        m_cond.notify_all();
+    }
+
+    template <typename Predicate>
+    bool waitFor(Predicate predicate)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        return m_cond.wait_for(lock, std::chrono::seconds(5), [&] { return predicate(*this); });
+    }
+
+    bool waitInGate()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        return m_cond.wait_for(lock, std::chrono::seconds(5), [this] { return m_inGate; });
+    }
+
+    // Guarded by the waits
+    bool connected;
+    bool closed;
+    int keyFramesNeeded;
+    std::vector<std::vector<uint8_t>> messages;
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    bool m_gated;
+    bool m_inGate;
+};
+
+struct ChannelPair {
+    ChannelPair()
+    {
+        std::shared_ptr<IOService> service = getIOService();
+        ShmChannel::Socket producerSocket(service->service());
+        ShmChannel::Socket consumerSocket(service->service());
+        boost::asio::local::connect_pair(producerSocket, consumerSocket);
+        producer = std::make_shared<ShmChannel>(0, service, std::move(producerSocket), &producerListener);
+        consumer = std::make_shared<ShmChannel>(0, service, std::move(consumerSocket), &consumerListener);
+    }
+
+    ~ChannelPair()
+    {
+        producer->close();
+        consumer->close();
+    }
+
+    void start()
+    {
+        BOOST_REQUIRE(producer->startProducer(kRingBytes));
+        consumer->startConsumer();
+        BOOST_REQUIRE(consumerListener.waitFor([](TestListener& l) { return l.connected; }));
+    }
+
+    // Index in the first 4 bytes, then a pattern derived from it
+    bool send(uint32_t index, uint32_t length, SendItemKind kind)
+    {
+        std::vector<uint8_t> payload(length);
+        for (uint32_t i = 0; i < length; i++) {
+            payload[i] = (uint8_t)(index + i);
+        }
+        return producer->sendData((uint8_t*)&index, sizeof(index), payload.data(), length, kind);
+    }
+
+    static uint32_t indexOf(const std::vector<uint8_t>& message)
+    {
+        uint32_t index;
+        memcpy(&index, message.data(), sizeof(index));
+        return index;
+    }
+
+    static bool isIntact(const std::vector<uint8_t>& message)
+    {
+        uint32_t index = indexOf(message);
+        for (size_t i = sizeof(index); i < message.size(); i++) {
+            if (message[i] != (uint8_t)(index + i - sizeof(index))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    TestListener producerListener;
+    TestListener consumerListener;
+    std::shared_ptr<ShmChannel> producer;
+    std::shared_ptr<ShmChannel> consumer;
+};
+
+BOOST_AUTO_TEST_CASE(wrapAround)
+{
+    ChannelPair pair;
+    pair.start();
+
+    // Odd sizes up to 9000 bytes, four records in flight, so records end
+    // anywhere in the ring and the producer wraps many times
+    const uint32_t kCount = 2000;
+    for (uint32_t i = 0; i < kCount; i++) {
+        BOOST_REQUIRE(pair.send(i, (i * 2654435761u) % 9000 + 1, SEND_ITEM_DELTA_FRAME));
+        if (i % 4 == 3) {
+            BOOST_REQUIRE(pair.consumerListener.waitFor([i](TestListener& l) { return l.messages.size() == i + 1; }));
+        }
+    }
+    BOOST_REQUIRE(pair.consumerListener.waitFor([](TestListener& l) { return l.messages.size() == kCount; }));
+    for (uint32_t i = 0; i < kCount; i++) {
+        const std::vector<uint8_t>& message = pair.consumerListener.messages[i];
+        BOOST_CHECK_EQUAL(ChannelPair::indexOf(message), i);
+        BOOST_CHECK_EQUAL(message.size(), 4 + (i * 2654435761u) % 9000 + 1);
+        BOOST_CHECK(ChannelPair::isIntact(message));
+    }
+    SendQueueStats stats = pair.producer->getStats();
+    BOOST_CHECK_EQUAL(stats.sentItems, kCount);
+    BOOST_CHECK_EQUAL(stats.droppedFrames, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(dropUntilKeyFrame)
+{
+    ChannelPair pair;
+    pair.start();
+
+    // The consumer holds the first record, the ring fills up behind it
+    pair.consumerListener.hold();
+    uint32_t index = 0;
+    BOOST_REQUIRE(pair.send(index++, 1000, SEND_ITEM_KEY_FRAME));
+    BOOST_REQUIRE(pair.consumerListener.waitInGate());
+    uint32_t accepted = 1;
+    while (pair.send(index++, 10000, SEND_ITEM_DELTA_FRAME)) {
+        accepted++;
+        BOOST_REQUIRE(accepted < 100);
+    }
+    uint32_t firstDropped = index - 1;
+    BOOST_CHECK(!pair.send(index++, 10000, SEND_ITEM_DELTA_FRAME));
+    pair.consumerListener.release();
+    BOOST_REQUIRE(pair.consumerListener.waitFor([accepted](TestListener& l) { return l.messages.size() == accepted; }));
+    BOOST_REQUIRE(pair.producerListener.waitFor([](TestListener& l) { return l.keyFramesNeeded > 0; }));
+
+    // Room again, but delta frames depend on the dropped one
+    BOOST_CHECK(!pair.send(index++, 100, SEND_ITEM_DELTA_FRAME));
+    // Audio and control messages don't wait for the key frame
+    BOOST_CHECK(pair.send(index++, 100, SEND_ITEM_AUDIO_FRAME));
+    BOOST_CHECK(pair.send(index++, 100, SEND_ITEM_CONTROL));
+    BOOST_CHECK(pair.send(index++, 100, SEND_ITEM_KEY_FRAME));
+    BOOST_CHECK(pair.send(index++, 100, SEND_ITEM_DELTA_FRAME));
+    BOOST_REQUIRE(pair.consumerListener.waitFor([accepted](TestListener& l) { return l.messages.size() == accepted + 4; }));
+
+    std::vector<std::vector<uint8_t>>& messages = pair.consumerListener.messages;
+    for (uint32_t i = 0; i < accepted; i++) {
+        BOOST_CHECK_EQUAL(ChannelPair::indexOf(messages[i]), i);
+    }
+    BOOST_CHECK_EQUAL(ChannelPair::indexOf(messages[accepted]), firstDropped + 3);
+    BOOST_CHECK_EQUAL(ChannelPair::indexOf(messages[accepted + 3]), firstDropped + 6);
+    for (auto& message : messages) {
+        BOOST_CHECK(ChannelPair::isIntact(message));
+    }
+    // Once for the drop, not for every delta frame dropped after it
+    BOOST_CHECK_EQUAL(pair.producerListener.keyFramesNeeded, 1);
+    SendQueueStats stats = pair.producer->getStats();
+    BOOST_CHECK_EQUAL(stats.sentItems, accepted + 4);
+    BOOST_CHECK_EQUAL(stats.droppedFrames, 3u);
+}
+
+BOOST_AUTO_TEST_CASE(feedback)
+{
+    ChannelPair pair;
+    pair.start();
+
+    uint8_t message[3] = {0x5A, 1, 2};
+    BOOST_CHECK(pair.consumer->sendData(message, sizeof(message)));
+    BOOST_REQUIRE(pair.producerListener.waitFor([](TestListener& l) { return l.messages.size() == 1; }));
+    BOOST_CHECK(pair.producerListener.messages[0] == std::vector<uint8_t>(message, message + sizeof(message)));
+}
+
+BOOST_AUTO_TEST_CASE(peerClosed)
+{
+    ChannelPair pair;
+    pair.start();
+
+    pair.consumer->close();
+    BOOST_CHECK(pair.producerListener.waitFor([](TestListener& l) { return l.closed; }));
+}
+
+BOOST_AUTO_TEST_CASE(noRing)
+{
+    // A producer closing without handing over its ring, as a rejected
+    // peer sees it
+    ChannelPair pair;
+    pair.consumer->startConsumer();
+    pair.producer->close();
+    BOOST_CHECK(pair.consumerListener.waitFor([](TestListener& l) { return l.closed; }));
+    BOOST_CHECK(!pair.consumerListener.connected);
+}
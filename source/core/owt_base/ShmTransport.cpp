@@ -0,0 +1,165 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ShmTransport.h"
+
+#include <future>
+
+namespace owt_base {
+
+DEFINE_LOGGER(ShmTransport, "owt.ShmTransport");
+
+// Endpoints are named after this and the port given to InternalOut
+static const char kShmTransportPrefix[] = "internal-in";
+
+ShmTransport::ShmTransport(RawTransportListener* listener)
+    : m_service(getIOService())
+    , m_capacity(ShmChannelConfig::defaultConfig().ringCapacity())
+    , m_listener(listener)
+{
+}
+
+ShmTransport::~ShmTransport()
+{
+    close();
+}
+
+void ShmTransport::createConnection(const std::string& ip, uint32_t port)
+{
+    auto newChannel = ShmChannel::connect(0, m_service, kShmTransportPrefix, port, this);
+    if (!newChannel || !newChannel->startProducer(m_capacity)) {
+        ELOG_WARN("Failed to connect to %u", port);
+        if (RawTransportListener* listener = m_listener) {
+            listener->onTransportError();
+        }
+        return;
+    }
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_channel = newChannel;
+}
+
+void ShmTransport::listenTo(uint32_t port)
+{
+    listenTo(port, port);
+}
+
+void ShmTransport::listenTo(uint32_t minPort, uint32_t maxPort)
+{
+    if (m_acceptor) {
+        return;
+    }
+    m_acceptor.reset(new ShmAcceptor(m_service, kShmTransportPrefix,
+        [this](ShmChannel::Socket& socket) { acceptHandler(socket); }));
+    m_acceptor->listenTo(minPort, maxPort);
+}
+
+void ShmTransport::acceptHandler(ShmChannel::Socket& socket)
+{
+    auto newChannel = std::make_shared<ShmChannel>(0, m_service, std::move(socket), this);
+    newChannel->startConsumer();
+    std::shared_ptr<ShmChannel> oldChannel;
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        oldChannel = m_channel;
+        m_channel = newChannel;
+    }
+    // One sender at a time, as the TCP transport
+    if (oldChannel) {
+        oldChannel->close();
+    }
+}
+
+std::shared_ptr<ShmChannel> ShmTransport::channel()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    return m_channel;
+}
+
+unsigned short ShmTransport::getListeningPort()
+{
+    return m_acceptor ? m_acceptor->getListeningPort() : 0;
+}
+
+void ShmTransport::sendData(const char* data, int len)
+{
+    if (auto ch = channel()) {
+        ch->sendData(reinterpret_cast<const uint8_t*>(data), len);
+    }
+}
+
+void ShmTransport::sendData(const char* header, int headerLength,
+                            const char* payload, int payloadLength,
+                            SendItemKind kind)
+{
+    if (auto ch = channel()) {
+        ch->sendData(reinterpret_cast<const uint8_t*>(header), headerLength,
+                     reinterpret_cast<const uint8_t*>(payload), payloadLength, kind);
+    }
+}
+
+void ShmTransport::sendData(const char* header, int headerLength,
+                            MediaBufferPtr payload, int payloadLength,
+                            SendItemKind kind)
+{
+    sendData(header, headerLength, reinterpret_cast<const char*>(payload->data()), payloadLength, kind);
+}
+
+SendQueueStats ShmTransport::getSendQueueStats()
+{
+    auto ch = channel();
+    return ch ? ch->getStats() : SendQueueStats();
+}
+
+void ShmTransport::onShmConnected(uint32_t id)
+{
+    if (RawTransportListener* listener = m_listener) {
+        listener->onTransportConnected();
+    }
+}
+
+void ShmTransport::onShmData(uint32_t id, uint8_t* data, uint32_t len)
+{
+    if (RawTransportListener* listener = m_listener) {
+        listener->onTransportData(reinterpret_cast<char*>(data), len);
+    }
+}
+
+void ShmTransport::onShmClosed(uint32_t id)
+{
+    if (RawTransportListener* listener = m_listener) {
+        listener->onTransportError();
+    }
+}
+
+void ShmTransport::onShmKeyFrameNeeded(uint32_t id)
+{
+    if (RawTransportListener* listener = m_listener) {
+        listener->onTransportKeyFrameNeeded();
+    }
+}
+
+void ShmTransport::close()
+{
+    m_listener = nullptr;
+    if (m_acceptor) {
+        m_acceptor->close();
+    }
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        if (m_channel) {
+            m_channel->close();
+            m_channel.reset();
+        }
+    }
+    // Handlers of the acceptor and the channels run on the service thread and
+    // may have read their listener before it was cleared, wait for them so
+    // none calls into this or the listener once closed
+    if (!m_service->isServiceThread()) {
+        std::promise<void> done;
+        m_service->service().post([&done]() { done.set_value(); });
+        done.get_future().wait();
+    }
+}
+
+} /* namespace owt_base */
@@ -0,0 +1,69 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef ShmTransport_h
+#define ShmTransport_h
+
+#include <atomic>
+#include <boost/thread/mutex.hpp>
+#include <logger.h>
+#include <memory>
+
+#include "RawTransport.h"
+#include "ShmChannel.h"
+
+namespace owt_base {
+
+/*
+ * RawTransportInterface on a ShmChannel, for the peers of the same host.
+ * The listening side receives, the connecting side sends, as InternalIn
+ * and InternalOut do. Peers are checked to run as the same user instead
+ * of exchanging tickets.
+ */
+class ShmTransport : public RawTransportInterface, public ShmChannel::Listener {
+    DECLARE_LOGGER();
+public:
+    ShmTransport(RawTransportListener* listener);
+    ~ShmTransport();
+
+    // |ip| is ignored, the peer listens on this host
+    void createConnection(const std::string& ip, uint32_t port);
+    void listenTo(uint32_t port);
+    void listenTo(uint32_t minPort, uint32_t maxPort);
+    void sendData(const char*, int len);
+    void sendData(const char* header, int headerLength, const char* payload, int payloadLength,
+                  SendItemKind kind = SEND_ITEM_CONTROL);
+    // Copied into the ring, |payload| is not kept
+    void sendData(const char* header, int headerLength, MediaBufferPtr payload, int payloadLength,
+                  SendItemKind kind = SEND_ITEM_CONTROL);
+    void close();
+    bool initTicket(const std::string& ticket) { return true; }
+
+    unsigned short getListeningPort();
+
+    // Nothing is queued besides the ring, which ShmChannelConfig sizes
+    void setSendQueueConfig(const SendQueueConfig& config) { }
+    SendQueueStats getSendQueueStats();
+
+    // Implements ShmChannel::Listener
+    void onShmConnected(uint32_t id) override;
+    void onShmData(uint32_t id, uint8_t* data, uint32_t len) override;
+    void onShmClosed(uint32_t id) override;
+    void onShmKeyFrameNeeded(uint32_t id) override;
+
+private:
+    void acceptHandler(ShmChannel::Socket& socket);
+    std::shared_ptr<ShmChannel> channel();
+
+    std::shared_ptr<IOService> m_service;
+    std::unique_ptr<ShmAcceptor> m_acceptor;
+    boost::mutex m_mutex;
+    std::shared_ptr<ShmChannel> m_channel;
+    size_t m_capacity;
+    // Read by the handlers on the service thread, which close() waits for
+    std::atomic<RawTransportListener*> m_listener;
+};
+
+} /* namespace owt_base */
+#endif /* ShmTransport_h */
@@ -0,0 +1,84 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef SpscRing_h
+#define SpscRing_h
+
+#include <atomic>
+#include <vector>
+
+namespace owt_base {
+
+/*
+ * Bounded lock-free ring for exactly one producer thread and one consumer
+ * thread. push() is only called by the producer, front()/pop() only by
+ * the consumer.
+ */
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity)
+        : m_slots(capacity + 1)
+        , m_head(0)
+        , m_tail(0)
+    {
+    }
+
+    bool push(const T& item)
+    {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        size_t next = increment(tail);
+        if (next == m_head.load(std::memory_order_acquire))
+            return false;
+
+        m_slots[tail] = item;
+        m_tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    bool front(T& item)
+    {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire))
+            return false;
+
+        item = m_slots[head];
+        return true;
+    }
+
+    bool pop(T& item)
+    {
+        if (!front(item))
+            return false;
+
+        m_head.store(increment(m_head.load(std::memory_order_relaxed)), std::memory_order_release);
+        return true;
+    }
+
+    // Exact only on the producer or consumer thread
+    size_t size() const
+    {
+        size_t head = m_head.load(std::memory_order_acquire);
+        size_t tail = m_tail.load(std::memory_order_acquire);
+        return tail >= head ? tail - head : tail + m_slots.size() - head;
+    }
+
+    size_t capacity() const { return m_slots.size() - 1; }
+
+private:
+    size_t increment(size_t index) const
+    {
+        return index + 1 == m_slots.size() ? 0 : index + 1;
+    }
+
+    std::vector<T> m_slots;
+    // Keep the indexes of the two sides on separate cache lines
+    std::atomic<size_t> m_head;
+    char m_padding[64 - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> m_tail;
+};
+
+} /* namespace owt_base */
+
+#endif /* SpscRing_h */
@@ -0,0 +1,196 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "TeeStreamOut.h"
+#include "MediaFileOut.h"
+
+#include <mutex>
+#include <stdio.h>
+
+extern "C" {
+#include <libavutil/avstring.h>
+}
+
+namespace owt_base {
+
+DEFINE_LOGGER(TeeStreamOut, "owt.TeeStreamOut");
+
+// Packets queued per sink before it starts dropping, about 5s of a/v
+static const char *kFileFifoOptions = "queue_size=600:drop_pkts_on_overflow=1";
+static const char *kLiveFifoOptions = "queue_size=600:drop_pkts_on_overflow=1"
+        ":attempt_recovery=1:recovery_wait_time=1:max_recovery_attempts=10:restart_with_keyframe=1";
+
+static std::string escape(const std::string& str, const char *specialChars)
+{
+    char *escaped = NULL;
+    if (av_escape(&escaped, str.c_str(), specialChars, AV_ESCAPE_MODE_BACKSLASH, 0) < 0)
+        return std::string();
+
+    std::string ret(escaped);
+    av_free(escaped);
+    return ret;
+}
+
+TeeStreamOut::TeeStreamOut(const std::vector<Sink>& sinks, bool hasAudio, bool hasVideo, EventRegistry* handle, int timeout)
+    : AVStreamOut(buildUrl(sinks), hasAudio, hasVideo, handle, timeout)
+    , m_sinks(sinks)
+    , m_hasFile(false)
+{
+    for (auto& sink : m_sinks) {
+        if (sink.isFile)
+            m_hasFile = true;
+    }
+    ELOG_INFO("%zu sinks", m_sinks.size());
+
+    static std::once_flag logCallbackFlag;
+    std::call_once(logCallbackFlag, [] { av_log_set_callback(&TeeStreamOut::logCallback); });
+}
+
+TeeStreamOut::~TeeStreamOut()
+{
+    close();
+}
+
+bool TeeStreamOut::isAudioFormatSupported(FrameFormat format)
+{
+    for (auto& sink : m_sinks) {
+        if (!(sink.isFile ? MediaFileOut::supportsAudioFormat(format) : LiveStreamOut::supportsAudioFormat(format)))
+            return false;
+    }
+    return true;
+}
+
+bool TeeStreamOut::isVideoFormatSupported(FrameFormat format)
+{
+    for (auto& sink : m_sinks) {
+        if (!(sink.isFile ? MediaFileOut::supportsVideoFormat(format) : LiveStreamOut::supportsVideoFormat(format)))
+            return false;
+    }
+    return true;
+}
+
+const char *TeeStreamOut::getFormatName(std::string& url)
+{
+    if (url.empty()) {
+        ELOG_ERROR("Invalid sinks");
+        return NULL;
+    }
+    return "tee";
+}
+
+bool TeeStreamOut::getHeaderOpt(std::string& url, AVDictionary **options)
+{
+    av_dict_set(options, "use_fifo", "1", 0);
+    return true;
+}
+
+uint32_t TeeStreamOut::getKeyFrameInterval(void)
+{
+    // The shortest interval of the sinks, as LiveStreamOut and MediaFileOut
+    for (auto& sink : m_sinks) {
+        if (!sink.isFile)
+            return 2000;
+    }
+    return 120000;
+}
+
+void TeeStreamOut::onVideoSourceChanged()
+{
+    if (!m_hasFile) {
+        AVStreamOut::onVideoSourceChanged();
+        return;
+    }
+
+    // Same as MediaFileOut
+    setVideoSourceChanged();
+    deliverFeedbackMsg(FeedbackMsg{.type = VIDEO_FEEDBACK, .cmd = REQUEST_KEY_FRAME});
+}
+
+void TeeStreamOut::logCallback(void *avcl, int level, const char *fmt, va_list vl)
+{
+    va_list args;
+    va_copy(args, vl);
+    av_log_default_callback(avcl, level, fmt, vl);
+
+    // "Slave muxer #<index> failed: <reason>, continuing with <alive>/<total> slaves."
+    if (level <= AV_LOG_ERROR && avcl && *(const AVClass **)avcl == avformat_get_class()
+            && !strncmp(fmt, "Slave muxer #", 13)) {
+        AVFormatContext *context = (AVFormatContext *)avcl;
+        char message[512];
+        unsigned index;
+        vsnprintf(message, sizeof(message), fmt, args);
+        message[strcspn(message, "\n")] = '\0';
+        if (context->oformat && !strcmp(context->oformat->name, "tee") && context->opaque
+                && sscanf(message, "Slave muxer #%u", &index) == 1) {
+            // Set by AVStreamOut, only a TeeStreamOut opens a tee
+            TeeStreamOut *tee = static_cast<TeeStreamOut *>(static_cast<AVStreamOut *>(context->opaque));
+            tee->onSinkFailed(index, message);
+        }
+    }
+    va_end(args);
+}
+
+void TeeStreamOut::onSinkFailed(uint32_t index, const std::string& reason)
+{
+    if (index >= m_sinks.size())
+        return;
+
+    ELOG_WARN("Sink %u(%s) failed, %s", index, m_sinks[index].url.c_str(), reason.c_str());
+    notifyAsyncEvent("sinkfailed", m_sinks[index].url);
+}
+
+// [f=<muxer>:onfail=ignore:fifo_options=...:<muxer options>]<url>
+bool TeeStreamOut::getSinkSpec(const Sink& sink, std::string& spec)
+{
+    const char *format = sink.isFile ? MediaFileOut::formatName(sink.url) : LiveStreamOut::formatName(sink.options);
+    if (!format) {
+        ELOG_ERROR("Invalid format for url(%s)", sink.url.c_str());
+        return false;
+    }
+
+    AVDictionary *options = NULL;
+    if (!sink.isFile && !LiveStreamOut::getMuxerOptions(sink.options, sink.url, &options)) {
+        av_dict_free(&options);
+        return false;
+    }
+
+    // Values are unescaped once by the tee option parser
+    const char *specialChars = ":]=";
+    spec = "[f=";
+    spec.append(format);
+    spec.append(":onfail=ignore:fifo_options=");
+    spec.append(escape(sink.isFile ? kFileFifoOptions : kLiveFifoOptions, specialChars));
+
+    AVDictionaryEntry *entry = NULL;
+    while ((entry = av_dict_get(options, "", entry, AV_DICT_IGNORE_SUFFIX))) {
+        spec.append(":");
+        spec.append(entry->key);
+        spec.append("=");
+        spec.append(escape(entry->value, specialChars));
+    }
+    av_dict_free(&options);
+
+    spec.append("]");
+    spec.append(sink.url);
+    return true;
+}
+
+std::string TeeStreamOut::buildUrl(const std::vector<Sink>& sinks)
+{
+    std::string url;
+
+    for (auto& sink : sinks) {
+        std::string spec;
+        if (!getSinkSpec(sink, spec))
+            return std::string();
+
+        // And once more when the url is split into sinks
+        if (!url.empty())
+            url.append("|");
+        url.append(escape(spec, "|"));
+    }
+    return url;
+}
+
+} /* namespace owt_base */
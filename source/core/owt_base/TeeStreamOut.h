@@ -0,0 +1,67 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef TeeStreamOut_h
+#define TeeStreamOut_h
+
+#include <stdarg.h>
+#include <string>
+#include <vector>
+
+#include <logger.h>
+
+#include "AVStreamOut.h"
+#include "LiveStreamOut.h"
+
+namespace owt_base {
+
+/*
+ * Muxes one stream to several sinks through the FFmpeg tee muxer. The
+ * input queue, format checks, key frame gating and codec parameters are
+ * shared, each sink runs its muxer behind its own fifo thread. A sink that
+ * falls behind drops packets and a failing one is dropped or reconnected
+ * on the next key frame of the stream, without affecting the others. A
+ * dropped sink, like any failed file sink, is reported as a "sinkfailed"
+ * event with its url.
+ */
+class TeeStreamOut : public AVStreamOut {
+    DECLARE_LOGGER();
+
+public:
+    struct Sink {
+        std::string url;
+        bool isFile;
+        // Only for !isFile
+        LiveStreamOut::StreamingOptions options;
+    };
+
+    TeeStreamOut(const std::vector<Sink>& sinks, bool hasAudio, bool hasVideo, EventRegistry* handle, int timeout);
+    ~TeeStreamOut();
+
+    void onVideoSourceChanged() override;
+
+protected:
+    bool isAudioFormatSupported(FrameFormat format) override;
+    bool isVideoFormatSupported(FrameFormat format) override;
+    const char *getFormatName(std::string& url) override;
+    bool getHeaderOpt(std::string& url, AVDictionary **options) override;
+
+    uint32_t getKeyFrameInterval(void) override;
+    // Sinks reconnect inside the tee, the shared context is never reopened
+    uint32_t getReconnectCount(void) override {return 0;}
+
+private:
+    static std::string buildUrl(const std::vector<Sink>& sinks);
+    static bool getSinkSpec(const Sink& sink, std::string& spec);
+    // The tee only logs the sinks it drops
+    static void logCallback(void *avcl, int level, const char *fmt, va_list vl);
+    void onSinkFailed(uint32_t index, const std::string& reason);
+
+    std::vector<Sink> m_sinks;
+    bool m_hasFile;
+};
+
+} /* namespace owt_base */
+
+#endif /* TeeStreamOut_h */
@@ -0,0 +1,133 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE TeeStreamOut
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "TeeStreamOut.h"
+
+using namespace owt_base;
+
+class TestEvents : public EventRegistry {
+public:
+    bool notifyAsyncEvent(const std::string& event, const std::string& data) override
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        events.push_back(std::make_pair(event, data));
+        m_cond.notify_all();
+        return true;
+    }
+
+    bool notifyAsyncEventInEmergency(const std::string& event, const std::string& data) override
+    {
+        return notifyAsyncEvent(event, data);
+    }
+
+    bool waitFor(const std::string& event, std::string& data)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        return m_cond.wait_for(lock, std::chrono::seconds(5), [&] {
+            for (auto& e : events) {
+                if (e.first == event) {
+                    data = e.second;
+                    return true;
+                }
+            }
+            return false;
+        });
+    }
+
+    size_t count(const std::string& event)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        size_t n = 0;
+        for (auto& e : events) {
+            if (e.first == event)
+                n++;
+        }
+        return n;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::vector<std::pair<std::string, std::string>> events;
+};
+
+static TeeStreamOut::Sink fileSink(const std::string& url)
+{
+    TeeStreamOut::Sink sink;
+    sink.url = url;
+    sink.isFile = true;
+    return sink;
+}
+
+// VP8 in Matroska, the muxer takes the payload as is
+static void pushFrames(TeeStreamOut& tee, int count)
+{
+    std::vector<uint8_t> payload(2000, 0x5A);
+    for (int i = 0; i < count; i++) {
+        Frame frame;
+        memset(&frame, 0, sizeof(frame));
+        frame.format = FRAME_FORMAT_VP8;
+        frame.payload = payload.data();
+        frame.length = payload.size();
+        frame.timeStamp = i * 3000;
+        frame.additionalInfo.video.width = 320;
+        frame.additionalInfo.video.height = 240;
+        frame.additionalInfo.video.isKeyFrame = (i % 30 == 0);
+        tee.onFrame(frame);
+        std::this_thread::sleep_for(std::chrono::milliseconds(33));
+    }
+}
+
+static off_t fileSize(const std::string& path)
+{
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 ? st.st_size : -1;
+}
+
+BOOST_AUTO_TEST_CASE(failingSinkIsReported)
+{
+    std::string good = "/tmp/TeeStreamOutTest-" + std::to_string(getpid()) + ".mkv";
+    std::string bad = "/nonexistent-TeeStreamOutTest/out.mkv";
+    std::vector<TeeStreamOut::Sink> sinks{fileSink(good), fileSink(bad)};
+
+    TestEvents events;
+    {
+        TeeStreamOut tee(sinks, false, true, &events, 5000);
+        pushFrames(tee, 60);
+
+        std::string url;
+        BOOST_REQUIRE(events.waitFor("sinkfailed", url));
+        BOOST_CHECK_EQUAL(url, bad);
+    }
+    // The other sink kept muxing
+    BOOST_CHECK_EQUAL(events.count("sinkfailed"), 1u);
+    BOOST_CHECK_EQUAL(events.count("fatal"), 0u);
+    BOOST_CHECK_GT(fileSize(good), 60 * 2000);
+    unlink(good.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(allSinksFailing)
+{
+    std::vector<TeeStreamOut::Sink> sinks{
+        fileSink("/nonexistent-TeeStreamOutTest/a.mkv"),
+        fileSink("/nonexistent-TeeStreamOutTest/b.mkv")};
+
+    TestEvents events;
+    TeeStreamOut tee(sinks, false, true, &events, 5000);
+    pushFrames(tee, 60);
+
+    // The last one takes the whole tee down, reported as for a single sink
+    std::string reason;
+    BOOST_REQUIRE(events.waitFor("fatal", reason));
+    BOOST_CHECK_EQUAL(events.count("sinkfailed"), 1u);
+}
@@ -4,7 +4,7 @@
 
 #include "VCMFrameDecoder.h"
 
-#include <boost/shared_array.hpp>
+#include <algorithm>
 
 #include <webrtc/modules/video_coding/codecs/h264/include/h264.h>
 #include <webrtc/modules/video_coding/codecs/vp8/include/vp8.h>
@@ -22,9 +22,91 @@ namespace owt_base {
 
 DEFINE_LOGGER(VCMFrameDecoder, "owt.VCMFrameDecoder");
 
+// Frames that can't be queued beyond this depth are dropped. From half of
+// it on, frames no other frame refers to are dropped on arrival. About a
+// quarter second at 30fps.
+static const uint32_t kMaxPendingFrames = 8;
+// Number of recent decodes the percentiles are computed over
+static const size_t kDecodeTimeWindow = 256;
+
+// Annex B H.264 whose slices all have nal_ref_idc 0
+static bool isH264NonReference(const uint8_t* data, size_t length)
+{
+    bool hasSlice = false;
+    size_t i = 0;
+    while (i + 3 < length) {
+        if (data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 1) {
+            uint8_t header = data[i + 3];
+            uint8_t type = header & 0x1F;
+            if (type >= 1 && type <= 5) {
+                if (header & 0x60)
+                    return false;
+                hasSlice = true;
+            }
+            i += 4;
+        } else {
+            i++;
+        }
+    }
+    return hasSlice;
+}
+
+// VP9 inter frame refreshing no reference slot, from the uncompressed header
+static bool isVP9NonReference(const uint8_t* data, size_t length)
+{
+    // Superframes carry several frames, left alone
+    if (length < 3 || (data[length - 1] & 0xE0) == 0xC0)
+        return false;
+
+    size_t bit = 0;
+    auto read = [data, &bit](int count) {
+        uint32_t value = 0;
+        for (int i = 0; i < count; i++, bit++)
+            value = (value << 1) | ((data[bit / 8] >> (7 - bit % 8)) & 1);
+        return value;
+    };
+    if (read(2) != 2) // frame_marker
+        return false;
+    uint32_t profile = read(1);
+    profile |= read(1) << 1;
+    if (profile == 3)
+        read(1);
+    if (read(1)) // show_existing_frame
+        return false;
+    if (read(1) == 0) // frame_type, key frame
+        return false;
+    uint32_t showFrame = read(1);
+    uint32_t errorResilient = read(1);
+    if (!showFrame && read(1)) // intra_only
+        return false;
+    if (!errorResilient)
+        read(2); // reset_frame_context
+    return read(8) == 0; // refresh_frame_flags
+}
+
+// Whether no later frame refers to |frame|, so it can be dropped without
+// breaking the decode. VP8 keeps its reference flags in the entropy coded
+// part of the header and is always treated as a reference.
+static bool isNonReferenceFrame(const Frame& frame)
+{
+    switch (frame.format) {
+    case FRAME_FORMAT_H264:
+        return isH264NonReference(frame.payload, frame.length);
+    case FRAME_FORMAT_VP9:
+        return isVP9NonReference(frame.payload, frame.length);
+    default:
+        return false;
+    }
+}
+
 VCMFrameDecoder::VCMFrameDecoder(FrameFormat format)
     : m_needDecode(false)
+    , m_shard(VideoDecodeExecutor::GetInstance().attach(this))
+    , m_decodeScheduled(false)
     , m_needKeyFrame(true)
+    , m_decodedFrames(0)
+    , m_droppedFrames(0)
+    , m_decodeTimesPos(0)
 {
     memset(&m_codecInfo, 0, sizeof(m_codecInfo));
 }
@@ -32,6 +114,7 @@ VCMFrameDecoder::VCMFrameDecoder(FrameFormat format)
 VCMFrameDecoder::~VCMFrameDecoder()
 {
     m_needDecode = false;
+    VideoDecodeExecutor::GetInstance().detach(this, m_shard);
     if (m_decoder) {
         m_decoder->RegisterDecodeCompleteCallback(nullptr);
         m_decoder->Release();
@@ -79,9 +162,12 @@ bool VCMFrameDecoder::init(FrameFormat format)
 
     m_decoder->RegisterDecodeCompleteCallback(this);
 
-    m_needDecode = true;
-    m_needKeyFrame = true;
     m_codecInfo.codecType = codecType;
+    {
+        boost::mutex::scoped_lock lock(m_pendingMutex);
+        m_needKeyFrame = true;
+    }
+    m_needDecode = true;
     return true;
 }
 
@@ -103,6 +189,11 @@ int32_t VCMFrameDecoder::Decoded(VideoFrame& decodedImage)
     return 0;
 }
 
+bool VCMFrameDecoder::keepsPayload()
+{
+    return EncodedImage::GetBufferPaddingBytes(m_codecInfo.codecType) == 0;
+}
+
 void VCMFrameDecoder::onFrame(const Frame& frame)
 {
     if (!m_needDecode)
@@ -118,51 +209,180 @@ void VCMFrameDecoder::onFrame(const Frame& frame)
 
     if (frame.payload == 0 || frame.length == 0) {
         ELOG_DEBUG_T("Null frame, request key frame");
-        FeedbackMsg msg {.type = VIDEO_FEEDBACK, .cmd = REQUEST_KEY_FRAME};
-        deliverFeedbackMsg(msg);
+        requestKeyFrame();
         return;
     }
 
-    if (m_needKeyFrame) {
-        if (frame.additionalInfo.video.isKeyFrame) {
-            m_needKeyFrame = false;
+    // The payload is only borrowed, keep it in a pooled buffer with the
+    // padding the decoder reads past the end
+    PendingFrame pending;
+    pending.frame = frame;
+    pending.frame.payload = nullptr;
+    pending.frame.buffer = nullptr;
+    size_t padding = EncodedImage::GetBufferPaddingBytes(m_codecInfo.codecType);
+    if (padding == 0) {
+        pending.buffer = retainPayload(frame);
+    } else {
+        pending.buffer = MediaBufferPool::GetInstance().acquire(frame.length + padding);
+        memcpy(pending.buffer->data(), frame.payload, frame.length);
+        memset(pending.buffer->data() + frame.length, 0, padding);
+    }
+    pending.queueTime = std::chrono::steady_clock::now();
+
+    bool isKeyFrame = frame.additionalInfo.video.isKeyFrame;
+    bool needKeyFrame = false;
+    bool schedule = false;
+    uint64_t dropped = 0;
+    {
+        boost::mutex::scoped_lock lock(m_pendingMutex);
+        size_t depth = m_pendingFrames.size();
+        bool overloaded = depth >= (kMaxPendingFrames + 1) / 2;
+
+        if (m_needKeyFrame && !isKeyFrame) {
+            needKeyFrame = true;
+            dropped = 1;
+        } else if (overloaded && !isKeyFrame && isNonReferenceFrame(frame)) {
+            // Headers are only parsed when there is something to shed
+            dropped = 1;
+        } else if (!isKeyFrame && depth >= kMaxPendingFrames) {
+            // Later frames may refer to this one, wait for the next key frame
+            ELOG_DEBUG_T("Decode queue full, request key frame");
+            m_needKeyFrame = true;
+            needKeyFrame = true;
+            dropped = 1;
         } else {
-            ELOG_DEBUG_T("Request key frame");
-            FeedbackMsg msg {.type = VIDEO_FEEDBACK, .cmd = REQUEST_KEY_FRAME};
-            deliverFeedbackMsg(msg);
-            return;
+            if (isKeyFrame) {
+                m_needKeyFrame = false;
+                // Nothing after a key frame refers to the frames queued before it
+                if (overloaded) {
+                    dropped = depth;
+                    m_pendingFrames.clear();
+                }
+            }
+            m_pendingFrames.push_back(pending);
+            if (!m_decodeScheduled) {
+                m_decodeScheduled = true;
+                schedule = true;
+            }
         }
     }
 
-    uint8_t *payload    = NULL;
-    size_t length       = frame.length;
-    size_t padding      = EncodedImage::GetBufferPaddingBytes(m_codecInfo.codecType);
-    size_t size         = length + padding;
-    boost::shared_array<uint8_t> buffer;
+    if (dropped) {
+        boost::mutex::scoped_lock lock(m_statsMutex);
+        m_droppedFrames += dropped;
+    }
+    if (needKeyFrame) {
+        ELOG_DEBUG_T("Request key frame");
+        requestKeyFrame();
+    }
+    if (schedule) {
+        VideoDecodeExecutor::GetInstance().schedule(this, m_shard);
+    }
+}
 
-    if (padding > 0) {
-        buffer.reset(new uint8_t[size]);
-        if (buffer.get()) {
-            memcpy(buffer.get(), frame.payload, length);
-            memset(buffer.get() + length, 0, padding);
-        } else {
+void VCMFrameDecoder::decodePending()
+{
+    // One frame per run, so the decoders of a shard take turns
+    PendingFrame pending;
+    bool more = false;
+    {
+        boost::mutex::scoped_lock lock(m_pendingMutex);
+        if (m_pendingFrames.empty() || !m_needDecode) {
+            m_decodeScheduled = false;
             return;
         }
+        pending = m_pendingFrames.front();
+        m_pendingFrames.pop_front();
+        more = !m_pendingFrames.empty();
+        if (!more) {
+            m_decodeScheduled = false;
+        }
     }
 
-    payload = buffer.get() ? buffer.get() : frame.payload;
-    EncodedImage image(payload, length, size);
-    image._frameType = frame.additionalInfo.video.isKeyFrame ? kVideoFrameKey : kVideoFrameDelta;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    uint32_t waitUs = std::chrono::duration_cast<std::chrono::microseconds>(start - pending.queueTime).count();
+
+    size_t length   = pending.frame.length;
+    size_t padding  = EncodedImage::GetBufferPaddingBytes(m_codecInfo.codecType);
+    EncodedImage image(pending.buffer->data(), length, length + padding);
+    image._frameType = pending.frame.additionalInfo.video.isKeyFrame ? kVideoFrameKey : kVideoFrameDelta;
     image._completeFrame = true;
-    image._timeStamp = frame.timeStamp;
+    image._timeStamp = pending.frame.timeStamp;
     int ret = m_decoder->Decode(image, false, nullptr, &m_codecInfo);
     if (ret != 0) {
         ELOG_ERROR_T("Decode frame error: %d", ret);
 
-        m_needKeyFrame = true;
-        FeedbackMsg msg {.type = VIDEO_FEEDBACK, .cmd = REQUEST_KEY_FRAME};
-        deliverFeedbackMsg(msg);
+        uint64_t dropped = 0;
+        {
+            boost::mutex::scoped_lock lock(m_pendingMutex);
+            m_needKeyFrame = true;
+            dropped = m_pendingFrames.size();
+            m_pendingFrames.clear();
+            m_decodeScheduled = false;
+            more = false;
+        }
+        {
+            boost::mutex::scoped_lock lock(m_statsMutex);
+            m_droppedFrames += dropped;
+        }
+        requestKeyFrame();
+    }
+
+    uint64_t decoded = recordDecodeTime(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count(), waitUs);
+    if (decoded % kDecodeTimeWindow == 0) {
+        VideoDecodeStats stats = getDecodeStats();
+        ELOG_DEBUG_T("Decoded %llu, dropped %llu, decode time p50 %uus p99 %uus, queue wait p50 %uus p99 %uus",
+                (unsigned long long)stats.decodedFrames, (unsigned long long)stats.droppedFrames,
+                stats.decodeTimeP50Us, stats.decodeTimeP99Us, stats.queueWaitP50Us, stats.queueWaitP99Us);
+    }
+
+    if (more) {
+        VideoDecodeExecutor::GetInstance().schedule(this, m_shard);
+    }
+}
+
+void VCMFrameDecoder::requestKeyFrame()
+{
+    FeedbackMsg msg {.type = VIDEO_FEEDBACK, .cmd = REQUEST_KEY_FRAME};
+    deliverFeedbackMsg(msg);
+}
+
+VideoDecodeStats VCMFrameDecoder::getDecodeStats()
+{
+    boost::mutex::scoped_lock lock(m_statsMutex);
+    VideoDecodeStats stats = {};
+    stats.decodedFrames = m_decodedFrames;
+    stats.droppedFrames = m_droppedFrames;
+
+    std::vector<uint32_t> times(m_decodeTimesUs);
+    if (!times.empty()) {
+        std::sort(times.begin(), times.end());
+        stats.decodeTimeP50Us = times[(times.size() - 1) * 50 / 100];
+        stats.decodeTimeP99Us = times[(times.size() - 1) * 99 / 100];
+    }
+    std::vector<uint32_t> waits(m_queueWaitsUs);
+    if (!waits.empty()) {
+        std::sort(waits.begin(), waits.end());
+        stats.queueWaitP50Us = waits[(waits.size() - 1) * 50 / 100];
+        stats.queueWaitP99Us = waits[(waits.size() - 1) * 99 / 100];
+    }
+    return stats;
+}
+
+uint64_t VCMFrameDecoder::recordDecodeTime(uint32_t decodeUs, uint32_t waitUs)
+{
+    boost::mutex::scoped_lock lock(m_statsMutex);
+    m_decodedFrames++;
+    if (m_decodeTimesUs.size() < kDecodeTimeWindow) {
+        m_decodeTimesUs.push_back(decodeUs);
+        m_queueWaitsUs.push_back(waitUs);
+    } else {
+        m_decodeTimesUs[m_decodeTimesPos] = decodeUs;
+        m_queueWaitsUs[m_decodeTimesPos] = waitUs;
+        m_decodeTimesPos = (m_decodeTimesPos + 1) % kDecodeTimeWindow;
     }
+    return m_decodedFrames;
 }
 
 }
@@ -6,8 +6,14 @@
 #define VCMFrameDecoder_h
 
 #include "MediaFramePipeline.h"
+#include "VideoDecodeExecutor.h"
+
+#include <atomic>
+#include <chrono>
+#include <deque>
 
 #include <boost/scoped_ptr.hpp>
+#include <boost/thread/mutex.hpp>
 #include <logger.h>
 
 #include <webrtc/modules/video_coding/include/video_codec_interface.h>
@@ -15,7 +21,21 @@
 
 namespace owt_base {
 
-class VCMFrameDecoder : public VideoFrameDecoder, public webrtc::DecodedImageCallback {
+struct VideoDecodeStats {
+    uint64_t decodedFrames;
+    uint64_t droppedFrames;
+    // Over the most recent decodes, in microseconds
+    uint32_t decodeTimeP50Us;
+    uint32_t decodeTimeP99Us;
+    uint32_t queueWaitP50Us;
+    uint32_t queueWaitP99Us;
+};
+
+/**
+ * Decodes on the shared VideoDecodeExecutor. Encoded frames are copied into
+ * pooled padded buffers and queued, so onFrame() returns right away.
+ */
+class VCMFrameDecoder : public VideoFrameDecoder, public webrtc::DecodedImageCallback, public VideoDecodeJob {
     DECLARE_LOGGER();
 
 public:
@@ -31,13 +51,41 @@ public:
     bool init(FrameFormat format);
 
     void onFrame(const Frame&);
+    // Queued until decoded, unless the codec needs a padded copy
+    bool keepsPayload();
     int32_t Decoded(webrtc::VideoFrame& decodedImage);
 
+    // Implements VideoDecodeJob.
+    void decodePending();
+
+    VideoDecodeStats getDecodeStats();
+
 private:
-    bool m_needDecode;
-    bool m_needKeyFrame;
+    struct PendingFrame {
+        Frame frame;
+        MediaBufferPtr buffer;
+        std::chrono::steady_clock::time_point queueTime;
+    };
+
+    void requestKeyFrame();
+    uint64_t recordDecodeTime(uint32_t decodeUs, uint32_t waitUs);
+
+    std::atomic<bool> m_needDecode;
     webrtc::CodecSpecificInfo m_codecInfo;
     boost::scoped_ptr<webrtc::VideoDecoder> m_decoder;
+    uint32_t m_shard;
+
+    boost::mutex m_pendingMutex;
+    std::deque<PendingFrame> m_pendingFrames;
+    bool m_decodeScheduled;
+    bool m_needKeyFrame;
+
+    boost::mutex m_statsMutex;
+    uint64_t m_decodedFrames;
+    uint64_t m_droppedFrames;
+    std::vector<uint32_t> m_decodeTimesUs;
+    std::vector<uint32_t> m_queueWaitsUs;
+    size_t m_decodeTimesPos;
 };
 
 } /* namespace owt_base */
@@ -2,6 +2,9 @@
 //
 // SPDX-License-Identifier: Apache-2.0
 
+#include <algorithm>
+#include <chrono>
+
 #include <boost/make_shared.hpp>
 
 #include <webrtc/system_wrappers/include/cpu_info.h>
@@ -21,6 +24,12 @@ namespace owt_base {
 
 DEFINE_LOGGER(VCMFrameEncoder, "owt.VCMFrameEncoder");
 
+// Raw frames waiting for the encode thread beyond this depth are skipped,
+// oldest first, so the latest frame wins
+static const size_t kMaxPendingFrames = 1;
+// Number of recent encode times the percentiles are computed over
+static const size_t kEncodeTimeWindow = 256;
+
 VCMFrameEncoder::VCMFrameEncoder(FrameFormat format, VideoCodecProfile profile, bool useSimulcast)
     : m_streamId(0)
     , m_encodeFormat(format)
@@ -34,6 +43,10 @@ VCMFrameEncoder::VCMFrameEncoder(FrameFormat format, VideoCodecProfile profile,
     , m_bitrateKbps(0)
     , m_enableBsDump(false)
     , m_bsDumpfp(NULL)
+    , m_encodeScheduled(false)
+    , m_encodedFrames(0)
+    , m_skippedFrames(0)
+    , m_encodeTimesPos(0)
 {
     m_bufferManager.reset(new I420BufferManager(3));
     m_converter.reset(new FrameConverter());
@@ -312,12 +325,121 @@ void VCMFrameEncoder::onFrame(const Frame& frame)
         return;
     }
 
-    boost::shared_ptr<webrtc::VideoFrame> videoFrame = frameConvert(frame);
-    if (videoFrame == NULL) {
+    // Only take a reference here, the conversion is done by the encode
+    // thread so that frames skipped under load are never converted.
+    PendingFrame pending;
+    pending.frame = frame;
+    switch (frame.format) {
+    case FRAME_FORMAT_I420:
+        pending.i420Frame.reset(new VideoFrame(*reinterpret_cast<VideoFrame*>(frame.payload)));
+        break;
+#ifdef ENABLE_MSDK
+    case FRAME_FORMAT_MSDK:
+        pending.msdkHolder = *reinterpret_cast<MsdkFrameHolder*>(frame.payload);
+        break;
+#endif
+    default:
+        ELOG_ERROR_T("Unsupported input format(%s)", getFormatStr(frame.format));
         return;
     }
+    pending.frame.payload = NULL;
+
+    bool schedule = false;
+    {
+        boost::mutex::scoped_lock pendingLock(m_pendingMutex);
+        while (m_pendingFrames.size() >= kMaxPendingFrames) {
+            m_pendingFrames.pop_front();
+            boost::mutex::scoped_lock statsLock(m_statsMutex);
+            m_skippedFrames++;
+        }
+        m_pendingFrames.push_back(pending);
+        if (!m_encodeScheduled) {
+            m_encodeScheduled = true;
+            schedule = true;
+        }
+    }
+
+    if (schedule) {
+        m_srv->post(boost::bind(&VCMFrameEncoder::Encode, this));
+    }
+}
+
+VideoEncodeStats VCMFrameEncoder::getEncodeStats()
+{
+    boost::mutex::scoped_lock lock(m_statsMutex);
+    VideoEncodeStats stats = {};
+    stats.encodedFrames = m_encodedFrames;
+    stats.skippedFrames = m_skippedFrames;
+
+    std::vector<uint32_t> times(m_encodeTimesUs);
+    if (!times.empty()) {
+        std::sort(times.begin(), times.end());
+        stats.encodeTimeP50Us = times[(times.size() - 1) * 50 / 100];
+        stats.encodeTimeP90Us = times[(times.size() - 1) * 90 / 100];
+        stats.encodeTimeP99Us = times[(times.size() - 1) * 99 / 100];
+    }
+    return stats;
+}
+
+uint64_t VCMFrameEncoder::recordEncodeTime(uint32_t us)
+{
+    boost::mutex::scoped_lock lock(m_statsMutex);
+    m_encodedFrames++;
+    if (m_encodeTimesUs.size() < kEncodeTimeWindow) {
+        m_encodeTimesUs.push_back(us);
+    } else {
+        m_encodeTimesUs[m_encodeTimesPos] = us;
+        m_encodeTimesPos = (m_encodeTimesPos + 1) % kEncodeTimeWindow;
+    }
+    return m_encodedFrames;
+}
+
+void VCMFrameEncoder::encodePending()
+{
+    while (true) {
+        PendingFrame pending;
+        {
+            boost::mutex::scoped_lock lock(m_pendingMutex);
+            if (m_pendingFrames.empty()) {
+                m_encodeScheduled = false;
+                return;
+            }
+            pending = m_pendingFrames.front();
+            m_pendingFrames.pop_front();
+        }
+
+        switch (pending.frame.format) {
+        case FRAME_FORMAT_I420:
+            pending.frame.payload = reinterpret_cast<uint8_t*>(pending.i420Frame.get());
+            break;
+#ifdef ENABLE_MSDK
+        case FRAME_FORMAT_MSDK:
+            pending.frame.payload = reinterpret_cast<uint8_t*>(&pending.msdkHolder);
+            break;
+#endif
+        default:
+            continue;
+        }
 
-    m_srv->post(boost::bind(&VCMFrameEncoder::Encode, this, videoFrame));
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        {
+            boost::shared_lock<boost::shared_mutex> lock(m_mutex);
+            boost::shared_ptr<webrtc::VideoFrame> videoFrame = frameConvert(pending.frame);
+            if (videoFrame == NULL) {
+                continue;
+            }
+            encode(videoFrame);
+        }
+        uint64_t encoded = recordEncodeTime(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count());
+
+        if (encoded % kEncodeTimeWindow == 0) {
+            VideoEncodeStats stats = getEncodeStats();
+            ELOG_DEBUG_T("Encoded %llu, skipped %llu, encode time p50 %uus p90 %uus p99 %uus",
+                    (unsigned long long)stats.encodedFrames, (unsigned long long)stats.skippedFrames,
+                    stats.encodeTimeP50Us, stats.encodeTimeP90Us, stats.encodeTimeP99Us);
+        }
+    }
 }
 
 boost::shared_ptr<webrtc::VideoFrame> VCMFrameEncoder::frameConvert(const Frame& frame)
@@ -325,14 +447,15 @@ boost::shared_ptr<webrtc::VideoFrame> VCMFrameEncoder::frameConvert(const Frame&
     int32_t dstFrameWidth = m_isAdaptiveMode ? frame.additionalInfo.video.width : m_width;
     int32_t dstFrameHeight = m_isAdaptiveMode ? frame.additionalInfo.video.height: m_height;
 
+    boost::shared_ptr<webrtc::VideoFrame> dstFrame;
+    // Inputs are always copied into our own pool, so the small buffer pools
+    // of the producers are not held for the duration of an encode.
     rtc::scoped_refptr<webrtc::I420Buffer> rawBuffer = m_bufferManager->getFreeBuffer(dstFrameWidth, dstFrameHeight);
     if (!rawBuffer) {
         ELOG_ERROR_T("No valid buffer");
         return NULL;
     }
 
-    boost::shared_ptr<webrtc::VideoFrame> dstFrame;
-
     switch (frame.format) {
     case FRAME_FORMAT_I420: {
         if (m_encodeFormat == FRAME_FORMAT_UNKNOWN)
@@ -374,9 +497,9 @@ boost::shared_ptr<webrtc::VideoFrame> VCMFrameEncoder::frameConvert(const Frame&
     return dstFrame;
 }
 
+// Called on the encode thread with m_mutex shared locked.
 void VCMFrameEncoder::encode(boost::shared_ptr<webrtc::VideoFrame> frame)
 {
-    boost::shared_lock<boost::shared_mutex> lock(m_mutex);
     int ret;
 
     if (m_streams.size() == 0) {
@@ -433,9 +556,14 @@ webrtc::EncodedImageCallback::Result VCMFrameEncoder::OnEncodedImage(const Encod
     if (!m_streams.empty()) {
         Frame frame;
         memset(&frame, 0, sizeof(frame));
+        // The webrtc encoders own |encoded_frame| and reuse it, attach a
+        // pooled copy so that the destinations fanning the stream out can
+        // keep it without copying it again.
+        MediaBufferPtr buffer = MediaBufferPool::GetInstance().copyFrom(encoded_frame._buffer, encoded_frame._length);
         frame.format = m_encodeFormat;
-        frame.payload = encoded_frame._buffer;
+        frame.payload = buffer->data();
         frame.length = encoded_frame._length;
+        frame.buffer = buffer.get();
         frame.timeStamp = encoded_frame._timeStamp;
         frame.additionalInfo.video.width = encoded_frame._encodedWidth;
         frame.additionalInfo.video.height = encoded_frame._encodedHeight;
@@ -7,6 +7,7 @@
 
 #include <map>
 #include <atomic>
+#include <deque>
 
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
@@ -28,6 +29,15 @@ using namespace webrtc;
 
 namespace owt_base {
 
+struct VideoEncodeStats {
+    uint64_t encodedFrames;
+    uint64_t skippedFrames;
+    // Over the most recent encodes, in microseconds
+    uint32_t encodeTimeP50Us;
+    uint32_t encodeTimeP90Us;
+    uint32_t encodeTimeP99Us;
+};
+
 class EncodeOut : public FrameSource {
 public:
     EncodeOut(int32_t streamId, owt_base::VideoFrameEncoder* owner, owt_base::FrameDestination* dest)
@@ -91,14 +101,28 @@ public:
     void requestKeyFrame(int32_t streamId);
 
 protected:
-    static void Encode(VCMFrameEncoder *This, boost::shared_ptr<webrtc::VideoFrame> videoFrame) {This->encode(videoFrame);};
+    // A raw frame retained until the encode thread picks it up.
+    struct PendingFrame {
+        Frame frame;
+        boost::shared_ptr<webrtc::VideoFrame> i420Frame;
+#ifdef ENABLE_MSDK
+        MsdkFrameHolder msdkHolder;
+#endif
+    };
+
+    static void Encode(VCMFrameEncoder *This) {This->encodePending();};
+    void encodePending();
     void encode(boost::shared_ptr<webrtc::VideoFrame> videoFrame);
+    uint64_t recordEncodeTime(uint32_t us);
 
     boost::shared_ptr<webrtc::VideoFrame> frameConvert(const Frame& frame);
 
     void dump(uint8_t *buf, int len);
 
 private:
+    // Only feeds the periodic debug log.
+    VideoEncodeStats getEncodeStats();
+
     struct OutStream {
         uint32_t width;
         uint32_t height;
@@ -133,6 +157,16 @@ private:
 
     boost::scoped_ptr<FrameConverter> m_converter;
 
+    boost::mutex m_pendingMutex;
+    std::deque<PendingFrame> m_pendingFrames;
+    bool m_encodeScheduled;
+
+    boost::mutex m_statsMutex;
+    uint64_t m_encodedFrames;
+    uint64_t m_skippedFrames;
+    std::vector<uint32_t> m_encodeTimesUs;
+    size_t m_encodeTimesPos;
+
     bool m_enableBsDump;
     FILE *m_bsDumpfp;
 };
@@ -0,0 +1,104 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "VideoDecodeExecutor.h"
+
+namespace owt_base {
+
+DEFINE_LOGGER(VideoDecodeExecutor, "owt.VideoDecodeExecutor");
+
+VideoDecodeExecutor& VideoDecodeExecutor::GetInstance()
+{
+    // Intentionally leaked, decoders may be released during static destruction.
+    static VideoDecodeExecutor* executor = nullptr;
+    static boost::once_flag once = BOOST_ONCE_INIT;
+
+    boost::call_once(once, []() {
+        uint32_t threadCount = boost::thread::hardware_concurrency();
+        if (threadCount == 0)
+            threadCount = 1;
+
+        executor = new VideoDecodeExecutor(threadCount);
+        ELOG_DEBUG("Video decode threads %d", threadCount);
+    });
+    return *executor;
+}
+
+VideoDecodeExecutor::VideoDecodeExecutor(uint32_t threadCount)
+{
+    for (uint32_t i = 0; i < threadCount; i++) {
+        Shard* shard = new Shard();
+        shard->thread.reset(new boost::thread(&VideoDecodeExecutor::workerLoop, this, shard));
+        m_shards.push_back(shard);
+    }
+}
+
+uint32_t VideoDecodeExecutor::attach(VideoDecodeJob* job)
+{
+    // Place on the least loaded shard
+    uint32_t best = 0;
+    uint32_t bestJobs = UINT32_MAX;
+    for (uint32_t i = 0; i < m_shards.size(); i++) {
+        boost::mutex::scoped_lock lock(m_shards[i]->mutex);
+        if (m_shards[i]->jobs < bestJobs) {
+            best = i;
+            bestJobs = m_shards[i]->jobs;
+        }
+    }
+
+    boost::mutex::scoped_lock lock(m_shards[best]->mutex);
+    m_shards[best]->jobs++;
+    return best;
+}
+
+void VideoDecodeExecutor::detach(VideoDecodeJob* job, uint32_t shardIndex)
+{
+    Shard* shard = m_shards[shardIndex];
+    boost::mutex::scoped_lock lock(shard->mutex);
+
+    // A running job may schedule itself again, so drop its runs after it's done
+    while (shard->running == job)
+        shard->idleCond.wait(lock);
+
+    for (auto it = shard->tasks.begin(); it != shard->tasks.end();) {
+        if (*it == job)
+            it = shard->tasks.erase(it);
+        else
+            ++it;
+    }
+
+    shard->jobs--;
+}
+
+void VideoDecodeExecutor::schedule(VideoDecodeJob* job, uint32_t shardIndex)
+{
+    Shard* shard = m_shards[shardIndex];
+    boost::mutex::scoped_lock lock(shard->mutex);
+
+    shard->tasks.push_back(job);
+    shard->cond.notify_one();
+}
+
+void VideoDecodeExecutor::workerLoop(Shard* shard)
+{
+    boost::mutex::scoped_lock lock(shard->mutex);
+
+    while (true) {
+        while (shard->tasks.empty())
+            shard->cond.wait(lock);
+
+        VideoDecodeJob* job = shard->tasks.front();
+        shard->tasks.pop_front();
+        shard->running = job;
+        lock.unlock();
+
+        job->decodePending();
+
+        lock.lock();
+        shard->running = nullptr;
+        shard->idleCond.notify_all();
+    }
+}
+
+} /* namespace owt_base */
@@ -0,0 +1,69 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef VideoDecodeExecutor_h
+#define VideoDecodeExecutor_h
+
+#include <deque>
+#include <vector>
+
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include <logger.h>
+
+namespace owt_base {
+
+class VideoDecodeJob {
+public:
+    virtual ~VideoDecodeJob() { }
+
+    // Decode pending input, runs on an executor thread.
+    virtual void decodePending() = 0;
+};
+
+/*
+ * Fixed pool of video decode threads shared by all decoders in the process,
+ * so decoding never runs on the transport threads delivering the frames.
+ * Jobs are sharded across the threads when attached, and a job always
+ * runs on its own shard so it never decodes concurrently with itself.
+ */
+class VideoDecodeExecutor {
+    DECLARE_LOGGER();
+
+public:
+    static VideoDecodeExecutor& GetInstance();
+
+    // Returns the shard |job| is to be scheduled on.
+    uint32_t attach(VideoDecodeJob* job);
+    // Drops pending runs of |job| and waits for a running one to finish.
+    void detach(VideoDecodeJob* job, uint32_t shard);
+
+    // Runs of the jobs of a shard are taken in order, a job with more
+    // input than one run should decode schedules itself again.
+    void schedule(VideoDecodeJob* job, uint32_t shard);
+
+private:
+    struct Shard {
+        Shard() : running(nullptr), jobs(0) { }
+
+        boost::mutex mutex;
+        boost::condition_variable cond;
+        boost::condition_variable idleCond;
+        std::deque<VideoDecodeJob*> tasks;
+        VideoDecodeJob* running;
+        uint32_t jobs;
+        boost::scoped_ptr<boost::thread> thread;
+    };
+
+    VideoDecodeExecutor(uint32_t threadCount);
+
+    void workerLoop(Shard* shard);
+
+    std::vector<Shard*> m_shards;
+};
+
+} /* namespace owt_base */
+
+#endif /* VideoDecodeExecutor_h */
@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "InternalClient.h"
+#include "FrameWireFormat.h"
 #include "RawTransport.h"
 
 namespace owt_base {
@@ -18,6 +19,9 @@ InternalClient::InternalClient(
     , m_ready(false)
     , m_listener(listener)
 {
+    if (protocol == "shm") {
+        m_client->enableShm();
+    }
 }
 
 InternalClient::InternalClient(
@@ -82,22 +86,33 @@ void InternalClient::onConnected()
 
 void InternalClient::onData(uint8_t* buf, uint32_t len)
 {
-    Frame* frame = nullptr;
-    MetaData* metadata = nullptr;
+    Frame frame;
+    MetaData metadata;
     if (len <= 1) {
         ELOG_DEBUG("Skip onData len: %u", (unsigned int)len);
         return;
     }
     switch ((char) buf[0]) {
+        case TDT_MEDIA_FRAME_WIRE:
+            if (decodeFrame(buf + 1, len - 1, frame)) {
+                deliverFrame(frame);
+            }
+            break;
+        case TDT_MEDIA_METADATA_WIRE:
+            if (decodeMetaData(buf + 1, len - 1, metadata)) {
+                deliverMetaData(metadata);
+            }
+            break;
+        // From agents sending the previous format
         case TDT_MEDIA_FRAME:
-            frame = reinterpret_cast<Frame*>(buf + 1);
-            frame->payload = reinterpret_cast<uint8_t*>(buf + 1 + sizeof(Frame));
-            deliverFrame(*frame);
+            if (decodeLegacyFrame(buf + 1, len - 1, frame)) {
+                deliverFrame(frame);
+            }
             break;
         case TDT_MEDIA_METADATA:
-            metadata = reinterpret_cast<MetaData*>(buf + 1);
-            metadata->payload = reinterpret_cast<uint8_t*>(buf + 1 + sizeof(MetaData));
-            deliverMetaData(*metadata);
+            if (decodeLegacyMetaData(buf + 1, len - 1, metadata)) {
+                deliverMetaData(metadata);
+            }
             break;
         default:
             break;
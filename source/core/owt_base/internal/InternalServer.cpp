@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "InternalServer.h"
+#include "FrameWireFormat.h"
 #include "RawTransport.h"
 
 namespace owt_base {
@@ -20,6 +21,10 @@ InternalServer::InternalServer(
     if (!TransportSecret::getPassphrase().empty()) {
         m_server->enableSecure();
     }
+    if (protocol == "shm") {
+        // TCP still serves the clients of other hosts
+        m_server->enableShm();
+    }
     m_server->listenTo(minPort, maxPort);
 }
 
@@ -31,6 +36,7 @@ InternalServer::~InternalServer()
 bool InternalServer::addSource(const std::string& streamId, FrameSource* src)
 {
     ELOG_DEBUG("addSource %s, %p", streamId.c_str(), src);
+    boost::mutex::scoped_lock lock(m_sessionMutex);
     if (m_sourceMap.count(streamId)) {
         ELOG_WARN("Source for stream:%s already added", streamId.c_str());
         return false;
@@ -41,6 +47,7 @@ bool InternalServer::addSource(const std::string& streamId, FrameSource* src)
 
 bool InternalServer::removeSource(const std::string& streamId)
 {
+    boost::mutex::scoped_lock lock(m_sessionMutex);
     if (!m_sourceMap.count(streamId)) {
         ELOG_WARN("Invalid source for stream:%s to remove", streamId.c_str());
         return false;
@@ -50,26 +57,42 @@ bool InternalServer::removeSource(const std::string& streamId)
     m_sourceMap.erase(streamId);
     assert(src);
 
-    boost::mutex::scoped_lock lock(m_sessionMutex);
-    for (int sId : m_sessionIdMap[streamId]) {
-        if (m_sessions.count(sId)) {
-            // Unlink source & destination
-            src->removeAudioDestination(m_sessions[sId].get());
-            src->removeVideoDestination(m_sessions[sId].get());
-            src->removeDataDestination(m_sessions[sId].get());
+    auto it = m_streams.find(streamId);
+    if (it != m_streams.end()) {
+        unlinkStream(src, it->second.get());
+        for (int sId : it->second->sessionIds()) {
             m_sessions.erase(sId);
+            m_server->closeSession(sId);
         }
-        m_server->closeSession(sId);
+        m_streams.erase(it);
     }
-    m_sessionIdMap.erase(streamId);
     return true;
 }
 
+void InternalServer::linkStream(FrameSource* src, InternalStream* stream)
+{
+    src->addAudioDestination(stream);
+    src->addVideoDestination(stream);
+    src->addDataDestination(stream);
+}
+
+void InternalServer::unlinkStream(FrameSource* src, InternalStream* stream)
+{
+    src->removeAudioDestination(stream);
+    src->removeVideoDestination(stream);
+    src->removeDataDestination(stream);
+}
+
 unsigned int InternalServer::getListeningPort()
 {
     return m_server->getListeningPort();
 }
 
+SendQueueStats InternalServer::getSendQueueStats()
+{
+    return m_server->getSendQueueStats();
+}
+
 void InternalServer::onSessionAdded(int id)
 {
     ELOG_DEBUG("onSessionAdded %d", id);
@@ -77,7 +100,7 @@ void InternalServer::onSessionAdded(int id)
     if (m_sessions.count(id)) {
         ELOG_WARN("Duplicate session added:%d", id);
     } else {
-        m_sessions[id].reset(new InternalSession(id, this));
+        m_sessions[id].reset(new InternalSession(id));
     }
 }
 
@@ -104,14 +127,19 @@ void InternalServer::onSessionData(int id, uint8_t* data, uint32_t len)
                     ELOG_WARN("Mapped StreamID :%s %p", streamId.c_str(), m_sourceMap[streamId]);
 
                     FrameSource* src = m_sourceMap[streamId];
-                    if (src) {
-                        // Unlink source & destination
-                        src->addAudioDestination(session.get());
-                        src->addVideoDestination(session.get());
-                        src->addDataDestination(session.get());
+                    {
+                        boost::mutex::scoped_lock lock(m_sessionMutex);
+                        auto& stream = m_streams[streamId];
+                        if (!stream) {
+                            // Link source & destination for the first session of the stream
+                            stream.reset(new InternalStream(this));
+                            if (src) {
+                                linkStream(src, stream.get());
+                            }
+                        }
+                        stream->addSession(id);
                     }
                     session->setStreamId(streamId);
-                    m_sessionIdMap[streamId].insert(id);
                     if (m_listener) {
                         m_listener->onConnected(streamId);
                     }
@@ -141,43 +169,88 @@ void InternalServer::onSessionRemoved(int id)
     } else {
         auto session = m_sessions[id];
         std::string streamId = session->streamId();
-        FrameSource* src = m_sourceMap[streamId];
-        if (src) {
-            // Unlink source & destination
-            src->removeAudioDestination(session.get());
-            src->removeVideoDestination(session.get());
-            src->removeDataDestination(session.get());
+        auto it = m_streams.find(streamId);
+        if (it != m_streams.end()) {
+            it->second->removeSession(id);
+            if (it->second->sessionIds().empty()) {
+                // Unlink source & destination after the last session of the stream
+                auto src = m_sourceMap.find(streamId);
+                if (src != m_sourceMap.end() && src->second) {
+                    unlinkStream(src->second, it->second.get());
+                }
+                m_streams.erase(it);
+            }
         }
         m_sessions.erase(id);
-        m_sessionIdMap[streamId].erase(id);
         if (m_listener) {
             m_listener->onDisconnected(streamId);
         }
     }
 }
 
-void InternalServer::InternalSession::onFrame(const Frame& frame)
+void InternalServer::onSessionKeyFrameNeeded(int id)
+{
+    // Sessions and sources may be removed meanwhile on other threads
+    boost::mutex::scoped_lock lock(m_sessionMutex);
+    auto session = m_sessions.find(id);
+    if (session == m_sessions.end()) {
+        return;
+    }
+    // Requested as a key frame request from the session would be
+    auto src = m_sourceMap.find(session->second->streamId());
+    if (src != m_sourceMap.end() && src->second) {
+        ELOG_DEBUG("Request key frame for session:%d", id);
+        FeedbackMsg fbMsg{.type = VIDEO_FEEDBACK, .cmd = REQUEST_KEY_FRAME};
+        src->second->onFeedback(fbMsg);
+    }
+}
+
+void InternalServer::InternalStream::onFrame(const Frame& frame)
+{
+    uint8_t header[kFrameMessageMaxHeaderSize];
+    uint32_t headerLength = encodeFrameMessage(frame, header);
+
+    // Serialized once into a pooled buffer shared by the queues of all sessions
+    TransportData data{header, headerLength, frame.payload, frame.length};
+    data.kind = sendItemKind(frame);
+    send(data);
+}
+
+void InternalServer::InternalStream::onMetaData(const MetaData& metadata)
 {
-    uint8_t sendBuffer[1 + sizeof(Frame) + frame.length];
-    sendBuffer[0] = TDT_MEDIA_FRAME;
-    memcpy(&sendBuffer[1],
-           reinterpret_cast<uint8_t*>(const_cast<Frame*>(&frame)),
-           sizeof(Frame));
-    memcpy(&sendBuffer[1 + sizeof(Frame)], frame.payload, frame.length);
+    uint8_t header[kMetaDataMessageMaxHeaderSize];
+    uint32_t headerLength = encodeMetaDataMessage(metadata, header);
 
-    m_parent->m_server->sendSessionData(m_id, sendBuffer, sizeof(sendBuffer));
+    TransportData data{header, headerLength,
+                       metadata.payload, metadata.length};
+    send(data);
 }
 
-void InternalServer::InternalSession::onMetaData(const MetaData& metadata)
+void InternalServer::InternalStream::addSession(int id)
 {
-    uint8_t sendBuffer[1 + sizeof(MetaData) + metadata.length];
-    sendBuffer[0] = TDT_MEDIA_METADATA;
-    memcpy(&sendBuffer[1],
-           reinterpret_cast<uint8_t*>(const_cast<MetaData*>(&metadata)),
-           sizeof(MetaData));
-    memcpy(&sendBuffer[1 + sizeof(MetaData)], metadata.payload, metadata.length);
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_sessionIds.insert(id);
+}
 
-    m_parent->m_server->sendSessionData(m_id, sendBuffer, sizeof(sendBuffer));
+void InternalServer::InternalStream::removeSession(int id)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_sessionIds.erase(id);
+}
+
+std::set<int> InternalServer::InternalStream::sessionIds()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    return m_sessionIds;
+}
+
+void InternalServer::InternalStream::send(const TransportData& data)
+{
+    // A full queue may block or drop, so don't hold m_mutex while queueing
+    std::set<int> sessionIds = this->sessionIds();
+    for (int id : sessionIds) {
+        m_parent->m_server->sendSessionData(id, data);
+    }
 }
 
 } /* namespace owt_base */
@@ -32,20 +32,19 @@ public:
     bool removeSource(const std::string& streamId);
 
     unsigned int getListeningPort();
+    SendQueueStats getSendQueueStats();
 
     // Implements TransportServer::Listener
     void onSessionAdded(int id) override;
     void onSessionData(int id, uint8_t* data, uint32_t len) override;
     void onSessionRemoved(int id) override;
+    void onSessionKeyFrameNeeded(int id) override;
 
 private:
-    class InternalSession : public FrameDestination {
+    class InternalSession {
     public:
-        InternalSession(int id, InternalServer* p)
-            : m_id(id), m_parent(p) {}
-        // Implements FrameDestination
-        void onFrame(const Frame&) override;
-        void onMetaData(const MetaData&) override;
+        InternalSession(int id)
+            : m_id(id) {}
 
         int id() { return m_id; }
         std::string streamId() { return m_streamId; }
@@ -56,13 +55,36 @@ private:
     private:
         int m_id;
         std::string m_streamId;
+    };
+
+    // The destination of a source for all its sessions. Each frame is
+    // serialized once and the same message is queued to every session.
+    class InternalStream : public FrameDestination {
+    public:
+        InternalStream(InternalServer* p)
+            : m_parent(p) {}
+        // Implements FrameDestination
+        void onFrame(const Frame&) override;
+        void onMetaData(const MetaData&) override;
+
+        void addSession(int id);
+        void removeSession(int id);
+        std::set<int> sessionIds();
+    private:
+        void send(const TransportData& data);
+
+        boost::mutex m_mutex;
+        std::set<int> m_sessionIds;
         InternalServer* m_parent;
     };
 
+    void linkStream(FrameSource* src, InternalStream* stream);
+    void unlinkStream(FrameSource* src, InternalStream* stream);
+
     boost::shared_ptr<TransportServer> m_server;
     boost::mutex m_sessionMutex;
     std::unordered_map<std::string, FrameSource*> m_sourceMap;
-    std::unordered_map<std::string, std::set<int>> m_sessionIdMap;
+    std::unordered_map<std::string, boost::shared_ptr<InternalStream>> m_streams;
     std::unordered_map<int, boost::shared_ptr<InternalSession>> m_sessions;
     Listener* m_listener;
 };
@@ -16,6 +16,29 @@ static const int kHeaderSize = 4;
 static const int kInitalBufferSize = 1600;
 static const int kBufferAlignment = 16;
 static const double kExpansionMultiplier = 1.3;
+// Limits of the messages gathered into one write
+static const size_t kMaxGatherCount = 64;
+static const size_t kMaxGatherBytes = 256 * 1024;
+
+TransportData::TransportData(const uint8_t* data, uint32_t len)
+    : buffer(MediaBufferPool::GetInstance().acquire(kHeaderSize + len))
+    , length(len)
+    , kind(SEND_ITEM_CONTROL)
+{
+    *(reinterpret_cast<uint32_t*>(buffer->data())) = htonl(len);
+    memcpy(buffer->data() + kHeaderSize, data, len);
+}
+
+TransportData::TransportData(const uint8_t* header, uint32_t headerLength,
+                             const uint8_t* payload, uint32_t payloadLength)
+    : buffer(MediaBufferPool::GetInstance().acquire(kHeaderSize + headerLength + payloadLength))
+    , length(headerLength + payloadLength)
+    , kind(SEND_ITEM_CONTROL)
+{
+    *(reinterpret_cast<uint32_t*>(buffer->data())) = htonl(length);
+    memcpy(buffer->data() + kHeaderSize, header, headerLength);
+    memcpy(buffer->data() + kHeaderSize + headerLength, payload, payloadLength);
+}
 
 TransportMessage::TransportMessage()
     : m_buffer(new uint8_t[kInitalBufferSize])
@@ -158,18 +181,31 @@ void TransportSession::sendData(TransportData data)
         ELOG_DEBUG("sendData: already closed");
         return;
     }
+    // The message header is already in place, queue it as is.
+    // The queue applies its drop or block policy when it is full, waiting
+    // on the IO thread would hold off the write making room.
+    bool queued = m_sendQueue.push(data, data.messageLength(), data.kind,
+                                   !m_service->isServiceThread());
     auto self(shared_from_this());
-    m_service->post(boost::bind(&TransportSession::prepareSend, self, data));
+    if (m_sendQueue.takeKeyFrameRequest()) {
+        // Notified on the IO thread, as received feedback is
+        m_service->post([self]() {
+            if (!self->m_isClosed) {
+                self->m_listener->onKeyFrameNeeded(self->m_id);
+            }
+        });
+    }
+    if (!queued) {
+        ELOG_DEBUG("sendData: dropped %u bytes", data.length);
+        return;
+    }
+    m_service->post(boost::bind(&TransportSession::prepareSend, self));
 }
 
-void TransportSession::prepareSend(TransportData data)
+void TransportSession::prepareSend()
 {
-    // Only access m_sendQueue in IO service thread.
-    TransportMessage toSend(data.buffer.get(), data.length);
-    TransportData wrappedData{toSend.messageData(),
-                              toSend.messageLength()};
-    m_sendQueue.push(wrappedData);
-    if (m_sendQueue.size() == 1) {
+    // Only start writing in IO service thread.
+    if (m_sendQueue.inFlight() == 0) {
         sendHandler();
     }
 }
@@ -183,37 +219,46 @@ void TransportSession::sendHandler()
         ELOG_WARN("sendHandler: socket is not open");
         return;
     }
-    if (m_sendQueue.empty()) {
+    // Gather the queued messages into one vectored write.
+    std::vector<TransportData> messages;
+    size_t count = m_sendQueue.take(messages, kMaxGatherCount, kMaxGatherBytes);
+    if (count == 0) {
         return;
     }
+    std::vector<boost::asio::const_buffer> buffers;
+    size_t gatheredBytes = 0;
+    for (auto it = messages.begin(); it != messages.end(); ++it) {
+        buffers.push_back(boost::asio::buffer(it->messageData(), it->messageLength()));
+        gatheredBytes += it->messageLength();
+    }
 
-    TransportData& data = m_sendQueue.front();
-
-    ELOG_DEBUG("SendHandler- %p %zu", this, (size_t)data.length);
+    ELOG_DEBUG("SendHandler- %p %zu messages, %zu bytes", this, count, gatheredBytes);
     auto self(shared_from_this());
     if (m_sslSocket) {
         boost::asio::async_write(
             *m_sslSocket,
-            boost::asio::buffer(data.buffer.get(), data.length),
+            buffers,
             boost::bind(&TransportSession::writeHandler, self,
                 boost::asio::placeholders::error,
-                boost::asio::placeholders::bytes_transferred));
+                boost::asio::placeholders::bytes_transferred,
+                count));
     } else {
         boost::asio::async_write(
             m_socket,
-            boost::asio::buffer(data.buffer.get(), data.length),
+            buffers,
             boost::bind(&TransportSession::writeHandler, self,
                 boost::asio::placeholders::error,
-                boost::asio::placeholders::bytes_transferred));
+                boost::asio::placeholders::bytes_transferred,
+                count));
     }
 }
 
 void TransportSession::writeHandler(
     const boost::system::error_code& ec,
-    std::size_t bytes)
+    std::size_t bytes,
+    size_t count)
 {
-    assert(m_sendQueue.size() > 0);
-    m_sendQueue.pop();
+    m_sendQueue.complete(count);
     if (ec) {
         ELOG_DEBUG("Error writing data: %s", ec.message().c_str());
         if (!m_isClosed) {
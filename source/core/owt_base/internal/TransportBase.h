@@ -14,6 +14,8 @@
 #include <logger.h>
 
 #include "IOService.h"
+#include "MediaBuffer.h"
+#include "SendQueue.h"
 #include <memory>
 #include <queue>
 
@@ -22,6 +24,9 @@ namespace owt_base {
 // const char TDT_FEEDBACK_MSG = 0x5A;
 // const char TDT_MEDIA_FRAME = 0x8F;
 
+// Shared memory endpoints of TransportServer are named after this and the TCP port
+const char kShmServerPrefix[] = "transport-server";
+
 using boost::asio::ip::tcp;
 
 /*
@@ -58,17 +63,27 @@ private:
 };
 
 /*
- * Combine buffer and size
+ * A complete TransportMessage in one pooled buffer, header included,
+ * so it can be queued to any number of sessions without further copies.
  */
 struct TransportData{
-    TransportData() {}
-    TransportData(const uint8_t* data, uint32_t len)
-        : buffer(new uint8_t[len]), length(len)
-    {
-        memcpy(buffer.get(), data, len);
-    }
-    boost::shared_array<uint8_t> buffer;
+    static const uint32_t kHeaderSize = 4;
+
+    TransportData() : length(0), kind(SEND_ITEM_CONTROL) {}
+    TransportData(const uint8_t* data, uint32_t len);
+    TransportData(const uint8_t* header, uint32_t headerLength,
+                  const uint8_t* payload, uint32_t payloadLength);
+
+    // Payload without the length header
+    uint8_t* data() const { return buffer->data() + kHeaderSize; }
+    // Length header followed by payload, as written to the socket
+    const uint8_t* messageData() const { return buffer->data(); }
+    uint32_t messageLength() const { return length + kHeaderSize; }
+
+    MediaBufferPtr buffer;
     uint32_t length;
+    // How the send queue may treat it under backpressure
+    SendItemKind kind;
 } ;
 
 /*
@@ -82,6 +97,8 @@ public:
     public:
         virtual void onData(uint32_t id, TransportData data) = 0;
         virtual void onClose(uint32_t id) = 0;
+        // The send queue dropped video and waits for a key frame
+        virtual void onKeyFrameNeeded(uint32_t id) { }
     };
     typedef boost::asio::ssl::stream<boost::asio::ip::tcp::socket> SSLSocket;
 
@@ -101,12 +118,15 @@ public:
     void start();
     void close();
 
+    void setSendQueueConfig(const SendQueueConfig& config) { m_sendQueue.setConfig(config); }
+    SendQueueStats getSendQueueStats() { return m_sendQueue.stats(); }
+
 private:
     void receiveData();
     void readHandler(const boost::system::error_code&, std::size_t);
-    void prepareSend(TransportData data);
+    void prepareSend();
     void sendHandler();
-    void writeHandler(const boost::system::error_code&, std::size_t);
+    void writeHandler(const boost::system::error_code&, std::size_t, size_t);
 
     uint32_t m_id;
     std::shared_ptr<IOService> m_service;
@@ -114,7 +134,7 @@ private:
     std::shared_ptr<SSLSocket> m_sslSocket;
     TransportMessage m_receivedMessage;
     boost::shared_array<uint8_t> m_receivedBuffer;
-    std::queue<TransportData> m_sendQueue;
+    SendQueue<TransportData> m_sendQueue;
     uint32_t m_receivedBufferSize;
     bool m_isClosed;
     Listener* m_listener;
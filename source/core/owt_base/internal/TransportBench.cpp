@@ -0,0 +1,215 @@
+// Copyright (C) <2021> Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// Loopback benchmark of TransportServer to TransportClient, through TCP or
+// shared memory. The client runs in a child process, as the internal
+// connections between agents do, and acks every few frames so the server
+// keeps a bounded window of frames in flight.
+//
+// Without a pace, frames are sent as fast as the window allows and the
+// throughput is reported. With a pace in microseconds, frames are sent on
+// that schedule and the latency from send to delivery is reported.
+//
+// Build and run from this directory:
+//   g++ -O2 -std=c++11 -I. -I.. -I../../common TransportBench.cpp TransportServer.cpp TransportClient.cpp \
+//       TransportBase.cpp ../ShmChannel.cpp ../../common/IOService.cpp \
+//       -lboost_thread -lboost_system -lssl -lcrypto -llog4cxx -pthread -o TransportBench
+//   ./TransportBench tcp|shm <frame bytes> <frames> [pace us]
+
+#include "TransportClient.h"
+#include "TransportServer.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace owt_base;
+
+namespace {
+
+int64_t nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct FrameHeader {
+    uint8_t tag;
+    uint32_t index;
+    int64_t sentNs;
+} __attribute__((packed));
+
+class Server : public TransportServer::Listener {
+public:
+    Server() : session(-1), acked(0) {}
+
+    void onSessionAdded(int id) override
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        session = id;
+        cond.notify_all();
+    }
+
+    void onSessionData(int id, uint8_t* data, uint32_t len) override
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        memcpy(&acked, data, sizeof(acked));
+        cond.notify_all();
+    }
+
+    void onSessionRemoved(int id) override {}
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    int session;
+    uint64_t acked;
+};
+
+class Client : public TransportClient::Listener {
+public:
+    Client(uint64_t total, uint64_t ackEvery)
+        : client(nullptr), total(total), ackEvery(ackEvery), received(0)
+    {}
+
+    void onConnected() override {}
+
+    // On the IO thread
+    void onData(uint8_t* data, uint32_t len) override
+    {
+        FrameHeader header;
+        memcpy(&header, data, sizeof(header));
+        latencyNs.push_back(nowNs() - header.sentNs);
+        received++;
+        if (received % ackEvery == 0 || received == total) {
+            client->sendData((uint8_t*)&received, sizeof(received));
+        }
+        if (received == total) {
+            std::lock_guard<std::mutex> lock(mutex);
+            cond.notify_all();
+        }
+    }
+
+    void onDisconnected() override {}
+
+    TransportClient* client;
+    uint64_t total;
+    uint64_t ackEvery;
+    uint64_t received;
+    std::vector<int64_t> latencyNs;
+    std::mutex mutex;
+    std::condition_variable cond;
+};
+
+void runClient(bool shm, uint32_t port, uint32_t frames, uint64_t window)
+{
+    Client listener(frames, std::max<uint64_t>(1, window / 2));
+    TransportClient client(&listener);
+    listener.client = &client;
+    if (shm) {
+        client.enableShm();
+    }
+    client.createConnection("127.0.0.1", port);
+    {
+        std::unique_lock<std::mutex> lock(listener.mutex);
+        listener.cond.wait(lock, [&] { return listener.received == frames; });
+    }
+    std::vector<int64_t> latency = listener.latencyNs;
+    std::sort(latency.begin(), latency.end());
+    printf("  latency p50 %.1fus p99 %.1fus max %.1fus\n", latency[latency.size() / 2] / 1000.0,
+        latency[latency.size() * 99 / 100] / 1000.0, latency.back() / 1000.0);
+    fflush(stdout);
+    // Lets the last ack out before the connection goes
+    sleep(1);
+    client.close();
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 4) {
+        printf("Usage: %s tcp|shm <frame bytes> <frames> [pace us]\n", argv[0]);
+        return 2;
+    }
+    const bool shm = std::string(argv[1]) == "shm";
+    const uint32_t size = atoi(argv[2]);
+    const uint32_t frames = atoi(argv[3]);
+    const int paceUs = argc > 4 ? atoi(argv[4]) : 0;
+    // Up to 2MB in flight, which the default 4MB ring holds
+    const uint64_t window = std::max<uint64_t>(1, std::min<uint64_t>(32, 2000000 / size));
+
+    int portPipe[2];
+    if (pipe(portPipe) != 0) {
+        return 1;
+    }
+    pid_t pid = fork();
+    if (pid == 0) {
+        uint32_t port;
+        if (read(portPipe[0], &port, sizeof(port)) != sizeof(port)) {
+            _exit(1);
+        }
+        runClient(shm, port, frames, window);
+        _exit(0);
+    }
+
+    Server listener;
+    TransportServer server(&listener);
+    if (shm) {
+        server.enableShm();
+    }
+    server.listenTo(20000, 21000);
+    uint32_t port = server.getListeningPort();
+    if (write(portPipe[1], &port, sizeof(port)) != sizeof(port)) {
+        return 1;
+    }
+    {
+        std::unique_lock<std::mutex> lock(listener.mutex);
+        listener.cond.wait(lock, [&] { return listener.session >= 0; });
+    }
+
+    std::vector<uint8_t> payload(size);
+    for (uint32_t i = 0; i < size; i++) {
+        payload[i] = i * 7;
+    }
+    printf("%s frames of %u bytes, %u frames, %s\n", argv[1], size, frames,
+        paceUs ? (std::to_string(paceUs) + "us apart").c_str() : "unpaced");
+    fflush(stdout);
+    int64_t begin = nowNs();
+    for (uint32_t i = 0; i < frames; i++) {
+        if (paceUs) {
+            int64_t due = begin + (int64_t)i * paceUs * 1000;
+            while (nowNs() < due) {
+                usleep(50);
+            }
+        } else {
+            std::unique_lock<std::mutex> lock(listener.mutex);
+            listener.cond.wait(lock, [&] { return i - listener.acked < window; });
+        }
+        FrameHeader header{0x8F, i, nowNs()};
+        TransportData data{(uint8_t*)&header, sizeof(header), payload.data(), size};
+        // Not dropped for a key frame pending, a drop would stall the window
+        data.kind = SEND_ITEM_KEY_FRAME;
+        server.sendSessionData(listener.session, data);
+    }
+    {
+        std::unique_lock<std::mutex> lock(listener.mutex);
+        listener.cond.wait(lock, [&] { return listener.acked == frames; });
+    }
+    int64_t elapsed = nowNs() - begin;
+    if (!paceUs) {
+        printf("  throughput %.0f frames/s %.2f GB/s\n", frames * 1e9 / elapsed, (double)frames * size / elapsed);
+    }
+    int status;
+    waitpid(pid, &status, 0);
+    SendQueueStats stats = server.getSendQueueStats();
+    printf("  dropped %lu\n", (unsigned long)stats.droppedFrames);
+    server.close();
+    return 0;
+}
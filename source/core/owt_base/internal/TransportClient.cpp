@@ -17,6 +17,9 @@ static constexpr const char kServerKey[] = "cert/server.key";
 TransportClient::TransportClient(Listener* listener)
     : m_service(getIOService())
     , m_socket(m_service->service())
+    , m_isShmEnabled(false)
+    , m_isShmConnected(false)
+    , m_port(0)
     , m_isSecure(false)
     , m_listener(listener)
 {}
@@ -57,7 +60,7 @@ bool TransportClient::enableSecure()
 void TransportClient::onData(uint32_t id, TransportData data)
 {
     if (m_listener) {
-        m_listener->onData(data.buffer.get(), data.length);
+        m_listener->onData(data.data(), data.length);
     }
 }
 
@@ -68,13 +71,60 @@ void TransportClient::onClose(uint32_t id)
     }
 }
 
+void TransportClient::onShmConnected(uint32_t id)
+{
+    m_isShmConnected = true;
+    if (m_listener) {
+        m_listener->onConnected();
+    }
+}
+
+void TransportClient::onShmData(uint32_t id, uint8_t* data, uint32_t len)
+{
+    if (m_listener) {
+        m_listener->onData(data, len);
+    }
+}
+
+void TransportClient::onShmClosed(uint32_t id)
+{
+    if (!m_isShmConnected) {
+        // The server refused the ring, e.g. for a peer of another user
+        ELOG_DEBUG("No ring received on %u, use TCP", m_port);
+        m_shm.reset();
+        if (m_listener) {
+            connectTcp();
+        }
+        return;
+    }
+    if (m_listener) {
+        m_listener->onDisconnected();
+    }
+}
+
 void TransportClient::createConnection(const std::string& ip, uint32_t port)
 {
-    if (m_session || m_sslSocket) {
+    if (m_session || m_sslSocket || m_shm) {
         return;
     }
+    m_ip = ip;
+    m_port = port;
+    if (m_isShmEnabled) {
+        m_shm = ShmChannel::connect(0, m_service, kShmServerPrefix, port, this);
+        if (m_shm) {
+            ELOG_DEBUG("Connected through shared memory on %u", port);
+            m_shm->startConsumer();
+            return;
+        }
+        ELOG_DEBUG("No shared memory on %u, use TCP", port);
+    }
+    connectTcp();
+}
+
+void TransportClient::connectTcp()
+{
     tcp::resolver resolver(m_service->service());
-    tcp::resolver::query query(ip.c_str(), boost::to_string(port).c_str());
+    tcp::resolver::query query(m_ip.c_str(), boost::to_string(m_port).c_str());
     tcp::resolver::iterator iterator = resolver.resolve(query);
     if (m_isSecure) {
         m_sslSocket.reset(new SSLSocket(m_service->service(), *m_sslContext));
@@ -134,25 +184,42 @@ void TransportClient::handshakeHandler(const boost::system::error_code& ec)
 
 void TransportClient::sendData(const uint8_t* data, uint32_t len)
 {
+    if (m_shm) {
+        m_shm->sendData(data, len);
+        return;
+    }
     TransportData tData{data, (uint32_t)len};
     m_session->sendData(tData);
 }
 
 void TransportClient::sendData(const uint8_t* header, uint32_t headerLength,
-                               const uint8_t* payload, uint32_t payloadLength)
+                               const uint8_t* payload, uint32_t payloadLength,
+                               SendItemKind kind)
 {
-    TransportData data;
-    data.buffer.reset(new uint8_t[headerLength + payloadLength]);
-    memcpy(data.buffer.get(), header, headerLength);
-    memcpy(data.buffer.get() + headerLength, payload, payloadLength);
-    data.length = headerLength + payloadLength;
+    if (m_shm) {
+        m_shm->sendData(header, headerLength, payload, payloadLength, kind);
+        return;
+    }
+    TransportData data{header, headerLength, payload, payloadLength};
+    data.kind = kind;
     m_session->sendData(data);
 }
 
+SendQueueStats TransportClient::getSendQueueStats()
+{
+    if (m_shm) {
+        return m_shm->getStats();
+    }
+    return m_session ? m_session->getSendQueueStats() : SendQueueStats();
+}
+
 void TransportClient::close()
 {
     ELOG_DEBUG("Closing...");
     m_listener = nullptr;
+    if (m_shm) {
+        m_shm->close();
+    }
     boost::system::error_code ec;
     if (m_socket.is_open()) {
         m_socket.cancel();
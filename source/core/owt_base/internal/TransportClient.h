@@ -13,6 +13,7 @@
 #include <logger.h>
 #include <memory>
 #include "RawTransport.h"
+#include "ShmChannel.h"
 #include "TransportBase.h"
 #include <unordered_map>
 
@@ -23,7 +24,8 @@ using boost::asio::ip::tcp;
 /*
  * TransportClient
  */
-class TransportClient : public TransportSession::Listener {
+class TransportClient : public TransportSession::Listener,
+                        public ShmChannel::Listener {
     DECLARE_LOGGER();
 public:
     class Listener {
@@ -36,12 +38,18 @@ public:
     ~TransportClient();
 
     bool enableSecure();
+    // Connect through shared memory if the server is on the same host and
+    // accepts it, through TCP otherwise
+    void enableShm() { m_isShmEnabled = true; }
 
     void createConnection(const std::string& ip, uint32_t port);
     void sendData(const uint8_t*, uint32_t len);
     void sendData(const uint8_t* header, uint32_t headerLength,
-                  const uint8_t* payload, uint32_t payloadLength);
+                  const uint8_t* payload, uint32_t payloadLength,
+                  SendItemKind kind = SEND_ITEM_CONTROL);
     void close();
+
+    SendQueueStats getSendQueueStats();
     bool initTicket(const std::string& ticket) { return true; }
 
     unsigned short getListeningPort() { return 0; }
@@ -50,7 +58,13 @@ public:
     void onData(uint32_t id, TransportData data) override;
     void onClose(uint32_t id) override;
 
+    // Implements ShmChannel::Listener
+    void onShmConnected(uint32_t id) override;
+    void onShmData(uint32_t id, uint8_t* data, uint32_t len) override;
+    void onShmClosed(uint32_t id) override;
+
 private:
+    void connectTcp();
     void connectHandler(const boost::system::error_code&);
     void handshakeHandler(const boost::system::error_code& ec);
 
@@ -59,6 +73,11 @@ private:
     std::shared_ptr<IOService> m_service;
     boost::asio::ip::tcp::socket m_socket;
     std::shared_ptr<TransportSession> m_session;
+    bool m_isShmEnabled;
+    std::shared_ptr<ShmChannel> m_shm;
+    bool m_isShmConnected;
+    std::string m_ip;
+    uint32_t m_port;
 
     bool m_isSecure;
     std::shared_ptr<boost::asio::ssl::context> m_sslContext;
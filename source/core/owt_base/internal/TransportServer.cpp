@@ -34,6 +34,14 @@ TransportServer::~TransportServer()
 
 
 
+void TransportServer::enableShm()
+{
+    if (!m_shmAcceptor) {
+        m_shmAcceptor.reset(new ShmAcceptor(m_service, kShmServerPrefix,
+            [this](ShmChannel::Socket& socket) { shmAcceptHandler(socket); }));
+    }
+}
+
 bool TransportServer::enableSecure()
 {
     if (m_isSecure) {
@@ -74,7 +82,7 @@ bool TransportServer::enableSecure()
 void TransportServer::onData(uint32_t id, TransportData data)
 {
     if (m_listener) {
-        m_listener->onSessionData(id, data.buffer.get(), data.length);
+        m_listener->onSessionData(id, data.data(), data.length);
     }
 }
 
@@ -83,6 +91,57 @@ void TransportServer::onClose(uint32_t id)
     onSessionRemoved(id);
 }
 
+void TransportServer::onKeyFrameNeeded(uint32_t id)
+{
+    if (m_listener) {
+        m_listener->onSessionKeyFrameNeeded(id);
+    }
+}
+
+void TransportServer::onShmData(uint32_t id, uint8_t* data, uint32_t len)
+{
+    if (m_listener) {
+        m_listener->onSessionData(id, data, len);
+    }
+}
+
+void TransportServer::onShmClosed(uint32_t id)
+{
+    onSessionRemoved(id);
+}
+
+void TransportServer::onShmKeyFrameNeeded(uint32_t id)
+{
+    onKeyFrameNeeded(id);
+}
+
+void TransportServer::shmAcceptHandler(ShmChannel::Socket& socket)
+{
+    // Accepted on m_service as the TCP sessions, so the IDs don't collide
+    int sessionId = m_nextSessionId++;
+    auto channel = std::make_shared<ShmChannel>(
+        sessionId, m_service, std::move(socket), this);
+    // The ring replaces the send queue
+    if (!channel->startProducer(ShmChannelConfig::defaultConfig().ringCapacity())) {
+        return;
+    }
+    {
+        boost::mutex::scoped_lock lock(m_shmMutex);
+        m_shmChannels[sessionId] = channel;
+    }
+    ELOG_DEBUG("Accept shared memory session %d", sessionId);
+    if (m_listener) {
+        m_listener->onSessionAdded(sessionId);
+    }
+}
+
+std::shared_ptr<ShmChannel> TransportServer::shmChannel(int id)
+{
+    boost::mutex::scoped_lock lock(m_shmMutex);
+    auto it = m_shmChannels.find(id);
+    return it != m_shmChannels.end() ? it->second : nullptr;
+}
+
 void TransportServer::doAccept()
 {
     if (!m_acceptor.is_open()) {
@@ -168,6 +227,9 @@ void TransportServer::listenTo(uint32_t port)
         m_acceptor.listen(boost::asio::socket_base::max_connections, ec);
         if (!ec) {
             doAccept();
+            if (m_shmAcceptor) {
+                m_shmAcceptor->listenTo(getListeningPort());
+            }
         }
     } else {
         ELOG_WARN("TransportServer listenTo failed: %s", ec.message().c_str());
@@ -207,6 +269,9 @@ void TransportServer::listenTo(uint32_t minPort, uint32_t maxPort)
             ELOG_DEBUG("TCP transport listening on:%d(range:%d ~ %d)",
                 m_acceptor.local_endpoint().port(), minPort, maxPort);
             doAccept();
+            if (m_shmAcceptor) {
+                m_shmAcceptor->listenTo(getListeningPort());
+            }
         } else {
             ELOG_ERROR("Error(%s) in listening on port range %d ~ %d",
                 ec.message().c_str(), minPort, maxPort);
@@ -230,11 +295,13 @@ unsigned short TransportServer::getListeningPort()
 
 void TransportServer::onSessionRemoved(int id)
 {
-    if (m_sessions.count(id)) {
-        m_sessions.erase(id);
-        if (m_listener) {
-            m_listener->onSessionRemoved(id);
-        }
+    bool removed = m_sessions.erase(id) > 0;
+    if (!removed) {
+        boost::mutex::scoped_lock lock(m_shmMutex);
+        removed = m_shmChannels.erase(id) > 0;
+    }
+    if (removed && m_listener) {
+        m_listener->onSessionRemoved(id);
     }
 }
 
@@ -244,28 +311,58 @@ void TransportServer::sendData(const uint8_t* data, uint32_t len)
     for (auto it = m_sessions.begin(); it != m_sessions.end(); it++) {
         it->second->sendData(tData);
     }
+    boost::mutex::scoped_lock lock(m_shmMutex);
+    for (auto it = m_shmChannels.begin(); it != m_shmChannels.end(); it++) {
+        it->second->sendData(data, len);
+    }
 }
 
 void TransportServer::sendData(const uint8_t* header, uint32_t headerLength,
-                               const uint8_t* payload, uint32_t payloadLength)
+                               const uint8_t* payload, uint32_t payloadLength,
+                               SendItemKind kind)
 {
-    TransportData data;
-    data.buffer.reset(new uint8_t[headerLength + payloadLength]);
-    memcpy(data.buffer.get(), header, headerLength);
-    memcpy(data.buffer.get() + headerLength, payload, payloadLength);
-    data.length = headerLength + payloadLength;
+    TransportData data{header, headerLength, payload, payloadLength};
+    data.kind = kind;
 
     for (auto it = m_sessions.begin(); it != m_sessions.end(); it++) {
         it->second->sendData(data);
     }
+    boost::mutex::scoped_lock lock(m_shmMutex);
+    for (auto it = m_shmChannels.begin(); it != m_shmChannels.end(); it++) {
+        it->second->sendData(header, headerLength, payload, payloadLength, kind);
+    }
 }
 
-void TransportServer::sendSessionData(int id, const uint8_t* data, uint32_t len)
+void TransportServer::sendSessionData(int id, const uint8_t* data, uint32_t len,
+                                      SendItemKind kind)
 {
     TransportData tData{data, len};
-    if (m_sessions.count(id)) {
-        m_sessions[id]->sendData(tData);
+    tData.kind = kind;
+    sendSessionData(id, tData);
+}
+
+void TransportServer::sendSessionData(int id, const TransportData& data)
+{
+    auto it = m_sessions.find(id);
+    if (it != m_sessions.end()) {
+        it->second->sendData(data);
+    } else if (auto channel = shmChannel(id)) {
+        // Copied into the ring, the pooled buffer is not kept
+        channel->sendData(data.data(), data.length, nullptr, 0, data.kind);
+    }
+}
+
+SendQueueStats TransportServer::getSendQueueStats()
+{
+    SendQueueStats stats;
+    for (auto it = m_sessions.begin(); it != m_sessions.end(); it++) {
+        stats.merge(it->second->getSendQueueStats());
     }
+    boost::mutex::scoped_lock lock(m_shmMutex);
+    for (auto it = m_shmChannels.begin(); it != m_shmChannels.end(); it++) {
+        stats.merge(it->second->getStats());
+    }
+    return stats;
 }
 
 void TransportServer::closeSession(int id)
@@ -274,6 +371,12 @@ void TransportServer::closeSession(int id)
     if (m_sessions.count(id)) {
         m_sessions.erase(id);
     }
+    boost::mutex::scoped_lock lock(m_shmMutex);
+    auto it = m_shmChannels.find(id);
+    if (it != m_shmChannels.end()) {
+        it->second->close();
+        m_shmChannels.erase(it);
+    }
 }
 
 
@@ -298,6 +401,16 @@ void TransportServer::close()
                 .shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
         }
         m_sessions.clear();
+        if (m_shmAcceptor) {
+            m_shmAcceptor->close();
+        }
+        {
+            boost::mutex::scoped_lock lock(m_shmMutex);
+            for (auto it = m_shmChannels.begin(); it != m_shmChannels.end(); it++) {
+                it->second->close();
+            }
+            m_shmChannels.clear();
+        }
         m_service.reset();
         ELOG_DEBUG("Closed %p", this);
     }
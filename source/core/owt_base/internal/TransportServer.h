@@ -7,6 +7,7 @@
 
 #include "IOService.h"
 #include "RawTransport.h"
+#include "ShmChannel.h"
 #include "TransportBase.h"
 
 #include <boost/asio.hpp>
@@ -29,7 +30,8 @@ using boost::asio::ip::tcp;
 /*
  * TransportServer
  */
-class TransportServer : public TransportSession::Listener {
+class TransportServer : public TransportSession::Listener,
+                        public ShmChannel::Listener {
     DECLARE_LOGGER();
 public:
     class Listener {
@@ -37,18 +39,24 @@ public:
         virtual void onSessionAdded(int id) = 0;
         virtual void onSessionData(int id, uint8_t* data, uint32_t len) = 0;
         virtual void onSessionRemoved(int id) = 0;
+        // Video was dropped sending to the session, until a key frame
+        virtual void onSessionKeyFrameNeeded(int id) { }
     };
     TransportServer(Listener* listener);
     ~TransportServer();
 
     bool enableSecure();
+    // Also accept the clients of the same host on shared memory, at the
+    // listening port. Must be called before listenTo.
+    void enableShm();
 
     // Follow RawTransportInterface
     void listenTo(uint32_t port);
     void listenTo(uint32_t minPort, uint32_t maxPort);
     void sendData(const uint8_t* data, uint32_t len);
     void sendData(const uint8_t* header, uint32_t headerLength,
-                  const uint8_t* payload, uint32_t payloadLength);
+                  const uint8_t* payload, uint32_t payloadLength,
+                  SendItemKind kind = SEND_ITEM_CONTROL);
     void close();
     bool initTicket(const std::string& ticket) { return true; }
 
@@ -57,10 +65,22 @@ public:
     // Implements TransportSession::Listener
     void onData(uint32_t id, TransportData data) override;
     void onClose(uint32_t id) override;
+    void onKeyFrameNeeded(uint32_t id) override;
 
-    void sendSessionData(int id, const uint8_t* data, uint32_t len);
+    // Implements ShmChannel::Listener
+    void onShmData(uint32_t id, uint8_t* data, uint32_t len) override;
+    void onShmClosed(uint32_t id) override;
+    void onShmKeyFrameNeeded(uint32_t id) override;
+
+    void sendSessionData(int id, const uint8_t* data, uint32_t len,
+                         SendItemKind kind = SEND_ITEM_CONTROL);
+    // Queues the message as is, its buffer may be shared with other sessions.
+    void sendSessionData(int id, const TransportData& data);
     void closeSession(int id);
 
+    // Sum of the send queue statistics of all sessions
+    SendQueueStats getSendQueueStats();
+
 private:
     typedef boost::asio::ssl::stream<boost::asio::ip::tcp::socket> SSLSocket;
 
@@ -69,9 +89,15 @@ private:
     void handshakeHandler(std::shared_ptr<SSLSocket> sock,
                           const boost::system::error_code& ec);
     void onSessionRemoved(int id);
+    void shmAcceptHandler(ShmChannel::Socket& socket);
+    std::shared_ptr<ShmChannel> shmChannel(int id);
 
     int m_nextSessionId;
     std::unordered_map<int, std::shared_ptr<TransportSession>> m_sessions;
+    // Sessions of the same host, sending through shared memory
+    std::unique_ptr<ShmAcceptor> m_shmAcceptor;
+    boost::mutex m_shmMutex;
+    std::unordered_map<int, std::shared_ptr<ShmChannel>> m_shmChannels;
 
     std::shared_ptr<IOService> m_service;
 
@@ -36,13 +36,6 @@ static std::unique_ptr<webrtc::FieldTrialBasedConfig> g_fieldTrial= []()
 static std::shared_ptr<webrtc::RtcEventLog> g_eventLog =
     std::make_shared<webrtc::RtcEventLogNull>();
 
-static std::shared_ptr<webrtc::TaskQueueFactory> g_taskQueueFactory =
-    createStaticTaskQueueFactory();
-static std::shared_ptr<rtc::TaskQueue> g_taskQueue =
-    std::make_shared<rtc::TaskQueue>(g_taskQueueFactory->CreateTaskQueue(
-        "CallTaskQueue",
-        webrtc::TaskQueueFactory::Priority::NORMAL));
-
 static constexpr int kStartBitrateBps = 800000;
 
 class RtcAdapterImpl : public RtcAdapter,
@@ -74,9 +67,9 @@ public:
     }
     std::shared_ptr<webrtc::TaskQueueFactory> taskQueueFactory() override
     {
-        return g_taskQueueFactory;
+        return m_taskQueueFactory;
     }
-    std::shared_ptr<rtc::TaskQueue> taskQueue() override { return g_taskQueue; }
+    std::shared_ptr<rtc::TaskQueue> taskQueue() override { return m_taskQueue; }
     std::shared_ptr<webrtc::RtcEventLog> eventLog() override { return g_eventLog; }
     webrtc::WebRtcKeyValueConfig* trial() override { return g_fieldTrial.get(); }
     ControllerSendPtr rtpTransportController() override
@@ -99,6 +92,9 @@ private:
     void initCall();
     void initRtpTransportController();
 
+    // Queues of this adapter all come from one slot of the static pool
+    std::shared_ptr<webrtc::TaskQueueFactory> m_taskQueueFactory;
+    std::shared_ptr<rtc::TaskQueue> m_taskQueue;
     std::shared_ptr<CallPtr> m_callPtr;
 
     // For sender
@@ -111,6 +107,10 @@ private:
 };
 
 RtcAdapterImpl::RtcAdapterImpl()
+    : m_taskQueueFactory(createStaticTaskQueueFactory())
+    , m_taskQueue(std::make_shared<rtc::TaskQueue>(m_taskQueueFactory->CreateTaskQueue(
+          "CallTaskQueue",
+          webrtc::TaskQueueFactory::Priority::NORMAL)))
 {
 }
 
@@ -118,8 +118,10 @@ RtcAdapterImpl::~RtcAdapterImpl()
 {
     if (m_callPtr) {
         std::shared_ptr<CallPtr> pCallPtr = m_callPtr;
+        // The call creates its queues from the factory until it is destroyed
+        std::shared_ptr<webrtc::TaskQueueFactory> factory = m_taskQueueFactory;
         m_callPtr.reset();
-        g_taskQueue->PostTask([pCallPtr]() {
+        m_taskQueue->PostTask([pCallPtr, factory]() {
             if (*pCallPtr) {
                 (*pCallPtr).reset();
             }
@@ -134,11 +136,12 @@ void RtcAdapterImpl::initCall()
     }
     m_callPtr.reset(new CallPtr());
     std::shared_ptr<CallPtr> pCallPtr = m_callPtr;
-    g_taskQueue->PostTask([pCallPtr]() {
+    webrtc::TaskQueueFactory* factory = m_taskQueueFactory.get();
+    m_taskQueue->PostTask([pCallPtr, factory]() {
         // Initialize call
         if (!(*pCallPtr)) {
             webrtc::Call::Config call_config(g_eventLog.get());
-            call_config.task_queue_factory = g_taskQueueFactory.get();
+            call_config.task_queue_factory = factory;
             call_config.trials = g_fieldTrial.get();
 
             if (!g_moduleThread) {
@@ -173,7 +176,7 @@ void RtcAdapterImpl::initRtpTransportController()
             webrtc::Clock::GetRealTimeClock(), g_eventLog.get(),
             nullptr/*network_state_predicator_factory*/,
             nullptr/*network_controller_factory*/, bitrateConstraints,
-            std::move(pacerThreadProxy)/*pacer_thread*/, g_taskQueueFactory.get(), g_fieldTrial.get());
+            std::move(pacerThreadProxy)/*pacer_thread*/, m_taskQueueFactory.get(), g_fieldTrial.get());
         m_transportControllerSend->RegisterTargetTransferRateObserver(this);
     }
 }
@@ -301,4 +304,14 @@ RtcAdapter* RtcAdapterFactory::CreateRtcAdapter()
 
 void RtcAdapterFactory::DestroyRtcAdapter(RtcAdapter* adapter) {}
 
+void RtcAdapterFactory::SetTaskQueuePoolSize(size_t size)
+{
+    setStaticTaskQueuePoolSize(size);
+}
+
+std::vector<TaskQueueStats> RtcAdapterFactory::GetTaskQueueStats()
+{
+    return getStaticTaskQueueStats();
+}
+
 } // namespace rtc_adapter
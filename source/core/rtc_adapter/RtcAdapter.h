@@ -6,6 +6,8 @@
 #define RTC_ADAPTER_RTC_ADAPTER_H_
 
 #include <MediaFramePipeline.h>
+#include <string>
+#include <vector>
 
 namespace rtc_adapter {
 
@@ -30,6 +32,16 @@ struct AdapterStats {
     owt_base::FrameFormat format = owt_base::FRAME_FORMAT_UNKNOWN;
 };
 
+// Stats of one static WebRTC task queue
+struct TaskQueueStats {
+    std::string name;
+    size_t index;
+    // Adapters currently placed on this slot
+    uint32_t users;
+    uint64_t tasks;
+    uint64_t busyUs;
+};
+
 class AdapterStatsListener {
 public:
     virtual void onAdapterStats(const AdapterStats& stat) = 0;
@@ -105,6 +117,10 @@ public:
     static RtcAdapter* CreateRtcAdapter();
     // Use delete instead of this function
     static void DestroyRtcAdapter(RtcAdapter*);
+    // Number of WebRTC task queues per kind shared by all adapters,
+    // applies to adapters created afterwards
+    static void SetTaskQueuePoolSize(size_t size);
+    static std::vector<TaskQueueStats> GetTaskQueueStats();
 };
 
 } // namespace rtc_adapter
@@ -71,11 +71,12 @@ static int getNextNaluPosition(uint8_t* buffer, int buffer_size, bool& is_aud_or
 }
 
 #define MAX_NALS_PER_FRAME 128
-static int dropAUDandSEI(uint8_t* framePayload, int frameLength)
+// Copies the frame without its AUD and SEI NALs into |filtered|, returns
+// false if it has none. The frame itself is shared with other destinations.
+static bool dropAUDandSEI(uint8_t* framePayload, int frameLength, std::vector<uint8_t>& filtered)
 {
     uint8_t* origin_pkt_data = framePayload;
     int origin_pkt_length = frameLength;
-    uint8_t* head = origin_pkt_data;
 
     std::vector<int> nal_offset;
     std::vector<bool> nal_type_is_aud_or_sei;
@@ -103,7 +104,7 @@ static int dropAUDandSEI(uint8_t* framePayload, int frameLength)
         }
     }
     if (sc_positions_length == 0 || !has_aud_or_sei)
-        return frameLength;
+        return false;
     // Calculate size of each NALs
     for (unsigned int count = 0; count < nal_offset.size(); count++) {
         if (count + 1 == nal_offset.size()) {
@@ -112,15 +113,16 @@ static int dropAUDandSEI(uint8_t* framePayload, int frameLength)
             nal_size.push_back(nal_offset[count + 1] - nal_offset[count]);
         }
     }
-    // remove in place the AUD NALs
-    int new_size = 0;
+    // copy all but the AUD and SEI NALs
+    filtered.clear();
+    filtered.reserve(origin_pkt_length);
     for (unsigned int i = 0; i < nal_offset.size(); i++) {
         if (!nal_type_is_aud_or_sei[i]) {
-            memmove(head + new_size, head + nal_offset[i], nal_size[i]);
-            new_size += nal_size[i];
+            filtered.insert(filtered.end(), origin_pkt_data + nal_offset[i],
+                origin_pkt_data + nal_offset[i] + nal_size[i]);
         }
     }
-    return new_size;
+    return true;
 }
 
 static void dump(void* index, FrameFormat format, uint8_t* buf, int len)
@@ -357,24 +359,18 @@ void VideoSendAdapterImpl::onFrame(const Frame& frame)
             0);
 
     } else if (frame.format == FRAME_FORMAT_H264 || frame.format == FRAME_FORMAT_H265) {
-        int frame_length = frame.length;
         if (m_enableDump) {
-            dump(this, frame.format, frame.payload, frame_length);
+            dump(this, frame.format, frame.payload, frame.length);
         }
 
         //FIXME: temporarily filter out AUD because chrome M59 could NOT handle it correctly.
         //FIXME: temporarily filter out SEI because safari could NOT handle it correctly.
-        if (frame.format == FRAME_FORMAT_H264) {
-            frame_length = dropAUDandSEI(frame.payload, frame_length);
+        rtc::ArrayView<const uint8_t> payload(frame.payload, frame.length);
+        std::vector<uint8_t> filtered;
+        if (frame.format == FRAME_FORMAT_H264 && dropAUDandSEI(frame.payload, frame.length, filtered)) {
+            payload = filtered;
         }
 
-        int nalu_found_length = 0;
-        uint8_t* buffer_start = frame.payload;
-        int buffer_length = frame_length;
-        int nalu_start_offset = 0;
-        int nalu_end_offset = 0;
-        int sc_len = 0;
-
         h.codec = (frame.format == FRAME_FORMAT_H264) ?
             webrtc::VideoCodecType::kVideoCodecH264 :
             webrtc::VideoCodecType::kVideoCodecH265;
@@ -387,7 +383,7 @@ void VideoSendAdapterImpl::onFrame(const Frame& frame)
                 webrtc::kVideoCodecH264,
                 timeStamp,
                 timeStamp,
-                rtc::ArrayView<const uint8_t>(frame.payload, frame.length),
+                payload,
                 h,
                 m_rtpRtcp->ExpectedRetransmissionTimeMs(),
                 0);
@@ -9,6 +9,10 @@
 #include <rtc_base/task_utils/to_queued_task.h>
 #include <api/task_queue/task_queue_base.h>
 #include <api/task_queue/default_task_queue_factory.h>
+#include <rtc_base/time_utils.h>
+
+#include <atomic>
+#include <mutex>
 
 namespace rtc_adapter {
 
@@ -25,6 +29,150 @@ public:
                          uint32_t milliseconds) override {}
 };
 
+static constexpr size_t kQueueKinds = 4;
+static const char* kQueueNames[kQueueKinds] = {
+    "CallTaskQueue", "DecodingQueue", "rtp_send_controller", "TaskQueuePacedSender"};
+static const webrtc::TaskQueueFactory::Priority kQueuePriorities[kQueueKinds] = {
+    webrtc::TaskQueueFactory::Priority::NORMAL,
+    webrtc::TaskQueueFactory::Priority::HIGH,
+    webrtc::TaskQueueFactory::Priority::NORMAL,
+    webrtc::TaskQueueFactory::Priority::NORMAL};
+
+// Busy time of each queue is logged at most this often
+static constexpr int64_t kStatsIntervalUs = 30 * rtc::kNumMicrosecsPerSec;
+
+// Counters of one pooled queue, updated on the queue thread
+struct QueueStats {
+    const char* name = nullptr;
+    size_t index = 0;
+    std::atomic<uint64_t> tasks{0};
+    std::atomic<uint64_t> busyUs{0};
+    int64_t lastReportUs = 0;
+    uint64_t reportedBusyUs = 0;
+
+    void addTask(int64_t startUs, int64_t endUs)
+    {
+        tasks++;
+        uint64_t busy = (busyUs += (endUs - startUs));
+
+        if (lastReportUs == 0) {
+            lastReportUs = endUs;
+        } else if (endUs - lastReportUs >= kStatsIntervalUs) {
+            RTC_LOG(LS_INFO) << "TaskQueue " << name << "#" << index << " busy "
+                             << (busy - reportedBusyUs) * 100 / (endUs - lastReportUs) << "%";
+            lastReportUs = endUs;
+            reportedBusyUs = busy;
+        }
+    }
+};
+
+// Process wide pool of |size| queues per name. Every factory is placed on
+// one slot for its lifetime, the slot with fewest users and then least busy
+// time is picked for a new one.
+class TaskQueuePool {
+public:
+    static TaskQueuePool& GetInstance()
+    {
+        // Intentionally leaked, queues may still be used during static destruction.
+        static TaskQueuePool* pool = new TaskQueuePool();
+        return *pool;
+    }
+
+    void setSize(size_t size)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_size = size > 0 ? size : 1;
+        RTC_LOG(LS_INFO) << "TaskQueue pool size " << m_size;
+    }
+
+    size_t acquireSlot()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        while (m_slots.size() < m_size) {
+            Slot* slot = new Slot();
+            for (size_t i = 0; i < kQueueKinds; i++) {
+                slot->stats[i].name = kQueueNames[i];
+                slot->stats[i].index = m_slots.size();
+            }
+            m_slots.push_back(slot);
+        }
+
+        size_t best = 0;
+        for (size_t i = 1; i < m_size; i++) {
+            if (m_slots[i]->users < m_slots[best]->users ||
+                (m_slots[i]->users == m_slots[best]->users &&
+                 m_slots[i]->busyUs() < m_slots[best]->busyUs())) {
+                best = i;
+            }
+        }
+        m_slots[best]->users++;
+        return best;
+    }
+
+    void releaseSlot(size_t slot)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_slots[slot]->users--;
+    }
+
+    // Returns nullptr for names not served by the pool
+    webrtc::TaskQueueBase* getQueue(absl::string_view name, size_t slot, QueueStats** stats)
+    {
+        for (size_t i = 0; i < kQueueKinds; i++) {
+            if (name != absl::string_view(kQueueNames[i])) {
+                continue;
+            }
+            std::lock_guard<std::mutex> lock(m_mutex);
+            Slot* s = m_slots[slot];
+            if (!s->queues[i]) {
+                s->queues[i] = m_defaultFactory->CreateTaskQueue(kQueueNames[i], kQueuePriorities[i]);
+            }
+            *stats = &s->stats[i];
+            return s->queues[i].get();
+        }
+        return nullptr;
+    }
+
+    std::vector<TaskQueueStats> getStats()
+    {
+        std::vector<TaskQueueStats> result;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (Slot* slot : m_slots) {
+            for (size_t i = 0; i < kQueueKinds; i++) {
+                if (slot->queues[i]) {
+                    const QueueStats& stats = slot->stats[i];
+                    result.push_back(TaskQueueStats{
+                        stats.name, stats.index, slot->users, stats.tasks, stats.busyUs});
+                }
+            }
+        }
+        return result;
+    }
+
+private:
+    struct Slot {
+        std::unique_ptr<webrtc::TaskQueueBase, webrtc::TaskQueueDeleter> queues[kQueueKinds];
+        QueueStats stats[kQueueKinds];
+        uint32_t users = 0;
+
+        uint64_t busyUs() const
+        {
+            uint64_t total = 0;
+            for (size_t i = 0; i < kQueueKinds; i++) {
+                total += stats[i].busyUs;
+            }
+            return total;
+        }
+    };
+
+    TaskQueuePool() : m_defaultFactory(webrtc::CreateDefaultTaskQueueFactory()) {}
+
+    std::mutex m_mutex;
+    size_t m_size = 1;
+    std::vector<Slot*> m_slots;
+    std::unique_ptr<webrtc::TaskQueueFactory> m_defaultFactory;
+};
+
 // TaskQueueProxy holds a TaskQueueBase* and proxy its method without Delete
 class TaskQueueProxy : public webrtc::TaskQueueBase {
 public:
@@ -46,10 +194,12 @@ public:
                 // Set current to pass RTC_DCHECK
                 webrtc::TaskQueueBase::CurrentTaskQueueSetter setCurrent(m_parent);
                 // Only run when owner exists
+                int64_t startUs = rtc::TimeMicros();
                 QueuedTask* raw = m_task.release();
                 if (raw->Run()) {
                     delete raw;
                 }
+                m_parent->m_stats->addTask(startUs, rtc::TimeMicros());
             }
             return true;
         }
@@ -59,8 +209,8 @@ public:
         TaskQueueProxy* m_parent;
     };
 
-    TaskQueueProxy(webrtc::TaskQueueBase* taskQueue)
-        : m_taskQueue(taskQueue), m_sp(std::make_shared<int>(1))
+    TaskQueueProxy(webrtc::TaskQueueBase* taskQueue, QueueStats* stats)
+        : m_taskQueue(taskQueue), m_stats(stats), m_sp(std::make_shared<int>(1))
     {
         RTC_CHECK(m_taskQueue);
     }
@@ -92,45 +242,27 @@ public:
     }
 private:
     webrtc::TaskQueueBase* m_taskQueue;
+    QueueStats* m_stats;
     // Use shared_ptr to track its tasks
     std::shared_ptr<int> m_sp;
 };
 
-// Provide static TaskQueues
+// Provide static TaskQueues from one slot of the pool
 class StaticTaskQueueFactory final : public webrtc::TaskQueueFactory {
  public:
+    StaticTaskQueueFactory() : m_slot(TaskQueuePool::GetInstance().acquireSlot()) {}
+    ~StaticTaskQueueFactory() override { TaskQueuePool::GetInstance().releaseSlot(m_slot); }
+
     // Implements webrtc::TaskQueueFactory
     std::unique_ptr<webrtc::TaskQueueBase, webrtc::TaskQueueDeleter> CreateTaskQueue(
         absl::string_view name,
         webrtc::TaskQueueFactory::Priority priority) const override
     {
-        // Use a pool if following threads take too heavy load
-        static std::unique_ptr<webrtc::TaskQueueFactory> defaultTaskQueueFactory =
-            webrtc::CreateDefaultTaskQueueFactory();
-        static std::unique_ptr<webrtc::TaskQueueBase, webrtc::TaskQueueDeleter> callTaskQueue =
-            defaultTaskQueueFactory->CreateTaskQueue(
-                "CallTaskQueue", webrtc::TaskQueueFactory::Priority::NORMAL);
-        static std::unique_ptr<webrtc::TaskQueueBase, webrtc::TaskQueueDeleter> decodingQueue =
-            defaultTaskQueueFactory->CreateTaskQueue(
-                "DecodingQueue", webrtc::TaskQueueFactory::Priority::HIGH);
-        static std::unique_ptr<webrtc::TaskQueueBase, webrtc::TaskQueueDeleter> rtpSendCtrlQueue =
-            defaultTaskQueueFactory->CreateTaskQueue(
-                "rtp_send_controller", webrtc::TaskQueueFactory::Priority::NORMAL);
-        static std::unique_ptr<webrtc::TaskQueueBase, webrtc::TaskQueueDeleter> tempQueue =
-            defaultTaskQueueFactory->CreateTaskQueue(
-                "TaskQueuePacedSender", webrtc::TaskQueueFactory::Priority::NORMAL);
-        if (name == absl::string_view("CallTaskQueue")) {
-            return std::unique_ptr<webrtc::TaskQueueBase, webrtc::TaskQueueDeleter>(
-                new TaskQueueProxy(callTaskQueue.get()));
-        } else if (name == absl::string_view("DecodingQueue")) {
-            return std::unique_ptr<webrtc::TaskQueueBase, webrtc::TaskQueueDeleter>(
-                new TaskQueueProxy(decodingQueue.get()));
-        } else if (name == absl::string_view("rtp_send_controller")) {
-            return std::unique_ptr<webrtc::TaskQueueBase, webrtc::TaskQueueDeleter>(
-                new TaskQueueProxy(rtpSendCtrlQueue.get()));
-        } else if (name == absl::string_view("TaskQueuePacedSender")) {
+        QueueStats* stats = nullptr;
+        webrtc::TaskQueueBase* taskQueue = TaskQueuePool::GetInstance().getQueue(name, m_slot, &stats);
+        if (taskQueue) {
             return std::unique_ptr<webrtc::TaskQueueBase, webrtc::TaskQueueDeleter>(
-                new TaskQueueProxy(tempQueue.get()));
+                new TaskQueueProxy(taskQueue, stats));
         } else {
             // Return dummy task queue for other names like "IncomingVideoStream"
             RTC_DLOG(LS_INFO) << "Dummy TaskQueue for " << name;
@@ -138,6 +270,9 @@ class StaticTaskQueueFactory final : public webrtc::TaskQueueFactory {
                 new TaskQueueDummy());
         }
     }
+
+ private:
+    const size_t m_slot;
 };
 
 std::unique_ptr<webrtc::TaskQueueFactory> createStaticTaskQueueFactory()
@@ -145,4 +280,14 @@ std::unique_ptr<webrtc::TaskQueueFactory> createStaticTaskQueueFactory()
     return std::unique_ptr<webrtc::TaskQueueFactory>(new StaticTaskQueueFactory());
 }
 
+void setStaticTaskQueuePoolSize(size_t size)
+{
+    TaskQueuePool::GetInstance().setSize(size);
+}
+
+std::vector<TaskQueueStats> getStaticTaskQueueStats()
+{
+    return TaskQueuePool::GetInstance().getStats();
+}
+
 } // namespace rtc_adapter
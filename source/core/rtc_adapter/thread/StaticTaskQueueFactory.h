@@ -6,13 +6,22 @@
 #define RTC_ADAPTER_THREAD_STATIC_TASK_QUEUE_FACTORY_
 
 #include <memory>
+#include <vector>
 
+#include "RtcAdapter.h"
 #include "api/task_queue/task_queue_factory.h"
 
 namespace rtc_adapter {
 
+// Each factory is placed on one slot of the static queue pool and creates
+// all its queues from that slot, so the queues of one adapter share a slot.
 std::unique_ptr<webrtc::TaskQueueFactory> createStaticTaskQueueFactory();
 
+// Number of queues per name, applies to factories created afterwards.
+void setStaticTaskQueuePoolSize(size_t size);
+
+std::vector<TaskQueueStats> getStaticTaskQueueStats();
+
 }  // namespace webrtc
 
 #endif  // RTC_ADAPTER_THREAD_STATIC_TASK_QUEUE_FACTORY_
@@ -54,6 +54,14 @@ exports.add = function (req, res, next) {
       sub_req.connection.parameters = req.body.parameters || {method: 'PUT', dashSegDuration: 2, dashWindowSize: 5};
     }
 
+    if (req.body.mirrors) {
+      sub_req.connection.mirrors = req.body.mirrors.map((mirror) => ({
+        protocol: mirror.protocol || guessProtocol(mirror.url),
+        url: mirror.url,
+        parameters: mirror.parameters
+      }));
+    }
+
     requestHandler.addServerSideSubscription(req.params.room, sub_req, function (result, err) {
         if (result === 'error') {
             return next(err);
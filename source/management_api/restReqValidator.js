@@ -270,7 +270,12 @@ const ServerSideSubscriptionRequest = {
             additionalProperties: false,
             required: ['method', 'dashSegDuration', 'dashWindowSize']
           }
-        ]}
+        ]},
+        // Further outputs of the same mux, each of them may fail alone
+        'mirrors': {
+          type: 'array',
+          items: { $ref: '#/definitions/StreamingOutConnectionOptions' }
+        }
       },
       additionalProperties: false,
       required: ['protocol', 'url']